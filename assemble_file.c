@@ -8,37 +8,146 @@
 #include "utils.h"
 #include "secondPass.h"
 #include "writeOutputFiles.h"
+#include "mapped_file.h"
+#include "output_buffer.h"
+#include "batch_io.h"
+#include "translation.h"
+#include "diagnostics.h"
+#include "data_structures/hashtable.h"
+
+/* the copy_macro_symbols function creates a new symbol list with the macros from the symbol table.
+    the parser checks new constants against it, the same way it checks them against the symbol table before the first pass */
+static Symbol_Node * copy_macro_symbols(translation* output, int* allocationError) {
+    Symbol_Node *copy = NULL, *current, *inserted;
+    for (current = output->symbol_table_head; current != NULL; current = current->next) {
+        if (current->symbol->type == ENUM_SYMBOL_CONSTANT_MACRO) {
+            inserted = insert_symbol_from(&copy, &output->free_symbols, current->symbol->name);
+            if (inserted == NULL) {
+                *allocationError = 1;
+                break;
+            }
+            inserted->symbol->type = ENUM_SYMBOL_CONSTANT_MACRO;
+        }
+    }
+    return copy;
+}
+
+/* the add_constant_symbol function adds a constant that was defined on the i-th line to the symbol table,
+    unless a symbol with the same name was already defined */
+static int add_constant_symbol(const char* fileName, translation* output, ParsedSyntaxLine* line, int i, int* allocationError) {
+    Symbol_Node* current;
+    if (symbol_contains(output->symbol_table_head, line->statement.constantDefinition.name) != NULL) {
+        report(DIAG_SYMBOL_ALREADY_DEFINED, fileName, i + 1, 0, "s", line->statement.constantDefinition.name);
+        return 1;
+    }
+    current = insert_symbol_from(&output->symbol_table_head, &output->free_symbols, line->statement.constantDefinition.name);
+    if (current == NULL) {
+        *allocationError = 1;
+        return 0;
+    }
+    current->symbol->type = ENUM_SYMBOL_CONSTANT_MACRO;
+    return 0;
+}
+
+/* the stream_passes function runs both passes over the am file while reading it line by line.
+    every line is parsed, handled and freed before the next one is read, so the memory that is used depends on the 
+    number of symbols and not on the number of lines. the mapped file is read a second time for the second pass. */
+static int stream_passes(char* amName, translation* output, const AssemblerOptions* options, int* allocationError) {
+    MappedFile file;
+    LineView line;
+    size_t offset;
+    Symbol_Node* parseSymbols[2]; /* for each pass, the symbols that the parser checks constant definitions against */
+    ParsedSyntaxLine* parsedLine;
+    int IC = START_POSITION, DC = 0;
+    int i, pass, error = 0;
+
+    if (map_file(amName, &file) != 0) {
+        fprintf(stderr, "File could not be opened.\n");
+        *allocationError = 1;
+        return 1;
+    }
+
+    /* both copies are taken before the first pass adds the constants to the symbol table */
+    parseSymbols[0] = copy_macro_symbols(output, allocationError);
+    parseSymbols[1] = copy_macro_symbols(output, allocationError);
+
+    for (pass = 1; pass <= 2 && !*allocationError && !error_limit_reached(); pass++) {
+        if (pass == 2 && error && options->failFast) {
+            break;
+        }
+        /* each pass defines the constants again, from an empty table */
+        clear_hashtable(output->constants_table);
+        offset = 0;
+        for (i = 0; next_line(&file, &offset, &line); i++) {
+            parsedLine = parse_line(line.start, line.length, output->constants_table, &parseSymbols[pass - 1], &output->free_symbols);
+            if (parsedLine == NULL) {
+                fprintf(stderr, "Memory allocation failed");
+                *allocationError = 1;
+                break;
+            }
+            if (pass == 1) {
+                if (parsedLine->type == ENUM_CONSTANT_DEFINITION && parsedLine->error == NULL) {
+                    error |= add_constant_symbol(amName, output, parsedLine, i, allocationError);
+                }
+                error |= firstPassLine(amName, output, parsedLine, i, &IC, &DC);
+            } else {
+                error |= secondPassLine(parsedLine, output, i, amName);
+            }
+            free_parsed_syntax_line(parsedLine);
+            if (*allocationError || error_limit_reached()) break;
+        }
+        if (pass == 1) {
+            error |= finishFirstPass(amName, output, IC, DC);
+        }
+    }
+
+    /* the copies go back to the nodes that the next file uses */
+    recycle_symbols(parseSymbols[0], &output->free_symbols);
+    recycle_symbols(parseSymbols[1], &output->free_symbols);
+    unmap_file(&file);
+    return error;
+}
+
+/* the move_to_bundle function moves a file that had to be written on its own (the am file in streaming mode) into the output bundle */
+static void move_to_bundle(const char* fileName) {
+    MappedFile file;
+    OutputBuffer buffer;
+    if (map_file(fileName, &file) != 0) {
+        return;
+    }
+    init_output_buffer(&buffer, NULL);
+    output_write(&buffer, file.data, file.size);
+    unmap_file(&file);
+    if (write_output_file(fileName, &buffer) == 0) {
+        remove(fileName);
+    }
+    free_output_buffer(&buffer);
+}
 
 /* the assemble_file function, recives the name of the file to assemble from the assenbler.
     then it goes through all the steps to create and assemble the output of the file  */
-void assemble_file(const char* filename) {
+void assemble_file(const char* filename, const MappedFile* preloadedSource, const AssemblerOptions* options, translation* output) {
     ParsedSyntaxLine **lines = NULL;
-    translation *output = NULL;
     int lineCount = 0;
     char *amName = NULL, *asName = NULL;
     int i;
     int error = 0, allocationError = 0; /* a flag to indicate if there's an error */
+    MappedFile source, amFile;
+    boolean sourceMapped = FALSE;
+    OutputBuffer amOutput;
+    FILE* amFp = NULL;
 
-    /* Initialize output values */
-    output = malloc(sizeof(translation));
-    if (output == NULL) {
-        fprintf(stderr, "Failed to allocate memory for translation struct\n");
-        goto end;
-    }
-    output->symbol_table_head = NULL;
-    output->external_table_head = NULL;
-    output->IC = START_POSITION;
-    output->DC = 0;
-    
-    for (i = 0; i < MEMORY_SIZE; i++) {
-        output->code_image[i] = 0;
-        output->data_image[i] = 0;
-    }
+    init_output_buffer(&amOutput, NULL);
+
+    /* Clear what the previous file left in the translation */
+    reset_translation(output);
+    begin_file_diagnostics(filename, options->maxErrors);
 
     amName = concatenate_strings(filename, ".am");
 
     if (amName == NULL) {
         fprintf(stderr, "Failed to allocate memory for am file name\n");
+        error = 1;
         goto end;
     }
 
@@ -46,40 +155,106 @@ void assemble_file(const char* filename) {
 
     if (asName == NULL) {
         fprintf(stderr, "Failed to allocate memory for as file name\n");
+        error = 1;
         goto end;
     }
 
     printf("Processing file \"%s\"\n", asName);
     printf("Creating .am file for file \"%s\"\n", asName);
+    /* The source was already read if the file is part of a batch */
+    if (preloadedSource != NULL) {
+        source = *preloadedSource;
+    } else if (map_file(asName, &source) == 0) {
+        sourceMapped = TRUE;
+    } else {
+        fprintf(stderr, "File %s could not be opened.\n", asName);
+        remove_output_file(amName);
+        error = PREPROCESS_FAIL;
+        goto end;
+    }
+
+    /* In streaming mode the am file is written right away, so it can be read again line by line.
+     Otherwise it is kept in memory, parsed from there, and written afterwards */
+    if (options->streaming) {
+        amFp = fopen(amName, "w+");
+        if (amFp == NULL) {
+            fprintf(stderr, "File %s could not be opened.\n", amName);
+            error = PREPROCESS_FAIL;
+            goto end;
+        }
+        init_output_buffer(&amOutput, amFp);
+    }
+
     /* Perform preprocessing */
-    error = create_preprocessed_file(filename, &output->symbol_table_head, asName, amName);
+    error = preprocess_source(&source, &output->symbol_table_head, &output->free_symbols, asName, &amOutput, NULL);
+    if (amFp != NULL) {
+        fclose(amFp);
+    }
     /* If the preprocessing failed, end the assemble process because an am file can't be created'*/
-    if (error == PREPROCESS_FAIL) {
+    if (error == PREPROCESS_FAIL || amOutput.failed) {
+        /* a streamed am file was written directly and not through the output files stage */
+        if (amFp != NULL) {
+            remove(amName);
+        } else {
+            remove_output_file(amName);
+        }
+        error = PREPROCESS_FAIL;
         goto end;
     }
 
     printf("Parsing file \"%s\"\n", amName);
-    /* Parse the file into a linked list of parsed lines */
-    lines = parse_file(amName, &lineCount, &output->symbol_table_head, &allocationError);
+    if (options->streaming) {
+        /* Parse and translate the file line by line, without keeping the parsed lines */
+        error |= stream_passes(amName, output, options, &allocationError);
+        if (options->bundlePath != NULL) {
+            move_to_bundle(amName);
+        }
+        if (allocationError) {
+            error = 1;
+            goto end;
+        }
+    } else {
+        /* Parse the am file from memory into a linked list of parsed lines, then write it */
+        amFile.data = amOutput.data;
+        amFile.size = amOutput.size;
+        amFile.isMapped = FALSE;
+        lines = parse_source(&amFile, &lineCount, &output->symbol_table_head, &output->free_symbols, output->constants_table, &allocationError);
+        write_output_file(amName, &amOutput);
 
-    if (allocationError) {
-        goto end;
-    }
+        if (allocationError) {
+            error = 1;
+            goto end;
+        }
 
-    error |= firstPass(amName, output, lines, lineCount);
+        error |= firstPass(amName, output, lines, lineCount);
 
-    /* we go into the secondPass phase even if there's an error, so that we can find additional errors */
-    error |= secondPass(lines, output, lineCount, amName);
+        /* we go into the secondPass phase even if there's an error, so that we can find additional errors,
+            unless the file already has too many errors or --fail-fast was given */
+        if (!error_limit_reached() && !(error && options->failFast)) {
+            error |= secondPass(lines, output, lineCount, amName);
+        }
+    }
+
+    if (output->code_image.failed || output->data_image.failed) {
+        fprintf(stderr, "Failed to allocate memory for the memory image\n");
+        error = 1;
+        goto end;
+    }
 
+    /* the diagnostics of the file are written together, before the output files */
+    flush_diagnostics();
     if (error == 0) {
         /* only create the output files if there is no error */
         write_output_files(filename, output);
     }
 
     end:
+    flush_diagnostics();
     printf("Finished assembling file \"%s\" with %s\n\n", filename, error ? "errors" : "success");
     
     /* free all assigned memory */
+    free_output_buffer(&amOutput);
+    if (sourceMapped) unmap_file(&source);
     i = 0;
     while (i < lineCount) {
         if (lines[i] != NULL)
@@ -89,10 +264,5 @@ void assemble_file(const char* filename) {
     if (amName != NULL) free(amName);
     if (asName != NULL) free(asName);
     if (lines != NULL) free(lines);
-    if (output != NULL && output->external_table_head != NULL)
-        free_externals(output->external_table_head);
-    if (output != NULL && output->symbol_table_head != NULL) 
-        free_symbols(output->symbol_table_head);
-    if (output != NULL)
-        free(output);
+    /* the tables of the translation are kept for the next file, and are emptied by reset_translation */
 }
\ No newline at end of file
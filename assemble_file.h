@@ -1,8 +1,13 @@
 #ifndef ASSEMBLE_FILE_H
 #define ASSEMBLE_FILE_H
 
+#include "structs.h"
+#include "mapped_file.h"
+
 /* the assemble_file function, recives the name of the file to assemble from the assenbler.
-    then it goes through all the steps to create and assemble the output of the file  */
-void assemble_file(const char* filename);
+    then it goes through all the steps to create and assemble the output of the file.
+    preloadedSource is the content of the .as file if it was already read, or NULL if the file should be read here.
+    output is the translation that the file is assembled into, it is reset first so that it can be reused for every file */
+void assemble_file(const char* filename, const MappedFile* preloadedSource, const AssemblerOptions* options, translation* output);
 
 #endif
\ No newline at end of file
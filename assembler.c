@@ -1,23 +1,186 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "parser.h"
 #include "utils.h"
 #include "assemble_file.h"
+#include "batch_io.h"
+#include "translation.h"
+#include "constants.h"
+#include "diagnostics.h"
+#include "watch.h"
+#include "library.h"
+#include "preprocessor.h"
 
 /**
  * The main function of the assembler program. 
- * It reads a list of files from args and assembles those files.
+ * It reads a list of files and options from args and assembles those files.
+ * Options start with "--" and apply to all of the files:
+ *   --stream      parse each file line by line in both passes, so that memory doesn't grow with the number of lines
+ *   --io-depth=N  when more than one file is given, read up to N files ahead and write the output files in the background (default 4, 0 disables it)
+ *   --bundle=PATH write the output files of all of the files into a single bundle at PATH instead of separate files
+ *   --memory-size=N the number of words in the memory of the target machine (default 4096, at most 65536)
+ *   --max-errors=N stop assembling a file after N errors
+ *   --fail-fast   don't run the second pass on a file that had errors in the first pass
+ *   --map         write a .map file with the addresses of the symbols and the line of every instruction, for the profiler of the emulator
+ *   --diagnostics=text|json write the errors and warnings as messages (the default), or as one JSON object per line to stderr
+ *   --watch       after the files are assembled, keep running and assemble every file again when it is saved (Linux only)
+ *   --library=PATH every file uses the macros and the constants of the library at PATH, like it imported it with .import "PATH"
+ *   --define=NAME[=VALUE] a constant for the conditions of every file (.if, .ifdef and .ifndef), 1 when no value is given
+ *   --make-library=PATH compile the macros and the constants of the file into a library at PATH, instead of assembling it
 */
 int main(int argc, char **argv) {
-    int i;
-    
-    if (argc <= 1) {
-        fprintf(stderr, "No files specified, exiting program.\n");
+    int i, fileCount = 0, result = 0;
+    AssemblerOptions options;
+    char** fileNames;
+    char *libraryImage = NULL, *asName;
+    MappedFile source;
+    BundleWriter* bundle = NULL;
+    translation* output = NULL;
+    boolean batch = FALSE;
+
+    options.streaming = FALSE;
+    options.ioDepth = DEFAULT_IO_DEPTH;
+    options.bundlePath = NULL;
+    options.memorySize = MEMORY_SIZE;
+    options.maxErrors = 0;
+    options.failFast = FALSE;
+    options.map = FALSE;
+    options.watch = FALSE;
+
+    fileNames = malloc(argc * sizeof(char*));
+    if (fileNames == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the file names\n");
         return 1;
     }
-    
+
     for (i = 1; i < argc; i++) {
-        assemble_file(argv[i]);
+        if (strncmp(argv[i], "--", 2) != 0) {
+            fileNames[fileCount++] = argv[i];
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            options.streaming = TRUE;
+        } else if (strcmp(argv[i], "--fail-fast") == 0) {
+            options.failFast = TRUE;
+        } else if (strcmp(argv[i], "--map") == 0) {
+            options.map = TRUE;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            options.watch = TRUE;
+        } else if (strcmp(argv[i], "--diagnostics=text") == 0) {
+            set_diagnostics_format(DIAGNOSTICS_TEXT);
+        } else if (strcmp(argv[i], "--diagnostics=json") == 0) {
+            set_diagnostics_format(DIAGNOSTICS_JSON);
+        } else if (strncmp(argv[i], "--max-errors=", 13) == 0 && is_number(argv[i] + 13) && argv[i][13] != '\0' && argv[i][13] != '-') {
+            options.maxErrors = get_number(argv[i] + 13);
+        } else if (strncmp(argv[i], "--io-depth=", 11) == 0 && is_number(argv[i] + 11) && argv[i][11] != '\0') {
+            options.ioDepth = get_number(argv[i] + 11);
+        } else if (strncmp(argv[i], "--memory-size=", 14) == 0 && is_number(argv[i] + 14) && argv[i][14] != '\0'
+            && get_number(argv[i] + 14) > START_POSITION && get_number(argv[i] + 14) <= MAX_MEMORY_SIZE) {
+            options.memorySize = get_number(argv[i] + 14);
+        } else if (strncmp(argv[i], "--bundle=", 9) == 0 && argv[i][9] != '\0') {
+            options.bundlePath = argv[i] + 9;
+        } else if (strncmp(argv[i], "--define=", 9) == 0) {
+            if (define_condition_constant(argv[i] + 9) != 0) {
+                fprintf(stderr, "Invalid define \"%s\", exiting program.\n", argv[i] + 9);
+                result = 1;
+                goto end;
+            }
+        } else if (strncmp(argv[i], "--library=", 10) == 0 && argv[i][10] != '\0') {
+            if (use_library(argv[i] + 10) != 0) {
+                fprintf(stderr, "Library %s could not be loaded, exiting program.\n", argv[i] + 10);
+                result = 1;
+                goto end;
+            }
+        } else if (strncmp(argv[i], "--make-library=", 15) == 0 && argv[i][15] != '\0') {
+            libraryImage = argv[i] + 15;
+        } else {
+            fprintf(stderr, "Unknown option \"%s\", exiting program.\n", argv[i]);
+            result = 1;
+            goto end;
+        }
+    }
+    
+    if (fileCount == 0) {
+        fprintf(stderr, "No files specified, exiting program.\n");
+        result = 1;
+        goto end;
+    }
+    if (libraryImage != NULL) {
+        /* the library is compiled from a single file, nothing is assembled */
+        if (fileCount > 1) {
+            fprintf(stderr, "--make-library takes a single file, exiting program.\n");
+            result = 1;
+        } else {
+            asName = concatenate_strings(fileNames[0], ".as");
+            result = asName == NULL || compile_library(asName, libraryImage, options.maxErrors) != 0;
+            if (asName != NULL) free(asName);
+        }
+        goto end;
+    }
+    if (options.watch && options.bundlePath != NULL) {
+        fprintf(stderr, "--watch can't be used with --bundle, exiting program.\n");
+        result = 1;
+        goto end;
     }
 
-    return 0;
-}
\ No newline at end of file
+    /* one translation is used for all of the files, it keeps its memory between them */
+    output = create_translation(options.memorySize);
+    if (output == NULL) {
+        fprintf(stderr, "Failed to allocate memory for translation struct\n");
+        result = 1;
+        goto end;
+    }
+    if (options.map && enable_line_map(output) != 0) {
+        fprintf(stderr, "Failed to allocate memory for the line map\n");
+        result = 1;
+        goto end;
+    }
+
+    if (options.bundlePath != NULL) {
+        bundle = create_bundle(options.bundlePath);
+        if (bundle == NULL) {
+            fprintf(stderr, "Bundle %s could not be created, exiting program.\n", options.bundlePath);
+            result = 1;
+            goto end;
+        }
+        set_output_bundle(bundle);
+    }
+
+    if (options.watch) {
+        /* the files are first assembled by watch_files, which keeps the state of every file to assemble it again when it is saved */
+        result = watch_files(fileNames, fileCount, &options, output);
+    } else {
+        /* the I/O of a batch of files is done in the background, while the files are assembled one after the other */
+        if (fileCount > 1 && options.ioDepth > 0) {
+            batch = start_batch_io(fileNames, fileCount, options.ioDepth) == 0;
+        }
+
+        for (i = 0; i < fileCount; i++) {
+            if (batch && take_batch_input(i, &source) == 0) {
+                assemble_file(fileNames[i], &source, &options, output);
+                unmap_file(&source);
+            } else {
+                assemble_file(fileNames[i], NULL, &options, output);
+            }
+        }
+
+        finish_batch_io();
+    }
+
+end:
+    /* every exit after the file names were allocated comes here, so the libraries, the defines and the diagnostics are always released */
+    if (bundle != NULL) {
+        set_output_bundle(NULL);
+        if (close_bundle_writer(bundle) != 0) {
+            fprintf(stderr, "Error writing bundle %s\n", options.bundlePath);
+            result = 1;
+        }
+    }
+    end_diagnostics();
+    free_libraries();
+    free_condition_constants();
+    if (output != NULL) {
+        free_translation(output);
+    }
+    free(fileNames);
+    return result;
+}
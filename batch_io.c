@@ -0,0 +1,346 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch_io.h"
+#include "utils.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define HAS_THREADS 1
+#endif
+
+/* When not NULL, every output file is appended to this bundle instead of being written on its own */
+static BundleWriter* outputBundle = NULL;
+
+/* Sends all of the output files that are written from now on into a bundle. NULL goes back to separate files */
+void set_output_bundle(BundleWriter* bundle) {
+    outputBundle = bundle;
+}
+
+/* Writes a whole buffer to a file (or to the output bundle), right away */
+static int write_file_now(const char* path, const char* data, size_t size) {
+    FILE* file;
+    if (outputBundle != NULL) {
+        if (append_to_bundle(outputBundle, path, data, size) != 0) {
+            fprintf(stderr, "Error writing file \"%s\" to the bundle\n", path);
+            return 1;
+        }
+        return 0;
+    }
+    file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error creating file \"%s\"\n", path);
+        return 1;
+    }
+    if (size > 0 && fwrite(data, 1, size, file) != size) {
+        fprintf(stderr, "Error writing file \"%s\"\n", path);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+    return 0;
+}
+
+/* Removes a file right away. Files can't be removed from a bundle, so nothing is done in bundle mode */
+static void remove_file_now(const char* path) {
+    if (outputBundle == NULL) {
+        remove(path);
+    }
+}
+
+#ifdef HAS_THREADS
+
+typedef enum {
+    INPUT_PENDING,
+    INPUT_LOADED,
+    INPUT_FAILED,
+    INPUT_TAKEN
+} InputState;
+
+/* A file that was queued to be written (or removed) by the writer thread */
+typedef struct WriteRequest {
+    char* path;
+    char* data;
+    size_t size;
+    boolean isRemove;
+    struct WriteRequest* next;
+} WriteRequest;
+
+/* The state of the batch I/O stage. One lock and one condition protect all of it */
+static struct {
+    boolean running;
+    boolean stopping;
+    pthread_t reader;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    char** fileNames;
+    int count;
+    int depth;
+    InputState* states;
+    MappedFile* inputs;
+    int taken; /* the inputs before this index were already taken */
+    WriteRequest* queueHead;
+    WriteRequest* queueTail;
+} batch;
+
+/* The reader thread loads the source files in order, while staying at most depth files ahead of the assembler */
+static void* reader_thread(void* unused) {
+    int i, failed;
+    char* asName;
+    MappedFile source;
+
+    for (i = 0; i < batch.count; i++) {
+        pthread_mutex_lock(&batch.lock);
+        while (i >= batch.taken + batch.depth && !batch.stopping) {
+            pthread_cond_wait(&batch.changed, &batch.lock);
+        }
+        if (batch.stopping) {
+            pthread_mutex_unlock(&batch.lock);
+            break;
+        }
+        pthread_mutex_unlock(&batch.lock);
+
+        /* the file is read into memory, so that slow storage is only waited for here */
+        asName = concatenate_strings(batch.fileNames[i], ".as");
+        failed = asName == NULL || read_whole_file(asName, &source) != 0;
+        free(asName);
+
+        pthread_mutex_lock(&batch.lock);
+        if (failed) {
+            batch.states[i] = INPUT_FAILED;
+        } else {
+            batch.inputs[i] = source;
+            batch.states[i] = INPUT_LOADED;
+        }
+        pthread_cond_broadcast(&batch.changed);
+        pthread_mutex_unlock(&batch.lock);
+    }
+    return unused;
+}
+
+/* The writer thread writes the queued files in the order they were queued, until the stage is stopped */
+static void* writer_thread(void* unused) {
+    WriteRequest* request;
+    for (;;) {
+        pthread_mutex_lock(&batch.lock);
+        while (batch.queueHead == NULL && !batch.stopping) {
+            pthread_cond_wait(&batch.changed, &batch.lock);
+        }
+        request = batch.queueHead;
+        if (request == NULL) {
+            pthread_mutex_unlock(&batch.lock);
+            break;
+        }
+        batch.queueHead = request->next;
+        if (batch.queueHead == NULL) {
+            batch.queueTail = NULL;
+        }
+        pthread_mutex_unlock(&batch.lock);
+
+        if (request->isRemove) {
+            remove_file_now(request->path);
+        } else {
+            write_file_now(request->path, request->data, request->size);
+        }
+        free(request->path);
+        free(request->data);
+        free(request);
+    }
+    return unused;
+}
+
+/* Adds a request to the end of the writer thread's queue */
+static void queue_request(WriteRequest* request) {
+    pthread_mutex_lock(&batch.lock);
+    request->next = NULL;
+    if (batch.queueTail == NULL) {
+        batch.queueHead = request;
+    } else {
+        batch.queueTail->next = request;
+    }
+    batch.queueTail = request;
+    pthread_cond_broadcast(&batch.changed);
+    pthread_mutex_unlock(&batch.lock);
+}
+
+/* Starts the batch I/O stage for the given files (base names, without the extension).
+ A reader thread loads the .as files up to depth files ahead of the one that is being assembled,
+ and a writer thread writes the queued output files in the background.
+ Returns 0 on success. If the stage isn't started, all of the input and output is done synchronously */
+int start_batch_io(char** fileNames, int count, int depth) {
+    int i;
+    if (batch.running || count <= 0 || depth <= 0) {
+        return 1;
+    }
+    batch.states = malloc(count * sizeof(InputState));
+    batch.inputs = malloc(count * sizeof(MappedFile));
+    if (batch.states == NULL || batch.inputs == NULL) {
+        free(batch.states);
+        free(batch.inputs);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        batch.states[i] = INPUT_PENDING;
+    }
+    batch.fileNames = fileNames;
+    batch.count = count;
+    batch.depth = depth;
+    batch.taken = 0;
+    batch.stopping = FALSE;
+    batch.queueHead = NULL;
+    batch.queueTail = NULL;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.changed, NULL);
+
+    if (pthread_create(&batch.reader, NULL, reader_thread, NULL) != 0) {
+        goto fail;
+    }
+    if (pthread_create(&batch.writer, NULL, writer_thread, NULL) != 0) {
+        pthread_mutex_lock(&batch.lock);
+        batch.stopping = TRUE;
+        pthread_cond_broadcast(&batch.changed);
+        pthread_mutex_unlock(&batch.lock);
+        pthread_join(batch.reader, NULL);
+        for (i = 0; i < count; i++) {
+            if (batch.states[i] == INPUT_LOADED) unmap_file(&batch.inputs[i]);
+        }
+        goto fail;
+    }
+    batch.running = TRUE;
+    return 0;
+
+    fail:
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.changed);
+    free(batch.states);
+    free(batch.inputs);
+    return 1;
+}
+
+/* Takes the source of the index-th file of the batch, blocking until the reader thread has loaded it.
+ The caller owns the source afterwards and releases it with unmap_file.
+ Returns 0 on success and 1 if the file could not be read or if the batch I/O stage isn't running */
+int take_batch_input(int index, MappedFile* source) {
+    int result = 1;
+    if (!batch.running || index < 0 || index >= batch.count) {
+        return 1;
+    }
+    pthread_mutex_lock(&batch.lock);
+    while (batch.states[index] == INPUT_PENDING) {
+        pthread_cond_wait(&batch.changed, &batch.lock);
+    }
+    if (batch.states[index] == INPUT_LOADED) {
+        *source = batch.inputs[index];
+        result = 0;
+    }
+    batch.states[index] = INPUT_TAKEN;
+    if (index + 1 > batch.taken) {
+        batch.taken = index + 1;
+    }
+    pthread_cond_broadcast(&batch.changed);
+    pthread_mutex_unlock(&batch.lock);
+    return result;
+}
+
+/* Writes the content of the buffer to the file at path. When the batch I/O stage is running the write is queued
+ and done in the background, and the queue takes the buffer's memory. Otherwise the file is written right away.
+ Returns 0 if the file was written or queued */
+int write_output_file(const char* path, OutputBuffer* buffer) {
+    WriteRequest* request;
+    if (buffer->failed) {
+        fprintf(stderr, "Failed to allocate memory for file \"%s\"\n", path);
+        return 1;
+    }
+    if (!batch.running) {
+        return write_file_now(path, buffer->data, buffer->size);
+    }
+    request = malloc(sizeof(WriteRequest));
+    if (request == NULL || (request->path = duplicate_string(path)) == NULL) {
+        free(request);
+        return write_file_now(path, buffer->data, buffer->size);
+    }
+    request->data = buffer->data;
+    request->size = buffer->size;
+    request->isRemove = FALSE;
+    /* the queue owns the content now */
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    queue_request(request);
+    return 0;
+}
+
+/* Removes the file at path, after all of the writes that were queued before */
+void remove_output_file(const char* path) {
+    WriteRequest* request;
+    if (!batch.running) {
+        remove_file_now(path);
+        return;
+    }
+    request = malloc(sizeof(WriteRequest));
+    if (request == NULL || (request->path = duplicate_string(path)) == NULL) {
+        free(request);
+        remove_file_now(path);
+        return;
+    }
+    request->data = NULL;
+    request->size = 0;
+    request->isRemove = TRUE;
+    queue_request(request);
+}
+
+/* Waits for all of the queued writes and stops the batch I/O stage */
+void finish_batch_io(void) {
+    int i;
+    if (!batch.running) {
+        return;
+    }
+    pthread_mutex_lock(&batch.lock);
+    batch.stopping = TRUE;
+    pthread_cond_broadcast(&batch.changed);
+    pthread_mutex_unlock(&batch.lock);
+    pthread_join(batch.reader, NULL);
+    pthread_join(batch.writer, NULL);
+
+    /* free the inputs that were loaded but never taken */
+    for (i = 0; i < batch.count; i++) {
+        if (batch.states[i] == INPUT_LOADED) {
+            unmap_file(&batch.inputs[i]);
+        }
+    }
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.changed);
+    free(batch.states);
+    free(batch.inputs);
+    batch.running = FALSE;
+}
+
+#else
+
+/* Without threads there is no batch I/O stage, and everything is done synchronously */
+int start_batch_io(char** fileNames, int count, int depth) {
+    return 1;
+}
+
+int take_batch_input(int index, MappedFile* source) {
+    return 1;
+}
+
+int write_output_file(const char* path, OutputBuffer* buffer) {
+    if (buffer->failed) {
+        fprintf(stderr, "Failed to allocate memory for file \"%s\"\n", path);
+        return 1;
+    }
+    return write_file_now(path, buffer->data, buffer->size);
+}
+
+void remove_output_file(const char* path) {
+    remove_file_now(path);
+}
+
+void finish_batch_io(void) {
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef BATCH_IO_H
+#define BATCH_IO_H
+
+#include "mapped_file.h"
+#include "output_buffer.h"
+#include "bundle.h"
+
+#define DEFAULT_IO_DEPTH 4
+
+/* Starts the batch I/O stage for the given files (base names, without the extension).
+ A reader thread loads the .as files up to depth files ahead of the one that is being assembled,
+ and a writer thread writes the queued output files in the background.
+ Returns 0 on success. If the stage isn't started, all of the input and output is done synchronously */
+int start_batch_io(char** fileNames, int count, int depth);
+
+/* Takes the source of the index-th file of the batch, blocking until the reader thread has loaded it.
+ The caller owns the source afterwards and releases it with unmap_file.
+ Returns 0 on success and 1 if the file could not be read or if the batch I/O stage isn't running */
+int take_batch_input(int index, MappedFile* source);
+
+/* Sends all of the output files that are written from now on into a bundle. NULL goes back to separate files.
+ The bundle must not be changed while the batch I/O stage is running */
+void set_output_bundle(BundleWriter* bundle);
+
+/* Writes the content of the buffer to the file at path. When the batch I/O stage is running the write is queued
+ and done in the background, and the queue takes the buffer's memory. Otherwise the file is written right away.
+ Returns 0 if the file was written or queued */
+int write_output_file(const char* path, OutputBuffer* buffer);
+
+/* Removes the file at path, after all of the writes that were queued before */
+void remove_output_file(const char* path);
+
+/* Waits for all of the queued writes and stops the batch I/O stage */
+void finish_batch_io(void);
+
+#endif
@@ -0,0 +1,391 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../structs.h"
+#include "../constants.h"
+#include "../parser.h"
+#include "../utils.h"
+#include "../writeOutputFiles.h"
+#include "../data_structures/node.h"
+#include "../data_structures/hashtable.h"
+
+/* Microbenchmarks for the hottest routines of the assembler.
+ Every benchmark runs over tokens collected from real assembly sources (by default the programs in the test directory),
+ so the measured distribution of keywords, labels and numbers is the one the assembler actually sees.
+ Each benchmark is run for a number of samples (--samples, default DEFAULT_SAMPLES), and the median and p99 of the nanoseconds per operation are reported. */
+
+#define DEFAULT_SAMPLES 101
+#define MIN_SAMPLE_NS 1000000.0 /* every sample runs for at least 1ms so that the clock resolution doesn't matter */
+#define MAX_SAMPLES 10001
+
+static const char* defaultSources[] = {
+    "test/test-example/test.as",
+    "test/test-forum/test.as",
+    "test/test-errors/test.as",
+    "test/test-errors-preprocess/test.as"
+};
+
+/* A growable list of strings that the benchmarks iterate over */
+typedef struct {
+    char** items;
+    int count;
+    int capacity;
+} Corpus;
+
+/* All of the inputs that the benchmarks use, collected from the source files */
+typedef struct {
+    Corpus lines; /* raw source lines, as the preprocessor reads them */
+    Corpus heads; /* the first token of each statement (after the label), candidates for get_opcode */
+    Corpus tokens; /* every token that isn't a separator */
+    Corpus labelDefinitions; /* names of the labels that are defined in the sources */
+    Corpus labelReferences; /* tokens that are used as label operands */
+    Corpus externNames; /* names that are declared with .extern */
+    Corpus externalUses; /* names of externals, once per use */
+    int* words; /* machine words taken from the .ob files next to the sources */
+    int wordCount;
+    hashtable* constantsTable; /* the constants that are defined in the sources */
+    Symbol_Node* symbolTable; /* a symbol table with the labels that are defined in the sources */
+} BenchInput;
+
+/* A benchmark runs one pass over its input and returns the number of operations it has done */
+typedef long (*BenchFunction)(BenchInput* input);
+
+typedef struct {
+    const char* name;
+    BenchFunction function;
+} Benchmark;
+
+/* Written by the benchmarks so that the compiler can't remove the calls */
+static volatile long sink;
+
+static void corpus_add(Corpus* corpus, const char* item) {
+    if (corpus->count == corpus->capacity) {
+        corpus->capacity = corpus->capacity == 0 ? 64 : corpus->capacity * 2;
+        corpus->items = realloc(corpus->items, corpus->capacity * sizeof(char*));
+        if (corpus->items == NULL) {
+            fprintf(stderr, "Failed to allocate memory for the benchmark corpus\n");
+            exit(1);
+        }
+    }
+    corpus->items[corpus->count++] = duplicate_string(item);
+}
+
+static void corpus_free(Corpus* corpus) {
+    int i;
+    for (i = 0; i < corpus->count; i++) {
+        free(corpus->items[i]);
+    }
+    free(corpus->items);
+}
+
+/* Decodes a base-4 word the way encrypt writes it */
+static int decode_word(const char* encrypted) {
+    int i, word = 0;
+    for (i = 0; i < ENCRYPTED_WORD_LENGTH; i++) {
+        word <<= 2;
+        switch (encrypted[i]) {
+            case '#': word |= 1; break;
+            case '%': word |= 2; break;
+            case '!': word |= 3; break;
+            default: break;
+        }
+    }
+    return word;
+}
+
+/* Collects the machine words from the .ob file that belongs to a source file, if there is one */
+static void collect_words(BenchInput* input, const char* sourceName) {
+    char obName[FILENAME_MAX], line[MAX_LINE_LENGTH + 2], encrypted[MAX_LINE_LENGTH + 2];
+    int address, length;
+    FILE* file;
+
+    length = strlen(sourceName);
+    if (length < 3 || length + 1 >= FILENAME_MAX) {
+        return;
+    }
+    strcpy(obName, sourceName);
+    strcpy(obName + length - 3, ".ob");
+    file = fopen(obName, "r");
+    if (file == NULL) {
+        return;
+    }
+    fgets(line, sizeof(line), file); /* skip the title */
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "%d %s", &address, encrypted) == 2 && strlen(encrypted) == ENCRYPTED_WORD_LENGTH) {
+            input->words = realloc(input->words, (input->wordCount + 1) * sizeof(int));
+            input->words[input->wordCount++] = decode_word(encrypted);
+        }
+    }
+    fclose(file);
+}
+
+/* Reads a source file and collects the benchmark inputs from it */
+static void collect_source(BenchInput* input, const char* sourceName) {
+    char line[MAX_LINE_LENGTH + 2];
+    char label[MAX_LINE_LENGTH + 1];
+    node *tokens, *current;
+    char* bracket;
+    int allocationError, value = 0, expectOperands;
+    FILE* file = fopen(sourceName, "r");
+
+    if (file == NULL) {
+        fprintf(stderr, "Skipping \"%s\", it could not be opened\n", sourceName);
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        corpus_add(&input->lines, line);
+        tokens = tokenize_line(line, &allocationError);
+        current = tokens;
+        if (current != NULL && is_token_label(current->token)) {
+            current->token[strlen(current->token) - 1] = '\0';
+            if (symbol_contains(input->symbolTable, current->token) == NULL) {
+                insert_symbol(&input->symbolTable, current->token);
+            }
+            corpus_add(&input->labelDefinitions, current->token);
+            current = current->next;
+        }
+        if (current != NULL && current->token[0] != COMMENT) {
+            corpus_add(&input->heads, current->token);
+            expectOperands = is_instruction_keyword(current->token);
+            if (is_const_defintion_keyword(current->token, TRUE) && current->next != NULL) {
+                insert(input->constantsTable, current->next->token, &value, sizeof(int));
+                value++;
+            } else if (strcmp(current->token, EXTERN) == 0 && current->next != NULL) {
+                corpus_add(&input->externNames, current->next->token);
+            }
+            for (; current != NULL; current = current->next) {
+                if (strcmp(current->token, ",") == 0 || strcmp(current->token, "=") == 0) {
+                    continue;
+                }
+                corpus_add(&input->tokens, current->token);
+                /* indexed operands such as X[2] reference the label X */
+                strcpy(label, current->token);
+                bracket = strchr(label, '[');
+                if (bracket != NULL) {
+                    *bracket = '\0';
+                }
+                if (expectOperands && is_label(label)) {
+                    corpus_add(&input->labelReferences, label);
+                }
+            }
+        }
+        free_nodes(tokens);
+    }
+    fclose(file);
+    collect_words(input, sourceName);
+}
+
+/* Externals can be declared after they are used, so their uses are collected after all of the sources were read */
+static void collect_external_uses(BenchInput* input) {
+    int i, j;
+    for (i = 0; i < input->labelReferences.count; i++) {
+        for (j = 0; j < input->externNames.count; j++) {
+            if (strcmp(input->labelReferences.items[i], input->externNames.items[j]) == 0) {
+                corpus_add(&input->externalUses, input->labelReferences.items[i]);
+                break;
+            }
+        }
+    }
+}
+
+static long bench_tokenize_line(BenchInput* input) {
+    int i, allocationError;
+    node* tokens;
+    for (i = 0; i < input->lines.count; i++) {
+        tokens = tokenize_line(input->lines.items[i], &allocationError);
+        sink += tokens != NULL;
+        free_nodes(tokens);
+    }
+    return input->lines.count;
+}
+
+static long bench_get_opcode(BenchInput* input) {
+    int i;
+    for (i = 0; i < input->heads.count; i++) {
+        sink += get_opcode(input->heads.items[i]);
+    }
+    return input->heads.count;
+}
+
+static long bench_is_keyword(BenchInput* input) {
+    int i;
+    for (i = 0; i < input->tokens.count; i++) {
+        sink += is_keyword(input->tokens.items[i], TRUE);
+    }
+    return input->tokens.count;
+}
+
+static long bench_is_label(BenchInput* input) {
+    int i;
+    for (i = 0; i < input->tokens.count; i++) {
+        sink += is_label(input->tokens.items[i]);
+    }
+    return input->tokens.count;
+}
+
+static long bench_hash(BenchInput* input) {
+    int i;
+    for (i = 0; i < input->tokens.count; i++) {
+        sink += hash(input->tokens.items[i]);
+    }
+    return input->tokens.count;
+}
+
+static long bench_search(BenchInput* input) {
+    int i;
+    for (i = 0; i < input->tokens.count; i++) {
+        sink += search(input->constantsTable, input->tokens.items[i]) != NULL;
+    }
+    return input->tokens.count;
+}
+
+static long bench_symbol_contains(BenchInput* input) {
+    int i;
+    for (i = 0; i < input->labelReferences.count; i++) {
+        sink += symbol_contains(input->symbolTable, input->labelReferences.items[i]) != NULL;
+    }
+    return input->labelReferences.count;
+}
+
+/* The externals table is built from scratch on every pass, like it is for every file, so the free is included */
+static long bench_insert_external(BenchInput* input) {
+    int i;
+    External_Node* head = NULL;
+    for (i = 0; i < input->externalUses.count; i++) {
+        head = insert_external(head, input->externalUses.items[i], START_POSITION + (i % (MEMORY_SIZE - START_POSITION)));
+    }
+    sink += head != NULL;
+    free_externals(head);
+    return input->externalUses.count;
+}
+
+/* encrypt returns an allocated string, so the free is included */
+static long bench_encrypt(BenchInput* input) {
+    int i;
+    char* encrypted;
+    for (i = 0; i < input->wordCount; i++) {
+        encrypted = encrypt(input->words[i]);
+        sink += encrypted[0];
+        free(encrypted);
+    }
+    return input->wordCount;
+}
+
+static const Benchmark benchmarks[] = {
+    {"tokenize_line (+free)", bench_tokenize_line},
+    {"get_opcode", bench_get_opcode},
+    {"is_keyword", bench_is_keyword},
+    {"is_label", bench_is_label},
+    {"hash", bench_hash},
+    {"search", bench_search},
+    {"symbol_contains", bench_symbol_contains},
+    {"insert_external (+free)", bench_insert_external},
+    {"encrypt (+free)", bench_encrypt}
+};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Runs a single benchmark and prints its median and p99 in nanoseconds per operation */
+static void run_benchmark(const Benchmark* benchmark, BenchInput* input, double* samples, int sampleCount) {
+    long opsPerPass, repetitions = 1, r;
+    double start, elapsed;
+    int i;
+
+    opsPerPass = benchmark->function(input); /* warm up */
+    if (opsPerPass == 0) {
+        printf("%-26s %10s\n", benchmark->name, "no input");
+        return;
+    }
+    /* Calibrate the number of passes per sample */
+    for (;;) {
+        start = now_ns();
+        for (r = 0; r < repetitions; r++) {
+            benchmark->function(input);
+        }
+        elapsed = now_ns() - start;
+        if (elapsed >= MIN_SAMPLE_NS) break;
+        repetitions *= 2;
+    }
+
+    for (i = 0; i < sampleCount; i++) {
+        start = now_ns();
+        for (r = 0; r < repetitions; r++) {
+            benchmark->function(input);
+        }
+        samples[i] = (now_ns() - start) / (double)(repetitions * opsPerPass);
+    }
+    qsort(samples, sampleCount, sizeof(double), compare_doubles);
+    printf("%-26s %10ld %12.2f %12.2f %12.2f\n", benchmark->name, opsPerPass,
+        samples[sampleCount / 2], samples[(sampleCount * 99 + 99) / 100 - 1], samples[0]);
+}
+
+/* The main function of the microbenchmark harness.
+ Usage: microbench [--samples=N] [source.as ...]
+ If no sources are given the programs in the test directory are used. */
+int main(int argc, char** argv) {
+    BenchInput input;
+    double* samples;
+    int i, sampleCount = DEFAULT_SAMPLES, sourceCount = 0;
+
+    memset(&input, 0, sizeof(input));
+    input.constantsTable = create_hashtable();
+    if (input.constantsTable == NULL) {
+        fprintf(stderr, "Failed to allocate memory for constantsTable\n");
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--samples=", 10) == 0) {
+            sampleCount = atoi(argv[i] + 10);
+            if (sampleCount < 1 || sampleCount > MAX_SAMPLES) {
+                fprintf(stderr, "The number of samples must be between 1 and %d\n", MAX_SAMPLES);
+                return 1;
+            }
+        } else {
+            collect_source(&input, argv[i]);
+            sourceCount++;
+        }
+    }
+    if (sourceCount == 0) {
+        for (i = 0; i < sizeof(defaultSources) / sizeof(defaultSources[0]); i++) {
+            collect_source(&input, defaultSources[i]);
+        }
+    }
+    collect_external_uses(&input);
+
+    samples = malloc(sampleCount * sizeof(double));
+    if (samples == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the samples\n");
+        return 1;
+    }
+
+    printf("%d samples per benchmark\n", sampleCount);
+    printf("%-26s %10s %12s %12s %12s\n", "benchmark", "ops/pass", "median ns/op", "p99 ns/op", "min ns/op");
+    for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        run_benchmark(&benchmarks[i], &input, samples, sampleCount);
+    }
+
+    free(samples);
+    free(input.words);
+    corpus_free(&input.lines);
+    corpus_free(&input.heads);
+    corpus_free(&input.tokens);
+    corpus_free(&input.labelDefinitions);
+    corpus_free(&input.labelReferences);
+    corpus_free(&input.externNames);
+    corpus_free(&input.externalUses);
+    free_hashtable(input.constantsTable);
+    free_symbols(input.symbolTable);
+    return 0;
+}
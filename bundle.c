@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bundle.h"
+#include "utils.h"
+
+/* Writes bytes to the bundle and keeps track of its size. A partial write marks the writer as failed */
+static int write_bytes(BundleWriter* writer, const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, writer->file) != size) {
+        writer->failed = TRUE;
+        return 1;
+    }
+    writer->offset += size;
+    return 0;
+}
+
+/* Creates a new bundle at path. Returns NULL if the file could not be created */
+BundleWriter* create_bundle(const char* path) {
+    BundleWriter* writer = malloc(sizeof(BundleWriter));
+    if (writer == NULL) {
+        return NULL;
+    }
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        free(writer);
+        return NULL;
+    }
+    writer->offset = 0;
+    writer->entries = NULL;
+    writer->count = 0;
+    writer->capacity = 0;
+    writer->failed = FALSE;
+    if (write_bytes(writer, BUNDLE_MAGIC, BUNDLE_MAGIC_LENGTH) != 0) {
+        fclose(writer->file);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+/* Appends a file with the given name and content to the bundle. Returns 0 on success */
+int append_to_bundle(BundleWriter* writer, const char* name, const char* data, size_t size) {
+    unsigned char header[12];
+    BundleEntry* grown;
+    BundleEntry* entry;
+    size_t nameLength = strlen(name);
+
+    if (writer->failed) {
+        return 1;
+    }
+    if (writer->count == writer->capacity) {
+        grown = realloc(writer->entries, (writer->capacity == 0 ? 64 : writer->capacity * 2) * sizeof(BundleEntry));
+        if (grown == NULL) {
+            writer->failed = TRUE;
+            return 1;
+        }
+        writer->entries = grown;
+        writer->capacity = writer->capacity == 0 ? 64 : writer->capacity * 2;
+    }
+    entry = &writer->entries[writer->count];
+    entry->name = duplicate_string(name);
+    if (entry->name == NULL) {
+        writer->failed = TRUE;
+        return 1;
+    }
+
+    put_le_number(header, nameLength, 4);
+    put_le_number(header + 4, size, 8);
+    if (write_bytes(writer, header, sizeof(header)) != 0 || write_bytes(writer, name, nameLength) != 0) {
+        free(entry->name);
+        return 1;
+    }
+    entry->offset = writer->offset;
+    entry->size = size;
+    if (write_bytes(writer, data, size) != 0) {
+        free(entry->name);
+        return 1;
+    }
+    writer->count++;
+    return 0;
+}
+
+/* Writes the index of the bundle and closes it. Returns 0 on success */
+int close_bundle_writer(BundleWriter* writer) {
+    unsigned char record[20], footer[BUNDLE_FOOTER_LENGTH];
+    size_t indexOffset = writer->offset;
+    int i, error = writer->failed;
+
+    for (i = 0; i < writer->count; i++) {
+        if (!writer->failed) {
+            put_le_number(record, strlen(writer->entries[i].name), 4);
+            put_le_number(record + 4, writer->entries[i].offset, 8);
+            put_le_number(record + 12, writer->entries[i].size, 8);
+            error |= write_bytes(writer, record, sizeof(record)) || write_bytes(writer, writer->entries[i].name, strlen(writer->entries[i].name));
+        }
+        free(writer->entries[i].name);
+    }
+    if (!writer->failed) {
+        put_le_number(footer, indexOffset, 8);
+        put_le_number(footer + 8, writer->count, 4);
+        memcpy(footer + 12, BUNDLE_INDEX_MAGIC, BUNDLE_MAGIC_LENGTH);
+        error |= write_bytes(writer, footer, sizeof(footer));
+    }
+    error |= fclose(writer->file) != 0;
+    free(writer->entries);
+    free(writer);
+    return error;
+}
+
+/* Opens a bundle for reading. Returns 0 on success and 1 if the file could not be read or is not a valid bundle */
+int open_bundle(const char* path, Bundle* bundle) {
+    const unsigned char* data;
+    const unsigned char* footer;
+    size_t indexOffset, position, nameLength;
+    int i;
+
+    bundle->entries = NULL;
+    bundle->count = 0;
+    bundle->index = NULL;
+    if (map_file(path, &bundle->file) != 0) {
+        return 1;
+    }
+    data = (const unsigned char*)bundle->file.data;
+    if (bundle->file.size < BUNDLE_MAGIC_LENGTH + BUNDLE_FOOTER_LENGTH ||
+        memcmp(data, BUNDLE_MAGIC, BUNDLE_MAGIC_LENGTH) != 0) {
+        goto fail;
+    }
+    footer = data + bundle->file.size - BUNDLE_FOOTER_LENGTH;
+    if (memcmp(footer + 12, BUNDLE_INDEX_MAGIC, BUNDLE_MAGIC_LENGTH) != 0) {
+        goto fail;
+    }
+    indexOffset = get_le_number(footer, 8);
+    bundle->count = get_le_number(footer + 8, 4);
+    if (indexOffset > bundle->file.size - BUNDLE_FOOTER_LENGTH ||
+        bundle->count > (bundle->file.size - BUNDLE_FOOTER_LENGTH - indexOffset) / 20) {
+        goto fail;
+    }
+
+    bundle->entries = calloc(bundle->count + 1, sizeof(BundleEntry));
+    bundle->index = create_hashtable();
+    if (bundle->entries == NULL || bundle->index == NULL) {
+        goto fail;
+    }
+    position = indexOffset;
+    for (i = 0; i < bundle->count; i++) {
+        if (position + 20 > bundle->file.size - BUNDLE_FOOTER_LENGTH) {
+            goto fail;
+        }
+        nameLength = get_le_number(data + position, 4);
+        bundle->entries[i].offset = get_le_number(data + position + 4, 8);
+        bundle->entries[i].size = get_le_number(data + position + 12, 8);
+        position += 20;
+        if (nameLength > bundle->file.size - BUNDLE_FOOTER_LENGTH - position ||
+            bundle->entries[i].offset > indexOffset ||
+            bundle->entries[i].size > indexOffset - bundle->entries[i].offset) {
+            goto fail;
+        }
+        bundle->entries[i].name = malloc(nameLength + 1);
+        if (bundle->entries[i].name == NULL) {
+            goto fail;
+        }
+        memcpy(bundle->entries[i].name, data + position, nameLength);
+        bundle->entries[i].name[nameLength] = '\0';
+        position += nameLength;
+        /* a later file with the same name hides the earlier one, because search returns the newest key */
+        if (insert(bundle->index, bundle->entries[i].name, &i, sizeof(int)) != 0) {
+            goto fail;
+        }
+    }
+    return 0;
+
+    fail:
+    close_bundle(bundle);
+    return 1;
+}
+
+/* Finds the file with the given name in the bundle. If a name was added more than once the last one is returned.
+ Returns NULL if there's no such file */
+const BundleEntry* find_in_bundle(const Bundle* bundle, const char* name) {
+    int* place = (int*)search(bundle->index, name);
+    if (place == NULL) {
+        return NULL;
+    }
+    return &bundle->entries[*place];
+}
+
+/* Returns a pointer to the content of a file in the bundle. The content is not null-terminated */
+const char* bundle_entry_data(const Bundle* bundle, const BundleEntry* entry) {
+    return bundle->file.data + entry->offset;
+}
+
+/* Releases a bundle that was opened by open_bundle */
+void close_bundle(Bundle* bundle) {
+    int i;
+    if (bundle->entries != NULL) {
+        for (i = 0; i < bundle->count; i++) {
+            free(bundle->entries[i].name);
+        }
+        free(bundle->entries);
+    }
+    if (bundle->index != NULL) {
+        free_hashtable(bundle->index);
+    }
+    unmap_file(&bundle->file);
+    bundle->entries = NULL;
+    bundle->index = NULL;
+    bundle->count = 0;
+}
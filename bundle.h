@@ -0,0 +1,72 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "structs.h"
+#include "mapped_file.h"
+#include "data_structures/hashtable.h"
+
+/* A bundle is a single append-only file that holds many output files (for example all of the artifacts of a batch).
+ Layout:
+    BUNDLE_MAGIC
+    entries:  for each file - name length (4 bytes), content size (8 bytes), the name, the content
+    index:    for each file - name length (4 bytes), content offset (8 bytes), content size (8 bytes), the name
+    footer:   index offset (8 bytes), number of entries (4 bytes), BUNDLE_INDEX_MAGIC
+ All of the numbers are little-endian. The header of each entry allows recovering a bundle whose index was never written. */
+
+#define BUNDLE_MAGIC "ASMBNDL1"
+#define BUNDLE_INDEX_MAGIC "ASMBIDX1"
+#define BUNDLE_MAGIC_LENGTH 8
+#define BUNDLE_FOOTER_LENGTH (8 + 4 + BUNDLE_MAGIC_LENGTH)
+
+/* A file inside a bundle */
+typedef struct {
+    char* name;
+    size_t offset; /* the offset of the content from the start of the bundle */
+    size_t size;
+} BundleEntry;
+
+/* A bundle that is being written */
+typedef struct {
+    FILE* file;
+    size_t offset; /* the current size of the bundle */
+    BundleEntry* entries;
+    int count;
+    int capacity;
+    boolean failed; /* set after the first error, nothing more is appended and close_bundle_writer fails */
+} BundleWriter;
+
+/* A bundle that was opened for reading. The bundle is memory-mapped so only the files that are read are loaded */
+typedef struct {
+    MappedFile file;
+    BundleEntry* entries;
+    int count;
+    hashtable* index; /* maps the name of a file to its place in entries */
+} Bundle;
+
+/* Creates a new bundle at path. Returns NULL if the file could not be created */
+BundleWriter* create_bundle(const char* path);
+
+/* Appends a file with the given name and content to the bundle. Returns 0 on success.
+ After a failure the writer is marked as failed, since the offsets of what follows could no longer be trusted */
+int append_to_bundle(BundleWriter* writer, const char* name, const char* data, size_t size);
+
+/* Writes the index of the bundle and closes it. Returns 0 on success, and 1 if anything failed to be written.
+ The index of a failed bundle isn't written, so it can't be opened as if it were complete */
+int close_bundle_writer(BundleWriter* writer);
+
+/* Opens a bundle for reading. Returns 0 on success and 1 if the file could not be read or is not a valid bundle */
+int open_bundle(const char* path, Bundle* bundle);
+
+/* Finds the file with the given name in the bundle. If a name was added more than once the last one is returned.
+ Returns NULL if there's no such file */
+const BundleEntry* find_in_bundle(const Bundle* bundle, const char* name);
+
+/* Returns a pointer to the content of a file in the bundle. The content is not null-terminated */
+const char* bundle_entry_data(const Bundle* bundle, const BundleEntry* entry);
+
+/* Releases a bundle that was opened by open_bundle */
+void close_bundle(Bundle* bundle);
+
+#endif
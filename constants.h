@@ -1,7 +1,11 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
-#define MEMORY_SIZE 4096
+#define MEMORY_SIZE 4096 /* the default memory size, in words */
+#define MAX_MEMORY_SIZE 65536 /* the largest memory size that can be given with --memory-size */
+#define IMAGE_PAGE_SIZE 256 /* the number of words in each page of a word image */
+#define WORD_MASK 0x3FFF /* a word of the machine is 14 bits */
+#define MAX_OPERAND_ADDRESS 4095 /* an address in an operand word has 12 bits */
 #define MAX_LINE_LENGTH 80
 #define MAX_DATA_LENGTH 40 /* Because each number is seperated by comma it can't be more than 40*/
 #define MAX_STRING_LENGTH 80
@@ -38,5 +42,11 @@
 #define COMMENT ';'
 #define MACRO_START "mcr"
 #define MACRO_END "endmcr"
+#define CONDITION_IF ".if"
+#define CONDITION_IFDEF ".ifdef"
+#define CONDITION_IFNDEF ".ifndef"
+#define CONDITION_ELSE ".else"
+#define CONDITION_ENDIF ".endif"
+#define MAX_CONDITION_DEPTH 32 /* the most .if directives that can be open at once */
 
 #endif
\ No newline at end of file
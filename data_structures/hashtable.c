@@ -34,13 +34,21 @@ hashtable* create_hashtable() {
     for (i = 0; i < TABLE_SIZE; i++) {
         ht->buckets[i] = NULL;
     }
+    ht->free_nodes = NULL;
     return ht;
 }
 
 /* Inserts a new key-value pair into the hashtable, Note: it copies value by value into the table */
 int insert(hashtable* ht, const char* key, const void* value, size_t value_size) {
     unsigned int bucket = hash(key);
-    hash_node* newnode = malloc(sizeof(hash_node));
+    hash_node* newnode;
+    if (ht->free_nodes != NULL) {
+        /* use a node that was cleared from the table before allocating a new one */
+        newnode = ht->free_nodes;
+        ht->free_nodes = newnode->next;
+    } else {
+        newnode = malloc(sizeof(hash_node));
+    }
     if (newnode == NULL) {
         return 1;
     }
@@ -94,9 +102,32 @@ void replace(hashtable* ht, const char* key, void* newValue, size_t newValueSize
     }
 }
 
+/* Removes all of the key-value pairs from the hashtable, and keeps their nodes for the next inserts */
+void clear_hashtable(hashtable* ht) {
+    int i;
+    for (i = 0; i < TABLE_SIZE; i++) {
+        hash_node* current = ht->buckets[i];
+        while (current != NULL) {
+            hash_node* temp = current;
+            current = current->next;
+            free(temp->key);
+            free(temp->value);
+            temp->next = ht->free_nodes;
+            ht->free_nodes = temp;
+        }
+        ht->buckets[i] = NULL;
+    }
+}
+
 /* Frees the hashtable */
 void free_hashtable(hashtable* ht) {
     int i;
+    hash_node* unused;
+    while (ht->free_nodes != NULL) {
+        unused = ht->free_nodes;
+        ht->free_nodes = unused->next;
+        free(unused);
+    }
     for (i = 0; i < TABLE_SIZE; i++) {
         hash_node* current = ht->buckets[i];
         while (current != NULL) {
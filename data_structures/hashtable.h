@@ -15,6 +15,7 @@ typedef struct hash_node {
 /* A hashtable structure */
 typedef struct hashtable {
     hash_node* buckets[TABLE_SIZE];
+    hash_node* free_nodes; /* nodes that were cleared from the table and can be used again by insert */
 } hashtable;
 
 /* Hashes a key into an unsigned int */
@@ -32,6 +33,9 @@ void* search(hashtable* ht, const char* key);
 /* Replaces the value of a key in the hashtable with a new value */
 void replace(hashtable* ht, const char* key, void* newValue, size_t newValueSize, int* allocationError);
 
+/* Removes all of the key-value pairs from the hashtable, and keeps their nodes for the next inserts */
+void clear_hashtable(hashtable* ht);
+
 /* Frees the hashtable */
 void free_hashtable(hashtable* ht);
 
@@ -5,6 +5,8 @@
 #include "../utils.h"
 #include "../structs.h"
 
+#define EXTERNAL_INITIAL_USES 8 /* the number of uses of an external that fit before its array of addresses grows */
+
 /* Function to insert a new node into the linked list and return a pointer to the updated list */
 node* insert_node(node* head, const char* token) {
     node *newNode, *current;
@@ -18,6 +20,7 @@ node* insert_node(node* head, const char* token) {
         return NULL;
     }
     newNode->next = NULL;
+    newNode->column = 0;
 
     if (head == NULL) {
         return newNode;
@@ -72,9 +75,18 @@ Symbol_Node * symbol_contains(Symbol_Node * head, const char* label) {
 
 /* the insert_symbol function inserts a new symbol into the symbol table and returns a pointer to it */
 Symbol_Node * insert_symbol (Symbol_Node ** head, char * label) {
-    if (*head == NULL) {
-        /* if the list is empty */
-        Symbol_Node * symbol;
+    return insert_symbol_from(head, NULL, label);
+}
+
+/* the insert_symbol_from function inserts a new symbol into the symbol table and returns a pointer to it.
+    the node is taken from freeList if it isn't empty, and is allocated otherwise */
+Symbol_Node * insert_symbol_from (Symbol_Node ** head, Symbol_Node ** freeList, char * label) {
+    Symbol_Node * current;
+    Symbol_Node * symbol;
+    if (freeList != NULL && *freeList != NULL) {
+        symbol = *freeList;
+        *freeList = symbol->next;
+    } else {
         symbol = malloc(sizeof(Symbol_Node));
         if (symbol == NULL) {
             return NULL;
@@ -84,32 +96,32 @@ Symbol_Node * insert_symbol (Symbol_Node ** head, char * label) {
             free(symbol);
             return NULL;
         }
-        strcpy(symbol->symbol->name, label);
-        symbol->next = NULL;
+    }
+    strcpy(symbol->symbol->name, label);
+    symbol->next = NULL;
+    if (*head == NULL) {
+        /* if the list is empty */
         *head = symbol;
-        return symbol;
     } else {
-        Symbol_Node * current;
-        Symbol_Node * symbol;
         current = *head;
         while (current->next != NULL) {
             /* go to the end of the list */
             current = current->next;
         }
-        symbol = malloc(sizeof(Symbol_Node));
-        if (symbol == NULL) {
-            return NULL;
-        }
-        symbol->symbol = malloc(sizeof(Symbol));
-        if (symbol->symbol == NULL) {
-            free(symbol);
-            return NULL;
-        }
-        strcpy(symbol->symbol->name, label);
         current->next = symbol;
-        symbol->next = NULL;
-        return symbol;
-    } 
+    }
+    return symbol;
+}
+
+/* the recycle_symbols function moves all of the nodes of a symbol table to freeList, so they can be inserted again */
+void recycle_symbols (Symbol_Node * head, Symbol_Node ** freeList) {
+    Symbol_Node * last;
+    if (head == NULL) {
+        return;
+    }
+    for (last = head; last->next != NULL; last = last->next);
+    last->next = *freeList;
+    *freeList = head;
 }
 
 /* the free_symbols function frees the memory that was assigned for the symbol table's nodes */
@@ -129,10 +141,28 @@ void free_symbols (Symbol_Node * head) {
 /* the insert_external function inserts a new external into the external table,
     or a new use of a present external, and returns a pointer to the head of the list */
 External_Node * insert_external (External_Node * head, char * label, int IC) {
+    int allocationError = 0;
+    return insert_external_from(head, NULL, label, IC, &allocationError);
+}
+
+/* the insert_external_from function works like insert_external, except that a new external
+    takes its node from freeList if it isn't empty. if the memory could not be allocated, allocationError is set to 1
+    and the list is returned without the use */
+External_Node * insert_external_from (External_Node * head, External_Node ** freeList, char * label, int IC, int * allocationError) {
     External_Node * found;
     found = search_externals(head, label);
     if (found) {
         /* if the external is already in the list */
+        if (found->external->numOfUse == found->external->capacity) {
+            /* the array of addresses is full, so its size is doubled */
+            int * grown = realloc(found->external->addresses, 2 * found->external->capacity * sizeof(int));
+            if (grown == NULL) {
+                *allocationError = 1;
+                return head;
+            }
+            found->external->addresses = grown;
+            found->external->capacity *= 2;
+        }
         found->external->addresses[found->external->numOfUse] = IC; /* add the new use */
         found->external->numOfUse++;
         return head;
@@ -140,14 +170,39 @@ External_Node * insert_external (External_Node * head, char * label, int IC) {
         /* if the external is not in the list */
         External_Node * current;
         External_Node * newNode;
+        char * name;
+        name = duplicate_string(label);
+        if (name == NULL) {
+            *allocationError = 1;
+            return head;
+        }
         current = head;
         while (current != NULL && current->next != NULL) {
             /* go to the end of the list */
             current = current->next;
         }
-        newNode = malloc(sizeof(External_Node));
-        newNode->external = malloc(sizeof(External));
-        newNode->external->name = duplicate_string(label);
+        if (freeList != NULL && *freeList != NULL) {
+            newNode = *freeList;
+            *freeList = newNode->next;
+        } else {
+            newNode = malloc(sizeof(External_Node));
+            if (newNode == NULL || (newNode->external = malloc(sizeof(External))) == NULL) {
+                free(newNode);
+                free(name);
+                *allocationError = 1;
+                return head;
+            }
+            newNode->external->capacity = EXTERNAL_INITIAL_USES;
+            newNode->external->addresses = malloc(EXTERNAL_INITIAL_USES * sizeof(int));
+            if (newNode->external->addresses == NULL) {
+                free(newNode->external);
+                free(newNode);
+                free(name);
+                *allocationError = 1;
+                return head;
+            }
+        }
+        newNode->external->name = name;
         newNode->external->addresses[0] = IC;
         newNode->external->numOfUse = 1;
         newNode->next = NULL;
@@ -162,6 +217,19 @@ External_Node * insert_external (External_Node * head, char * label, int IC) {
     }  
 }
 
+/* the recycle_externals function moves all of the nodes of an external table to freeList, so they can be inserted again */
+void recycle_externals (External_Node * head, External_Node ** freeList) {
+    External_Node * next;
+    while (head != NULL) {
+        next = head->next;
+        free(head->external->name);
+        head->external->name = NULL;
+        head->next = *freeList;
+        *freeList = head;
+        head = next;
+    }
+}
+
 /* the search_externals function searches for an external with a name that matches 
     label in the external table and returns it */
 External_Node * search_externals (External_Node * head, char * label) {
@@ -184,6 +252,7 @@ void free_externals (External_Node * head) {
     current2 = head;
     while (current1 != NULL) {
         free(current1->external->name);
+        free(current1->external->addresses);
         free(current1->external);
         current1 = current1->next;
         free(current2);
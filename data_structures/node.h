@@ -6,6 +6,7 @@
 /* the node structure describes a node in a linked list */
 typedef struct node {
     char* token;
+    int column; /* for a token of a line, the column it starts at (from 1), otherwise 0 */
     struct node* next;
 } node;
 
@@ -37,6 +38,13 @@ Symbol_Node * symbol_contains(Symbol_Node * head, const char* label);
 /* the insert_symbol function inserts a new symbol into the symbol table and returns a pointer to it */
 Symbol_Node * insert_symbol (Symbol_Node ** head, char * label);
 
+/* the insert_symbol_from function inserts a new symbol into the symbol table and returns a pointer to it.
+    the node is taken from freeList if it isn't empty, and is allocated otherwise */
+Symbol_Node * insert_symbol_from (Symbol_Node ** head, Symbol_Node ** freeList, char * label);
+
+/* the recycle_symbols function moves all of the nodes of a symbol table to freeList, so they can be inserted again */
+void recycle_symbols (Symbol_Node * head, Symbol_Node ** freeList);
+
 /* the free_symbols function frees the memory that was assigned for the symbol table's nodes */
 void free_symbols (Symbol_Node * head);
 
@@ -44,6 +52,14 @@ void free_symbols (Symbol_Node * head);
     or a new use of a present external, and returns a pointer to the head of the list */
 External_Node * insert_external (External_Node * head, char * label, int IC);
 
+/* the insert_external_from function works like insert_external, except that a new external
+    takes its node from freeList if it isn't empty. if the memory could not be allocated, allocationError is set to 1
+    and the list is returned without the use */
+External_Node * insert_external_from (External_Node * head, External_Node ** freeList, char * label, int IC, int * allocationError);
+
+/* the recycle_externals function moves all of the nodes of an external table to freeList, so they can be inserted again */
+void recycle_externals (External_Node * head, External_Node ** freeList);
+
 /* the search_externals function searches for an external with a name that matches 
     label in the external table and returns it */
 External_Node * search_externals (External_Node * head, char * label);
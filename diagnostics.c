@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "diagnostics.h"
+#include "output_buffer.h"
+#include "json.h"
+#include "utils.h"
+
+/* How the beginning of a message looks, before the text of the diagnostic itself */
+typedef enum {
+    STYLE_ON_LINE, /* Error in file "x" on line 3: ... */
+    STYLE_COMMA_LINE, /* Error in file "x", line 3: ... */
+    STYLE_FILE, /* Error in file "x", ... (the text says where) */
+    STYLE_WHOLE_FILE, /* Error in file "x": ... */
+    STYLE_PLAIN /* only the text */
+} MessageStyle;
+
+/* The description of a diagnostic code. in the text %1 to %6 are the arguments and %L is the line */
+typedef struct {
+    DiagnosticCode code;
+    Severity severity;
+    MessageStyle style;
+    const char* name;
+    const char* text;
+} DiagnosticInfo;
+
+static const DiagnosticInfo diagnosticInfo[] = {
+    {DIAG_LINE_TOO_LONG, SEVERITY_ERROR, STYLE_FILE, "line-too-long", "line %L is too long, maximum length is %1"},
+    {DIAG_MACRO_NAME_MISSING, SEVERITY_ERROR, STYLE_COMMA_LINE, "macro-name-missing", "Macro name is missing"},
+    {DIAG_INVALID_MACRO_NAME, SEVERITY_ERROR, STYLE_COMMA_LINE, "invalid-macro-name", "Invalid macro name %1"},
+    {DIAG_TOKEN_AFTER_MACRO_NAME, SEVERITY_ERROR, STYLE_COMMA_LINE, "token-after-macro-name", "Unexpected token %1 after macro name"},
+    {DIAG_TOKEN_AFTER_MACRO_END, SEVERITY_ERROR, STYLE_COMMA_LINE, "token-after-macro-end", "Unexpected token %1 after macro end: %2"},
+    {DIAG_LIBRARY_STATEMENT, SEVERITY_ERROR, STYLE_COMMA_LINE, "library-statement", "Only macros and constants can be defined in a library"},
+    {DIAG_IMPORT_PATH_MISSING, SEVERITY_ERROR, STYLE_COMMA_LINE, "import-path-missing", "Invalid import directive, expected the path of a library in quotes"},
+    {DIAG_INVALID_LIBRARY, SEVERITY_ERROR, STYLE_COMMA_LINE, "invalid-library", "%1 is not a library, libraries are made with --make-library"},
+    {DIAG_TOO_MANY_LIBRARIES, SEVERITY_ERROR, STYLE_COMMA_LINE, "too-many-libraries", "A file can't use more than %1 libraries"},
+    {DIAG_ELSE_WITHOUT_IF, SEVERITY_ERROR, STYLE_COMMA_LINE, "else-without-if", ".else without an .if before it"},
+    {DIAG_ENDIF_WITHOUT_IF, SEVERITY_ERROR, STYLE_COMMA_LINE, "endif-without-if", ".endif without an .if before it"},
+    {DIAG_IF_NOT_CLOSED, SEVERITY_ERROR, STYLE_COMMA_LINE, "if-not-closed", "%1 is never closed with .endif"},
+    {DIAG_ELSE_AGAIN, SEVERITY_ERROR, STYLE_COMMA_LINE, "else-again", "Second .else of the %1 on line %2"},
+    {DIAG_INVALID_CONDITION, SEVERITY_ERROR, STYLE_COMMA_LINE, "invalid-condition", "Invalid condition, unexpected %1"},
+    {DIAG_CONDITION_UNDEFINED, SEVERITY_ERROR, STYLE_COMMA_LINE, "condition-undefined", "The constant %1 of the condition is not defined"},
+    {DIAG_TOKEN_AFTER_CONDITION, SEVERITY_ERROR, STYLE_COMMA_LINE, "token-after-condition", "Unexpected %1 after %2"},
+    {DIAG_CONDITION_TOO_DEEP, SEVERITY_ERROR, STYLE_COMMA_LINE, "condition-too-deep", "More than %1 .if directives are open"},
+
+    {DIAG_DIRECTIVE_EMPTY, SEVERITY_ERROR, STYLE_ON_LINE, "directive-empty", "Invalid directive, no tokens found"},
+    {DIAG_DATA_EXPECTED_COMMA, SEVERITY_ERROR, STYLE_ON_LINE, "data-expected-comma", "Invalid data directive, expected comma before %1"},
+    {DIAG_INVALID_DATA_VALUE, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-data-value", "Invalid data value: '%1'"},
+    {DIAG_DATA_UNEXPECTED_COMMA, SEVERITY_ERROR, STYLE_ON_LINE, "data-unexpected-comma", "Invalid data directive, unexpected comma"},
+    {DIAG_INVALID_STRING, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-string", "Invalid string value: %1"},
+    {DIAG_STRING_UNPRINTABLE, SEVERITY_ERROR, STYLE_ON_LINE, "string-unprintable", "Invalid string value, string has unprintable characters"},
+    {DIAG_TOKEN_AFTER_STRING, SEVERITY_ERROR, STYLE_ON_LINE, "token-after-string", "Invalid string directive, unexpected token: '%1'"},
+    {DIAG_INVALID_ENTRY_LABEL, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-entry-label", "Invalid entry label: %1"},
+    {DIAG_TOKEN_AFTER_ENTRY, SEVERITY_ERROR, STYLE_ON_LINE, "token-after-entry", "Invalid entry directive, unexpected token %1 after label"},
+    {DIAG_INVALID_EXTERN_LABEL, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-extern-label", "Invalid extern label: %1"},
+    {DIAG_TOKEN_AFTER_EXTERN, SEVERITY_ERROR, STYLE_ON_LINE, "token-after-extern", "Invalid extern directive, unexpected token %1 after label"},
+    {DIAG_INVALID_DIRECTIVE, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-directive", "Invalid directive type"},
+    {DIAG_INVALID_IMMEDIATE, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-immediate", "Invalid immediate operand: %1"},
+    {DIAG_CONSTANT_AS_LABEL, SEVERITY_ERROR, STYLE_ON_LINE, "constant-as-label", "Uncompatible operand: %1 is a constant. However, it is used as a label. Perhaps you forgot a #?"},
+    {DIAG_INVALID_OPERAND, SEVERITY_ERROR, STYLE_ON_LINE, "invalid-operand", "Uncompatible operand: %1"},
+    {DIAG_NO_OPERANDS, SEVERITY_ERROR, STYLE_ON_LINE, "no-operands", "Invalid instruction, no operands found"},
+    {DIAG_TOO_MANY_OPERANDS, SEVERITY_ERROR, STYLE_ON_LINE, "too-many-operands", "Too many operands. The maximum number of operands for \"%1\" is %2"},
+    {DIAG_OPERAND_NOT_ALLOWED, SEVERITY_ERROR, STYLE_ON_LINE, "operand-not-allowed", "Error: Operand %1 ('%2') of type %3 is invalid for instruction '%4'. Allowed source types: [%5]. Allowed destination types: [%6]."},
+    {DIAG_EXPECTED_COMMA, SEVERITY_ERROR, STYLE_ON_LINE, "expected-comma", "Expected comma but has: %1"},
+    {DIAG_CONSTANT_WITH_LABEL, SEVERITY_ERROR, STYLE_ON_LINE, "constant-with-label", "Invalid constant definition. Cannot have a label in a constant defintion statement."},
+    {DIAG_CONSTANT_EMPTY, SEVERITY_ERROR, STYLE_ON_LINE, "constant-empty", "Invalid constant definition, no tokens found"},
+    {DIAG_CONSTANT_EMPTY_TOKEN, SEVERITY_ERROR, STYLE_ON_LINE, "constant-empty-token", "Invalid constant definition, empty token"},
+    {DIAG_CONSTANT_INVALID_NAME, SEVERITY_ERROR, STYLE_ON_LINE, "constant-invalid-name", "Invalid constant definition, invalid name: %1"},
+    {DIAG_CONSTANT_REDEFINED, SEVERITY_ERROR, STYLE_ON_LINE, "constant-redefined", "Invalid constant definition, constant already defined: %1"},
+    {DIAG_CONSTANT_IS_LABEL, SEVERITY_ERROR, STYLE_ON_LINE, "constant-is-label", "Invalid constant definition, label already defined: %1"},
+    {DIAG_CONSTANT_NO_EQUALS, SEVERITY_ERROR, STYLE_ON_LINE, "constant-no-equals", "Invalid constant definition, no tokens found after label"},
+    {DIAG_CONSTANT_EXPECTED_EQUALS, SEVERITY_ERROR, STYLE_ON_LINE, "constant-expected-equals", "Invalid constant definition, expected '=' but has: %1"},
+    {DIAG_CONSTANT_NO_VALUE, SEVERITY_ERROR, STYLE_ON_LINE, "constant-no-value", "Invalid constant definition, no tokens found after '='"},
+    {DIAG_CONSTANT_INVALID_VALUE, SEVERITY_ERROR, STYLE_ON_LINE, "constant-invalid-value", "Invalid constant definition, invalid value: %1"},
+    {DIAG_TOKEN_AFTER_CONSTANT, SEVERITY_ERROR, STYLE_ON_LINE, "token-after-constant", "Invalid constant definition, unexpected token after value"},
+    {DIAG_TOKENIZE_FAILED, SEVERITY_ERROR, STYLE_ON_LINE, "tokenize-failed", "Failed to tokenize line"},
+    {DIAG_SYMBOL_REDEFINED, SEVERITY_ERROR, STYLE_ON_LINE, "symbol-redefined", "Trying to redefine the symbol \"%1\""},
+    {DIAG_LABEL_WITHOUT_STATEMENT, SEVERITY_ERROR, STYLE_ON_LINE, "label-without-statement", "Unexpected end of line after label: %1"},
+    {DIAG_WHITESPACE_BEFORE_COMMENT, SEVERITY_ERROR, STYLE_ON_LINE, "whitespace-before-comment", "Comments can't have whitespaces before ';'"},
+    {DIAG_UNEXPECTED_TOKEN, SEVERITY_ERROR, STYLE_ON_LINE, "unexpected-token", "Unexpected token: %1"},
+
+    {DIAG_SYMBOL_ALREADY_DEFINED, SEVERITY_ERROR, STYLE_ON_LINE, "symbol-already-defined", "Trying to redefine the symbol: \"%1\""},
+    {DIAG_CONSTANT_NOT_USEABLE, SEVERITY_WARNING, STYLE_ON_LINE, "constant-not-useable", "the constant \"%1\" is too %2 and not useable"},
+    {DIAG_ENTRY_NOT_DEFINED, SEVERITY_ERROR, STYLE_WHOLE_FILE, "entry-not-defined", "Symbol \"%1\" was declared as entry but was never defined"},
+    {DIAG_PROGRAM_TOO_LARGE, SEVERITY_ERROR, STYLE_WHOLE_FILE, "program-too-large", "Program is too large"},
+    {DIAG_EXTERN_AGAIN, SEVERITY_WARNING, STYLE_ON_LINE, "extern-again", "Redefining the symbol \"%1\" as extern again"},
+    {DIAG_ENTRY_AGAIN, SEVERITY_WARNING, STYLE_ON_LINE, "entry-again", "Redefining the symbol \"%1\" as entry again"},
+    {DIAG_WRONG_OPERAND_COUNT, SEVERITY_ERROR, STYLE_ON_LINE, "wrong-operand-count", "The instruction \"%1\" requires %2 %3, but %4 %5 given"},
+
+    {DIAG_VALUE_TOO_LARGE, SEVERITY_ERROR, STYLE_ON_LINE, "value-too-large", "value \"%1\" is too %2"},
+    {DIAG_INDEX_OUT_OF_BOUNDS, SEVERITY_ERROR, STYLE_ON_LINE, "index-out-of-bounds", "Index %1 is out of bounds"},
+    {DIAG_NOT_INDEXABLE, SEVERITY_ERROR, STYLE_ON_LINE, "not-indexable", "Symbol is not indexable"},
+    {DIAG_ADDRESS_TOO_LARGE, SEVERITY_ERROR, STYLE_ON_LINE, "address-too-large", "The address %1 of symbol \"%2\" does not fit in an operand"},
+    {DIAG_SYMBOL_NOT_FOUND, SEVERITY_ERROR, STYLE_ON_LINE, "symbol-not-found", "Symbol \"%1\" not found"},
+
+    {DIAG_TOO_MANY_ERRORS, SEVERITY_NOTE, STYLE_WHOLE_FILE, "too-many-errors", "Stopping after %1 errors"},
+    {DIAG_OUT_OF_MEMORY, SEVERITY_ERROR, STYLE_PLAIN, "out-of-memory", "Error: Failed to allocate memory for %1"}
+};
+
+/* The diagnostics of the file that is being assembled. errors and warnings are kept apart,
+ because errors are written to stderr and warnings to stdout */
+static OutputBuffer errors = {NULL, 0, 0, NULL, FALSE};
+static OutputBuffer warnings = {NULL, 0, 0, NULL, FALSE};
+static DiagnosticsFormat outputFormat = DIAGNOSTICS_TEXT;
+static const char* currentFile = "";
+static int errorCount = 0;
+static int diagnosticCount = 0; /* the errors and the warnings of the file */
+static int errorLimit = 0;
+static boolean collecting = FALSE;
+static CollectedDiagnostic* collected = NULL; /* the diagnostics of the file, when they are collected */
+static int collectedCount = 0;
+static int collectedCapacity = 0;
+
+/* the find_info function returns the description of a diagnostic code */
+static const DiagnosticInfo* find_info(DiagnosticCode code) {
+    int i;
+    for (i = 0; i < (int)(sizeof(diagnosticInfo) / sizeof(diagnosticInfo[0])); i++) {
+        if (diagnosticInfo[i].code == code) {
+            return &diagnosticInfo[i];
+        }
+    }
+    return &diagnosticInfo[sizeof(diagnosticInfo) / sizeof(diagnosticInfo[0]) - 1];
+}
+
+/* the collect_arguments function writes the arguments that are described by argTypes as strings, and returns their number */
+static int collect_arguments(char arguments[MAX_DIAGNOSTIC_ARGS][MAX_ARGUMENT_LENGTH], const char* argTypes, va_list args) {
+    int count;
+    for (count = 0; argTypes[count] != '\0' && count < MAX_DIAGNOSTIC_ARGS; count++) {
+        if (argTypes[count] == 'd') {
+            sprintf(arguments[count], "%d", va_arg(args, int));
+        } else {
+            sprintf(arguments[count], "%.*s", MAX_ARGUMENT_LENGTH - 1, va_arg(args, const char*));
+        }
+    }
+    return count;
+}
+
+/* the expand function writes text into buffer, with %1 to %6 replaced by the arguments and %L by the line */
+static void expand(char* buffer, const char* text, int line, int argCount, char* const args[]) {
+    char* end = buffer + MAX_DIAGNOSTIC_LENGTH - MAX_ARGUMENT_LENGTH - 16; /* the longest argument still fits after it */
+    int index;
+    while (*text != '\0' && buffer < end) {
+        if (text[0] == '%' && text[1] == 'L') {
+            buffer += sprintf(buffer, "%d", line);
+            text += 2;
+        } else if (text[0] == '%' && text[1] >= '1' && text[1] <= '0' + MAX_DIAGNOSTIC_ARGS) {
+            index = text[1] - '1';
+            buffer += sprintf(buffer, "%s", index < argCount ? args[index] : "");
+            text += 2;
+        } else {
+            *buffer++ = *text++;
+        }
+    }
+    *buffer = '\0';
+}
+
+/* the format_diagnostic_message function writes the message of a diagnostic, without the file and line, into buffer */
+void format_diagnostic_message(char buffer[MAX_DIAGNOSTIC_LENGTH], DiagnosticCode code, int argCount, char* const args[]) {
+    expand(buffer, find_info(code)->text, 0, argCount, args);
+}
+
+/* the diagnostic_severity function returns the severity of a diagnostic code */
+Severity diagnostic_severity(DiagnosticCode code) {
+    return find_info(code)->severity;
+}
+
+/* the add_message function adds a message to one of the buffers, or writes it right away if the buffer can't grow */
+static void add_message(OutputBuffer* buffer, FILE* stream, const char* message) {
+    output_puts(buffer, message);
+    if (buffer->failed) {
+        fputs(message, stream);
+    }
+}
+
+/* the collect function adds a diagnostic to the list of collected diagnostics. a diagnostic that can't be kept is dropped */
+static void collect(const DiagnosticInfo* info, int line, int column, const char* text) {
+    CollectedDiagnostic* grown;
+    char* message;
+    if (collectedCount == collectedCapacity) {
+        grown = realloc(collected, (collectedCapacity == 0 ? 16 : collectedCapacity * 2) * sizeof(CollectedDiagnostic));
+        if (grown == NULL) {
+            return;
+        }
+        collected = grown;
+        collectedCapacity = collectedCapacity == 0 ? 16 : collectedCapacity * 2;
+    }
+    message = duplicate_string(text);
+    if (message == NULL) {
+        return;
+    }
+    collected[collectedCount].code = info->code;
+    collected[collectedCount].severity = info->severity;
+    collected[collectedCount].line = line;
+    collected[collectedCount].column = column;
+    collected[collectedCount++].message = message;
+}
+
+/* the clear_collected function empties the list of collected diagnostics */
+static void clear_collected(void) {
+    int i;
+    for (i = 0; i < collectedCount; i++) {
+        free(collected[i].message);
+    }
+    collectedCount = 0;
+}
+
+/* the write_diagnostic function writes a diagnostic in the selected format */
+static void write_diagnostic(DiagnosticCode code, const char* file, int line, int column, int argCount, char* const args[]) {
+    static const char* severityNames[] = {"error", "warning", "note"};
+    const DiagnosticInfo* info = find_info(code);
+    char text[MAX_DIAGNOSTIC_LENGTH];
+    char fields[256];
+    char* message;
+    OutputBuffer json;
+    int i;
+
+    expand(text, info->text, line, argCount, args);
+    if (collecting) {
+        collect(info, line, column, text);
+        return;
+    }
+    if (outputFormat == DIAGNOSTICS_JSON) {
+        /* the object is built in memory, with the strings escaped by write_json_string, and added as one message */
+        init_output_buffer(&json, NULL);
+        output_puts(&json, "{\"file\":");
+        write_json_string(&json, file, strlen(file));
+        sprintf(fields, ",\"line\":%d,\"column\":%d,\"severity\":\"%s\",\"code\":%d,\"name\":\"%s\",\"args\":[",
+            line, column, severityNames[info->severity], info->code, info->name);
+        output_puts(&json, fields);
+        for (i = 0; i < argCount; i++) {
+            if (i > 0) output_write(&json, ",", 1);
+            write_json_string(&json, args[i], strlen(args[i]));
+        }
+        output_puts(&json, "],\"message\":");
+        write_json_string(&json, text, strlen(text));
+        output_write(&json, "}\n", 3);
+        if (!json.failed) {
+            add_message(&errors, stderr, json.data);
+        }
+        free_output_buffer(&json);
+    } else {
+        message = malloc(strlen(file) + strlen(text) + 256);
+        if (message == NULL) {
+            return;
+        }
+        switch (info->style) {
+            case STYLE_ON_LINE:
+                sprintf(message, "%s in file \"%s\" on line %d: %s\n", info->severity == SEVERITY_WARNING ? "Warning" : "Error", file, line, text);
+                break;
+            case STYLE_COMMA_LINE:
+                sprintf(message, "Error in file \"%s\", line %d: %s\n", file, line, text);
+                break;
+            case STYLE_FILE:
+                sprintf(message, "Error in file \"%s\", %s\n", file, text);
+                break;
+            case STYLE_WHOLE_FILE:
+                sprintf(message, "Error in file \"%s\": %s\n", file, text);
+                break;
+            default:
+                sprintf(message, "%s\n", text);
+                break;
+        }
+        if (info->severity == SEVERITY_WARNING) {
+            add_message(&warnings, stdout, message);
+        } else {
+            add_message(&errors, stderr, message);
+        }
+        free(message);
+    }
+}
+
+/* the add_diagnostic function counts a diagnostic and writes it, unless the file already has too many errors */
+static void add_diagnostic(DiagnosticCode code, const char* file, int line, int column, int argCount, char* const args[]) {
+    char limit[MAX_ARGUMENT_LENGTH];
+    char* limitArgs[1];
+    diagnosticCount++;
+    if (diagnostic_severity(code) == SEVERITY_ERROR) {
+        errorCount++;
+        if (errorLimit > 0 && errorCount > errorLimit) {
+            /* the file already has too many errors, the stage that reported it should stop soon */
+            return;
+        }
+    }
+    write_diagnostic(code, file, line, column, argCount, args);
+    if (diagnostic_severity(code) == SEVERITY_ERROR && errorLimit > 0 && errorCount == errorLimit) {
+        sprintf(limit, "%d", errorLimit);
+        limitArgs[0] = limit;
+        write_diagnostic(DIAG_TOO_MANY_ERRORS, currentFile, 0, 0, 1, limitArgs);
+    }
+}
+
+/* the set_diagnostics_format function selects how the diagnostics are written */
+void set_diagnostics_format(DiagnosticsFormat format) {
+    outputFormat = format;
+}
+
+/* the collect_diagnostics function selects if the diagnostics are kept in a list instead of being written */
+void collect_diagnostics(boolean collect) {
+    collecting = collect;
+}
+
+/* the collected_diagnostics function returns the diagnostics that were collected for the file, and sets count to their number */
+const CollectedDiagnostic* collected_diagnostics(int* count) {
+    *count = collectedCount;
+    return collected;
+}
+
+/* the begin_file_diagnostics function starts collecting the diagnostics of a new file.
+    after maxErrors errors (0 for no limit) the rest of the errors of the file are dropped */
+void begin_file_diagnostics(const char* fileName, int maxErrors) {
+    flush_diagnostics();
+    clear_collected();
+    currentFile = fileName;
+    errorCount = 0;
+    diagnosticCount = 0;
+    errorLimit = maxErrors;
+}
+
+/* the report function adds a diagnostic to the diagnostics of the file.
+    line and column are 0 when they don't apply. argTypes has a character for every argument that follows:
+    's' for a string and 'd' for an int */
+void report(DiagnosticCode code, const char* file, int line, int column, const char* argTypes, ...) {
+    char arguments[MAX_DIAGNOSTIC_ARGS][MAX_ARGUMENT_LENGTH];
+    char* pointers[MAX_DIAGNOSTIC_ARGS];
+    int i, count;
+    va_list args;
+    va_start(args, argTypes);
+    count = collect_arguments(arguments, argTypes, args);
+    va_end(args);
+    for (i = 0; i < count; i++) {
+        pointers[i] = arguments[i];
+    }
+    add_diagnostic(code, file, line, column, count, pointers);
+}
+
+/* The diagnostic that is given instead of a diagnostic that could not be allocated, so the line still has an error */
+static char outOfMemoryArgument[] = "a diagnostic";
+static Diagnostic outOfMemory = {DIAG_OUT_OF_MEMORY, 0, 1, {outOfMemoryArgument}};
+
+/* the create_diagnostic function creates a diagnostic that is reported later, with the arguments given like in report.
+    if the memory could not be allocated, an out of memory diagnostic is returned instead */
+Diagnostic* create_diagnostic(DiagnosticCode code, int column, const char* argTypes, va_list args) {
+    char arguments[MAX_DIAGNOSTIC_ARGS][MAX_ARGUMENT_LENGTH];
+    int i;
+    Diagnostic* diagnostic = malloc(sizeof(Diagnostic));
+    if (diagnostic == NULL) {
+        return &outOfMemory;
+    }
+    diagnostic->code = code;
+    diagnostic->column = column;
+    diagnostic->argCount = collect_arguments(arguments, argTypes, args);
+    for (i = 0; i < diagnostic->argCount; i++) {
+        diagnostic->args[i] = duplicate_string(arguments[i]);
+        if (diagnostic->args[i] == NULL) {
+            diagnostic->argCount = i;
+            free_diagnostic(diagnostic);
+            return &outOfMemory;
+        }
+    }
+    return diagnostic;
+}
+
+/* the report_diagnostic function reports a diagnostic that was created with create_diagnostic */
+void report_diagnostic(const Diagnostic* diagnostic, const char* file, int line) {
+    add_diagnostic(diagnostic->code, file, line, diagnostic->column, diagnostic->argCount, diagnostic->args);
+}
+
+/* the free_diagnostic function frees a diagnostic that was created with create_diagnostic */
+void free_diagnostic(Diagnostic* diagnostic) {
+    int i;
+    if (diagnostic == NULL || diagnostic == &outOfMemory) {
+        return;
+    }
+    for (i = 0; i < diagnostic->argCount; i++) {
+        free(diagnostic->args[i]);
+    }
+    free(diagnostic);
+}
+
+/* the error_count function returns the number of errors that were reported for the file */
+int error_count(void) {
+    return errorCount;
+}
+
+/* the diagnostic_count function returns the number of errors and warnings that were reported for the file */
+int diagnostic_count(void) {
+    return diagnosticCount;
+}
+
+/* the discard_diagnostics function drops the diagnostics of the file that weren't written yet, and starts counting them again */
+void discard_diagnostics(void) {
+    errors.size = 0;
+    warnings.size = 0;
+    clear_collected();
+    errorCount = 0;
+    diagnosticCount = 0;
+}
+
+/* the error_limit_reached function checks if the file has reached the maximum number of errors, so it should stop early */
+boolean error_limit_reached(void) {
+    return errorLimit > 0 && errorCount >= errorLimit;
+}
+
+/* the flush_diagnostics function writes the diagnostics that were collected so far, all at once */
+void flush_diagnostics(void) {
+    if (warnings.size > 0) {
+        fwrite(warnings.data, 1, warnings.size, stdout);
+        warnings.size = 0;
+    }
+    if (errors.size > 0) {
+        fflush(stdout); /* the messages that were already printed to stdout should come first */
+        fwrite(errors.data, 1, errors.size, stderr);
+        errors.size = 0;
+    }
+}
+
+/* the end_diagnostics function writes the diagnostics that are left, and frees the buffers */
+void end_diagnostics(void) {
+    flush_diagnostics();
+    free_output_buffer(&errors);
+    free_output_buffer(&warnings);
+    init_output_buffer(&errors, NULL);
+    init_output_buffer(&warnings, NULL);
+    clear_collected();
+    if (collected != NULL) free(collected);
+    collected = NULL;
+    collectedCapacity = 0;
+}
@@ -0,0 +1,175 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdarg.h>
+#include "structs.h"
+
+#define MAX_DIAGNOSTIC_LENGTH 1024 /* the longest text of a diagnostic, without the name of the file */
+#define MAX_DIAGNOSTIC_ARGS 6
+#define MAX_ARGUMENT_LENGTH 128
+
+/* The severity of a diagnostic */
+typedef enum {
+    SEVERITY_ERROR,
+    SEVERITY_WARNING,
+    SEVERITY_NOTE /* a message about the diagnostics themselves, it isn't counted as an error */
+} Severity;
+
+/* The code of every diagnostic. the hundreds are the stage of the assembler that reports it */
+typedef enum {
+    NO_DIAGNOSTIC = 0,
+
+    /* the preprocessor */
+    DIAG_LINE_TOO_LONG = 101,
+    DIAG_MACRO_NAME_MISSING = 102,
+    DIAG_INVALID_MACRO_NAME = 103,
+    DIAG_TOKEN_AFTER_MACRO_NAME = 104,
+    DIAG_TOKEN_AFTER_MACRO_END = 105,
+    DIAG_LIBRARY_STATEMENT = 106,
+    DIAG_IMPORT_PATH_MISSING = 107,
+    DIAG_INVALID_LIBRARY = 108,
+    DIAG_TOO_MANY_LIBRARIES = 109,
+    DIAG_ELSE_WITHOUT_IF = 110,
+    DIAG_ENDIF_WITHOUT_IF = 111,
+    DIAG_IF_NOT_CLOSED = 112,
+    DIAG_ELSE_AGAIN = 113,
+    DIAG_INVALID_CONDITION = 114,
+    DIAG_CONDITION_UNDEFINED = 115,
+    DIAG_TOKEN_AFTER_CONDITION = 116,
+    DIAG_CONDITION_TOO_DEEP = 117,
+
+    /* the parser */
+    DIAG_DIRECTIVE_EMPTY = 201,
+    DIAG_DATA_EXPECTED_COMMA = 202,
+    DIAG_INVALID_DATA_VALUE = 203,
+    DIAG_DATA_UNEXPECTED_COMMA = 204,
+    DIAG_INVALID_STRING = 205,
+    DIAG_STRING_UNPRINTABLE = 206,
+    DIAG_TOKEN_AFTER_STRING = 207,
+    DIAG_INVALID_ENTRY_LABEL = 208,
+    DIAG_TOKEN_AFTER_ENTRY = 209,
+    DIAG_INVALID_EXTERN_LABEL = 210,
+    DIAG_TOKEN_AFTER_EXTERN = 211,
+    DIAG_INVALID_DIRECTIVE = 212,
+    DIAG_INVALID_IMMEDIATE = 213,
+    DIAG_CONSTANT_AS_LABEL = 214,
+    DIAG_INVALID_OPERAND = 215,
+    DIAG_NO_OPERANDS = 216,
+    DIAG_TOO_MANY_OPERANDS = 217,
+    DIAG_OPERAND_NOT_ALLOWED = 218,
+    DIAG_EXPECTED_COMMA = 219,
+    DIAG_CONSTANT_WITH_LABEL = 220,
+    DIAG_CONSTANT_EMPTY = 221,
+    DIAG_CONSTANT_EMPTY_TOKEN = 222,
+    DIAG_CONSTANT_INVALID_NAME = 223,
+    DIAG_CONSTANT_REDEFINED = 224,
+    DIAG_CONSTANT_IS_LABEL = 225,
+    DIAG_CONSTANT_NO_EQUALS = 226,
+    DIAG_CONSTANT_EXPECTED_EQUALS = 227,
+    DIAG_CONSTANT_NO_VALUE = 228,
+    DIAG_CONSTANT_INVALID_VALUE = 229,
+    DIAG_TOKEN_AFTER_CONSTANT = 230,
+    DIAG_TOKENIZE_FAILED = 231,
+    DIAG_SYMBOL_REDEFINED = 232,
+    DIAG_LABEL_WITHOUT_STATEMENT = 233,
+    DIAG_WHITESPACE_BEFORE_COMMENT = 234,
+    DIAG_UNEXPECTED_TOKEN = 235,
+
+    /* the first pass */
+    DIAG_SYMBOL_ALREADY_DEFINED = 301,
+    DIAG_CONSTANT_NOT_USEABLE = 302,
+    DIAG_ENTRY_NOT_DEFINED = 303,
+    DIAG_PROGRAM_TOO_LARGE = 304,
+    DIAG_EXTERN_AGAIN = 305,
+    DIAG_ENTRY_AGAIN = 306,
+    DIAG_WRONG_OPERAND_COUNT = 307,
+
+    /* the second pass */
+    DIAG_VALUE_TOO_LARGE = 401,
+    DIAG_INDEX_OUT_OF_BOUNDS = 402,
+    DIAG_NOT_INDEXABLE = 403,
+    DIAG_ADDRESS_TOO_LARGE = 404,
+    DIAG_SYMBOL_NOT_FOUND = 405,
+
+    /* the assembler itself */
+    DIAG_TOO_MANY_ERRORS = 901,
+    DIAG_OUT_OF_MEMORY = 902
+} DiagnosticCode;
+
+/* A diagnostic that is kept until it is reported, like the error of a parsed line */
+typedef struct Diagnostic {
+    DiagnosticCode code;
+    int column; /* the column the diagnostic points at, starting from 1, or 0 if it is about the whole line */
+    int argCount;
+    char* args[MAX_DIAGNOSTIC_ARGS];
+} Diagnostic;
+
+/* The ways the diagnostics can be written */
+typedef enum {
+    DIAGNOSTICS_TEXT, /* the messages, errors to stderr and warnings to stdout */
+    DIAGNOSTICS_JSON /* one JSON object per diagnostic, all of them to stderr */
+} DiagnosticsFormat;
+
+/* A diagnostic that was collected instead of written, see collect_diagnostics */
+typedef struct {
+    DiagnosticCode code;
+    Severity severity;
+    int line; /* the line of the .as file for the diagnostics of the preprocessor, and of the .am file for the rest (0 for the whole file) */
+    int column;
+    char* message; /* the text of the diagnostic, without the file and the line */
+} CollectedDiagnostic;
+
+/* the set_diagnostics_format function selects how the diagnostics are written */
+void set_diagnostics_format(DiagnosticsFormat format);
+
+/* the collect_diagnostics function selects if the diagnostics are kept in a list instead of being written (for the language server).
+    the list is emptied by begin_file_diagnostics and discard_diagnostics */
+void collect_diagnostics(boolean collect);
+
+/* the collected_diagnostics function returns the diagnostics that were collected for the file, and sets count to their number */
+const CollectedDiagnostic* collected_diagnostics(int* count);
+
+/* the begin_file_diagnostics function starts collecting the diagnostics of a new file.
+    after maxErrors errors (0 for no limit) the rest of the errors of the file are dropped */
+void begin_file_diagnostics(const char* fileName, int maxErrors);
+
+/* the report function adds a diagnostic to the diagnostics of the file.
+    line and column are 0 when they don't apply. argTypes has a character for every argument that follows:
+    's' for a string and 'd' for an int */
+void report(DiagnosticCode code, const char* file, int line, int column, const char* argTypes, ...);
+
+/* the create_diagnostic function creates a diagnostic that is reported later, with the arguments given like in report.
+    if the memory could not be allocated, an out of memory diagnostic is returned instead, so it never returns NULL */
+Diagnostic* create_diagnostic(DiagnosticCode code, int column, const char* argTypes, va_list args);
+
+/* the report_diagnostic function reports a diagnostic that was created with create_diagnostic */
+void report_diagnostic(const Diagnostic* diagnostic, const char* file, int line);
+
+/* the free_diagnostic function frees a diagnostic that was created with create_diagnostic */
+void free_diagnostic(Diagnostic* diagnostic);
+
+/* the diagnostic_severity function returns the severity of a diagnostic code */
+Severity diagnostic_severity(DiagnosticCode code);
+
+/* the format_diagnostic_message function writes the message of a diagnostic, without the file and line, into buffer */
+void format_diagnostic_message(char buffer[MAX_DIAGNOSTIC_LENGTH], DiagnosticCode code, int argCount, char* const args[]);
+
+/* the error_count function returns the number of errors that were reported for the file */
+int error_count(void);
+
+/* the diagnostic_count function returns the number of errors and warnings that were reported for the file */
+int diagnostic_count(void);
+
+/* the discard_diagnostics function drops the diagnostics of the file that weren't written yet, and starts counting them again */
+void discard_diagnostics(void);
+
+/* the error_limit_reached function checks if the file has reached the maximum number of errors, so it should stop early */
+boolean error_limit_reached(void);
+
+/* the flush_diagnostics function writes the diagnostics that were collected so far, all at once */
+void flush_diagnostics(void);
+
+/* the end_diagnostics function writes the diagnostics that are left, and frees the buffers */
+void end_diagnostics(void);
+
+#endif
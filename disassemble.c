@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "disassemble.h"
+#include "constants.h"
+#include "globals.h"
+#include "isa.h"
+
+#define GENERATED_LABEL_SIZE 8 /* L, an address of up to 5 digits and the \0 */
+
+/* An operand of an instruction that is written back as source */
+typedef struct {
+    int mode;
+    int value; /* the number, the number of the register, or the address of the label */
+    int index; /* the index of an indexed operand */
+    const char* external; /* the name of the external that the operand uses, or NULL */
+} SourceOperand;
+
+/* An instruction that is written back as source */
+typedef struct {
+    int opcode;
+    int length;
+    int operandCount;
+    SourceOperand operands[MAX_OPERANDS];
+} SourceInstruction;
+
+/* What the disassembler knows about the words of an object. the arrays are indexed by the address - START_POSITION */
+typedef struct {
+    const ObjectFile* object;
+    int length; /* the number of words of the code and the data */
+    const char** names; /* the name of the entry at every address, or NULL */
+    unsigned char* used; /* whether an operand uses the address as a label */
+    unsigned char* starts; /* whether an instruction starts at the address */
+    int* minimumLength; /* the number of words that the line at the address must have, for the indexed operands that use it */
+    ObjectSymbol* externals; /* the uses of the externals, by their address */
+} Disassembly;
+
+/* the sign_extend function returns the number in the 12 bits of an operand word as an int */
+static int sign_extend(int value) {
+    value &= 0xFFF;
+    return value >= 0x800 ? value - 0x1000 : value;
+}
+
+/* the object_error function writes an error about the word at address, on its line of the .ob file (the title is the first line).
+    the message may have a %d for the argument */
+static void object_error(const Disassembly* disassembly, int address, const char* message, int argument) {
+    fprintf(stderr, "Error in file \"%s.ob\" on line %d: ", disassembly->object->name, address - START_POSITION + 2);
+    fprintf(stderr, message, argument);
+    fprintf(stderr, "\n");
+}
+
+/* the compare_address function orders symbols by their address */
+static int compare_address(const void* first, const void* second) {
+    return ((const ObjectSymbol*)first)->address - ((const ObjectSymbol*)second)->address;
+}
+
+/* the compare_name function orders pointers to symbols by their name */
+static int compare_name(const void* first, const void* second) {
+    return strcmp((*(const ObjectSymbol* const*)first)->name, (*(const ObjectSymbol* const*)second)->name);
+}
+
+/* the label_of function returns the label of an address: the entry at it, or L followed by the address */
+static const char* label_of(const Disassembly* disassembly, int address, char buffer[GENERATED_LABEL_SIZE]) {
+    if (disassembly->names[address - START_POSITION] != NULL) {
+        return disassembly->names[address - START_POSITION];
+    }
+    sprintf(buffer, "L%04d", address);
+    return buffer;
+}
+
+/* the decode_operand function decodes the operand that is in the given mode, in the words starting at address.
+    shift is where the number of a register is in the word. returns 1 if the operand can't be written as source, and writes why when report is TRUE */
+static int decode_operand(const Disassembly* disassembly, int instruction, int mode, int address, int shift, SourceOperand* operand, boolean report) {
+    const unsigned short* words = disassembly->object->words;
+    int word = words[address - START_POSITION], index;
+    ObjectSymbol key, *found;
+
+    operand->mode = mode;
+    operand->external = NULL;
+    operand->index = 0;
+    switch (mode) {
+        case MODE_IMMEDIATE:
+            if ((word & 3) != ARE_ABSOLUTE) {
+                if (report) object_error(disassembly, address, "The number of the instruction at address %04d isn't absolute", instruction);
+                return 1;
+            }
+            operand->value = sign_extend(word >> OPERAND_VALUE_SHIFT);
+            return 0;
+        case MODE_DIRECT:
+        case MODE_INDEXED:
+            if (mode == MODE_INDEXED) {
+                index = words[address + 1 - START_POSITION];
+                if ((index & 3) != ARE_ABSOLUTE || sign_extend(index >> OPERAND_VALUE_SHIFT) < 0) {
+                    if (report) object_error(disassembly, address + 1, "Invalid index of the instruction at address %04d", instruction);
+                    return 1;
+                }
+                operand->index = index >> OPERAND_VALUE_SHIFT;
+            }
+            if ((word & 3) == ARE_EXTERNAL) {
+                key.address = address;
+                found = disassembly->object->externalCount == 0 ? NULL : bsearch(&key, disassembly->externals,
+                    disassembly->object->externalCount, sizeof(ObjectSymbol), compare_address);
+                if (found == NULL || word != ARE_EXTERNAL) {
+                    if (report) object_error(disassembly, address, "The external of the instruction at address %04d isn't in the .ext file", instruction);
+                    return 1;
+                }
+                operand->external = found->name;
+                operand->value = 0;
+                return 0;
+            }
+            operand->value = word >> OPERAND_VALUE_SHIFT;
+            if ((word & 3) != ARE_RELOCATABLE || operand->value < START_POSITION || operand->value >= START_POSITION + disassembly->length) {
+                if (report) object_error(disassembly, address, "The address that the instruction at address %04d uses isn't in the object", instruction);
+                return 1;
+            }
+            return 0;
+        case MODE_REGISTER:
+            operand->value = (word >> shift) & 7; /* the number of a register is 3 bits */
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+/* the decode_instruction function rebuilds the instruction at address from the opcode and the addressing modes of its first word.
+    returns 1 if the words at address can't be written as an instruction, and writes why when report is TRUE */
+static int decode_instruction(const Disassembly* disassembly, int address, SourceInstruction* decoded, boolean report) {
+    const unsigned short* words = disassembly->object->words;
+    int word = words[address - START_POSITION];
+    int opcode = (word >> OPCODE_SHIFT) & (OPCODE_COUNT - 1);
+    int count = instructionRules[opcode].numberOfOperandsRequired;
+    int sourceMode = count == 2 ? (word >> SOURCE_MODE_SHIFT) & 3 : MODE_NONE;
+    int destinationMode = count > 0 ? (word >> DESTINATION_MODE_SHIFT) & 3 : MODE_NONE;
+    const EncodingEntry* encoding = &encodingTable[opcode][sourceMode][destinationMode];
+    int i, mode, next = address + 1, registers = 0;
+
+    if (!encoding->legal || encoding->firstWord != word) {
+        if (report) object_error(disassembly, address, "Invalid instruction word %d", word);
+        return 1;
+    }
+    if (address + encoding->words > START_POSITION + disassembly->object->codeLength) {
+        if (report) object_error(disassembly, address, "The instruction at address %04d goes past the end of the code", address);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        mode = i == 0 && count == 2 ? sourceMode : destinationMode;
+        if (decode_operand(disassembly, address, mode, next, registerShifts[count][i], &decoded->operands[i], report) != 0) {
+            return 1;
+        }
+        if (mode == MODE_REGISTER) {
+            registers |= decoded->operands[i].value << registerShifts[count][i];
+        }
+        if (mode == MODE_REGISTER && !encoding->packedRegisters && words[next - START_POSITION] != registers) {
+            if (report) object_error(disassembly, next, "Invalid register word of the instruction at address %04d", address);
+            return 1;
+        }
+        if (!encoding->packedRegisters) {
+            /* two registers share one word, so the second register is in the same word as the first */
+            next += operandWords[mode];
+            registers = 0;
+        }
+    }
+    if (encoding->packedRegisters && words[next - START_POSITION] != registers) {
+        if (report) object_error(disassembly, next, "Invalid register word of the instruction at address %04d", address);
+        return 1;
+    }
+    decoded->opcode = opcode;
+    decoded->length = encoding->words;
+    decoded->operandCount = count;
+    return 0;
+}
+
+/* the scan_code function decodes the code once, to find the addresses that need labels and where the instructions start.
+    returns 1 if some of the code can't be written as source */
+static int scan_code(Disassembly* disassembly) {
+    SourceInstruction instruction;
+    SourceOperand* operand;
+    int address = START_POSITION, end = START_POSITION + disassembly->object->codeLength, i, error = 0;
+
+    while (address < end) {
+        disassembly->starts[address - START_POSITION] = 1;
+        if (decode_instruction(disassembly, address, &instruction, TRUE) != 0) {
+            /* the word is written as a comment, and the next word is tried as an instruction */
+            error = 1;
+            address++;
+            continue;
+        }
+        for (i = 0; i < instruction.operandCount; i++) {
+            operand = &instruction.operands[i];
+            if ((operand->mode != MODE_DIRECT && operand->mode != MODE_INDEXED) || operand->external != NULL) {
+                continue;
+            }
+            disassembly->used[operand->value - START_POSITION] = 1;
+            if (operand->mode == MODE_INDEXED && operand->value < end) {
+                object_error(disassembly, address, "The instruction at address %04d indexes the code", address);
+                error = 1;
+            } else if (operand->mode == MODE_INDEXED && disassembly->minimumLength[operand->value - START_POSITION] < operand->index + 1) {
+                disassembly->minimumLength[operand->value - START_POSITION] = operand->index + 1;
+            }
+        }
+        address += instruction.length;
+    }
+    for (address = START_POSITION; address < end; address++) {
+        i = address - START_POSITION;
+        if ((disassembly->used[i] || disassembly->names[i] != NULL) && !disassembly->starts[i]) {
+            object_error(disassembly, address, "The label at address %04d is in the middle of an instruction", address);
+            error = 1;
+        }
+    }
+    return error;
+}
+
+/* the print_instruction function writes an instruction as a line of source */
+static void print_instruction(const Disassembly* disassembly, const SourceInstruction* instruction, FILE* output) {
+    char buffer[GENERATED_LABEL_SIZE];
+    const SourceOperand* operand;
+    int i;
+
+    fprintf(output, "%s", instructionRules[instruction->opcode].name);
+    for (i = 0; i < instruction->operandCount; i++) {
+        operand = &instruction->operands[i];
+        fprintf(output, i == 0 ? " " : ", ");
+        switch (operand->mode) {
+            case MODE_IMMEDIATE:
+                fprintf(output, "#%d", operand->value);
+                break;
+            case MODE_REGISTER:
+                fprintf(output, "r%d", operand->value);
+                break;
+            default:
+                fprintf(output, "%s", operand->external != NULL ? operand->external : label_of(disassembly, operand->value, buffer));
+                if (operand->mode == MODE_INDEXED) {
+                    fprintf(output, "[%d]", operand->index);
+                }
+                break;
+        }
+    }
+    fprintf(output, "\n");
+}
+
+/* the print_code function writes the instructions of the code, with the labels of the addresses that have them */
+static void print_code(const Disassembly* disassembly, FILE* output) {
+    SourceInstruction instruction;
+    char buffer[GENERATED_LABEL_SIZE];
+    int address = START_POSITION, end = START_POSITION + disassembly->object->codeLength, i;
+
+    while (address < end) {
+        i = address - START_POSITION;
+        if (decode_instruction(disassembly, address, &instruction, FALSE) != 0) {
+            fprintf(output, "; %04d: the word %d isn't an instruction\n", address, disassembly->object->words[i]);
+            address++;
+            continue;
+        }
+        if (disassembly->used[i] || disassembly->names[i] != NULL) {
+            fprintf(output, "%s:", label_of(disassembly, address, buffer));
+        }
+        fprintf(output, "\t");
+        print_instruction(disassembly, &instruction, output);
+        address += instruction.length;
+    }
+}
+
+/* the string_length function returns the number of words of the string that starts at the index of the word and ends before end,
+    with its \0, or 0 if the words there aren't a string that fits in the rest of the line */
+static int string_length(const Disassembly* disassembly, int start, int end, int lineLength) {
+    const unsigned short* words = disassembly->object->words;
+    int i;
+    for (i = start; i < end && words[i] < 128 && isprint(words[i]) && words[i] != '"'; i++);
+    if (i == start || i == end || words[i] != 0 || lineLength + (int)strlen("\t.string \"\"") + i - start > MAX_LINE_LENGTH) {
+        return 0;
+    }
+    return i - start + 1;
+}
+
+/* the data_value function returns a data word, that is 14 bits, as an int */
+static int data_value(int word) {
+    return word >= 0x2000 ? word - 0x4000 : word;
+}
+
+/* the print_data function writes the data, in .string lines where the words are strings and in .data lines otherwise.
+    a line doesn't go on past the next label, and the line of a label has all of the words that indexes of it use */
+static void print_data(const Disassembly* disassembly, FILE* output) {
+    const unsigned short* words = disassembly->object->words;
+    char buffer[GENERATED_LABEL_SIZE], number[16];
+    const char* separator;
+    int i = disassembly->object->codeLength, end, length, lineLength, count, width;
+
+    while (i < disassembly->length) {
+        /* the line ends at the next label */
+        for (end = i + 1; end < disassembly->length && !disassembly->used[end] && disassembly->names[end] == NULL; end++);
+        lineLength = 0;
+        if (disassembly->used[i] || disassembly->names[i] != NULL) {
+            lineLength = fprintf(output, "%s:", label_of(disassembly, i + START_POSITION, buffer));
+        }
+        length = string_length(disassembly, i, end, lineLength);
+        if (length > 0 && length >= disassembly->minimumLength[i]) {
+            fprintf(output, "\t.string \"");
+            for (; length > 1; length--) {
+                putc(words[i++], output);
+            }
+            fprintf(output, "\"\n");
+            i++;
+            continue;
+        }
+        lineLength += fprintf(output, "\t.data");
+        /* the numbers are written without spaces between them when the words that have to be in the line don't fit otherwise */
+        for (count = 0, width = lineLength; count < disassembly->minimumLength[i]; count++) {
+            width += sprintf(number, " %d,", data_value(words[i + count]));
+        }
+        separator = width > MAX_LINE_LENGTH ? "," : ", ";
+        for (count = 0; i < end; count++, i++) {
+            sprintf(number, "%s%d", count == 0 ? " " : separator, data_value(words[i]));
+            if (count >= disassembly->minimumLength[i - count] && lineLength + (int)strlen(number) > MAX_LINE_LENGTH) {
+                break;
+            }
+            lineLength += fprintf(output, "%s", number);
+        }
+        fprintf(output, "\n");
+    }
+}
+
+/* the print_symbols function writes the .entry and the .extern lines of the object, every external once */
+static int print_symbols(const Disassembly* disassembly, FILE* output) {
+    const ObjectFile* object = disassembly->object;
+    const ObjectSymbol** sorted;
+    int i;
+
+    for (i = 0; i < object->entryCount; i++) {
+        fprintf(output, ".entry %s\n", object->entries[i].name);
+    }
+    if (object->externalCount == 0) {
+        return 0;
+    }
+    sorted = malloc(object->externalCount * sizeof(ObjectSymbol*));
+    if (sorted == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the externals of file \"%s\"\n", object->name);
+        return 1;
+    }
+    for (i = 0; i < object->externalCount; i++) {
+        sorted[i] = &object->externals[i];
+    }
+    qsort(sorted, object->externalCount, sizeof(ObjectSymbol*), compare_name);
+    for (i = 0; i < object->externalCount; i++) {
+        if (i == 0 || strcmp(sorted[i - 1]->name, sorted[i]->name) != 0) {
+            fprintf(output, ".extern %s\n", sorted[i]->name);
+        }
+    }
+    free(sorted);
+    return 0;
+}
+
+/* the name_entries function puts the name of every entry at its address. returns 1 if an entry isn't in the object */
+static int name_entries(Disassembly* disassembly) {
+    const ObjectFile* object = disassembly->object;
+    int i, error = 0;
+
+    for (i = 0; i < object->entryCount; i++) {
+        if (object->entries[i].address < START_POSITION || object->entries[i].address >= START_POSITION + disassembly->length) {
+            fprintf(stderr, "Error in file \"%s.ent\" on line %d: The entry isn't in the object\n", object->name, object->entries[i].line);
+            error = 1;
+            continue;
+        }
+        disassembly->names[object->entries[i].address - START_POSITION] = object->entries[i].name;
+    }
+    return error;
+}
+
+/* the check_names function checks that no entry or external has the name of a label that is made for an address.
+    returns 1 if one of them has */
+static int check_names(const Disassembly* disassembly) {
+    const ObjectFile* object = disassembly->object;
+    const ObjectSymbol* symbol;
+    int i, address, error = 0;
+    char* end;
+
+    for (i = 0; i < object->entryCount + object->externalCount; i++) {
+        symbol = i < object->entryCount ? &object->entries[i] : &object->externals[i - object->entryCount];
+        if (symbol->name[0] != 'L' || !isdigit((unsigned char)symbol->name[1])) {
+            continue;
+        }
+        address = (int)strtol(symbol->name + 1, &end, 10);
+        if (*end == '\0' && address >= START_POSITION && address < START_POSITION + disassembly->length &&
+            disassembly->used[address - START_POSITION] && disassembly->names[address - START_POSITION] == NULL) {
+            fprintf(stderr, "Error in file \"%s\": The symbol \"%s\" has the name of the label of address %04d\n", object->name, symbol->name, address);
+            error = 1;
+        }
+    }
+    return error;
+}
+
+/* the disassemble_object function writes source code that assembles back into the words, entries and externals of the object.
+    the instructions are rebuilt from the opcode and the addressing modes of their first word, the labels are the entries of the object,
+    and the other addresses that operands use get a label L followed by the address. the data is written with .string where it is a string.
+    returns 0 on success and 1 if the object has words that can't be written as source (the errors are written to stderr) */
+int disassemble_object(const ObjectFile* object, FILE* output) {
+    Disassembly disassembly;
+    int error = 1;
+
+    memset(&disassembly, 0, sizeof(Disassembly));
+    disassembly.object = object;
+    disassembly.length = object->codeLength + object->dataLength;
+    disassembly.names = calloc(disassembly.length + 1, sizeof(const char*));
+    disassembly.used = calloc(disassembly.length + 1, sizeof(unsigned char));
+    disassembly.starts = calloc(disassembly.length + 1, sizeof(unsigned char));
+    disassembly.minimumLength = calloc(disassembly.length + 1, sizeof(int));
+    disassembly.externals = malloc((object->externalCount + 1) * sizeof(ObjectSymbol));
+    if (disassembly.names == NULL || disassembly.used == NULL || disassembly.starts == NULL ||
+        disassembly.minimumLength == NULL || disassembly.externals == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the disassembly of file \"%s\"\n", object->name);
+        goto end;
+    }
+    if (object->externalCount > 0) {
+        memcpy(disassembly.externals, object->externals, object->externalCount * sizeof(ObjectSymbol));
+        qsort(disassembly.externals, object->externalCount, sizeof(ObjectSymbol), compare_address);
+    }
+
+    /* the labels of the whole object are found first, because a jump can go back to an address that was already written */
+    error = name_entries(&disassembly);
+    error |= scan_code(&disassembly);
+    error |= check_names(&disassembly);
+    fprintf(output, "; disassembled from %s.ob\n", object->name);
+    error |= print_symbols(&disassembly, output);
+    print_code(&disassembly, output);
+    print_data(&disassembly, output);
+
+    end:
+    if (disassembly.names != NULL) free((void*)disassembly.names);
+    if (disassembly.used != NULL) free(disassembly.used);
+    if (disassembly.starts != NULL) free(disassembly.starts);
+    if (disassembly.minimumLength != NULL) free(disassembly.minimumLength);
+    if (disassembly.externals != NULL) free(disassembly.externals);
+    return error;
+}
@@ -0,0 +1,13 @@
+#ifndef DISASSEMBLE_H
+#define DISASSEMBLE_H
+
+#include <stdio.h>
+#include "object_file.h"
+
+/* the disassemble_object function writes source code that assembles back into the words, entries and externals of the object.
+    the instructions are rebuilt from the opcode and the addressing modes of their first word, the labels are the entries of the object,
+    and the other addresses that operands use get a label L followed by the address. the data is written with .string where it is a string.
+    returns 0 on success and 1 if the object has words that can't be written as source (the errors are written to stderr) */
+int disassemble_object(const ObjectFile* object, FILE* output);
+
+#endif
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <string.h>
+#include "disassemble.h"
+#include "object_file.h"
+
+#define DISASSEMBLER_OUTPUT_BUFFER_SIZE 65536
+
+/**
+ * The main function of the disassembler.
+ * Usage: disassembler FILE
+ * It reads file.ob, and file.ent and file.ext if they exist, and writes to the standard output source code
+ * that the assembler turns back into the same files.
+ * Returns 0 on success, and 1 if the object could not be read or some of its words can't be written as source.
+*/
+int main(int argc, char **argv) {
+    ObjectFile object;
+    int error;
+
+    if (argc != 2 || strncmp(argv[1], "--", 2) == 0) {
+        fprintf(stderr, "Usage: disassembler FILE\n");
+        return 1;
+    }
+    if (load_object(argv[1], &object) != 0) {
+        return 1;
+    }
+    setvbuf(stdout, NULL, _IOFBF, DISASSEMBLER_OUTPUT_BUFFER_SIZE);
+    error = disassemble_object(&object, stdout);
+    if (fflush(stdout) != 0 || ferror(stdout)) {
+        fprintf(stderr, "Error writing the standard output\n");
+        error = 1;
+    }
+    free_object(&object);
+    return error;
+}
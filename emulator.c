@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "machine.h"
+#include "profile.h"
+#include "jit.h"
+#include "snapshot.h"
+#include "object_file.h"
+#include "constants.h"
+#include "utils.h"
+
+#define EMULATOR_IO_BUFFER_SIZE 65536
+
+/* The ways the emulator can run a program */
+enum {
+    RUN_INTERPRETER,
+    RUN_JIT, /* --jit */
+    RUN_JIT_CHECK /* --jit-check */
+};
+
+/* the names of the statuses of run_machine, for the messages of --jit-check */
+static const char* statusNames[] = {"halted", "ran the maximum number of instructions", "faulted"};
+
+/* the compare_runs function writes the first difference between the machine after it ran the program with the translator,
+    and the machine and the memory after it ran in the interpreter. returns 0 if there isn't a difference */
+static int compare_runs(const Machine* expected, const unsigned short* memory, const Machine* machine, FILE* expectedOutput, FILE* output) {
+    int i, expectedChar, outputChar;
+    long position = 0;
+
+    if (expected->pc != machine->pc || expected->steps != machine->steps) {
+        fprintf(stderr, "The interpreter stopped at address %04d after %lu instructions, and the translator at address %04d after %lu instructions\n",
+            expected->pc, expected->steps, machine->pc, machine->steps);
+        return 1;
+    }
+    for (i = 0; i < REGISTER_COUNT; i++) {
+        if (expected->registers[i] != machine->registers[i]) {
+            fprintf(stderr, "r%d is %d in the interpreter and %d in the translator\n", i, expected->registers[i], machine->registers[i]);
+            return 1;
+        }
+    }
+    if (expected->zero != machine->zero || expected->stackDepth != machine->stackDepth ||
+        memcmp(expected->stack, machine->stack, expected->stackDepth * sizeof(int)) != 0) {
+        fprintf(stderr, "The Z flag or the stack are different in the interpreter and in the translator\n");
+        return 1;
+    }
+    for (i = 0; i < machine->memorySize; i++) {
+        if (memory[i] != machine->memory[i]) {
+            fprintf(stderr, "The word at address %04d is %d in the interpreter and %d in the translator\n", i, memory[i], machine->memory[i]);
+            return 1;
+        }
+    }
+    rewind(expectedOutput);
+    rewind(output);
+    do {
+        expectedChar = getc(expectedOutput);
+        outputChar = getc(output);
+        if (expectedChar != outputChar) {
+            fprintf(stderr, "The output is different from character %ld\n", position);
+            return 1;
+        }
+        position++;
+    } while (expectedChar != EOF);
+    return 0;
+}
+
+/* the check_jit function runs the program in the interpreter and with the translator, with the same input (the standard input),
+    and compares the outputs and the machines at the end. the output of the interpreter is written to stdout.
+    returns 0 if they are the same, and 1 otherwise */
+static int check_jit(Machine* machine, Jit* jit, const ObjectFile* object, unsigned long maxSteps, MachineStatus* status) {
+    Machine expected;
+    MachineStatus statuses[2];
+    FILE *input = tmpfile(), *outputs[2];
+    unsigned short* memory = malloc(machine->memorySize * sizeof(unsigned short));
+    int c, i, result = 1;
+
+    outputs[0] = tmpfile();
+    outputs[1] = tmpfile();
+    if (input == NULL || outputs[0] == NULL || outputs[1] == NULL || memory == NULL) {
+        fprintf(stderr, "Failed to create the temporary files of --jit-check\n");
+        goto end;
+    }
+    while ((c = getc(stdin)) != EOF) {
+        putc(c, input);
+    }
+    for (i = 0; i < 2; i++) {
+        rewind(input);
+        if (load_machine(machine, object) != 0) {
+            goto end;
+        }
+        flush_jit(jit);
+        statuses[i] = i == 0 ? run_machine(machine, maxSteps, input, outputs[i]) : run_jit(jit, machine, maxSteps, input, outputs[i]);
+        if (i == 0) {
+            expected = *machine;
+            memcpy(memory, machine->memory, machine->memorySize * sizeof(unsigned short));
+        }
+    }
+    *status = statuses[0];
+
+    if (statuses[0] != statuses[1]) {
+        fprintf(stderr, "The program %s in the interpreter and %s with the translator\n", statusNames[statuses[0]], statusNames[statuses[1]]);
+    } else if (compare_runs(&expected, memory, machine, outputs[0], outputs[1]) == 0) {
+        fprintf(stderr, "The interpreter and the translator agree after %lu instructions\n", machine->steps);
+        result = 0;
+    }
+    rewind(outputs[0]);
+    while ((c = getc(outputs[0])) != EOF) {
+        putchar(c);
+    }
+
+    end:
+    if (input != NULL) fclose(input);
+    if (outputs[0] != NULL) fclose(outputs[0]);
+    if (outputs[1] != NULL) fclose(outputs[1]);
+    if (memory != NULL) free(memory);
+    return result;
+}
+
+/**
+ * The main function of the emulator.
+ * It loads file.ob (a file that was assembled on its own, or the output of the linker) and runs it from address 100.
+ * red reads a character from the standard input and prn writes a character to the standard output.
+ * Options:
+ *   --max-steps=N   stop after N instructions (default 0, no limit)
+ *   --memory-size=N the number of words in the memory of the machine (default 4096, at most 65536)
+ *   --stats         write the number of instructions that ran, and how fast, to stderr
+ *   --profile       write the number of instructions that ran from every label and on every line to stderr
+ *   --jit           translate the program into native code while it runs (only on x86-64, otherwise it is interpreted)
+ *   --jit-check     run the program in the interpreter and with --jit, and check that the outputs and the machines are the same
+ *   --checkpoint=C  when the program stops at --max-steps, write the state of the machine into the checkpoint file C
+ *   --resume=C      continue from the checkpoint file C instead of loading FILE (--max-steps counts from the start of the first run)
+ * Returns 0 if the program halted (and with --jit-check, if the runs are the same), and 1 otherwise.
+*/
+int main(int argc, char **argv) {
+    Machine machine;
+    Jit jit;
+    ObjectFile object;
+    MachineStatus status = MACHINE_FAULT;
+    const char *fileName = NULL, *checkpointName = NULL, *resumeName = NULL;
+    unsigned long maxSteps = 0, firstStep;
+    int i, memorySize = MEMORY_SIZE, stats = 0, profile = 0, mode = RUN_INTERPRETER, result;
+    clock_t start;
+    double seconds;
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0 && fileName == NULL) {
+            fileName = argv[i];
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = 1;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = 1;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            mode = RUN_JIT;
+        } else if (strcmp(argv[i], "--jit-check") == 0) {
+            mode = RUN_JIT_CHECK;
+        } else if (strncmp(argv[i], "--checkpoint=", 13) == 0 && argv[i][13] != '\0') {
+            checkpointName = argv[i] + 13;
+        } else if (strncmp(argv[i], "--resume=", 9) == 0 && argv[i][9] != '\0') {
+            resumeName = argv[i] + 9;
+        } else if (strncmp(argv[i], "--max-steps=", 12) == 0 && is_number(argv[i] + 12) && argv[i][12] != '\0' && argv[i][12] != '-') {
+            maxSteps = strtoul(argv[i] + 12, NULL, 10);
+        } else if (strncmp(argv[i], "--memory-size=", 14) == 0 && is_number(argv[i] + 14) && argv[i][14] != '\0'
+            && get_number(argv[i] + 14) > START_POSITION && get_number(argv[i] + 14) <= MAX_MEMORY_SIZE) {
+            memorySize = get_number(argv[i] + 14);
+        } else {
+            fprintf(stderr, "Unknown option \"%s\", exiting program.\n", argv[i]);
+            return 1;
+        }
+    }
+    if ((fileName == NULL) == (resumeName == NULL)) {
+        fprintf(stderr, "Usage: emulator [--max-steps=N] [--memory-size=N] [--stats] [--profile] [--jit | --jit-check] [--checkpoint=C] FILE\n"
+            "       emulator [--max-steps=N] [--stats] [--jit] [--checkpoint=C] --resume=C\n");
+        return 1;
+    }
+    if (resumeName != NULL && (profile || mode == RUN_JIT_CHECK)) {
+        fprintf(stderr, "--profile and --jit-check need the object file, and can't be used with --resume\n");
+        return 1;
+    }
+
+    if (resumeName != NULL) {
+        /* the checkpoint has the memory of the machine, so the object isn't read. object is left empty for free_object */
+        memset(&object, 0, sizeof(object));
+        if (load_checkpoint(&machine, resumeName) != 0) {
+            return 1;
+        }
+    } else {
+        if (load_object(fileName, &object) != 0) {
+            return 1;
+        }
+        if (create_machine(&machine, memorySize) != 0) {
+            fprintf(stderr, "Failed to allocate memory for the machine\n");
+            free_object(&object);
+            return 1;
+        }
+        if (load_machine(&machine, &object) != 0) {
+            free_machine(&machine);
+            free_object(&object);
+            return 1;
+        }
+    }
+    if (profile) {
+        machine.profile = calloc(memorySize, sizeof(unsigned long));
+        if (machine.profile == NULL) {
+            fprintf(stderr, "Failed to allocate memory for the profile\n");
+            free_machine(&machine);
+            free_object(&object);
+            return 1;
+        }
+    }
+    if (create_jit(&jit, &machine) != 0) {
+        fprintf(stderr, "Failed to allocate memory for the translator\n");
+        if (machine.profile != NULL) free(machine.profile);
+        free_machine(&machine);
+        free_object(&object);
+        return 1;
+    }
+
+    /* the program can read and write a character in every instruction, so the streams are given large buffers */
+    setvbuf(stdin, NULL, _IOFBF, EMULATOR_IO_BUFFER_SIZE);
+    setvbuf(stdout, NULL, _IOFBF, EMULATOR_IO_BUFFER_SIZE);
+    firstStep = machine.steps;
+    start = clock();
+    result = 0;
+    if (mode == RUN_JIT_CHECK) {
+        result = check_jit(&machine, &jit, &object, maxSteps, &status);
+    } else if (mode == RUN_JIT) {
+        status = run_jit(&jit, &machine, maxSteps, stdin, stdout);
+    } else {
+        status = run_machine(&machine, maxSteps, stdin, stdout);
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    fflush(stdout);
+
+    if (status == MACHINE_STEP_LIMIT) {
+        fprintf(stderr, "Stopped at address %04d after %lu instructions\n", machine.pc, machine.steps);
+        if (checkpointName != NULL && save_checkpoint(&machine, checkpointName) == 0) {
+            fprintf(stderr, "The state of the machine was written to %s\n", checkpointName);
+        }
+    }
+    if (stats) {
+        fprintf(stderr, "Ran %lu instructions in %.3f seconds", machine.steps - firstStep, seconds);
+        if (seconds > 0) {
+            fprintf(stderr, " (%.1f million per second)", (machine.steps - firstStep) / seconds / 1e6);
+        }
+        fprintf(stderr, "\n");
+        if (mode != RUN_INTERPRETER) {
+            fprintf(stderr, "Translated %lu blocks (%s)\n", jit.translated, jit.available ? "x86-64" : "not available, interpreted");
+        }
+    }
+    if (profile) {
+        if (print_profile(stderr, &machine, &object) != 0) {
+            fprintf(stderr, "Failed to allocate memory for the profile\n");
+        }
+        free(machine.profile);
+    }
+    free_jit(&jit);
+    free_machine(&machine);
+    free_object(&object);
+    return status == MACHINE_HALTED && result == 0 ? 0 : 1;
+}
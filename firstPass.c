@@ -8,111 +8,114 @@
 #include "secondPass.h"
 #include <stdio.h>
 #include "globals.h"
+#include "diagnostics.h"
+#include "library.h"
+#include "isa.h"
 
 /* the firstPass goes through the parsed lines for the first time and creates the symbol table */
 int firstPass (const char* fileName, translation * translation, ParsedSyntaxLine **lines,int lineCount) {
   int IC = START_POSITION, DC = 0;
   int error = 0; /* a flag to indicate if there's an error */
   int i;
+  for (i = 0; i < lineCount && !error_limit_reached(); i++) {
+    error |= firstPassLine(fileName, translation, lines[i], i, &IC, &DC);
+  }
+  error |= finishFirstPass(fileName, translation, IC, DC);
+  return error;
+}
+
+/* the firstPassLine function handles a single parsed line (the i-th line of the file) in the first pass.
+    it adds the symbols that the line defines to the symbol table, and advances the IC and DC by the size of the line */
+int firstPassLine (const char* fileName, translation * translation, ParsedSyntaxLine * parsedLine, int i, int * IC, int * DC) {
+  int error = 0; /* a flag to indicate if there's an error */
   Symbol_Node * found;
   Symbol_Node * current;
   ParsedSyntaxLine line;
-  int operandNum = 0;
-  for (i = 0; i < lineCount; i++) {
-    line = *(lines[i]);
-    if (*line.error != '\0') {
-      fprintf(stderr, "Error in file \"%s\" on line %d: %s\n", fileName, i + 1, line.error);
-      error = 1;
-      continue;
-    } if (*line.labelName != '\0' && (line.type == ENUM_INSTRUCTION ||
-     (line.type == ENUM_DIRECTIVE && 
-     (line.statement.directive.directiveType == ENUM_DATA || line.statement.directive.directiveType == ENUM_STRING)))) {
-        /* if there's a label that declares of data or string */
-        found = symbol_contains(translation->symbol_table_head, line.labelName);
-        if (found) { /* if the symbol is already in the symbol table */
-          if (found->symbol->type == ENUM_SYMBOL_ENTRY) {
-            /* if the current type of the symbol is entry, 
-            it means that it was already declared, and now it is initialized */
-            found->symbol->type = line.type == ENUM_INSTRUCTION ? ENUM_SYMBOL_ENTRY_CODE : (
-              line.statement.directive.directiveType == ENUM_DATA ? ENUM_SYMBOL_ENTRY_DATA : ENUM_SYMBOL_ENTRY_STRING
-            ) ;
-            found->symbol->address = line.type == ENUM_INSTRUCTION ? IC : DC;
-
-            /* keep track of the length of the of the string/data so that we can identify an out of bounds index */
-            if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_DATA) {
-              found->symbol->dataLength = line.statement.directive.directiveValue.data.count;
-            } else if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_STRING) {
-              found->symbol->dataLength = strlen(line.statement.directive.directiveValue.string) + 1;
-            }
-          }
-          else { 
-            /* the symbol is present in the symbol table and it is not a
-             entry which means that it was already initialized */
-            fprintf(stderr, "Error in file \"%s\" on line %d: Trying to redefine the symbol: \"%s\"\n", fileName, i + 1, found->symbol->name);
-            error = 1;
-          }
-        }
-        else { /* the symbol is not present in the sumbol table, which means that it needs to be added */
-          current = insert_symbol(&translation->symbol_table_head, line.labelName);
-          current->symbol->type = line.type == ENUM_INSTRUCTION ? ENUM_SYMBOL_CODE : 
-          (line.statement.directive.directiveType == ENUM_DATA ? ENUM_SYMBOL_DATA : ENUM_SYMBOL_STRING);
-          current->symbol->address = line.type == ENUM_INSTRUCTION ? IC : DC; 
+  line = *parsedLine;
+  if (line.error != NULL) {
+    report_diagnostic(line.error, fileName, i + 1);
+    return 1;
+  } if (*line.labelName != '\0' && (line.type == ENUM_INSTRUCTION ||
+   (line.type == ENUM_DIRECTIVE && 
+   (line.statement.directive.directiveType == ENUM_DATA || line.statement.directive.directiveType == ENUM_STRING)))) {
+      /* if there's a label that declares of data or string */
+      found = symbol_contains(translation->symbol_table_head, line.labelName);
+      if (found) { /* if the symbol is already in the symbol table */
+        if (found->symbol->type == ENUM_SYMBOL_ENTRY) {
+          /* if the current type of the symbol is entry, 
+          it means that it was already declared, and now it is initialized */
+          found->symbol->type = line.type == ENUM_INSTRUCTION ? ENUM_SYMBOL_ENTRY_CODE : (
+            line.statement.directive.directiveType == ENUM_DATA ? ENUM_SYMBOL_ENTRY_DATA : ENUM_SYMBOL_ENTRY_STRING
+          ) ;
+          found->symbol->address = line.type == ENUM_INSTRUCTION ? *IC : *DC;
 
           /* keep track of the length of the of the string/data so that we can identify an out of bounds index */
           if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_DATA) {
-            current->symbol->dataLength = line.statement.directive.directiveValue.data.count;
-          }
-          else if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_STRING) {
-            current->symbol->dataLength = strlen(line.statement.directive.directiveValue.string) + 1;
+            found->symbol->dataLength = line.statement.directive.directiveValue.data.count;
+          } else if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_STRING) {
+            found->symbol->dataLength = strlen(line.statement.directive.directiveValue.string) + 1;
           }
         }
-    }
-    /* if the line is an instruction we should increase the IC so that the addresses of the symbols are correct */
-    if (line.type == ENUM_INSTRUCTION) {
-      error |= checkNumOfOperands(fileName, i + 1, line.statement.instruction.numOfOperands, line.statement.instruction.opcode);
-      IC++; /* the first word which describes the instruction itself */
-      if (line.statement.instruction.operands[0].operandType == OPERAND_TYPE_REGISTER &&
-      line.statement.instruction.operands[1].operandType == OPERAND_TYPE_REGISTER) {
-        /* if both operands are registers, then only one additional word is needed to store them */
-        IC++;
-      }
-      else {
-        for (operandNum = 0; operandNum < line.statement.instruction.numOfOperands; operandNum++) {
-          if (line.statement.instruction.operands[operandNum].operandType == OPERAND_TYPE_IMMEDIATE) {
-            /* if the operand is a number, then only one additional word is needed to store the number itself */
-            IC++;
-          } else if (line.statement.instruction.operands[operandNum].operandType == OPERAND_TYPE_DIRECT) {
-            /* if the operand is a label, then only one additional word is needed to store the address of the label */
-            IC++;
-          } else if (line.statement.instruction.operands[operandNum].operandType == OPERAND_TYPE_INDEXED) {
-            /* if the operand is a indexed label, then two additional words are 
-            needed to store the adress of the label, and the index itself */
-            IC += 2;
-          } else IC++; /* if the operand is a register, then only one additional word is needed to store the register number */
+        else { 
+          /* the symbol is present in the symbol table and it is not a
+           entry which means that it was already initialized */
+          report(DIAG_SYMBOL_ALREADY_DEFINED, fileName, i + 1, 0, "s", found->symbol->name);
+          error = 1;
         }
       }
-    } else if (line.type == ENUM_CONSTANT_DEFINITION && isNumTooLarge(line.statement.constantDefinition.value, 14)) {
-      /* if the constant can't fit in 14 bits it has no use */
-      printf("Warning in file \"%s\" on line %d: the constant \"%s\" is too %s and not useable\n", fileName, i +1, line.statement.constantDefinition.name, line.statement.constantDefinition.value > 0 ? "large" : "small");
-    } else if (line.type == ENUM_DIRECTIVE && (line.statement.directive.directiveType == ENUM_DATA || line.statement.directive.directiveType == ENUM_STRING)) {
-      /* if the line is a directive, then we should increase the DC so that the addresses of the symbols are correct */
-      if (line.statement.directive.directiveType == ENUM_DATA) {
-        /* the number of words needed to store the data. each word stores one number */
-        DC += line.statement.directive.directiveValue.data.count; 
-      } else {
-        /* the number of words needed to store the string. each word stores one character, 
-          and we need an additional one to store the \0 */
-        DC += strlen(line.statement.directive.directiveValue.string) + 1;
+      else if (library_defines(line.labelName)) { /* a macro or a constant of a library that the file uses */
+          report(DIAG_SYMBOL_ALREADY_DEFINED, fileName, i + 1, 0, "s", line.labelName);
+          error = 1;
+      }
+      else { /* the symbol is not present in the sumbol table, which means that it needs to be added */
+        current = insert_symbol_from(&translation->symbol_table_head, &translation->free_symbols, line.labelName);
+        current->symbol->type = line.type == ENUM_INSTRUCTION ? ENUM_SYMBOL_CODE : 
+        (line.statement.directive.directiveType == ENUM_DATA ? ENUM_SYMBOL_DATA : ENUM_SYMBOL_STRING);
+        current->symbol->address = line.type == ENUM_INSTRUCTION ? *IC : *DC; 
+
+        /* keep track of the length of the of the string/data so that we can identify an out of bounds index */
+        if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_DATA) {
+          current->symbol->dataLength = line.statement.directive.directiveValue.data.count;
+        }
+        else if (line.type == ENUM_DIRECTIVE && line.statement.directive.directiveType == ENUM_STRING) {
+          current->symbol->dataLength = strlen(line.statement.directive.directiveValue.string) + 1;
+        }
       }
-    } else if (line.type == ENUM_DIRECTIVE && (line.statement.directive.directiveType == ENUM_ENTRY || line.statement.directive.directiveType == ENUM_EXTERN)) {
-      /* if the line declares a synbol as entry, or as external */
-      handle_symbol_definition(fileName, i + 1, translation, line, &error);
+  }
+  /* if the line is an instruction we should increase the IC so that the addresses of the symbols are correct */
+  if (line.type == ENUM_INSTRUCTION) {
+    error |= checkNumOfOperands(fileName, i + 1, line.statement.instruction.numOfOperands, line.statement.instruction.opcode);
+    /* the number of words depends only on the addressing modes, and is looked up in the encoding table */
+    *IC += encoding_of(&line.statement.instruction)->words;
+  } else if (line.type == ENUM_CONSTANT_DEFINITION && isNumTooLarge(line.statement.constantDefinition.value, 14)) {
+    /* if the constant can't fit in 14 bits it has no use */
+    report(DIAG_CONSTANT_NOT_USEABLE, fileName, i + 1, 0, "ss", line.statement.constantDefinition.name, line.statement.constantDefinition.value > 0 ? "large" : "small");
+  } else if (line.type == ENUM_DIRECTIVE && (line.statement.directive.directiveType == ENUM_DATA || line.statement.directive.directiveType == ENUM_STRING)) {
+    /* if the line is a directive, then we should increase the DC so that the addresses of the symbols are correct */
+    if (line.statement.directive.directiveType == ENUM_DATA) {
+      /* the number of words needed to store the data. each word stores one number */
+      *DC += line.statement.directive.directiveValue.data.count; 
+    } else {
+      /* the number of words needed to store the string. each word stores one character, 
+        and we need an additional one to store the \0 */
+      *DC += strlen(line.statement.directive.directiveValue.string) + 1;
     }
+  } else if (line.type == ENUM_DIRECTIVE && (line.statement.directive.directiveType == ENUM_ENTRY || line.statement.directive.directiveType == ENUM_EXTERN)) {
+    /* if the line declares a synbol as entry, or as external */
+    handle_symbol_definition(fileName, i + 1, translation, line, &error);
   }
+  return error;
+}
+
+/* the finishFirstPass function runs after all of the lines went through the first pass.
+  it checks that every entry was defined, moves the data symbols after the code, and checks the size of the program */
+int finishFirstPass (const char* fileName, translation * translation, int IC, int DC) {
+  int error = 0; /* a flag to indicate if there's an error */
+  Symbol_Node * current;
   for (current = translation->symbol_table_head; current != NULL; current = current->next) {
     if (current->symbol->type == ENUM_SYMBOL_ENTRY) {
       /* no symbol can remain as entry, it needs to be initialized */
-      fprintf(stderr, "Error in file \"%s\": Symbol \"%s\" was declared as entry but was never defined\n", fileName, current->symbol->name);
+      report(DIAG_ENTRY_NOT_DEFINED, fileName, 0, 0, "s", current->symbol->name);
       error = 1;
     } if (current->symbol->type == ENUM_SYMBOL_ENTRY_DATA || current->symbol->type == ENUM_SYMBOL_DATA 
     || current->symbol->type == ENUM_SYMBOL_STRING || current->symbol->type == ENUM_SYMBOL_ENTRY_STRING) {
@@ -121,9 +124,9 @@ int firstPass (const char* fileName, translation * translation, ParsedSyntaxLine
       current->symbol->address += IC;
     }
   }
-  if (IC + DC > MEMORY_SIZE) {
+  if (IC + DC > translation->memory_size) {
     /* if the final size of the program exceeds the memory size of the computer */
-    printf("Error in file \"%s\": Program is too large\n", fileName);
+    report(DIAG_PROGRAM_TOO_LARGE, fileName, 0, 0, "");
     error = 1;
   }
   return error;
@@ -139,9 +142,9 @@ void handle_symbol_definition(const char* fileName, int lineNumber, translation*
 
       /* if the user is decalring a symbol entry/extenal twice, a warning should be issued */
       if (line.statement.directive.directiveType == ENUM_EXTERN && found->symbol->type == ENUM_SYMBOL_EXTERN) {
-        printf("Warning in file \"%s\" on line %d: Redefining the symbol \"%s\" as extern again\n", fileName, lineNumber, found->symbol->name);
+        report(DIAG_EXTERN_AGAIN, fileName, lineNumber, 0, "s", found->symbol->name);
       } else if (line.statement.directive.directiveType == ENUM_ENTRY && found->symbol->type == ENUM_SYMBOL_ENTRY) {
-        printf("Warning in file \"%s\" on line %d: Redefining the symbol \"%s\" as entry again\n", fileName, lineNumber, found->symbol->name);
+        report(DIAG_ENTRY_AGAIN, fileName, lineNumber, 0, "s", found->symbol->name);
       } 
       
       /* update the type of the symbol so that it is a entry symbol  */
@@ -157,20 +160,20 @@ void handle_symbol_definition(const char* fileName, int lineNumber, translation*
             found->symbol->type = ENUM_SYMBOL_ENTRY_STRING;
             break;
           default: /* if the type of the symbol is external */
-            fprintf(stderr, "Error in file \"%s\" on line %d: Trying to redefine the symbol \"%s\"\n", fileName, lineNumber, found->symbol->name);
+            report(DIAG_SYMBOL_REDEFINED, fileName, lineNumber, 0, "s", found->symbol->name);
             *error = 1;
             break;
         }
       } else { /* if the symbol is currently entry, and the line is declaring it as external */
-        fprintf(stderr, "Error in file \"%s\" on line %d: Trying to redefine the symbol \"%s\"\n", fileName, lineNumber, found->symbol->name);
+        report(DIAG_SYMBOL_REDEFINED, fileName, lineNumber, 0, "s", found->symbol->name);
         *error = 1;
       }
     } else { /* if the symbol isn't present in the symbol table it needs to be added to it */
         if (line.statement.directive.directiveType == ENUM_ENTRY) { /* if the symbol is entry */
-            current = insert_symbol(&translation->symbol_table_head, line.statement.directive.directiveValue.entryLabel);
+            current = insert_symbol_from(&translation->symbol_table_head, &translation->free_symbols, line.statement.directive.directiveValue.entryLabel);
             current->symbol->type = ENUM_SYMBOL_ENTRY;
         } else { /* if the symbol is external */
-            current = insert_symbol(&translation->symbol_table_head, line.statement.directive.directiveValue.externLabel);
+            current = insert_symbol_from(&translation->symbol_table_head, &translation->free_symbols, line.statement.directive.directiveValue.externLabel);
             current->symbol->type = ENUM_SYMBOL_EXTERN;
         }
     }
@@ -180,7 +183,7 @@ void handle_symbol_definition(const char* fileName, int lineNumber, translation*
 int checkNumOfOperands(const char * fileName,int lineNum, int numOfOperands, Opcode instruction) {
   int required = instructionRules[instruction].numberOfOperandsRequired;
   if (numOfOperands != instructionRules[instruction].numberOfOperandsRequired) {
-    fprintf(stderr, "Error in file \"%s\" on line %d: The instruction \"%s\" requires %d %s, but %d %s given\n", fileName, lineNum, instructionRules[instruction].name, required, required > 1 ? "operands" : "operand" , numOfOperands, numOfOperands > 1 ? "were" : "was");
+    report(DIAG_WRONG_OPERAND_COUNT, fileName, lineNum, 0, "sdsds", instructionRules[instruction].name, required, required > 1 ? "operands" : "operand" , numOfOperands, numOfOperands > 1 ? "were" : "was");
     return 1;
   } else return 0;
 }
\ No newline at end of file
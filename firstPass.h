@@ -8,6 +8,14 @@
 /* the firstPass goes through the parsed lines for the first time and creates the symbol table */
 int firstPass (const char* fileName, translation * translation, ParsedSyntaxLine **lines,int lineCount);
 
+/* the firstPassLine function handles a single parsed line (the i-th line of the file) in the first pass.
+    it adds the symbols that the line defines to the symbol table, and advances the IC and DC by the size of the line */
+int firstPassLine (const char* fileName, translation * translation, ParsedSyntaxLine * parsedLine, int i, int * IC, int * DC);
+
+/* the finishFirstPass function runs after all of the lines went through the first pass.
+    it checks that every entry was defined, moves the data symbols after the code, and checks the size of the program */
+int finishFirstPass (const char* fileName, translation * translation, int IC, int DC);
+
 /* the handle_symbol_definition function, handles the decleration of a entry/external symbol */
 void handle_symbol_definition(const char* fileName, int lineNumber, translation* translation, ParsedSyntaxLine line, int* error);
 
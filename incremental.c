@@ -0,0 +1,827 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "incremental.h"
+#include "parser.h"
+#include "firstPass.h"
+#include "secondPass.h"
+#include "writeOutputFiles.h"
+#include "translation.h"
+#include "word_image.h"
+#include "batch_io.h"
+#include "mapped_file.h"
+#include "diagnostics.h"
+#include "constants.h"
+#include "utils.h"
+#include "data_structures/node.h"
+
+/* The kinds of labels that a line can define */
+enum {
+    LABEL_NONE,
+    LABEL_CODE,
+    LABEL_DATA,
+    LABEL_STRING
+};
+
+/* the label_kind function returns the kind of the label that the first pass defines for the line */
+static int label_kind(const ParsedSyntaxLine* line) {
+    if (line->error != NULL || line->labelName[0] == '\0') {
+        return LABEL_NONE;
+    }
+    if (line->type == ENUM_INSTRUCTION) {
+        return LABEL_CODE;
+    }
+    if (line->type == ENUM_DIRECTIVE && line->statement.directive.directiveType == ENUM_DATA) {
+        return LABEL_DATA;
+    }
+    if (line->type == ENUM_DIRECTIVE && line->statement.directive.directiveType == ENUM_STRING) {
+        return LABEL_STRING;
+    }
+    return LABEL_NONE;
+}
+
+/* the declares_symbols function checks if the line defines a constant, or declares an entry or an external.
+    the symbol table changes when such a line changes, so the file is built from the start */
+static boolean declares_symbols(const ParsedSyntaxLine* line) {
+    return line->type == ENUM_CONSTANT_DEFINITION || (line->type == ENUM_DIRECTIVE &&
+        (line->statement.directive.directiveType == ENUM_ENTRY || line->statement.directive.directiveType == ENUM_EXTERN));
+}
+
+/* the data_length function returns the number of words of the data of a .data or .string line */
+static int data_length(const ParsedSyntaxLine* line) {
+    if (line->statement.directive.directiveType == ENUM_DATA) {
+        return line->statement.directive.directiveValue.data.count;
+    }
+    return strlen(line->statement.directive.directiveValue.string) + 1;
+}
+
+/* the measure_line function sets the number of words of the code and the data that the line takes, like the first pass counts them */
+static void measure_line(IncrementalLine* line) {
+    const ParsedSyntaxLine* parsed = line->parsed;
+    line->codeSize = 0;
+    line->dataSize = 0;
+    line->encoded = FALSE;
+    if (parsed->error != NULL) {
+        return;
+    }
+    if (parsed->type == ENUM_INSTRUCTION) {
+        line->codeSize = encoding_of(&parsed->statement.instruction)->words;
+    } else if (parsed->type == ENUM_DIRECTIVE && (parsed->statement.directive.directiveType == ENUM_DATA ||
+        parsed->statement.directive.directiveType == ENUM_STRING)) {
+        line->dataSize = data_length(parsed);
+    }
+}
+
+/* the build_sums function turns the sizes in tree[1..count] into a Fenwick tree, in linear time */
+static void build_sums(int* tree, int count) {
+    int i, parent;
+    tree[0] = 0;
+    for (i = 1; i <= count; i++) {
+        parent = i + (i & -i);
+        if (parent <= count) {
+            tree[parent] += tree[i];
+        }
+    }
+}
+
+/* the add_to_sums function adds delta to the size of a line in a Fenwick tree of count lines */
+static void add_to_sums(int* tree, int count, int line, int delta) {
+    for (line++; line <= count; line += line & -line) {
+        tree[line] += delta;
+    }
+}
+
+/* the sum_before function returns the sum of the sizes of the lines before line */
+static int sum_before(const int* tree, int line) {
+    int sum = 0;
+    for (; line > 0; line -= line & -line) {
+        sum += tree[line];
+    }
+    return sum;
+}
+
+/* the rebuild_sums function builds the Fenwick trees of the sizes of all of the lines again, after lines were added or removed */
+static void rebuild_sums(IncrementalFile* file) {
+    int i;
+    for (i = 0; i < file->lineCount; i++) {
+        file->codeSums[i + 1] = file->lines[i].codeSize;
+        file->dataSums[i + 1] = file->lines[i].dataSize;
+    }
+    build_sums(file->codeSums, file->lineCount);
+    build_sums(file->dataSums, file->lineCount);
+}
+
+/* the reserve_lines function makes room for count lines. returns 0 on success and 1 if the memory could not be allocated */
+static int reserve_lines(IncrementalFile* file, int count) {
+    IncrementalLine* lines;
+    int *codeSums, *dataSums, capacity = file->lineCapacity == 0 ? 256 : file->lineCapacity;
+    if (count <= file->lineCapacity) {
+        return 0;
+    }
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    lines = realloc(file->lines, capacity * sizeof(IncrementalLine));
+    if (lines == NULL) {
+        return 1;
+    }
+    file->lines = lines;
+    codeSums = realloc(file->codeSums, (capacity + 1) * sizeof(int));
+    if (codeSums == NULL) {
+        return 1;
+    }
+    file->codeSums = codeSums;
+    dataSums = realloc(file->dataSums, (capacity + 1) * sizeof(int));
+    if (dataSums == NULL) {
+        return 1;
+    }
+    file->dataSums = dataSums;
+    file->lineCapacity = capacity;
+    return 0;
+}
+
+/* the release_lines function frees the parsed lines of the last build */
+static void release_lines(IncrementalFile* file) {
+    int i;
+    for (i = 0; i < file->lineCount; i++) {
+        free_parsed_syntax_line(file->lines[i].parsed);
+    }
+    file->lineCount = 0;
+}
+
+/* the find_symbol function returns the symbol with the given name, or NULL if there isn't one */
+static Symbol* find_symbol(IncrementalFile* file, const char* name) {
+    Symbol** found = (Symbol**)search(file->symbols, name);
+    return found == NULL ? NULL : *found;
+}
+
+/* the index_symbols function adds every symbol of the symbol table to the symbols hashtable, so the lines find them without
+    going through the list. returns 0 on success and 1 if the memory could not be allocated */
+static int index_symbols(IncrementalFile* file) {
+    Symbol_Node* current;
+    clear_hashtable(file->symbols);
+    for (current = file->output->symbol_table_head; current != NULL; current = current->next) {
+        /* symbol_contains finds the first symbol with a name, so the first one is kept */
+        if (search(file->symbols, current->symbol->name) == NULL &&
+            insert(file->symbols, current->symbol->name, &current->symbol, sizeof(Symbol*)) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* the index_lines function finds the labels and the last constant definition of the lines.
+    returns 0 on success and 1 if the memory could not be allocated or a label isn't in the symbol table */
+static int index_lines(IncrementalFile* file) {
+    IncrementalLabel* labels;
+    int i, count = 0;
+
+    file->lastConstantLine = -1;
+    for (i = 0; i < file->lineCount; i++) {
+        if (label_kind(file->lines[i].parsed) != LABEL_NONE) {
+            count++;
+        }
+        if (file->lines[i].parsed->type == ENUM_CONSTANT_DEFINITION) {
+            file->lastConstantLine = i;
+        }
+    }
+    labels = realloc(file->labels, (count > 0 ? count : 1) * sizeof(IncrementalLabel));
+    if (labels == NULL) {
+        return 1;
+    }
+    file->labels = labels;
+    file->labelCount = 0;
+    for (i = 0; i < file->lineCount; i++) {
+        if (label_kind(file->lines[i].parsed) != LABEL_NONE) {
+            labels[file->labelCount].symbol = find_symbol(file, file->lines[i].parsed->labelName);
+            labels[file->labelCount].line = i;
+            if (labels[file->labelCount++].symbol == NULL) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* the target_length function returns the length of the data of the target of an operand, when the operand is indexed into it */
+static int target_length(const Symbol* target, int mode) {
+    if (mode != MODE_INDEXED || target->type == ENUM_SYMBOL_EXTERN || target->type == ENUM_SYMBOL_CODE ||
+        target->type == ENUM_SYMBOL_ENTRY_CODE || target->type == ENUM_SYMBOL_CONSTANT_MACRO || target->type == ENUM_SYMBOL_ENTRY) {
+        return 0;
+    }
+    return target->dataLength;
+}
+
+/* the operand_label function returns the label that an operand uses, or NULL if it doesn't use one */
+static char* operand_label(const Operand* operand) {
+    switch (operandModes[operand->operandType]) {
+        case MODE_DIRECT:
+            return operand->operandValue.directLabel;
+        case MODE_INDEXED:
+            return operand->operandValue.constantIndex.label;
+        default:
+            return NULL;
+    }
+}
+
+/* the uses_constant function checks if an operand of an instruction uses the name of a constant of constants as a label */
+static boolean uses_constant(const ParsedSyntaxLine* line, hashtable* constants) {
+    const char* label;
+    int j;
+    for (j = 0; j < line->statement.instruction.numOfOperands; j++) {
+        label = operand_label(&line->statement.instruction.operands[j]);
+        if (label != NULL && search(constants, label) != NULL) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* the needs_encoding function checks if an instruction has to be encoded again: if it is new,
+    or if the address or the length of a symbol that it uses changed since it was encoded */
+static boolean needs_encoding(const IncrementalLine* line) {
+    const InstructionStatement* instruction = &line->parsed->statement.instruction;
+    int j;
+    if (!line->encoded) {
+        return TRUE;
+    }
+    for (j = 0; j < instruction->numOfOperands; j++) {
+        if (line->targets[j] != NULL && (line->targets[j]->address != line->targetAddresses[j] ||
+            target_length(line->targets[j], operandModes[instruction->operands[j].operandType]) != line->targetLengths[j])) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* the save_encoding function keeps the words of an instruction that the second pass encoded at address, and the symbols it used */
+static void save_encoding(IncrementalFile* file, IncrementalLine* line, int address) {
+    const InstructionStatement* instruction = &line->parsed->statement.instruction;
+    char* label;
+    int j, k;
+    for (k = 0; k < line->codeSize; k++) {
+        line->words[k] = image_word(&file->output->code_image, address + k);
+    }
+    for (j = 0; j < MAX_OPERANDS; j++) {
+        label = j < instruction->numOfOperands ? operand_label(&instruction->operands[j]) : NULL;
+        line->targets[j] = label == NULL ? NULL : find_symbol(file, label);
+        if (line->targets[j] != NULL) {
+            line->targetAddresses[j] = line->targets[j]->address;
+            line->targetLengths[j] = target_length(line->targets[j], operandModes[instruction->operands[j].operandType]);
+        }
+    }
+    line->encoded = TRUE;
+}
+
+/* the copy_encoding function writes the saved words of the i-th line at address, with the uses of the externals in them,
+    the same way that the second pass writes them. returns 1 if the memory of the externals table could not be allocated */
+static int copy_encoding(translation* output, const IncrementalLine* line, int i, int address, char* amName) {
+    const InstructionStatement* instruction = &line->parsed->statement.instruction;
+    int j, k, offset = 1, allocationError = 0;
+    for (k = 0; k < line->codeSize; k++) {
+        set_image_word(&output->code_image, address + k, line->words[k]);
+    }
+    if (output->code_lines != NULL && address < output->memory_size) {
+        output->code_lines[address] = i + 1;
+    }
+    for (j = 0; j < instruction->numOfOperands; j++) {
+        if (line->targets[j] != NULL && line->targets[j]->type == ENUM_SYMBOL_EXTERN) {
+            output->external_table_head = insert_external_from(output->external_table_head, &output->free_externals,
+                line->targets[j]->name, address + offset, &allocationError);
+            if (allocationError) {
+                report(DIAG_OUT_OF_MEMORY, amName, i + 1, 0, "s", "the externals table");
+                return 1;
+            }
+        }
+        if (!encoding_of(instruction)->packedRegisters) {
+            offset += operandWords[operandModes[instruction->operands[j].operandType]];
+        }
+    }
+    return 0;
+}
+
+/* the encode_lines function builds the images and the externals table of the translation from the lines, like the second pass.
+    an instruction is encoded again only if it is new, or if a symbol that it uses moved or changed its length.
+    the words of the other instructions are copied from the previous build. returns 1 if there was an error */
+static int encode_lines(IncrementalFile* file, char* amName) {
+    translation* output = file->output;
+    IncrementalLine* line;
+    int i, IC = START_POSITION, DC = 0, error = 0;
+
+    clear_word_image(&output->code_image);
+    clear_word_image(&output->data_image);
+    if (output->code_lines != NULL && output->IC > START_POSITION) {
+        memset(output->code_lines + START_POSITION, 0, ((output->IC < output->memory_size ? output->IC : output->memory_size) - START_POSITION) * sizeof(int));
+    }
+    recycle_externals(output->external_table_head, &output->free_externals);
+    output->external_table_head = NULL;
+
+    for (i = 0; i < file->lineCount && !error_limit_reached(); i++) {
+        line = &file->lines[i];
+        if (line->parsed->type == ENUM_INSTRUCTION && line->parsed->error == NULL) {
+            if (needs_encoding(line)) {
+                output->IC = IC;
+                error |= secondPassLine(line->parsed, output, i, amName);
+                save_encoding(file, line, IC);
+            } else {
+                error |= copy_encoding(output, line, i, IC, amName);
+            }
+            IC += line->codeSize;
+        } else {
+            /* the data doesn't depend on the symbols, so it is always written again */
+            output->DC = DC;
+            error |= secondPassLine(line->parsed, output, i, amName);
+            DC += line->dataSize;
+        }
+    }
+    output->IC = IC;
+    output->DC = DC;
+    return error;
+}
+
+/* the keep_source function keeps a copy of the source of the build, to compare the next version of the file with.
+    returns 0 on success and 1 if the memory could not be allocated */
+static int keep_source(IncrementalFile* file, const MappedFile* source) {
+    char* copy = realloc(file->source, source->size > 0 ? source->size : 1);
+    if (copy == NULL) {
+        return 1;
+    }
+    memcpy(copy, source->data, source->size);
+    file->source = copy;
+    file->sourceSize = source->size;
+    return 0;
+}
+
+/* the full_build function assembles the file from the start, like assemble_file, and keeps its lines for the next build.
+    source is NULL if the .as file could not be opened. when writeFiles is FALSE nothing is printed or written */
+static void full_build(IncrementalFile* file, const char* filename, const MappedFile* source, const AssemblerOptions* options,
+    char* asName, char* amName, boolean writeFiles) {
+    translation* output = file->output;
+    ParsedSyntaxLine** parsed = NULL;
+    MappedFile amFile;
+    int i, lineCount = 0, error = 0, allocationError = 0;
+
+    release_lines(file);
+    file->valid = FALSE;
+    file->map.count = 0;
+    file->map.failed = FALSE;
+    file->am.size = 0;
+    file->am.failed = FALSE;
+    reset_translation(output);
+
+    if (writeFiles) {
+        printf("Processing file \"%s\"\n", asName);
+        printf("Creating .am file for file \"%s\"\n", asName);
+    }
+    if (source == NULL) {
+        fprintf(stderr, "File %s could not be opened.\n", asName);
+        if (writeFiles) remove_output_file(amName);
+        error = 1;
+        goto end;
+    }
+    if (preprocess_source(source, &output->symbol_table_head, &output->free_symbols, asName, &file->am, &file->map) == PREPROCESS_FAIL || file->am.failed) {
+        if (writeFiles) remove_output_file(amName);
+        error = 1;
+        goto end;
+    }
+    get_file_libraries(&file->libraries);
+
+    if (writeFiles) {
+        printf("Parsing file \"%s\"\n", amName);
+    }
+    amFile.data = file->am.data;
+    amFile.size = file->am.size;
+    amFile.isMapped = FALSE;
+    parsed = parse_source(&amFile, &lineCount, &output->symbol_table_head, &output->free_symbols, output->constants_table, &allocationError);
+    if (writeFiles) {
+        write_output_file(amName, &file->am);
+    }
+    if (parsed == NULL || allocationError || reserve_lines(file, lineCount) != 0) {
+        error = 1;
+        goto end;
+    }
+    for (i = 0; i < lineCount; i++) {
+        file->lines[i].parsed = parsed[i];
+        measure_line(&file->lines[i]);
+    }
+    file->lineCount = lineCount;
+    free(parsed);
+    parsed = NULL;
+
+    for (i = 0; i < file->lineCount && !error_limit_reached(); i++) {
+        error |= firstPassLine(amName, output, file->lines[i].parsed, i, &output->IC, &output->DC);
+    }
+    error |= finishFirstPass(amName, output, output->IC, output->DC);
+    /* the encoding starts again from address START_POSITION, the addresses of the first pass were only needed for the symbols */
+    output->IC = START_POSITION;
+    output->DC = 0;
+
+    /* we go into the second pass even if there's an error, so that we can find additional errors,
+        unless the file already has too many errors or --fail-fast was given */
+    if (index_symbols(file) != 0) {
+        error = 1;
+        goto end;
+    }
+    if (!error_limit_reached() && !(error && options->failFast)) {
+        error |= encode_lines(file, amName);
+    }
+    if (output->code_image.failed || output->data_image.failed) {
+        fprintf(stderr, "Failed to allocate memory for the memory image\n");
+        error = 1;
+        goto end;
+    }
+
+    flush_diagnostics();
+    if (error == 0 && writeFiles) {
+        write_output_files(filename, output);
+    }
+    rebuild_sums(file);
+    file->valid = error == 0 && diagnostic_count() == 0 && !file->map.failed && index_lines(file) == 0 && keep_source(file, source) == 0;
+
+    end:
+    flush_diagnostics();
+    if (writeFiles) {
+        printf("Finished assembling file \"%s\" with %s\n\n", filename, error ? "errors" : "success");
+    }
+    if (parsed != NULL) {
+        /* the lines could not be kept */
+        for (i = 0; i < lineCount; i++) {
+            if (parsed[i] != NULL) free_parsed_syntax_line(parsed[i]);
+        }
+        free(parsed);
+    }
+}
+
+/* the at_line_start function checks if position is at the start of a line of text */
+static boolean at_line_start(const char* text, size_t position) {
+    return position == 0 || text[position - 1] == '\n';
+}
+
+/* the count_lines function returns the number of lines in size characters of text, the last line may not end with a newline */
+static int count_lines(const char* text, size_t size) {
+    const char *end = text + size, *newline;
+    int count = 0;
+    while (text < end && (newline = memchr(text, '\n', end - text)) != NULL) {
+        count++;
+        text = newline + 1;
+    }
+    return count + (text < end);
+}
+
+/* the line_offset function returns the offset of the given line of the text */
+static size_t line_offset(const char* text, size_t size, int line) {
+    const char* newline;
+    size_t offset = 0;
+    for (; line > 0 && offset < size && (newline = memchr(text + offset, '\n', size - offset)) != NULL; line--) {
+        offset = newline - text + 1;
+    }
+    return line > 0 ? size : offset;
+}
+
+/* the preprocess_line function writes a line of the source that isn't a part of a macro to the am file, like preprocess_source,
+    and returns the number of lines that were written (0 for a blank line).
+    returns -1 if the line can't be preprocessed on its own: if it is too long (a warning), imports a library, is a directive of conditional assembly, or starts or calls a macro */
+static int preprocess_line(IncrementalFile* file, const LineView* line, OutputBuffer* output) {
+    node* tokens;
+    Symbol* found;
+    const char* libraryCode;
+    size_t libraryCodeLength;
+    int allocationError = 0, result = 1;
+
+    if (line->length > MAX_LINE_LENGTH) {
+        return -1;
+    }
+    tokens = tokenize_span(line->start, line->length, &allocationError);
+    if (allocationError) {
+        return -1;
+    }
+    if (tokens == NULL) {
+        return 0;
+    }
+    found = find_symbol(file, tokens->token);
+    if (strcmp(tokens->token, MACRO_START) == 0 || strcmp(tokens->token, MACRO_END) == 0 || strcmp(tokens->token, IMPORT_DIRECTIVE) == 0 || is_condition_directive(tokens->token) ||
+        (found != NULL && found->type == ENUM_SYMBOL_CONSTANT_MACRO) || library_macro(tokens->token, &libraryCode, &libraryCodeLength) >= 0) {
+        result = -1;
+    } else {
+        output_write(output, line->start, line->length);
+        if (line->hasNewline) {
+            output_write(output, "\n", 1);
+        }
+    }
+    free_nodes(tokens);
+    return result;
+}
+
+/* the splice function replaces removed items of an array, from index start, with addedCount items.
+    the array has count items of the given size, and has room for the added items. when added is NULL the new items are left to be filled */
+static void splice(void* array, size_t size, int count, int start, int removed, const void* added, int addedCount) {
+    char* items = array;
+    memmove(items + (start + addedCount) * size, items + (start + removed) * size, (count - start - removed) * size);
+    if (added != NULL) {
+        memcpy(items + start * size, added, addedCount * size);
+    }
+}
+
+/* the update_lines function builds the file again from the last build, when only some of its lines changed.
+    the lines of the source that changed are found by comparing it with the last source, they are preprocessed and parsed again,
+    the addresses of the labels are moved with the Fenwick trees of the sizes of the lines, and the instructions are encoded with encode_lines.
+    the number of lines of the am file that were parsed is set in parsedLines.
+    returns 0 on success, and 1 if the file has to be built from the start (the state of the file may have changed then) */
+static int update_lines(IncrementalFile* file, const MappedFile* source, char* amName, int* parsedLines) {
+    const char *old = file->source, *new = source->data;
+    size_t oldSize = file->sourceSize, newSize = source->size, prefix, suffix, limit, offset, amStart, amEnd;
+    int firstLine, oldLines, newLines = 0, amFirst = 0, amRemoved = 0, amAdded = 0, delta;
+    int i, j, k, written, codeTotal, dataTotal, labelStart, labelEnd, result = 1;
+    int *newMap = NULL, *grownMap;
+    ParsedSyntaxLine** added = NULL;
+    IncrementalLine* line;
+    hashtable* constants = file->output->constants_table;
+    OutputBuffer addedText, am;
+    MappedFile changed;
+    LineView view;
+
+    init_output_buffer(&addedText, NULL);
+    init_output_buffer(&am, NULL);
+
+    /* the changed lines are between the longest common prefix and suffix of whole lines */
+    limit = oldSize < newSize ? oldSize : newSize;
+    for (prefix = 0; prefix < limit && old[prefix] == new[prefix]; prefix++);
+    while (!at_line_start(old, prefix)) {
+        prefix--;
+    }
+    limit -= prefix;
+    for (suffix = 0; suffix < limit && old[oldSize - 1 - suffix] == new[newSize - 1 - suffix]; suffix++);
+    while (suffix > 0 && !(at_line_start(old, oldSize - suffix) && at_line_start(new, newSize - suffix))) {
+        suffix--;
+    }
+    firstLine = count_lines(old, prefix);
+    oldLines = file->map.count - firstLine - count_lines(old + oldSize - suffix, suffix);
+
+    /* a line of a macro definition changes the code of the macro, and the lines that call it */
+    for (i = firstLine - 1; i <= firstLine + oldLines; i++) {
+        if (i >= 0 && i < file->map.count && file->map.lines[i] == MACRO_DEFINITION_LINE) {
+            goto end;
+        }
+    }
+    for (i = 0; i < firstLine + oldLines; i++) {
+        if (file->map.lines[i] == MACRO_DEFINITION_LINE) {
+            continue;
+        } else if (i < firstLine) {
+            amFirst += file->map.lines[i];
+        } else {
+            amRemoved += file->map.lines[i];
+        }
+    }
+    if (amFirst <= file->lastConstantLine) {
+        /* the constants table has the constants of the whole file, but a line can only use the ones that are defined above it.
+            the changed lines are parsed with those, like they are when the file is parsed from the start,
+            so a line that uses a constant that is defined below it fails to parse and the file is built from the start */
+        clear_hashtable(file->earlyConstants);
+        for (i = 0; i < amFirst; i++) {
+            if (file->lines[i].parsed->type == ENUM_CONSTANT_DEFINITION &&
+                insert(file->earlyConstants, file->lines[i].parsed->statement.constantDefinition.name,
+                    &file->lines[i].parsed->statement.constantDefinition.value, sizeof(int)) != 0) {
+                goto end;
+            }
+        }
+        constants = file->earlyConstants;
+    }
+
+    /* preprocess the lines of the new source that changed */
+    changed.data = new + prefix;
+    changed.size = newSize - suffix - prefix;
+    changed.isMapped = FALSE;
+    newMap = malloc((count_lines(changed.data, changed.size) + 1) * sizeof(int));
+    if (newMap == NULL) {
+        goto end;
+    }
+    for (offset = 0; next_line(&changed, &offset, &view); newLines++) {
+        written = preprocess_line(file, &view, &addedText);
+        if (written < 0) {
+            goto end;
+        }
+        newMap[newLines] = written;
+        amAdded += written;
+    }
+
+    /* parse the new lines of the am file. they can't change the symbols, other than the lengths of the labels that they define */
+    added = calloc(amAdded > 0 ? amAdded : 1, sizeof(ParsedSyntaxLine*));
+    if (added == NULL || addedText.failed) {
+        goto end;
+    }
+    changed.data = addedText.data;
+    changed.size = addedText.size;
+    for (offset = 0, i = 0; next_line(&changed, &offset, &view); i++) {
+        added[i] = parse_line(view.start, view.length, constants, &file->output->symbol_table_head, &file->output->free_symbols);
+        if (added[i] == NULL || added[i]->error != NULL || declares_symbols(added[i])) {
+            goto end;
+        }
+        if (added[i]->type == ENUM_INSTRUCTION) {
+            if (constants != file->output->constants_table && uses_constant(added[i], file->output->constants_table)) {
+                /* a constant that is defined below the line is used as a label, the way a new build would read it is left to it */
+                goto end;
+            }
+            checkNumOfOperands(amName, amFirst + i + 1, added[i]->statement.instruction.numOfOperands, added[i]->statement.instruction.opcode);
+        }
+    }
+    for (labelStart = 0; labelStart < file->labelCount && file->labels[labelStart].line < amFirst; labelStart++);
+    for (labelEnd = labelStart; labelEnd < file->labelCount && file->labels[labelEnd].line < amFirst + amRemoved; labelEnd++);
+    for (i = amFirst; i < amFirst + amRemoved; i++) {
+        if (declares_symbols(file->lines[i].parsed)) {
+            goto end;
+        }
+    }
+    for (i = 0, j = labelStart; i < amAdded; i++) {
+        if (label_kind(added[i]) == LABEL_NONE) {
+            continue;
+        }
+        /* the labels must be the same ones, in the same order and of the same kinds */
+        if (j == labelEnd || strcmp(added[i]->labelName, file->labels[j].symbol->name) != 0 ||
+            label_kind(added[i]) != label_kind(file->lines[file->labels[j].line].parsed)) {
+            goto end;
+        }
+        j++;
+    }
+    if (j != labelEnd || diagnostic_count() > 0 || reserve_lines(file, file->lineCount - amRemoved + amAdded) != 0) {
+        goto end;
+    }
+
+    /* replace the lines. from here on the state of the file is changed, and a failure builds the file from the start */
+    for (i = amFirst; i < amFirst + amRemoved; i++) {
+        free_parsed_syntax_line(file->lines[i].parsed);
+    }
+    delta = amAdded - amRemoved;
+    splice(file->lines, sizeof(IncrementalLine), file->lineCount, amFirst, amRemoved, NULL, amAdded);
+    for (i = 0; i < amAdded; i++) {
+        line = &file->lines[amFirst + i];
+        line->parsed = added[i];
+        added[i] = NULL;
+        measure_line(line);
+    }
+    if (delta == 0) {
+        for (i = amFirst; i < amFirst + amAdded; i++) {
+            add_to_sums(file->codeSums, file->lineCount, i, file->lines[i].codeSize - (sum_before(file->codeSums, i + 1) - sum_before(file->codeSums, i)));
+            add_to_sums(file->dataSums, file->lineCount, i, file->lines[i].dataSize - (sum_before(file->dataSums, i + 1) - sum_before(file->dataSums, i)));
+        }
+    } else {
+        file->lineCount += delta;
+        rebuild_sums(file);
+    }
+
+    /* the labels of the changed lines are defined on the new lines, and may have new lengths */
+    for (i = amFirst, j = labelStart; j < labelEnd; i++) {
+        if (label_kind(file->lines[i].parsed) != LABEL_NONE) {
+            file->labels[j].line = i;
+            if (label_kind(file->lines[i].parsed) != LABEL_CODE) {
+                file->labels[j].symbol->dataLength = data_length(file->lines[i].parsed);
+            }
+            j++;
+        }
+    }
+    for (j = labelEnd; j < file->labelCount; j++) {
+        file->labels[j].line += delta;
+    }
+    codeTotal = sum_before(file->codeSums, file->lineCount);
+    dataTotal = sum_before(file->dataSums, file->lineCount);
+    if (START_POSITION + codeTotal + dataTotal > file->output->memory_size) {
+        goto end;
+    }
+    for (j = 0; j < file->labelCount; j++) {
+        k = file->labels[j].line;
+        if (label_kind(file->lines[k].parsed) == LABEL_CODE) {
+            file->labels[j].symbol->address = START_POSITION + sum_before(file->codeSums, k);
+        } else {
+            file->labels[j].symbol->address = START_POSITION + codeTotal + sum_before(file->dataSums, k);
+        }
+    }
+
+    /* the map of the source and the am file are spliced like the lines */
+    if (file->map.count - oldLines + newLines > file->map.capacity) {
+        grownMap = realloc(file->map.lines, (file->map.count - oldLines + newLines) * sizeof(int));
+        if (grownMap == NULL) {
+            goto end;
+        }
+        file->map.lines = grownMap;
+        file->map.capacity = file->map.count - oldLines + newLines;
+    }
+    splice(file->map.lines, sizeof(int), file->map.count, firstLine, oldLines, newMap, newLines);
+    file->map.count += newLines - oldLines;
+    amStart = line_offset(file->am.data, file->am.size, amFirst);
+    amEnd = amStart + line_offset(file->am.data + amStart, file->am.size - amStart, amRemoved);
+    output_write(&am, file->am.data, amStart);
+    output_write(&am, addedText.data, addedText.size);
+    output_write(&am, file->am.data + amEnd, file->am.size - amEnd);
+    if (am.failed || keep_source(file, source) != 0) {
+        goto end;
+    }
+    free_output_buffer(&file->am);
+    file->am = am;
+    init_output_buffer(&am, NULL);
+
+    if (encode_lines(file, amName) != 0 || diagnostic_count() > 0 || file->output->code_image.failed || file->output->data_image.failed) {
+        goto end;
+    }
+    *parsedLines = amAdded;
+    result = 0;
+
+    end:
+    if (added != NULL) {
+        for (i = 0; i < amAdded; i++) {
+            if (added[i] != NULL) free_parsed_syntax_line(added[i]);
+        }
+        free(added);
+    }
+    if (newMap != NULL) free(newMap);
+    free_output_buffer(&addedText);
+    free_output_buffer(&am);
+    return result;
+}
+
+/* the init_incremental_file function readies an empty state, for a machine with memorySize words of memory.
+    when map is TRUE the line of every instruction is kept for the .map file. returns 0 on success and 1 if the memory could not be allocated */
+int init_incremental_file(IncrementalFile* file, int memorySize, boolean map) {
+    memset(file, 0, sizeof(IncrementalFile));
+    file->lastConstantLine = -1;
+    init_output_buffer(&file->am, NULL);
+    file->output = create_translation(memorySize);
+    file->symbols = create_hashtable();
+    file->earlyConstants = create_hashtable();
+    if (file->output == NULL || file->symbols == NULL || file->earlyConstants == NULL || (map && enable_line_map(file->output) != 0)) {
+        free_incremental_file(file);
+        return 1;
+    }
+    return 0;
+}
+
+/* the build function assembles the file from source (NULL if it could not be read), from the lines of the last build when it can.
+    when writeFiles is FALSE nothing is printed or written, and the diagnostics are left in the diagnostics of the file */
+static void build(IncrementalFile* file, const char* filename, const MappedFile* source, const AssemblerOptions* options, boolean writeFiles) {
+    char *amName = concatenate_strings(filename, ".am"), *asName = concatenate_strings(filename, ".as");
+    int parsedLines;
+
+    begin_file_diagnostics(filename, options->maxErrors);
+    if (amName == NULL || asName == NULL) {
+        fprintf(stderr, "Failed to allocate memory for am file name\n");
+        goto end;
+    }
+    if (file->valid) {
+        /* the lines are parsed with the libraries that the file imported, another file may have been built since */
+        set_file_libraries(&file->libraries);
+    }
+    if (source != NULL && file->valid && update_lines(file, source, amName, &parsedLines) == 0) {
+        if (writeFiles) {
+            printf("Processing file \"%s\"\n", asName);
+            printf("Parsing %d changed line%s of file \"%s\"\n", parsedLines, parsedLines == 1 ? "" : "s", amName);
+            write_output_file(amName, &file->am);
+            flush_diagnostics();
+            write_output_files(filename, file->output);
+            printf("Finished assembling file \"%s\" with success\n\n", filename);
+        }
+    } else {
+        /* the diagnostics of the lines that were parsed again are found again by the full build */
+        discard_diagnostics();
+        full_build(file, filename, source, options, asName, amName, writeFiles);
+    }
+
+    end:
+    if (writeFiles) {
+        flush_diagnostics();
+    }
+    if (amName != NULL) free(amName);
+    if (asName != NULL) free(asName);
+}
+
+/* the assemble_incremental function assembles the file like assemble_file, and writes the same output files.
+    when the previous build of the file had no diagnostics and the source changed in lines that don't define
+    macros, constants, entries, externals or new labels, only those lines are parsed again. otherwise the file is built from the start */
+void assemble_incremental(IncrementalFile* file, const char* filename, const AssemblerOptions* options) {
+    char* asName = concatenate_strings(filename, ".as");
+    MappedFile source;
+    boolean sourceMapped = asName != NULL && map_file(asName, &source) == 0;
+
+    build(file, filename, sourceMapped ? &source : NULL, options, TRUE);
+    if (sourceMapped) unmap_file(&source);
+    if (asName != NULL) free(asName);
+}
+
+/* the analyze_incremental function assembles source, the text of the .as file, like assemble_incremental, without printing or writing anything.
+    the diagnostics are left for the caller, to collect them with collect_diagnostics */
+void analyze_incremental(IncrementalFile* file, const char* filename, const MappedFile* source, const AssemblerOptions* options) {
+    build(file, filename, source, options, FALSE);
+}
+
+/* the free_incremental_file function frees the state of the file */
+void free_incremental_file(IncrementalFile* file) {
+    release_lines(file);
+    if (file->lines != NULL) free(file->lines);
+    if (file->codeSums != NULL) free(file->codeSums);
+    if (file->dataSums != NULL) free(file->dataSums);
+    if (file->labels != NULL) free(file->labels);
+    if (file->map.lines != NULL) free(file->map.lines);
+    if (file->source != NULL) free(file->source);
+    if (file->symbols != NULL) free_hashtable(file->symbols);
+    if (file->earlyConstants != NULL) free_hashtable(file->earlyConstants);
+    free_output_buffer(&file->am);
+    free_translation(file->output);
+    memset(file, 0, sizeof(IncrementalFile));
+}
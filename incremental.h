@@ -0,0 +1,69 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "structs.h"
+#include "isa.h"
+#include "output_buffer.h"
+#include "mapped_file.h"
+#include "preprocessor.h"
+#include "library.h"
+#include "data_structures/hashtable.h"
+
+/* A line of the am file, with what is kept about it between the builds of the file */
+typedef struct {
+    ParsedSyntaxLine* parsed;
+    int codeSize; /* the number of words of the code that the line takes */
+    int dataSize; /* the number of words of the data that the line takes */
+    boolean encoded; /* words and targets are the encoding of the line in the last build */
+    unsigned short words[MAX_INSTRUCTION_WORDS];
+    Symbol* targets[MAX_OPERANDS]; /* the symbols that the operands use, or NULL */
+    int targetAddresses[MAX_OPERANDS]; /* the address of every target when the line was encoded */
+    int targetLengths[MAX_OPERANDS]; /* the length of the data of every target when the line was encoded */
+} IncrementalLine;
+
+/* A label of the code or the data, and the line of the am file that defines it */
+typedef struct {
+    Symbol* symbol;
+    int line;
+} IncrementalLabel;
+
+/* The state that is kept between the builds of a file, so that after a small edit only the lines that changed
+ are preprocessed and parsed again, and only the instructions whose operands moved are encoded again */
+typedef struct {
+    translation* output; /* the translation of the file, its symbol table is kept between the builds */
+    boolean valid; /* the last build had no diagnostics, so the next build can start from it */
+    char* source; /* the .as file of the last build */
+    size_t sourceSize;
+    PreprocessMap map; /* the number of am lines that every line of the source was written to */
+    OutputBuffer am; /* the am file of the last build */
+    IncrementalLine* lines;
+    int lineCount;
+    int lineCapacity;
+    int* codeSums; /* Fenwick trees of the code and data sizes of the lines, for the addresses of the labels */
+    int* dataSums;
+    IncrementalLabel* labels; /* sorted by their lines */
+    int labelCount;
+    hashtable* symbols; /* the Symbol* of every name of the symbol table */
+    int lastConstantLine; /* the last line of the am file that defines a constant, or -1 */
+    hashtable* earlyConstants; /* the constants that are defined before the first changed line, when it is above lastConstantLine */
+    LibrarySet libraries; /* the libraries that the file used in the last build */
+} IncrementalFile;
+
+/* the init_incremental_file function readies an empty state, for a machine with memorySize words of memory.
+    when map is TRUE the line of every instruction is kept for the .map file. returns 0 on success and 1 if the memory could not be allocated */
+int init_incremental_file(IncrementalFile* file, int memorySize, boolean map);
+
+/* the assemble_incremental function assembles the file like assemble_file, and writes the same output files.
+    when the previous build of the file had no diagnostics and the source changed in lines that don't define
+    macros, constants, entries, externals or new labels, and don't use a constant that is defined after them,
+    only those lines are parsed again. otherwise the file is built from the start */
+void assemble_incremental(IncrementalFile* file, const char* filename, const AssemblerOptions* options);
+
+/* the analyze_incremental function assembles source, the text of the .as file, like assemble_incremental, without printing or writing anything.
+    the diagnostics are left for the caller, to collect them with collect_diagnostics */
+void analyze_incremental(IncrementalFile* file, const char* filename, const MappedFile* source, const AssemblerOptions* options);
+
+/* the free_incremental_file function frees the state of the file */
+void free_incremental_file(IncrementalFile* file);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef ISA_H
+#define ISA_H
+
+#include "structs.h"
+
+/* The layout of the words of the machine. every word is 14 bits, and the two lowest bits of an operand word are the A,R,E bits */
+#define OPCODE_SHIFT 6 /* the opcode is in bits 6-9 of the first word */
+#define SOURCE_MODE_SHIFT 4 /* the addressing mode of the source operand is in bits 4-5 of the first word */
+#define DESTINATION_MODE_SHIFT 2 /* the addressing mode of the destination operand is in bits 2-3 of the first word */
+#define OPERAND_VALUE_SHIFT 2 /* a number, an address or an index is in bits 2-13 of an operand word */
+#define OPERAND_VALUE_MASK 0xFFF /* the 12 bits of a number, an address or an index, before it is shifted */
+#define SOURCE_REGISTER_SHIFT 5 /* the number of a source register is in bits 5-7 of an operand word */
+#define DESTINATION_REGISTER_SHIFT 2 /* the number of a destination register is in bits 2-4 of an operand word */
+#define ARE_ABSOLUTE 0
+#define ARE_EXTERNAL 1
+#define ARE_RELOCATABLE 2
+
+/* The addressing modes, as they are written in the first word */
+#define MODE_IMMEDIATE 0
+#define MODE_DIRECT 1
+#define MODE_INDEXED 2
+#define MODE_REGISTER 3
+#define MODE_NONE 4 /* the instruction has no operand in this position */
+#define MODE_COUNT 5
+
+#define OPCODE_COUNT 16
+#define OPERAND_TYPE_COUNT 9 /* the OperandType flags are all smaller than this */
+#define MAX_INSTRUCTION_WORDS 5 /* the first word, and two indexed operands of two words each */
+
+/* An entry of the encoding table, that describes an instruction with a given opcode and addressing modes */
+typedef struct {
+    unsigned char words; /* the number of words the instruction takes */
+    unsigned char legal; /* whether the instruction allows these addressing modes */
+    unsigned char packedRegisters; /* whether both operands are registers that share a single word */
+    unsigned short firstWord; /* the first word of the instruction */
+} EncodingEntry;
+
+/* The tables below are generated by tools/isa_gen.c from the instructionRules and the layout above, into isa_tables.c */
+
+/* The encoding of every instruction, indexed by [opcode][source mode][destination mode] */
+extern const EncodingEntry encodingTable[OPCODE_COUNT][MODE_COUNT][MODE_COUNT];
+
+/* The number of additional words an operand takes in each addressing mode */
+extern const unsigned char operandWords[MODE_COUNT];
+
+/* The addressing mode of every OperandType flag, or MODE_NONE if it isn't a flag */
+extern const unsigned char operandModes[OPERAND_TYPE_COUNT];
+
+/* The shift of a register number in an operand word, indexed by [the number of operands][the index of the operand] */
+extern const unsigned char registerShifts[MAX_OPERANDS + 1][MAX_OPERANDS];
+
+/* the encoding_of function returns the encoding table entry of an instruction statement */
+#define encoding_of(instruction) (&encodingTable[(instruction)->opcode] \
+    [(instruction)->numOfOperands == 2 ? operandModes[(instruction)->operands[0].operandType] : MODE_NONE] \
+    [(instruction)->numOfOperands == 0 ? MODE_NONE : operandModes[(instruction)->operands[(instruction)->numOfOperands - 1].operandType]])
+
+#endif
@@ -0,0 +1,508 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include "jit.h"
+#include "constants.h"
+#include "globals.h"
+#include "isa.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#define HAS_JIT 1
+#endif
+
+#define JIT_BUFFER_SIZE (4 * 1024 * 1024)
+#define JIT_MAX_BLOCK_LENGTH 64 /* the most instructions in one block */
+#define JIT_MAX_INSTRUCTION_BYTES 96 /* more than the native code of any instruction */
+#define JIT_MAX_BLOCK_BYTES (JIT_MAX_BLOCK_LENGTH * JIT_MAX_INSTRUCTION_BYTES + 256)
+#define JIT_INTERPRET 0x100000 /* added to the address that a block returns, when the instruction there must run in the interpreter */
+
+/* The kinds of a block */
+enum {
+    JIT_BLOCK_NONE, /* not translated yet */
+    JIT_BLOCK_NATIVE, /* translated */
+    JIT_BLOCK_INTERPRET /* the first instruction can't be translated, so it runs in the interpreter */
+};
+
+/* What the native code of a block gets. The fields are read and written by the native code, at their offsets */
+typedef struct {
+    Machine* machine;
+    unsigned long steps;
+    unsigned long limit; /* the block stops looping before steps goes over the limit */
+    FILE* input;
+    FILE* output;
+} JitContext;
+
+/* The native code of a block. It returns the address of the next instruction */
+typedef int (*JitCode)(JitContext* context);
+
+/* the create_jit function readies a translator for the programs of the machine.
+    returns 0 on success and 1 if the memory could not be allocated */
+int create_jit(Jit* jit, const Machine* machine) {
+    memset(jit, 0, sizeof(Jit));
+    jit->blockCount = machine->memorySize;
+    jit->blocks = calloc(jit->blockCount, sizeof(JitBlock));
+    if (jit->blocks == NULL) {
+        return 1;
+    }
+#ifdef HAS_JIT
+    jit->buffer = mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (jit->buffer != MAP_FAILED) {
+        jit->size = JIT_BUFFER_SIZE;
+        jit->available = TRUE;
+    } else {
+        jit->buffer = NULL;
+    }
+#endif
+    return 0;
+}
+
+/* the flush_jit function drops all of the translated blocks. it is called after a new program is loaded into the machine */
+void flush_jit(Jit* jit) {
+    memset(jit->blocks, 0, jit->blockCount * sizeof(JitBlock));
+    jit->used = 0;
+    jit->flushes++;
+}
+
+/* the free_jit function frees the memory of a translator */
+void free_jit(Jit* jit) {
+#ifdef HAS_JIT
+    if (jit->buffer != NULL) munmap(jit->buffer, jit->size);
+#endif
+    if (jit->blocks != NULL) free(jit->blocks);
+    jit->buffer = NULL;
+    jit->blocks = NULL;
+    jit->available = FALSE;
+}
+
+#ifdef HAS_JIT
+
+/* The x86-64 registers that the native code uses. rbx has the machine, r12 the memory, r13 the context, r14 the steps and r15 the limit */
+enum {
+    RAX = 0, RCX = 1, RBX = 3, RSI = 6, RDI = 7, R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+#define REGISTER_OFFSET(number) ((long)offsetof(Machine, registers) + 4 * (number))
+
+/* the jit_red function is called by the native code of red */
+static int jit_red(FILE* input) {
+    int value = getc(input);
+    return value == EOF ? WORD_MASK : value;
+}
+
+/* the jit_prn function is called by the native code of prn */
+static void jit_prn(int value, FILE* output) {
+    putc(value & 0xFF, output);
+}
+
+/* the emit function adds a byte to the native code */
+static void emit(Jit* jit, int byte) {
+    jit->buffer[jit->used++] = (unsigned char)byte;
+}
+
+/* the emit32 function adds a 32-bit number to the native code */
+static void emit32(Jit* jit, long value) {
+    unsigned long bits = (unsigned long)value;
+    int i;
+    for (i = 0; i < 4; i++) {
+        emit(jit, (int)((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+/* the emit64 function adds a 64-bit number to the native code */
+static void emit64(Jit* jit, unsigned long value) {
+    int i;
+    for (i = 0; i < 8; i++) {
+        emit(jit, (int)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/* the emit_memory function adds an instruction whose operand is the memory at [base + index * scale + displacement].
+    prefix is 0 or an operand size prefix, wide makes it a 64-bit instruction, secondOpcode is -1 for an opcode of one byte,
+    and reg is the register of the instruction (or the digit of its opcode) */
+static void emit_memory(Jit* jit, int prefix, boolean wide, int opcode, int secondOpcode, int reg, int base, int index, int scale, long displacement) {
+    int rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | (index >= 0 && (index & 8) ? 2 : 0) | ((base & 8) ? 1 : 0);
+    int scaleBits = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+    if (prefix != 0) {
+        emit(jit, prefix);
+    }
+    if (rex != 0x40) {
+        emit(jit, rex);
+    }
+    emit(jit, opcode);
+    if (secondOpcode >= 0) {
+        emit(jit, secondOpcode);
+    }
+    /* the displacement is always 32 bits, so rbp and r13 don't need a special case */
+    if (index < 0 && (base & 7) != 4) {
+        emit(jit, 0x80 | ((reg & 7) << 3) | (base & 7));
+    } else {
+        emit(jit, 0x80 | ((reg & 7) << 3) | 4);
+        emit(jit, (scaleBits << 6) | ((index < 0 ? 4 : index) & 7) << 3 | (base & 7));
+    }
+    emit32(jit, displacement);
+}
+
+/* the emit_jump function adds a jump with a 32-bit offset (opcode is one or two bytes, like 0x0F85),
+    and returns where the offset is so it can be patched */
+static size_t emit_jump(Jit* jit, int opcode) {
+    if (opcode > 0xFF) {
+        emit(jit, opcode >> 8);
+    }
+    emit(jit, opcode & 0xFF);
+    emit32(jit, 0);
+    return jit->used - 4;
+}
+
+/* the patch_jump function makes the jump whose offset is at position go to target */
+static void patch_jump(Jit* jit, size_t position, size_t target) {
+    long offset = (long)target - (long)(position + 4);
+    size_t saved = jit->used;
+    jit->used = position;
+    emit32(jit, offset);
+    jit->used = saved;
+}
+
+/* the emit_call function adds a call of a C function */
+static void emit_call(Jit* jit, unsigned long function) {
+    emit(jit, 0x48); /* mov rax, function */
+    emit(jit, 0xB8);
+    emit64(jit, function);
+    emit(jit, 0xFF); /* call rax */
+    emit(jit, 0xD0);
+}
+
+/* the emit_exit function adds the end of the native code: count more instructions ran, and eax is the next address */
+static void emit_exit(Jit* jit, int count) {
+    if (count > 0) {
+        emit(jit, 0x49); /* add r14, count */
+        emit(jit, 0x81);
+        emit(jit, 0xC6);
+        emit32(jit, count);
+    }
+    emit_memory(jit, 0, TRUE, 0x89, -1, R14, R13, -1, 1, (long)offsetof(JitContext, steps)); /* mov [r13 + steps], r14 */
+    emit(jit, 0x41); emit(jit, 0x5F); /* pop r15 */
+    emit(jit, 0x41); emit(jit, 0x5E); /* pop r14 */
+    emit(jit, 0x41); emit(jit, 0x5D); /* pop r13 */
+    emit(jit, 0x41); emit(jit, 0x5C); /* pop r12 */
+    emit(jit, 0x5B); /* pop rbx */
+    emit(jit, 0xC3); /* ret */
+}
+
+/* the emit_exit_to function adds an end of the native code that goes to a known address */
+static void emit_exit_to(Jit* jit, int address, int count) {
+    emit(jit, 0xB8); /* mov eax, address */
+    emit32(jit, address);
+    emit_exit(jit, count);
+}
+
+/* the emit_load function adds the code that reads the value of an operand into eax or ecx */
+static void emit_load(Jit* jit, int reg, const DecodedOperand* operand) {
+    switch (operand->kind) {
+        case OPERAND_KIND_IMMEDIATE:
+            emit(jit, 0xB8 + reg); /* mov reg, value */
+            emit32(jit, operand->value);
+            break;
+        case OPERAND_KIND_REGISTER:
+            emit_memory(jit, 0, FALSE, 0x8B, -1, reg, RBX, -1, 1, REGISTER_OFFSET(operand->value)); /* mov reg, [rbx + register] */
+            break;
+        default:
+            emit_memory(jit, 0, FALSE, 0x0F, 0xB7, reg, R12, -1, 1, 2L * operand->value); /* movzx reg, word [r12 + 2 * address] */
+            break;
+    }
+}
+
+/* the emit_store function adds the code that writes eax, as a word, to the destination of an instruction */
+static void emit_store(Jit* jit, const DecodedOperand* operand) {
+    emit(jit, 0x25); /* and eax, WORD_MASK */
+    emit32(jit, WORD_MASK);
+    if (operand->kind == OPERAND_KIND_REGISTER) {
+        emit_memory(jit, 0, FALSE, 0x89, -1, RAX, RBX, -1, 1, REGISTER_OFFSET(operand->value)); /* mov [rbx + register], eax */
+    } else {
+        emit_memory(jit, 0x66, FALSE, 0x89, -1, RAX, R12, -1, 1, 2L * operand->value); /* mov [r12 + 2 * address], ax */
+        emit_memory(jit, 0, TRUE, 0x8B, -1, RCX, RBX, -1, 1, (long)offsetof(Machine, dirty)); /* mov rcx, [rbx + dirty] */
+        emit_memory(jit, 0, FALSE, 0xC6, -1, 0, RCX, -1, 1, operand->value >> MACHINE_PAGE_SHIFT); /* mov byte [rcx + page], 1 */
+        emit(jit, 1);
+    }
+}
+
+/* the emit_target function adds the code that puts the address a jump goes to in eax or ecx */
+static void emit_target(Jit* jit, int reg, const DecodedOperand* operand) {
+    if (operand->kind == OPERAND_KIND_REGISTER) {
+        emit_load(jit, reg, operand);
+    } else {
+        emit(jit, 0xB8 + reg);
+        emit32(jit, operand->value);
+    }
+}
+
+/* the emit_loop function ends a block that jumps back to its own start. the block runs again in the native code
+    until the jump isn't taken or the steps would go over the limit. conditional is TRUE for bne */
+static void emit_loop(Jit* jit, size_t body, int start, int next, int length, boolean conditional) {
+    size_t notTaken = 0, overLimit;
+    emit(jit, 0x49); /* add r14, length */
+    emit(jit, 0x81);
+    emit(jit, 0xC6);
+    emit32(jit, length);
+    if (conditional) {
+        emit_memory(jit, 0, FALSE, 0x83, -1, 7, RBX, -1, 1, (long)offsetof(Machine, zero)); /* cmp dword [rbx + zero], 0 */
+        emit(jit, 0);
+        notTaken = emit_jump(jit, 0x0F85); /* jne */
+    }
+    emit_memory(jit, 0, TRUE, 0x8D, -1, RAX, R14, -1, 1, length); /* lea rax, [r14 + length] */
+    emit(jit, 0x4C); /* cmp rax, r15 */
+    emit(jit, 0x39);
+    emit(jit, 0xF8);
+    overLimit = emit_jump(jit, 0x0F87); /* ja */
+    patch_jump(jit, emit_jump(jit, 0xE9), body); /* jmp body */
+    if (conditional) {
+        patch_jump(jit, notTaken, jit->used);
+        emit_exit_to(jit, next, 0);
+    }
+    patch_jump(jit, overLimit, jit->used);
+    emit_exit_to(jit, start, 0);
+}
+
+/* the emit_instruction function adds the native code of an instruction that doesn't jump */
+static void emit_instruction(Jit* jit, const DecodedInstruction* instruction) {
+    switch (instruction->opcode) {
+        case ENUM_MOV:
+            emit_load(jit, RAX, &instruction->source);
+            emit_store(jit, &instruction->destination);
+            break;
+        case ENUM_CMP:
+            emit_load(jit, RAX, &instruction->source);
+            emit_load(jit, RCX, &instruction->destination);
+            emit(jit, 0x29); emit(jit, 0xC8); /* sub eax, ecx */
+            emit(jit, 0xA9); emit32(jit, WORD_MASK); /* test eax, WORD_MASK */
+            emit(jit, 0x0F); emit(jit, 0x94); emit(jit, 0xC1); /* sete cl */
+            emit(jit, 0x0F); emit(jit, 0xB6); emit(jit, 0xC9); /* movzx ecx, cl */
+            emit_memory(jit, 0, FALSE, 0x89, -1, RCX, RBX, -1, 1, (long)offsetof(Machine, zero)); /* mov [rbx + zero], ecx */
+            break;
+        case ENUM_ADD:
+        case ENUM_SUB:
+            emit_load(jit, RAX, &instruction->destination);
+            emit_load(jit, RCX, &instruction->source);
+            emit(jit, instruction->opcode == ENUM_ADD ? 0x01 : 0x29); /* add or sub eax, ecx */
+            emit(jit, 0xC8);
+            emit_store(jit, &instruction->destination);
+            break;
+        case ENUM_NOT:
+            emit_load(jit, RAX, &instruction->destination);
+            emit(jit, 0xF7); emit(jit, 0xD0); /* not eax */
+            emit_store(jit, &instruction->destination);
+            break;
+        case ENUM_CLR:
+            emit(jit, 0x31); emit(jit, 0xC0); /* xor eax, eax */
+            emit_store(jit, &instruction->destination);
+            break;
+        case ENUM_LEA:
+            emit(jit, 0xB8); /* mov eax, address */
+            emit32(jit, instruction->source.value);
+            emit_store(jit, &instruction->destination);
+            break;
+        case ENUM_INC:
+        case ENUM_DEC:
+            emit_load(jit, RAX, &instruction->destination);
+            emit(jit, 0x83); emit(jit, instruction->opcode == ENUM_INC ? 0xC0 : 0xE8); emit(jit, 1); /* add or sub eax, 1 */
+            emit_store(jit, &instruction->destination);
+            break;
+        case ENUM_RED:
+            emit_memory(jit, 0, TRUE, 0x8B, -1, RDI, R13, -1, 1, (long)offsetof(JitContext, input)); /* mov rdi, [r13 + input] */
+            emit_call(jit, (unsigned long)jit_red);
+            emit_store(jit, &instruction->destination);
+            break;
+        default: /* prn */
+            emit_load(jit, RAX, &instruction->destination);
+            emit(jit, 0x89); emit(jit, 0xC7); /* mov edi, eax */
+            emit_memory(jit, 0, TRUE, 0x8B, -1, RSI, R13, -1, 1, (long)offsetof(JitContext, output)); /* mov rsi, [r13 + output] */
+            emit_call(jit, (unsigned long)jit_prn);
+            break;
+    }
+}
+
+/* the emit_jump_instruction function adds the native code of the instruction that ends a block.
+    address is where the instruction is, and count is the number of instructions of the block before it */
+static void emit_jump_instruction(Jit* jit, const DecodedInstruction* instruction, int start, size_t body, int address, int count) {
+    int next = address + instruction->length;
+    size_t full;
+    const DecodedOperand* target = &instruction->destination;
+    boolean loops = target->kind == OPERAND_KIND_MEMORY && target->value == start;
+
+    switch (instruction->opcode) {
+        case ENUM_JMP:
+        case ENUM_BNE:
+            if (loops) {
+                emit_loop(jit, body, start, next, count + 1, instruction->opcode == ENUM_BNE);
+            } else if (instruction->opcode == ENUM_JMP) {
+                emit_target(jit, RAX, target);
+                emit_exit(jit, count + 1);
+            } else {
+                emit(jit, 0xB8); /* mov eax, next */
+                emit32(jit, next);
+                emit_target(jit, RCX, target);
+                emit_memory(jit, 0, FALSE, 0x83, -1, 7, RBX, -1, 1, (long)offsetof(Machine, zero)); /* cmp dword [rbx + zero], 0 */
+                emit(jit, 0);
+                emit(jit, 0x0F); emit(jit, 0x44); emit(jit, 0xC1); /* cmove eax, ecx */
+                emit_exit(jit, count + 1);
+            }
+            break;
+        case ENUM_JSR:
+            emit_memory(jit, 0, FALSE, 0x8B, -1, RAX, RBX, -1, 1, (long)offsetof(Machine, stackDepth)); /* mov eax, [rbx + stackDepth] */
+            emit(jit, 0x3D); emit32(jit, MACHINE_STACK_SIZE); /* cmp eax, MACHINE_STACK_SIZE */
+            full = emit_jump(jit, 0x0F83); /* jae */
+            emit_memory(jit, 0, FALSE, 0xC7, -1, 0, RBX, RAX, 4, (long)offsetof(Machine, stack)); /* mov dword [rbx + stack + 4 * rax], next */
+            emit32(jit, next);
+            emit(jit, 0x83); emit(jit, 0xC0); emit(jit, 1); /* add eax, 1 */
+            emit_memory(jit, 0, FALSE, 0x89, -1, RAX, RBX, -1, 1, (long)offsetof(Machine, stackDepth)); /* mov [rbx + stackDepth], eax */
+            emit_target(jit, RAX, target);
+            emit_exit(jit, count + 1);
+            /* the interpreter writes the error of a full stack */
+            patch_jump(jit, full, jit->used);
+            emit_exit_to(jit, address + JIT_INTERPRET, count);
+            break;
+        default: /* rts */
+            emit_memory(jit, 0, FALSE, 0x8B, -1, RAX, RBX, -1, 1, (long)offsetof(Machine, stackDepth)); /* mov eax, [rbx + stackDepth] */
+            emit(jit, 0x85); emit(jit, 0xC0); /* test eax, eax */
+            full = emit_jump(jit, 0x0F84); /* jz */
+            emit(jit, 0x83); emit(jit, 0xE8); emit(jit, 1); /* sub eax, 1 */
+            emit_memory(jit, 0, FALSE, 0x89, -1, RAX, RBX, -1, 1, (long)offsetof(Machine, stackDepth)); /* mov [rbx + stackDepth], eax */
+            emit_memory(jit, 0, FALSE, 0x8B, -1, RAX, RBX, RAX, 4, (long)offsetof(Machine, stack)); /* mov eax, [rbx + stack + 4 * rax] */
+            emit_exit(jit, count + 1);
+            patch_jump(jit, full, jit->used);
+            emit_exit_to(jit, address + JIT_INTERPRET, count);
+            break;
+    }
+}
+
+/* the translate function translates the block that starts at address: the instructions until the first jump,
+    or until an instruction that can't be translated */
+static void translate(Jit* jit, const Machine* machine, int start, JitBlock* block) {
+    DecodedInstruction instruction;
+    int address = start, count = 0;
+    size_t body;
+    boolean ended = FALSE;
+
+    if (decode_instruction(machine, start, &instruction, FALSE) != 0) {
+        /* the interpreter writes the error */
+        block->kind = JIT_BLOCK_INTERPRET;
+        return;
+    }
+    if (instruction.opcode == ENUM_HLT || writes_code(machine, &instruction)) {
+        block->kind = JIT_BLOCK_INTERPRET;
+        block->writesCode = writes_code(machine, &instruction);
+        return;
+    }
+    if (jit->size - jit->used < JIT_MAX_BLOCK_BYTES) {
+        /* block points into the blocks, that flush_jit only clears */
+        flush_jit(jit);
+    }
+    mprotect(jit->buffer, jit->size, PROT_READ | PROT_WRITE);
+    block->code = jit->buffer + jit->used;
+
+    emit(jit, 0x53); /* push rbx */
+    emit(jit, 0x41); emit(jit, 0x54); /* push r12 */
+    emit(jit, 0x41); emit(jit, 0x55); /* push r13 */
+    emit(jit, 0x41); emit(jit, 0x56); /* push r14 */
+    emit(jit, 0x41); emit(jit, 0x57); /* push r15 */
+    emit(jit, 0x49); emit(jit, 0x89); emit(jit, 0xFD); /* mov r13, rdi */
+    emit_memory(jit, 0, TRUE, 0x8B, -1, RBX, R13, -1, 1, (long)offsetof(JitContext, machine)); /* mov rbx, [r13 + machine] */
+    emit_memory(jit, 0, TRUE, 0x8B, -1, R12, RBX, -1, 1, (long)offsetof(Machine, memory)); /* mov r12, [rbx + memory] */
+    emit_memory(jit, 0, TRUE, 0x8B, -1, R14, R13, -1, 1, (long)offsetof(JitContext, steps)); /* mov r14, [r13 + steps] */
+    emit_memory(jit, 0, TRUE, 0x8B, -1, R15, R13, -1, 1, (long)offsetof(JitContext, limit)); /* mov r15, [r13 + limit] */
+    body = jit->used;
+
+    while (!ended) {
+        switch (instruction.opcode) {
+            case ENUM_JMP: case ENUM_BNE: case ENUM_JSR: case ENUM_RTS:
+                emit_jump_instruction(jit, &instruction, start, body, address, count);
+                ended = TRUE;
+                break;
+            default:
+                emit_instruction(jit, &instruction);
+                break;
+        }
+        count++;
+        address += instruction.length;
+        if (!ended && (count == JIT_MAX_BLOCK_LENGTH || address >= machine->codeEnd ||
+            decode_instruction(machine, address, &instruction, FALSE) != 0 || instruction.opcode == ENUM_HLT || writes_code(machine, &instruction))) {
+            /* the next instruction starts a new block */
+            emit_exit_to(jit, address, count);
+            ended = TRUE;
+        }
+    }
+    mprotect(jit->buffer, jit->size, PROT_READ | PROT_EXEC);
+    block->kind = JIT_BLOCK_NATIVE;
+    block->length = count;
+    jit->translated++;
+}
+
+#endif
+
+/* the run_jit function runs the loaded program like run_machine, with the translated blocks.
+    an instruction that can't be translated (hlt, a write into the code, or an instruction that faults) is run by the interpreter,
+    and a write into the code drops all of the blocks. the program runs only in the interpreter when the machine has a profile */
+MachineStatus run_jit(Jit* jit, Machine* machine, unsigned long maxSteps, FILE* input, FILE* output) {
+    MachineStatus status = MACHINE_STEP_LIMIT;
+#ifdef HAS_JIT
+    JitContext context;
+    JitBlock* block;
+    JitCode code;
+    int pc = machine->pc, next;
+    boolean interpret;
+
+    if (!jit->available || machine->profile != NULL) {
+        return run_machine(machine, maxSteps, input, output);
+    }
+    context.machine = machine;
+    context.steps = machine->steps;
+    context.limit = maxSteps > 0 ? maxSteps : ULONG_MAX;
+    context.input = input;
+    context.output = output;
+
+    for (;;) {
+        if (maxSteps > 0 && context.steps >= maxSteps) {
+            status = MACHINE_STEP_LIMIT;
+            break;
+        }
+        block = NULL;
+        interpret = (pc & JIT_INTERPRET) != 0;
+        pc &= ~JIT_INTERPRET;
+        if (!interpret && pc >= START_POSITION && pc < machine->codeEnd) {
+            block = &jit->blocks[pc];
+            if (block->kind == JIT_BLOCK_NONE) {
+                translate(jit, machine, pc, block);
+            }
+        }
+        if (block != NULL && block->kind == JIT_BLOCK_NATIVE && context.limit - context.steps >= (unsigned long)block->length) {
+            /* an object pointer can't be cast to a function pointer in ISO C, so it is copied */
+            memcpy(&code, &block->code, sizeof(code));
+            pc = code(&context);
+            continue;
+        }
+
+        /* the instruction runs in the interpreter, one step at a time */
+        machine->pc = pc;
+        machine->steps = context.steps;
+        status = run_machine(machine, context.steps + 1, input, output);
+        next = machine->pc;
+        context.steps = machine->steps;
+        if (status != MACHINE_STEP_LIMIT) {
+            break;
+        }
+        if (block != NULL && block->writesCode) {
+            flush_jit(jit);
+        }
+        pc = next;
+    }
+    machine->pc = pc;
+    machine->steps = context.steps;
+#else
+    (void)jit;
+    status = run_machine(machine, maxSteps, input, output);
+#endif
+    return status;
+}
@@ -0,0 +1,43 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "machine.h"
+
+/* A block of instructions that was translated, from an address until the first jump */
+typedef struct {
+    unsigned char kind; /* not translated yet, translated, or run by the interpreter */
+    boolean writesCode; /* the block is a single instruction that writes into the code, run by the interpreter */
+    int length; /* the number of instructions of the block */
+    unsigned char* code; /* the native code of the block */
+} JitBlock;
+
+/* The translator of a machine. The blocks of the program are translated into x86-64 code the first time they run */
+typedef struct {
+    boolean available; /* FALSE when the computer isn't x86-64 or the code buffer could not be mapped, then only the interpreter runs */
+    unsigned char* buffer; /* the native code of all of the blocks */
+    size_t size;
+    size_t used;
+    JitBlock* blocks; /* the block that starts at every address of the memory */
+    int blockCount;
+    unsigned long translated; /* the number of blocks that were translated */
+    unsigned long flushes; /* the number of times all of the blocks were dropped */
+} Jit;
+
+/* the create_jit function readies a translator for the programs of the machine.
+    returns 0 on success and 1 if the memory could not be allocated */
+int create_jit(Jit* jit, const Machine* machine);
+
+/* the flush_jit function drops all of the translated blocks. it is called after a new program is loaded into the machine */
+void flush_jit(Jit* jit);
+
+/* the run_jit function runs the loaded program like run_machine, with the translated blocks.
+    an instruction that can't be translated (hlt, a write into the code, or an instruction that faults) is run by the interpreter,
+    and a write into the code drops all of the blocks. the program runs only in the interpreter when the machine has a profile */
+MachineStatus run_jit(Jit* jit, Machine* machine, unsigned long maxSteps, FILE* input, FILE* output);
+
+/* the free_jit function frees the memory of a translator */
+void free_jit(Jit* jit);
+
+#endif
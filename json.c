@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+
+#define MAX_JSON_DEPTH 64 /* the deepest nesting of arrays and objects that is parsed */
+
+/* The state of the parser: the text, and the position of the next character */
+typedef struct {
+    const char* text;
+    size_t length;
+    size_t position;
+    int depth;
+} JsonParser;
+
+static JsonValue* parse_value(JsonParser* parser);
+
+/* the skip_spaces function moves the parser over the white space before the next token */
+static void skip_spaces(JsonParser* parser) {
+    while (parser->position < parser->length && (parser->text[parser->position] == ' ' || parser->text[parser->position] == '\t' ||
+        parser->text[parser->position] == '\n' || parser->text[parser->position] == '\r')) {
+        parser->position++;
+    }
+}
+
+/* the next_is function moves the parser over the character c if it is the next token, and checks if it was */
+static boolean next_is(JsonParser* parser, char c) {
+    skip_spaces(parser);
+    if (parser->position < parser->length && parser->text[parser->position] == c) {
+        parser->position++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/* the skip_word function moves the parser over a word (true, false or null), and checks if it was there */
+static boolean skip_word(JsonParser* parser, const char* word) {
+    size_t length = strlen(word);
+    if (parser->length - parser->position >= length && memcmp(parser->text + parser->position, word, length) == 0) {
+        parser->position += length;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/* the hex_value function reads the 4 hex digits of a \u escape. returns -1 if they aren't hex digits */
+static long hex_value(JsonParser* parser) {
+    long value = 0;
+    int i;
+    char c;
+    if (parser->length - parser->position < 4) {
+        return -1;
+    }
+    for (i = 0; i < 4; i++) {
+        c = parser->text[parser->position++];
+        value *= 16;
+        if (c >= '0' && c <= '9') value += c - '0';
+        else if (c >= 'a' && c <= 'f') value += c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value += c - 'A' + 10;
+        else return -1;
+    }
+    return value;
+}
+
+/* the add_code_point function writes a character as UTF-8 at the end of out, and returns the end of what it wrote */
+static char* add_code_point(char* out, long code) {
+    if (code < 0x80) {
+        *out++ = (char)code;
+    } else if (code < 0x800) {
+        *out++ = (char)(0xC0 | (code >> 6));
+        *out++ = (char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *out++ = (char)(0xE0 | (code >> 12));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (code & 0x3F));
+    } else {
+        *out++ = (char)(0xF0 | (code >> 18));
+        *out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (code & 0x3F));
+    }
+    return out;
+}
+
+/* the parse_string function parses a string, after its opening quote. the text is written into string, and its length into length.
+    returns 0 on success and 1 if the string isn't valid or the memory could not be allocated */
+static int parse_string(JsonParser* parser, char** string, size_t* length) {
+    const char* start = parser->text + parser->position;
+    const char* end = memchr(start, '"', parser->length - parser->position);
+    char *out, c;
+    long code, low;
+
+    /* an escaped character is never longer in UTF-8 than its escape, so the text up to the first quote is enough unless it has escapes */
+    while (end != NULL && end > start && end[-1] == '\\') {
+        end = memchr(end + 1, '"', parser->text + parser->length - end - 1);
+    }
+    *string = malloc((end != NULL ? (size_t)(end - start) : parser->length - parser->position) + 1);
+    if (*string == NULL) {
+        return 1;
+    }
+    out = *string;
+    while (parser->position < parser->length) {
+        c = parser->text[parser->position++];
+        if (c == '"') {
+            *out = '\0';
+            *length = out - *string;
+            return 0;
+        }
+        if ((unsigned char)c < 0x20) {
+            break;
+        }
+        if (c != '\\') {
+            *out++ = c;
+            continue;
+        }
+        if (parser->position == parser->length) {
+            break;
+        }
+        c = parser->text[parser->position++];
+        switch (c) {
+            case '"': case '\\': case '/': *out++ = c; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u':
+                code = hex_value(parser);
+                if (code < 0) {
+                    goto fail;
+                }
+                if (code >= 0xD800 && code < 0xDC00 && skip_word(parser, "\\u")) {
+                    /* a surrogate pair is a single character */
+                    low = hex_value(parser);
+                    if (low < 0xDC00 || low >= 0xE000) {
+                        goto fail;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                out = add_code_point(out, code);
+                break;
+            default:
+                goto fail;
+        }
+    }
+
+    fail:
+    free(*string);
+    *string = NULL;
+    return 1;
+}
+
+/* the parse_number function parses a number */
+static int parse_number(JsonParser* parser, double* number) {
+    char buffer[64];
+    size_t length = 0;
+    char* end;
+    while (parser->position + length < parser->length && length < sizeof(buffer) - 1 &&
+        strchr("+-0123456789.eE", parser->text[parser->position + length]) != NULL) {
+        buffer[length] = parser->text[parser->position + length];
+        length++;
+    }
+    buffer[length] = '\0';
+    *number = strtod(buffer, &end);
+    if (length == 0 || end != buffer + length) {
+        return 1;
+    }
+    parser->position += length;
+    return 0;
+}
+
+/* the parse_children function parses the items of an array or the members of an object, after the opening bracket */
+static int parse_children(JsonParser* parser, JsonValue* parent, char close) {
+    JsonValue** last = &parent->children;
+    JsonValue* child;
+    char* key = NULL;
+    size_t keyLength;
+
+    if (next_is(parser, close)) {
+        return 0;
+    }
+    do {
+        if (parent->type == JSON_OBJECT) {
+            if (!next_is(parser, '"') || parse_string(parser, &key, &keyLength) != 0) {
+                return 1;
+            }
+            if (!next_is(parser, ':')) {
+                free(key);
+                return 1;
+            }
+        }
+        child = parse_value(parser);
+        if (child == NULL) {
+            if (key != NULL) free(key);
+            return 1;
+        }
+        child->key = key;
+        key = NULL;
+        *last = child;
+        last = &child->next;
+    } while (next_is(parser, ','));
+    return next_is(parser, close) ? 0 : 1;
+}
+
+/* the parse_value function parses the next value */
+static JsonValue* parse_value(JsonParser* parser) {
+    JsonValue* value = calloc(1, sizeof(JsonValue));
+    int error = 0;
+
+    if (value == NULL) {
+        return NULL;
+    }
+    skip_spaces(parser);
+    if (parser->position == parser->length) {
+        error = 1;
+    } else if (next_is(parser, '{') || next_is(parser, '[')) {
+        value->type = parser->text[parser->position - 1] == '{' ? JSON_OBJECT : JSON_ARRAY;
+        if (++parser->depth > MAX_JSON_DEPTH) {
+            error = 1;
+        } else {
+            error = parse_children(parser, value, value->type == JSON_OBJECT ? '}' : ']');
+        }
+        parser->depth--;
+    } else if (next_is(parser, '"')) {
+        value->type = JSON_STRING;
+        error = parse_string(parser, &value->string, &value->length);
+    } else if (skip_word(parser, "true")) {
+        value->type = JSON_TRUE;
+    } else if (skip_word(parser, "false")) {
+        value->type = JSON_FALSE;
+    } else if (skip_word(parser, "null")) {
+        value->type = JSON_NULL;
+    } else {
+        value->type = JSON_NUMBER;
+        error = parse_number(parser, &value->number);
+    }
+    if (error) {
+        free_json(value);
+        return NULL;
+    }
+    return value;
+}
+
+JsonValue* parse_json(const char* text, size_t length) {
+    JsonParser parser;
+    JsonValue* value;
+    parser.text = text;
+    parser.length = length;
+    parser.position = 0;
+    parser.depth = 0;
+    value = parse_value(&parser);
+    skip_spaces(&parser);
+    if (value != NULL && parser.position != parser.length) {
+        /* there is something after the value */
+        free_json(value);
+        return NULL;
+    }
+    return value;
+}
+
+JsonValue* json_member(const JsonValue* value, const char* key) {
+    JsonValue* member;
+    if (value == NULL || value->type != JSON_OBJECT) {
+        return NULL;
+    }
+    for (member = value->children; member != NULL; member = member->next) {
+        if (strcmp(member->key, key) == 0) {
+            return member;
+        }
+    }
+    return NULL;
+}
+
+int json_int(const JsonValue* value, int fallback) {
+    if (value == NULL || value->type != JSON_NUMBER || value->number < -2147483647.0 || value->number > 2147483647.0) {
+        return fallback;
+    }
+    return (int)value->number;
+}
+
+const char* json_string(const JsonValue* value) {
+    return value != NULL && value->type == JSON_STRING ? value->string : NULL;
+}
+
+void write_json_string(OutputBuffer* output, const char* text, size_t length) {
+    char escape[8];
+    size_t i, start = 0;
+    output_write(output, "\"", 1);
+    for (i = 0; i < length; i++) {
+        if (text[i] == '"' || text[i] == '\\' || (unsigned char)text[i] < 0x20) {
+            /* the characters before it are written together */
+            output_write(output, text + start, i - start);
+            if (text[i] == '"' || text[i] == '\\') {
+                sprintf(escape, "\\%c", text[i]);
+            } else {
+                sprintf(escape, "\\u%04x", (unsigned char)text[i]);
+            }
+            output_puts(output, escape);
+            start = i + 1;
+        }
+    }
+    output_write(output, text + start, length - start);
+    output_write(output, "\"", 1);
+}
+
+void write_json_value(OutputBuffer* output, const JsonValue* value) {
+    char number[64];
+    if (value == NULL) {
+        output_puts(output, "null");
+        return;
+    }
+    switch (value->type) {
+        case JSON_NUMBER:
+            sprintf(number, "%.17g", value->number);
+            output_puts(output, number);
+            break;
+        case JSON_STRING:
+            write_json_string(output, value->string, value->length);
+            break;
+        case JSON_TRUE:
+            output_puts(output, "true");
+            break;
+        case JSON_FALSE:
+            output_puts(output, "false");
+            break;
+        default:
+            output_puts(output, "null");
+            break;
+    }
+}
+
+void free_json(JsonValue* value) {
+    JsonValue* next;
+    while (value != NULL) {
+        next = value->next;
+        free_json(value->children);
+        if (value->string != NULL) free(value->string);
+        if (value->key != NULL) free(value->key);
+        free(value);
+        value = next;
+    }
+}
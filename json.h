@@ -0,0 +1,52 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <stddef.h>
+#include "structs.h"
+#include "output_buffer.h"
+
+/* The types of JSON values */
+typedef enum {
+    JSON_NULL,
+    JSON_FALSE,
+    JSON_TRUE,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} JsonType;
+
+/* A parsed JSON value. the items of an array and the members of an object are a linked list of their values */
+typedef struct JsonValue {
+    JsonType type;
+    double number;
+    char* string; /* the text of a string, it may have \0 characters in it */
+    size_t length; /* the length of the string */
+    char* key; /* the key of a member of an object, or NULL */
+    struct JsonValue* children; /* the first item or member */
+    struct JsonValue* next; /* the next item or member of the parent */
+} JsonValue;
+
+/* the parse_json function parses the JSON value in the length characters of text.
+    returns NULL if the text isn't valid JSON, or if the memory could not be allocated */
+JsonValue* parse_json(const char* text, size_t length);
+
+/* the json_member function returns the member of an object with the given key, or NULL if value isn't an object or has no such member */
+JsonValue* json_member(const JsonValue* value, const char* key);
+
+/* the json_int function returns the value of a number, or fallback if value isn't a number */
+int json_int(const JsonValue* value, int fallback);
+
+/* the json_string function returns the text of a string, or NULL if value isn't a string */
+const char* json_string(const JsonValue* value);
+
+/* the write_json_string function writes length characters of text as a JSON string, with the characters that need it escaped */
+void write_json_string(OutputBuffer* output, const char* text, size_t length);
+
+/* the write_json_value function writes a number, a string, true, false or null the way it was parsed (for the id of a request) */
+void write_json_value(OutputBuffer* output, const JsonValue* value);
+
+/* the free_json function frees a parsed value and everything in it */
+void free_json(JsonValue* value);
+
+#endif
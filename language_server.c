@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <string.h>
+#include "lsp.h"
+#include "utils.h"
+#include "constants.h"
+#include "diagnostics.h"
+#include "library.h"
+#include "preprocessor.h"
+
+/**
+ * The main function of the language server.
+ * Usage: language_server [--memory-size=N] [--max-errors=N] [--library=PATH]... [--define=NAME[=VALUE]]...
+ * It speaks the Language Server Protocol on the standard input and output, for the editors:
+ * the open documents are assembled in memory when they change and their errors and warnings are published as diagnostics,
+ * and it answers go to definition and find references for the labels, constants, externals and macros.
+ *   --memory-size=N the number of words in the memory of the target machine (default 4096, at most 65536)
+ *   --max-errors=N stop assembling a document after N errors
+ *   --define=NAME[=VALUE] a constant for the conditions of every document, like with the assembler
+ *   --library=PATH every document uses the macros and the constants of the library at PATH, like with the assembler
+ * Returns 0 if the client shut the server down before it exited, and 1 otherwise.
+*/
+int main(int argc, char **argv) {
+    AssemblerOptions options;
+    int i, result;
+
+    memset(&options, 0, sizeof(AssemblerOptions));
+    options.memorySize = MEMORY_SIZE;
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--memory-size=", 14) == 0 && is_number(argv[i] + 14) && argv[i][14] != '\0'
+            && get_number(argv[i] + 14) > START_POSITION && get_number(argv[i] + 14) <= MAX_MEMORY_SIZE) {
+            options.memorySize = get_number(argv[i] + 14);
+        } else if (strncmp(argv[i], "--max-errors=", 13) == 0 && is_number(argv[i] + 13) && argv[i][13] != '\0' && argv[i][13] != '-') {
+            options.maxErrors = get_number(argv[i] + 13);
+        } else if (strncmp(argv[i], "--define=", 9) == 0) {
+            if (define_condition_constant(argv[i] + 9) != 0) {
+                fprintf(stderr, "Invalid define \"%s\", exiting program.\n", argv[i] + 9);
+                free_libraries();
+                free_condition_constants();
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--library=", 10) == 0 && argv[i][10] != '\0') {
+            if (use_library(argv[i] + 10) != 0) {
+                fprintf(stderr, "Library %s could not be loaded, exiting program.\n", argv[i] + 10);
+                free_libraries();
+                free_condition_constants();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stdio") != 0) {
+            /* editors often pass --stdio, which is the only way the server talks anyway */
+            fprintf(stderr, "Unknown option \"%s\", exiting program.\n", argv[i]);
+            free_libraries();
+            free_condition_constants();
+            return 1;
+        }
+    }
+
+    /* the diagnostics are published to the client, and are never written to stdout, which carries the messages */
+    collect_diagnostics(TRUE);
+    result = run_language_server(0, stdout, &options);
+    end_diagnostics();
+    free_libraries();
+    free_condition_constants();
+    return result;
+}
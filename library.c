@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "library.h"
+#include "constants.h"
+#include "diagnostics.h"
+#include "output_buffer.h"
+#include "parser.h"
+#include "preprocessor.h"
+#include "utils.h"
+#include "data_structures/hashtable.h"
+#include "data_structures/node.h"
+
+/* A macro or a constant of a library that is being compiled */
+typedef struct {
+    char* name;
+    LibraryEntryKind kind;
+    int value; /* the value of a constant, or the number of lines of a macro */
+    size_t codeStart; /* the offset of the code of a macro in the code that was collected */
+    size_t codeLength;
+} LibraryEntry;
+
+static MacroLibrary* loadedLibraries = NULL;
+static LibrarySet defaultLibraries = {{NULL}, 0};
+static LibrarySet fileLibraries = {{NULL}, 0};
+
+/* the library_hash function is the hash of a name in the slots of an image. it only uses 32 bits, so an image can be read anywhere */
+static unsigned long library_hash(const char* name) {
+    unsigned long hash = 5381;
+    while (*name != '\0') {
+        hash = ((hash * 33) ^ (unsigned char)*name++) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+/* the add_entry function adds a name to the library that is being compiled. a macro that is defined again replaces the first one,
+    like in a file. returns the entry, or NULL if the memory could not be allocated */
+static LibraryEntry* add_entry(LibraryEntry** entries, int* count, int* capacity, hashtable* names, const char* name) {
+    LibraryEntry* grown;
+    int* found = (int*)search(names, name);
+    if (found != NULL) {
+        return &(*entries)[*found];
+    }
+    if (*count == *capacity) {
+        grown = realloc(*entries, (*capacity == 0 ? 16 : 2 * *capacity) * sizeof(LibraryEntry));
+        if (grown == NULL) {
+            return NULL;
+        }
+        *entries = grown;
+        *capacity = *capacity == 0 ? 16 : 2 * *capacity;
+    }
+    grown = &(*entries)[*count];
+    grown->name = duplicate_string(name);
+    if (grown->name == NULL || insert(names, name, count, sizeof(int)) != 0) {
+        if (grown->name != NULL) free(grown->name);
+        return NULL;
+    }
+    (*count)++;
+    return grown;
+}
+
+/* the write_image function writes the image of the library with the given entries and the code of its macros to imageName.
+    returns 0 on success */
+static int write_image(const char* imageName, const LibraryEntry* entries, int count, const OutputBuffer* code) {
+    unsigned long slotCount = 8, slot;
+    size_t size, namesStart, codeStart, nameOffset;
+    unsigned char* image, *entry;
+    FILE* file;
+    int i, result = 1;
+
+    while (slotCount < 2 * (unsigned long)count) {
+        slotCount *= 2;
+    }
+    namesStart = LIBRARY_HEADER_LENGTH + slotCount * 4 + count * LIBRARY_ENTRY_LENGTH;
+    size = namesStart;
+    for (i = 0; i < count; i++) {
+        size += strlen(entries[i].name) + 1;
+    }
+    codeStart = size;
+    size += code->size;
+    image = calloc(size, 1);
+    if (image == NULL) {
+        return 1;
+    }
+
+    memcpy(image, LIBRARY_MAGIC, LIBRARY_MAGIC_LENGTH);
+    put_le_number(image + LIBRARY_MAGIC_LENGTH, count, 4);
+    put_le_number(image + LIBRARY_MAGIC_LENGTH + 4, slotCount, 4);
+    nameOffset = namesStart;
+    for (i = 0; i < count; i++) {
+        entry = image + LIBRARY_HEADER_LENGTH + slotCount * 4 + i * LIBRARY_ENTRY_LENGTH;
+        put_le_number(entry, nameOffset, 4);
+        put_le_number(entry + 4, entries[i].kind, 4);
+        put_le_number(entry + 8, (unsigned long)entries[i].value & 0xFFFFFFFFUL, 4);
+        put_le_number(entry + 12, entries[i].kind == LIBRARY_MACRO ? codeStart + entries[i].codeStart : 0, 4);
+        put_le_number(entry + 16, entries[i].kind == LIBRARY_MACRO ? entries[i].codeLength : 0, 4);
+        strcpy((char*)image + nameOffset, entries[i].name);
+        nameOffset += strlen(entries[i].name) + 1;
+
+        /* the entry goes in the first empty slot from its hash */
+        slot = library_hash(entries[i].name) & (slotCount - 1);
+        while (get_le_number(image + LIBRARY_HEADER_LENGTH + slot * 4, 4) != 0) {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        put_le_number(image + LIBRARY_HEADER_LENGTH + slot * 4, i + 1, 4);
+    }
+    if (code->size > 0) {
+        memcpy(image + codeStart, code->data, code->size);
+    }
+
+    file = fopen(imageName, "wb");
+    if (file != NULL) {
+        result = fwrite(image, 1, size, file) != size;
+        result = fclose(file) != 0 || result;
+    }
+    free(image);
+    return result;
+}
+
+int compile_library(const char* sourceName, const char* imageName, int maxErrors) {
+    MappedFile source;
+    LineView line;
+    size_t offset = 0;
+    node* tokens = NULL;
+    ParsedSyntaxLine* parsed;
+    LibraryEntry *entries = NULL, *entry = NULL;
+    int count = 0, capacity = 0, lineNumber = 0, allocationError = 0, length, i, result = 1;
+    boolean inMacro = FALSE;
+    hashtable *names = NULL, *constants = NULL;
+    Symbol_Node* symbols = NULL;
+    OutputBuffer code;
+
+    if (map_file(sourceName, &source) != 0) {
+        fprintf(stderr, "File %s could not be opened.\n", sourceName);
+        return 1;
+    }
+    init_output_buffer(&code, NULL);
+    begin_file_diagnostics(sourceName, maxErrors);
+    names = create_hashtable();
+    constants = create_hashtable();
+    if (names == NULL || constants == NULL) {
+        report(DIAG_OUT_OF_MEMORY, sourceName, 0, 0, "s", "the library");
+        goto end;
+    }
+
+    while (next_line(&source, &offset, &line) && !error_limit_reached()) {
+        lineNumber++;
+        length = line.length > MAX_LINE_LENGTH ? MAX_LINE_LENGTH : line.length;
+        if (line.length > MAX_LINE_LENGTH) {
+            report(DIAG_LINE_TOO_LONG, sourceName, lineNumber, MAX_LINE_LENGTH + 1, "d", MAX_LINE_LENGTH);
+        }
+        tokens = tokenize_span(line.start, length, &allocationError);
+        if (allocationError) {
+            report(DIAG_OUT_OF_MEMORY, sourceName, lineNumber, 0, "s", "the tokens of the line");
+            goto end;
+        }
+        if (tokens == NULL) {
+            continue;
+        }
+
+        if (inMacro) {
+            if (strcmp(tokens->token, MACRO_END) == 0) {
+                if (tokens->next != NULL) {
+                    report(DIAG_TOKEN_AFTER_MACRO_END, sourceName, lineNumber, tokens->next->column, "ss", tokens->next->token, MACRO_END);
+                }
+                inMacro = FALSE;
+            } else if (entry != NULL) {
+                /* the code is kept the way it is written to the am file, so using the macro only copies it */
+                output_write(&code, line.start, length);
+                output_write(&code, "\n", 1);
+                entry->codeLength = code.size - entry->codeStart;
+                entry->value++;
+            }
+        } else if (strcmp(tokens->token, MACRO_START) == 0) {
+            inMacro = TRUE;
+            entry = NULL;
+            if (tokens->next == NULL) {
+                report(DIAG_MACRO_NAME_MISSING, sourceName, lineNumber, 0, "");
+            } else if (!is_macro_name_valid(tokens->next->token)) {
+                report(DIAG_INVALID_MACRO_NAME, sourceName, lineNumber, tokens->next->column, "s", tokens->next->token);
+            } else if (tokens->next->next != NULL) {
+                report(DIAG_TOKEN_AFTER_MACRO_NAME, sourceName, lineNumber, tokens->next->next->column, "s", tokens->next->next->token);
+            } else if (search(constants, tokens->next->token) != NULL) {
+                report(DIAG_SYMBOL_REDEFINED, sourceName, lineNumber, tokens->next->column, "s", tokens->next->token);
+            } else {
+                entry = add_entry(&entries, &count, &capacity, names, tokens->next->token);
+                if (entry == NULL || insert_symbol(&symbols, tokens->next->token) == NULL) {
+                    report(DIAG_OUT_OF_MEMORY, sourceName, lineNumber, 0, "s", "the macro");
+                    goto end;
+                }
+                entry->kind = LIBRARY_MACRO;
+                entry->value = 0;
+                entry->codeStart = code.size;
+                entry->codeLength = 0;
+            }
+        } else {
+            /* the constants are parsed like the constants of a file, so they have the same errors */
+            parsed = parse_line(line.start, length, constants, &symbols, NULL);
+            if (parsed == NULL) {
+                report(DIAG_OUT_OF_MEMORY, sourceName, lineNumber, 0, "s", "the parsed line");
+                goto end;
+            }
+            if (parsed->error != NULL) {
+                report_diagnostic(parsed->error, sourceName, lineNumber);
+            } else if (parsed->type == ENUM_CONSTANT_DEFINITION) {
+                entry = add_entry(&entries, &count, &capacity, names, parsed->statement.constantDefinition.name);
+                if (entry == NULL) {
+                    free_parsed_syntax_line(parsed);
+                    report(DIAG_OUT_OF_MEMORY, sourceName, lineNumber, 0, "s", "the constant");
+                    goto end;
+                }
+                entry->kind = LIBRARY_CONSTANT;
+                entry->value = parsed->statement.constantDefinition.value;
+                entry = NULL;
+            } else if (parsed->type != ENUM_COMMENT && parsed->type != ENUM_EMPTY) {
+                report(DIAG_LIBRARY_STATEMENT, sourceName, lineNumber, tokens->column, "");
+            }
+            free_parsed_syntax_line(parsed);
+        }
+        free_nodes(tokens);
+        tokens = NULL;
+    }
+
+    if (code.failed) {
+        report(DIAG_OUT_OF_MEMORY, sourceName, 0, 0, "s", "the code of the macros");
+    } else if (error_count() == 0) {
+        result = write_image(imageName, entries, count, &code);
+        if (result != 0) {
+            fprintf(stderr, "File %s could not be written.\n", imageName);
+        }
+    }
+
+    end:
+    if (tokens != NULL) {
+        free_nodes(tokens);
+    }
+    flush_diagnostics();
+    for (i = 0; i < count; i++) {
+        free(entries[i].name);
+    }
+    if (entries != NULL) free(entries);
+    if (names != NULL) free_hashtable(names);
+    if (constants != NULL) free_hashtable(constants);
+    free_symbols(symbols);
+    free_output_buffer(&code);
+    unmap_file(&source);
+    return result;
+}
+
+/* the is_valid_image function checks that everything the header, the slots and the entries point to is inside the image,
+    so the names can be looked up without checking it again */
+static boolean is_valid_image(const MappedFile* image, unsigned long* entryCount, unsigned long* slotCount) {
+    const unsigned char* data = (const unsigned char*)image->data;
+    const unsigned char* entry;
+    unsigned long i, nameOffset, kind, codeOffset, codeLength;
+    size_t entriesStart;
+
+    if (image->size < LIBRARY_HEADER_LENGTH || memcmp(data, LIBRARY_MAGIC, LIBRARY_MAGIC_LENGTH) != 0) {
+        return FALSE;
+    }
+    *entryCount = get_le_number(data + LIBRARY_MAGIC_LENGTH, 4);
+    *slotCount = get_le_number(data + LIBRARY_MAGIC_LENGTH + 4, 4);
+    if (*slotCount == 0 || (*slotCount & (*slotCount - 1)) != 0 || *entryCount >= *slotCount ||
+        *slotCount > (image->size - LIBRARY_HEADER_LENGTH) / 4 ||
+        *entryCount > (image->size - LIBRARY_HEADER_LENGTH - *slotCount * 4) / LIBRARY_ENTRY_LENGTH) {
+        return FALSE;
+    }
+    for (i = 0; i < *slotCount; i++) {
+        if (get_le_number(data + LIBRARY_HEADER_LENGTH + i * 4, 4) > *entryCount) {
+            return FALSE;
+        }
+    }
+    entriesStart = LIBRARY_HEADER_LENGTH + *slotCount * 4;
+    for (i = 0; i < *entryCount; i++) {
+        entry = data + entriesStart + i * LIBRARY_ENTRY_LENGTH;
+        nameOffset = get_le_number(entry, 4);
+        kind = get_le_number(entry + 4, 4);
+        codeOffset = get_le_number(entry + 12, 4);
+        codeLength = get_le_number(entry + 16, 4);
+        if (nameOffset >= image->size || memchr(data + nameOffset, '\0', image->size - nameOffset) == NULL ||
+            (kind != LIBRARY_MACRO && kind != LIBRARY_CONSTANT) || codeOffset > image->size || codeLength > image->size - codeOffset) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+const MacroLibrary* load_library(const char* path) {
+    MacroLibrary* library;
+    for (library = loadedLibraries; library != NULL; library = library->next) {
+        if (strcmp(library->path, path) == 0) {
+            return library;
+        }
+    }
+    library = malloc(sizeof(MacroLibrary));
+    if (library == NULL) {
+        return NULL;
+    }
+    library->path = duplicate_string(path);
+    if (library->path == NULL || map_file(path, &library->image) != 0) {
+        if (library->path != NULL) free(library->path);
+        free(library);
+        return NULL;
+    }
+    if (!is_valid_image(&library->image, &library->entryCount, &library->slotCount)) {
+        unmap_file(&library->image);
+        free(library->path);
+        free(library);
+        return NULL;
+    }
+    library->next = loadedLibraries;
+    loadedLibraries = library;
+    return library;
+}
+
+int use_library(const char* path) {
+    const MacroLibrary* library = load_library(path);
+    if (library == NULL || defaultLibraries.count == MAX_FILE_LIBRARIES) {
+        return 1;
+    }
+    defaultLibraries.libraries[defaultLibraries.count++] = library;
+    return 0;
+}
+
+void begin_file_libraries(void) {
+    fileLibraries = defaultLibraries;
+}
+
+int import_library(const MacroLibrary* library) {
+    int i;
+    for (i = 0; i < fileLibraries.count; i++) {
+        if (fileLibraries.libraries[i] == library) {
+            return 0;
+        }
+    }
+    if (fileLibraries.count == MAX_FILE_LIBRARIES) {
+        return 1;
+    }
+    fileLibraries.libraries[fileLibraries.count++] = library;
+    return 0;
+}
+
+void get_file_libraries(LibrarySet* set) {
+    *set = fileLibraries;
+}
+
+void set_file_libraries(const LibrarySet* set) {
+    fileLibraries = *set;
+}
+
+/* the find_entry function finds a name in the libraries of the file, the ones that were imported last first.
+    returns the entry in the image and sets the library it is in, or returns NULL if no library has it */
+static const unsigned char* find_entry(const char* name, const MacroLibrary** found) {
+    const MacroLibrary* library;
+    const unsigned char* data, *entry;
+    unsigned long hash = library_hash(name), slot, index, probes;
+    int i;
+
+    for (i = fileLibraries.count - 1; i >= 0; i--) {
+        library = fileLibraries.libraries[i];
+        data = (const unsigned char*)library->image.data;
+        slot = hash & (library->slotCount - 1);
+        for (probes = 0; probes < library->slotCount; probes++) {
+            index = get_le_number(data + LIBRARY_HEADER_LENGTH + slot * 4, 4);
+            if (index == 0) {
+                break;
+            }
+            entry = data + LIBRARY_HEADER_LENGTH + library->slotCount * 4 + (index - 1) * LIBRARY_ENTRY_LENGTH;
+            if (strcmp((const char*)data + get_le_number(entry, 4), name) == 0) {
+                *found = library;
+                return entry;
+            }
+            slot = (slot + 1) & (library->slotCount - 1);
+        }
+    }
+    return NULL;
+}
+
+int library_macro(const char* name, const char** code, size_t* length) {
+    const MacroLibrary* library;
+    const unsigned char* entry;
+    if (fileLibraries.count == 0 || (entry = find_entry(name, &library)) == NULL || get_le_number(entry + 4, 4) != LIBRARY_MACRO) {
+        return -1;
+    }
+    *code = library->image.data + get_le_number(entry + 12, 4);
+    *length = get_le_number(entry + 16, 4);
+    return (int)get_le_number(entry + 8, 4);
+}
+
+boolean library_constant(const char* name, int* value) {
+    const MacroLibrary* library;
+    const unsigned char* entry;
+    unsigned long number;
+    if (fileLibraries.count == 0 || (entry = find_entry(name, &library)) == NULL || get_le_number(entry + 4, 4) != LIBRARY_CONSTANT) {
+        return FALSE;
+    }
+    number = get_le_number(entry + 8, 4);
+    /* the value was written as 32 bits, negative values are sign extended back */
+    *value = number & 0x80000000UL ? (int)-(long)((~number & 0x7FFFFFFFUL) + 1) : (int)number;
+    return TRUE;
+}
+
+boolean library_defines(const char* name) {
+    const MacroLibrary* library;
+    return fileLibraries.count > 0 && find_entry(name, &library) != NULL;
+}
+
+void free_libraries(void) {
+    MacroLibrary* next;
+    while (loadedLibraries != NULL) {
+        next = loadedLibraries->next;
+        unmap_file(&loadedLibraries->image);
+        free(loadedLibraries->path);
+        free(loadedLibraries);
+        loadedLibraries = next;
+    }
+    defaultLibraries.count = 0;
+    fileLibraries.count = 0;
+}
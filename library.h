@@ -0,0 +1,84 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <stddef.h>
+#include "structs.h"
+#include "mapped_file.h"
+
+/* A library is an image of the macros and the constants of a .as file that has only mcr and .define statements.
+ The image is made once with compile_library, and a file uses it with the .import "PATH" directive or with the --library option
+ of the assembler, instead of defining the same macros and constants again.
+ The image is memory-mapped read-only and its names are looked up in place, so nothing of it is tokenized or copied
+ when a file uses it, and every file of a batch (and every build of a watched or open file) shares the same mapping.
+ Layout:
+    LIBRARY_MAGIC
+    header:   number of entries (4 bytes), number of slots (4 bytes, a power of 2)
+    slots:    for each slot - the index of an entry plus 1 (4 bytes), 0 for an empty slot. the slot of a name is found
+              with library_hash and the following slots (open addressing)
+    entries:  for each entry - the offset of its name (4 bytes), its kind (4 bytes), the value of a constant or the number of
+              lines of a macro (4 bytes), the offset of the code of a macro (4 bytes), the length of the code (4 bytes)
+    strings:  the names, ending with '\0', and the code of the macros as it is written to the am file
+ All of the numbers are little-endian, and the offsets are from the start of the image. */
+
+#define LIBRARY_MAGIC "ASMLIB01"
+#define LIBRARY_MAGIC_LENGTH 8
+#define LIBRARY_HEADER_LENGTH (LIBRARY_MAGIC_LENGTH + 4 + 4)
+#define LIBRARY_ENTRY_LENGTH 20
+#define IMPORT_DIRECTIVE ".import"
+#define MAX_FILE_LIBRARIES 16 /* the most libraries that a file can use, with the ones of --library */
+
+/* The kinds of the names of a library */
+typedef enum {
+    LIBRARY_MACRO = 1,
+    LIBRARY_CONSTANT = 2
+} LibraryEntryKind;
+
+/* A library that was loaded. it stays mapped until free_libraries */
+typedef struct MacroLibrary {
+    char* path;
+    MappedFile image;
+    unsigned long entryCount;
+    unsigned long slotCount;
+    struct MacroLibrary* next; /* the next library that was loaded */
+} MacroLibrary;
+
+/* The libraries that a file uses, the ones that were imported last are searched first */
+typedef struct {
+    const MacroLibrary* libraries[MAX_FILE_LIBRARIES];
+    int count;
+} LibrarySet;
+
+/* the compile_library function compiles the macros and the constants of the .as file sourceName into a library image at imageName.
+    the errors are reported like the errors of a file that is assembled. returns 0 on success and 1 on failure */
+int compile_library(const char* sourceName, const char* imageName, int maxErrors);
+
+/* the load_library function maps the library at path, or finds it if it was already loaded. returns NULL if it isn't a valid library */
+const MacroLibrary* load_library(const char* path);
+
+/* the use_library function adds a library that every file uses (the --library option). returns 0 on success */
+int use_library(const char* path);
+
+/* the begin_file_libraries function starts the libraries of a new file, with only the ones of use_library */
+void begin_file_libraries(void);
+
+/* the import_library function adds a library to the libraries of the file. returns 0 on success, and 1 if there are too many */
+int import_library(const MacroLibrary* library);
+
+/* the get_file_libraries and set_file_libraries functions save and restore the libraries of the file, to build it again later */
+void get_file_libraries(LibrarySet* set);
+void set_file_libraries(const LibrarySet* set);
+
+/* the library_macro function finds a macro of the libraries of the file. the code is set in code and its length in length,
+    and the number of its lines is returned. returns -1 if there's no such macro */
+int library_macro(const char* name, const char** code, size_t* length);
+
+/* the library_constant function finds a constant of the libraries of the file, and sets its value. returns FALSE if there's no such constant */
+boolean library_constant(const char* name, int* value);
+
+/* the library_defines function checks if a name is a macro or a constant of the libraries of the file */
+boolean library_defines(const char* name);
+
+/* the free_libraries function unmaps all of the libraries that were loaded */
+void free_libraries(void);
+
+#endif
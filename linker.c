@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "object_file.h"
+#include "constants.h"
+#include "isa.h"
+#include "utils.h"
+#include "word_image.h"
+#include "output_buffer.h"
+#include "batch_io.h"
+#include "writeOutputFiles.h"
+#include "data_structures/hashtable.h"
+
+/* An entry of the global entry table: where the symbol is in the linked image, and which file defined it */
+typedef struct {
+    int address;
+    int object;
+} LinkedEntry;
+
+/* the build_entry_table function adds the entries of every object to the table, at their linked addresses.
+    returns 1 if a symbol is an entry of more than one file */
+static int build_entry_table(const ObjectFile* objects, int count, const int* codeStarts, const int* dataStarts, hashtable* entries) {
+    LinkedEntry entry;
+    LinkedEntry* found;
+    int i, j, error = 0;
+    for (i = 0; i < count; i++) {
+        for (j = 0; j < objects[i].entryCount; j++) {
+            found = (LinkedEntry*)search(entries, objects[i].entries[j].name);
+            if (found != NULL) {
+                fprintf(stderr, "Error in file \"%s.ent\" on line %d: The symbol \"%s\" is already an entry of file \"%s\"\n",
+                    objects[i].name, objects[i].entries[j].line, objects[i].entries[j].name, objects[found->object].name);
+                error = 1;
+                continue;
+            }
+            entry.address = relocate_object_address(&objects[i], objects[i].entries[j].address, codeStarts[i], dataStarts[i]);
+            entry.object = i;
+            if (entry.address < 0) {
+                fprintf(stderr, "Error in file \"%s.ent\" on line %d: The address %04d of symbol \"%s\" is outside of the file\n",
+                    objects[i].name, objects[i].entries[j].line, objects[i].entries[j].address, objects[i].entries[j].name);
+                error = 1;
+            } else if (insert(entries, objects[i].entries[j].name, &entry, sizeof(LinkedEntry)) != 0) {
+                fprintf(stderr, "Failed to allocate memory for the entry table\n");
+                return 1;
+            }
+        }
+    }
+    return error;
+}
+
+/* the link_object function copies the words of an object into the linked image at its linked addresses.
+    every relocatable word is moved with the object it points into, and every use of an external is patched
+    with the address of the entry it refers to */
+static int link_object(const ObjectFile* object, int codeStart, int dataStart, hashtable* entries, WordImage* image) {
+    LinkedEntry* found;
+    int i, word, address, site, error = 0;
+
+    for (i = 0; i < object->codeLength; i++) {
+        word = object->words[i];
+        if ((word & 3) == ARE_RELOCATABLE) {
+            /* an address inside the object, that moves with it */
+            address = relocate_object_address(object, word >> OPERAND_VALUE_SHIFT, codeStart, dataStart);
+            if (address < 0) {
+                fprintf(stderr, "Error in file \"%s.ob\": The word at address %04d points outside of the file\n", object->name, START_POSITION + i);
+                error = 1;
+            } else if (address > MAX_OPERAND_ADDRESS) {
+                fprintf(stderr, "Error in file \"%s.ob\": The address %d of the word at address %04d does not fit in an operand\n", object->name, address, START_POSITION + i);
+                error = 1;
+            }
+            word = (address << OPERAND_VALUE_SHIFT) | ARE_RELOCATABLE;
+        }
+        set_image_word(image, codeStart + i, word);
+    }
+    for (i = 0; i < object->dataLength; i++) {
+        set_image_word(image, dataStart + i, object->words[object->codeLength + i]);
+    }
+
+    for (i = 0; i < object->externalCount; i++) {
+        site = object->externals[i].address - START_POSITION;
+        if (site < 0 || site >= object->codeLength || (object->words[site] & 3) != ARE_EXTERNAL) {
+            fprintf(stderr, "Error in file \"%s.ext\" on line %d: The word at address %04d is not a use of an external\n",
+                object->name, object->externals[i].line, object->externals[i].address);
+            error = 1;
+            continue;
+        }
+        found = (LinkedEntry*)search(entries, object->externals[i].name);
+        if (found == NULL) {
+            fprintf(stderr, "Error in file \"%s.ext\" on line %d: The external symbol \"%s\" is not an entry of any file\n",
+                object->name, object->externals[i].line, object->externals[i].name);
+            error = 1;
+        } else if (found->address > MAX_OPERAND_ADDRESS) {
+            fprintf(stderr, "Error in file \"%s.ext\" on line %d: The address %d of symbol \"%s\" does not fit in an operand\n",
+                object->name, object->externals[i].line, found->address, object->externals[i].name);
+            error = 1;
+        } else {
+            /* the use now points into the linked image, like any other symbol */
+            set_image_word(image, codeStart + site, (found->address << OPERAND_VALUE_SHIFT) | ARE_RELOCATABLE);
+        }
+    }
+    return error;
+}
+
+/* the collect_garbage function keeps only the objects that can be reached from the object that defines the root entry,
+    by following the uses of externals to the objects that define them. the other objects are freed and removed from
+    the array, and count is updated. an external is followed to the first object that has it as an entry */
+static int collect_garbage(ObjectFile* objects, int* count, const char* root) {
+    hashtable* definedBy;
+    int *reached, *pending;
+    int* found;
+    int i, j, pendingCount = 0, kept = 0, error = 0;
+
+    definedBy = create_hashtable();
+    reached = calloc(*count, sizeof(int));
+    pending = malloc(*count * sizeof(int));
+    if (definedBy == NULL || reached == NULL || pending == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the reference graph\n");
+        error = 1;
+        goto end;
+    }
+    for (i = 0; i < *count; i++) {
+        for (j = 0; j < objects[i].entryCount; j++) {
+            if (search(definedBy, objects[i].entries[j].name) == NULL &&
+                insert(definedBy, objects[i].entries[j].name, &i, sizeof(int)) != 0) {
+                fprintf(stderr, "Failed to allocate memory for the reference graph\n");
+                error = 1;
+                goto end;
+            }
+        }
+    }
+
+    found = (int*)search(definedBy, root);
+    if (found == NULL) {
+        fprintf(stderr, "Error: The root symbol \"%s\" is not an entry of any file\n", root);
+        error = 1;
+        goto end;
+    }
+    /* every object is added to the pending objects once, when it is first reached */
+    reached[*found] = 1;
+    pending[pendingCount++] = *found;
+    while (pendingCount > 0) {
+        i = pending[--pendingCount];
+        for (j = 0; j < objects[i].externalCount; j++) {
+            found = (int*)search(definedBy, objects[i].externals[j].name);
+            if (found != NULL && !reached[*found]) {
+                reached[*found] = 1;
+                pending[pendingCount++] = *found;
+            }
+        }
+    }
+
+    for (i = 0; i < *count; i++) {
+        if (reached[i]) {
+            objects[kept++] = objects[i];
+        } else {
+            printf("Dropping file \"%s\", it isn't used by \"%s\"\n", objects[i].name, root);
+            free_object(&objects[i]);
+        }
+    }
+    *count = kept;
+
+    end:
+    if (definedBy != NULL) free_hashtable(definedBy);
+    if (reached != NULL) free(reached);
+    if (pending != NULL) free(pending);
+    return error;
+}
+
+/* the write_linked_image function writes the linked image as an .ob file */
+static int write_linked_image(const char* name, const WordImage* image, int codeLength, int dataLength) {
+    OutputBuffer obFile;
+    char line[32];
+    char* obName;
+    char* encrypted;
+    int i, error;
+
+    obName = concatenate_strings(name, ".ob");
+    if (obName == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the name of the linked file\n");
+        return 1;
+    }
+    init_output_buffer(&obFile, NULL);
+    sprintf(line, "%4d %d\n", codeLength, dataLength); /* the title of the file */
+    output_puts(&obFile, line);
+    for (i = START_POSITION; i < START_POSITION + codeLength + dataLength; i++) {
+        encrypted = encrypt(image_word(image, i));
+        sprintf(line, "%04d %s\n", i, encrypted);
+        output_puts(&obFile, line);
+        free(encrypted);
+    }
+    error = obFile.failed || write_output_file(obName, &obFile) != 0;
+    if (error) {
+        fprintf(stderr, "Error writing file \"%s\"\n", obName);
+    }
+    free_output_buffer(&obFile);
+    free(obName);
+    return error;
+}
+
+/**
+ * The main function of the linker.
+ * It reads the objects that the assembler created for every file (file.ob, and file.ent and file.ext if they exist)
+ * and links them into a single .ob file. The code of all of the files comes first, in the order they were given,
+ * and then the data of all of the files. every use of an external is resolved to the entry with the same name.
+ * Options:
+ *   --output=NAME   the name of the linked file, without the extension (default "linked")
+ *   --memory-size=N the number of words in the memory of the target machine (default 4096, at most 65536)
+ *   --gc=ROOT       only link the files that are used, starting from the file that has the entry ROOT
+ *                   and following the externals of every linked file to the files that define them
+*/
+int main(int argc, char **argv) {
+    ObjectFile* objects;
+    int *codeStarts, *dataStarts;
+    int i, count = 0, codeLength = 0, dataLength = 0, memorySize = MEMORY_SIZE, error = 0;
+    const char* outputName = "linked";
+    const char* gcRoot = NULL;
+    hashtable* entries = NULL;
+    WordImage image;
+
+    objects = calloc(argc, sizeof(ObjectFile));
+    codeStarts = malloc(argc * sizeof(int));
+    dataStarts = malloc(argc * sizeof(int));
+    if (objects == NULL || codeStarts == NULL || dataStarts == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the files\n");
+        free(objects);
+        free(codeStarts);
+        free(dataStarts);
+        return 1;
+    }
+
+    for (i = 1; i < argc && !error; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            error = load_object(argv[i], &objects[count]);
+            if (!error) {
+                count++;
+            }
+        } else if (strncmp(argv[i], "--output=", 9) == 0 && argv[i][9] != '\0') {
+            outputName = argv[i] + 9;
+        } else if (strncmp(argv[i], "--gc=", 5) == 0 && argv[i][5] != '\0') {
+            gcRoot = argv[i] + 5;
+        } else if (strncmp(argv[i], "--memory-size=", 14) == 0 && is_number(argv[i] + 14) && argv[i][14] != '\0'
+            && get_number(argv[i] + 14) > START_POSITION && get_number(argv[i] + 14) <= MAX_MEMORY_SIZE) {
+            memorySize = get_number(argv[i] + 14);
+        } else {
+            fprintf(stderr, "Unknown option \"%s\", exiting program.\n", argv[i]);
+            error = 1;
+        }
+    }
+    if (!error && count == 0) {
+        fprintf(stderr, "No files specified, exiting program.\n");
+        error = 1;
+    }
+    if (!error && gcRoot != NULL) {
+        error = collect_garbage(objects, &count, gcRoot);
+    }
+    if (error) {
+        goto end;
+    }
+
+    /* the code of every file is placed after the code of the files before it, and the data after all of the code */
+    for (i = 0; i < count; i++) {
+        codeStarts[i] = START_POSITION + codeLength;
+        codeLength += objects[i].codeLength;
+    }
+    for (i = 0; i < count; i++) {
+        dataStarts[i] = START_POSITION + codeLength + dataLength;
+        dataLength += objects[i].dataLength;
+    }
+    if (START_POSITION + codeLength + dataLength > memorySize) {
+        fprintf(stderr, "Error: The linked program is too large\n");
+        error = 1;
+        goto end;
+    }
+
+    entries = create_hashtable();
+    if (entries == NULL || init_word_image(&image, memorySize) != 0) {
+        fprintf(stderr, "Failed to allocate memory for the linked image\n");
+        error = 1;
+        goto end;
+    }
+    error = build_entry_table(objects, count, codeStarts, dataStarts, entries);
+    for (i = 0; i < count; i++) {
+        error |= link_object(&objects[i], codeStarts[i], dataStarts[i], entries, &image);
+    }
+    if (image.failed) {
+        fprintf(stderr, "Failed to allocate memory for the linked image\n");
+        error = 1;
+    }
+    if (!error) {
+        printf("Linking %d files into \"%s.ob\"\n", count, outputName);
+        error = write_linked_image(outputName, &image, codeLength, dataLength);
+    }
+    free_word_image(&image);
+
+    end:
+    if (entries != NULL) free_hashtable(entries);
+    for (i = 0; i < count; i++) {
+        free_object(&objects[i]);
+    }
+    free(objects);
+    free(codeStarts);
+    free(dataStarts);
+    return error;
+}
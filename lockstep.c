@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "lockstep.h"
+#include "constants.h"
+#include "globals.h"
+#include "isa.h"
+
+/* the BLEND macro keeps old in the lanes where mask is 0, and takes value in the lanes where it is 0xFFFF.
+    the loops over the lanes don't branch, so the compiler can run them on many lanes at once */
+#define BLEND(old, value, mask) ((unsigned short)(((old) & ~(mask)) | ((value) & (mask))))
+
+/* the create_lockstep function readies MAX_LANES lanes with memorySize words of memory each.
+    returns 0 on success and 1 if the memory could not be allocated */
+int create_lockstep(Lockstep* lockstep, int memorySize) {
+    memset(lockstep, 0, sizeof(Lockstep));
+    if (create_machine(&lockstep->code, memorySize) != 0) {
+        return 1;
+    }
+    lockstep->memory = calloc((size_t)memorySize * MAX_LANES, sizeof(unsigned short));
+    lockstep->stacks = malloc(MAX_LANES * MACHINE_STACK_SIZE * sizeof(int));
+    if (lockstep->memory == NULL || lockstep->stacks == NULL) {
+        free_lockstep(lockstep);
+        return 1;
+    }
+    return 0;
+}
+
+/* the load_lockstep function loads an object into laneCount lanes, that start running at address 100 without limits or input.
+    returns 0 on success and 1 on error */
+int load_lockstep(Lockstep* lockstep, const ObjectFile* object, int laneCount) {
+    int address, lane;
+    if (laneCount < 1 || laneCount > MAX_LANES || load_machine(&lockstep->code, object) != 0) {
+        return 1;
+    }
+    lockstep->laneCount = laneCount;
+    for (address = 0; address < lockstep->code.memorySize; address++) {
+        for (lane = 0; lane < laneCount; lane++) {
+            lockstep->memory[address * MAX_LANES + lane] = lockstep->code.memory[address];
+        }
+    }
+    memset(lockstep->registers, 0, sizeof(lockstep->registers));
+    memset(lockstep->zero, 0, sizeof(lockstep->zero));
+    memset(lockstep->stackDepth, 0, sizeof(lockstep->stackDepth));
+    memset(lockstep->steps, 0, sizeof(lockstep->steps));
+    memset(lockstep->maxSteps, 0, sizeof(lockstep->maxSteps));
+    for (lane = 0; lane < MAX_LANES; lane++) {
+        lockstep->pc[lane] = START_POSITION;
+        lockstep->status[lane] = LANE_RUNNING;
+        lockstep->input[lane] = NULL;
+        lockstep->output[lane] = NULL;
+    }
+    lockstep->groupSteps = 0;
+    return 0;
+}
+
+/* the lane_values function copies the value of an operand in every lane to values. the copy is a local array of the caller,
+    that can't be the destination of the instruction, so the compiler runs the loops that use it on many lanes at once */
+static void lane_values(const Lockstep* lockstep, const DecodedOperand* operand, unsigned short* values) {
+    int lane;
+    switch (operand->kind) {
+        case OPERAND_KIND_REGISTER:
+            memcpy(values, lockstep->registers[operand->value], MAX_LANES * sizeof(unsigned short));
+            break;
+        case OPERAND_KIND_MEMORY:
+            memcpy(values, &lockstep->memory[operand->value * MAX_LANES], MAX_LANES * sizeof(unsigned short));
+            break;
+        default:
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                values[lane] = (unsigned short)operand->value;
+            }
+            break;
+    }
+}
+
+/* the lane_words function returns where the destination of an instruction is in every lane */
+static unsigned short* lane_words(Lockstep* lockstep, const DecodedOperand* operand) {
+    return operand->kind == OPERAND_KIND_REGISTER ? lockstep->registers[operand->value] : &lockstep->memory[operand->value * MAX_LANES];
+}
+
+/* the set_status function changes the status of the lanes in the mask */
+static void set_status(Lockstep* lockstep, const unsigned short* mask, LaneStatus status) {
+    int lane;
+    for (lane = 0; lane < lockstep->laneCount; lane++) {
+        if (mask[lane]) {
+            lockstep->status[lane] = status;
+        }
+    }
+}
+
+/* the write_pcs function sets the address of every lane of the mask */
+static void write_pcs(Lockstep* lockstep, const unsigned short* mask, int pc) {
+    int lane;
+    for (lane = 0; lane < lockstep->laneCount; lane++) {
+        lockstep->pc[lane] = mask[lane] ? pc : lockstep->pc[lane];
+    }
+}
+
+/* the lanes_agree function checks if all of the lanes of the mask are still running, at the same address that is put in pc */
+static boolean lanes_agree(const Lockstep* lockstep, const unsigned short* mask, int* pc) {
+    int lane, address = -1;
+    for (lane = 0; lane < lockstep->laneCount; lane++) {
+        if (!mask[lane]) {
+            continue;
+        }
+        if (lockstep->status[lane] != LANE_RUNNING || (address >= 0 && lockstep->pc[lane] != address)) {
+            return FALSE;
+        }
+        address = lockstep->pc[lane];
+    }
+    *pc = address;
+    return TRUE;
+}
+
+/* the step_group function runs the instruction at pc in the lanes of the mask, whose own addresses aren't kept up to date while they
+    run together. returns TRUE if all of the lanes went on to the same address, that is put in pc. otherwise the group ends:
+    the address of every lane of the mask is written, and the lanes that stopped have their new status */
+static boolean step_group(Lockstep* lockstep, const unsigned short* mask, int* pc) {
+    unsigned short source[MAX_LANES], values[MAX_LANES];
+    unsigned short* destination;
+    const DecodedOperand* target;
+    DecodedInstruction* instruction;
+    int address = *pc, lane, next, value, *stack;
+
+    /* the code is the same in every lane, so an address that can't run faults in all of the lanes that are at it.
+        the error is written once for all of them */
+    if (address < START_POSITION || address >= lockstep->code.codeEnd) {
+        fprintf(stderr, "Error at address %04d: The program counter %d is outside of the code\n", address, address);
+        set_status(lockstep, mask, LANE_FAULT);
+        write_pcs(lockstep, mask, address);
+        return FALSE;
+    }
+    instruction = &lockstep->code.decoded[address];
+    if (instruction->length == 0 && decode_instruction(&lockstep->code, address, instruction, TRUE) != 0) {
+        set_status(lockstep, mask, LANE_FAULT);
+        write_pcs(lockstep, mask, address);
+        return FALSE;
+    }
+    if (writes_code(&lockstep->code, instruction)) {
+        /* after the write the code of the lanes isn't the same anymore */
+        set_status(lockstep, mask, LANE_DETACHED);
+        write_pcs(lockstep, mask, address);
+        return FALSE;
+    }
+    next = address + instruction->length;
+    lockstep->groupSteps++;
+    for (lane = 0; lane < MAX_LANES; lane++) {
+        lockstep->steps[lane] += mask[lane] & 1;
+    }
+    target = &instruction->destination;
+
+    switch (instruction->opcode) {
+        case ENUM_MOV:
+            lane_values(lockstep, &instruction->source, source);
+            destination = lane_words(lockstep, target);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                destination[lane] = BLEND(destination[lane], source[lane], mask[lane]);
+            }
+            break;
+        case ENUM_CMP:
+            lane_values(lockstep, &instruction->source, source);
+            lane_values(lockstep, target, values);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                lockstep->zero[lane] = BLEND(lockstep->zero[lane], ((source[lane] - values[lane]) & WORD_MASK) == 0, mask[lane]);
+            }
+            break;
+        case ENUM_ADD:
+        case ENUM_SUB:
+            lane_values(lockstep, &instruction->source, source);
+            destination = lane_words(lockstep, target);
+            if (instruction->opcode == ENUM_ADD) {
+                for (lane = 0; lane < MAX_LANES; lane++) {
+                    destination[lane] = BLEND(destination[lane], (destination[lane] + source[lane]) & WORD_MASK, mask[lane]);
+                }
+            } else {
+                for (lane = 0; lane < MAX_LANES; lane++) {
+                    destination[lane] = BLEND(destination[lane], (destination[lane] - source[lane]) & WORD_MASK, mask[lane]);
+                }
+            }
+            break;
+        case ENUM_NOT:
+            destination = lane_words(lockstep, target);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                destination[lane] = BLEND(destination[lane], ~destination[lane] & WORD_MASK, mask[lane]);
+            }
+            break;
+        case ENUM_CLR:
+        case ENUM_LEA:
+            value = instruction->opcode == ENUM_LEA ? instruction->source.value : 0;
+            destination = lane_words(lockstep, target);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                destination[lane] = BLEND(destination[lane], value, mask[lane]);
+            }
+            break;
+        case ENUM_INC:
+        case ENUM_DEC:
+            value = instruction->opcode == ENUM_INC ? 1 : -1;
+            destination = lane_words(lockstep, target);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                destination[lane] = BLEND(destination[lane], (destination[lane] + value) & WORD_MASK, mask[lane]);
+            }
+            break;
+        case ENUM_RED:
+            destination = lane_words(lockstep, target);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                if (mask[lane]) {
+                    value = lockstep->input[lane] != NULL ? getc(lockstep->input[lane]) : EOF;
+                    destination[lane] = value == EOF ? WORD_MASK : value;
+                }
+            }
+            break;
+        case ENUM_PRN:
+            lane_values(lockstep, target, values);
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                if (mask[lane] && lockstep->output[lane] != NULL) {
+                    putc(values[lane] & 0xFF, lockstep->output[lane]);
+                }
+            }
+            break;
+        case ENUM_JMP:
+        case ENUM_BNE:
+            if (instruction->opcode == ENUM_JMP && target->kind != OPERAND_KIND_REGISTER) {
+                *pc = target->value;
+                return TRUE;
+            }
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                if (mask[lane]) {
+                    value = target->kind == OPERAND_KIND_REGISTER ? lockstep->registers[target->value][lane] : target->value;
+                    lockstep->pc[lane] = instruction->opcode == ENUM_BNE && lockstep->zero[lane] ? next : value;
+                }
+            }
+            return lanes_agree(lockstep, mask, pc);
+        case ENUM_JSR:
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                if (!mask[lane]) {
+                    continue;
+                }
+                if (lockstep->stackDepth[lane] == MACHINE_STACK_SIZE) {
+                    fprintf(stderr, "Error at address %04d: The stack is full after %d calls\n", address, MACHINE_STACK_SIZE);
+                    lockstep->status[lane] = LANE_FAULT;
+                    lockstep->pc[lane] = address;
+                    continue;
+                }
+                stack = lockstep->stacks + lane * MACHINE_STACK_SIZE;
+                stack[lockstep->stackDepth[lane]++] = next;
+                lockstep->pc[lane] = target->kind == OPERAND_KIND_REGISTER ? lockstep->registers[target->value][lane] : target->value;
+            }
+            return lanes_agree(lockstep, mask, pc);
+        case ENUM_RTS:
+            for (lane = 0; lane < MAX_LANES; lane++) {
+                if (!mask[lane]) {
+                    continue;
+                }
+                if (lockstep->stackDepth[lane] == 0) {
+                    fprintf(stderr, "Error at address %04d: rts without a call\n", address);
+                    lockstep->status[lane] = LANE_FAULT;
+                    lockstep->pc[lane] = address;
+                    continue;
+                }
+                stack = lockstep->stacks + lane * MACHINE_STACK_SIZE;
+                lockstep->pc[lane] = stack[--lockstep->stackDepth[lane]];
+            }
+            return lanes_agree(lockstep, mask, pc);
+        default: /* hlt */
+            set_status(lockstep, mask, LANE_HALTED);
+            write_pcs(lockstep, mask, address);
+            return FALSE;
+    }
+    *pc = next;
+    return TRUE;
+}
+
+/* the run_lockstep function runs the lanes until none of them is running, or until groupSteps reaches maxGroupSteps (0 for no limit).
+    the lanes that are at the lowest address run together as a group, so lanes that went different ways meet again where the ways join.
+    returns the number of lanes that are still running */
+int run_lockstep(Lockstep* lockstep, unsigned long maxGroupSteps) {
+    unsigned short mask[MAX_LANES];
+    unsigned long budget, ran;
+    int count = lockstep->laneCount, lane, pc, running;
+
+    for (;;) {
+        pc = INT_MAX;
+        running = 0;
+        for (lane = 0; lane < count; lane++) {
+            if (lockstep->status[lane] != LANE_RUNNING) {
+                continue;
+            }
+            if (lockstep->maxSteps[lane] > 0 && lockstep->steps[lane] >= lockstep->maxSteps[lane]) {
+                lockstep->status[lane] = LANE_STEP_LIMIT;
+                continue;
+            }
+            running++;
+            if (lockstep->pc[lane] < pc) {
+                pc = lockstep->pc[lane];
+            }
+        }
+        if (running == 0 || (maxGroupSteps > 0 && lockstep->groupSteps >= maxGroupSteps)) {
+            return running;
+        }
+        /* the group can run until the first of its lanes reaches its maximum number of instructions */
+        budget = ULONG_MAX;
+        for (lane = 0; lane < MAX_LANES; lane++) {
+            mask[lane] = lane < count && lockstep->status[lane] == LANE_RUNNING && lockstep->pc[lane] == pc ? 0xFFFF : 0;
+            if (mask[lane] && lockstep->maxSteps[lane] > 0 && lockstep->maxSteps[lane] - lockstep->steps[lane] < budget) {
+                budget = lockstep->maxSteps[lane] - lockstep->steps[lane];
+            }
+        }
+
+        for (ran = 1; step_group(lockstep, mask, &pc); ran++) {
+            if (ran == budget || (maxGroupSteps > 0 && lockstep->groupSteps >= maxGroupSteps)) {
+                write_pcs(lockstep, mask, pc);
+                break;
+            }
+        }
+    }
+}
+
+/* the detach_lane function copies the state of a lane to a machine with the same memory size, so it can continue with run_machine */
+void detach_lane(const Lockstep* lockstep, int lane, Machine* machine) {
+    int address, i;
+    for (address = 0; address < machine->memorySize; address++) {
+        machine->memory[address] = lockstep->memory[address * MAX_LANES + lane];
+    }
+    machine->codeEnd = lockstep->code.codeEnd;
+    memset(machine->decoded, 0, machine->memorySize * sizeof(DecodedInstruction));
+    memset(machine->dirty, 1, MACHINE_PAGE_COUNT(machine->memorySize));
+    for (i = 0; i < REGISTER_COUNT; i++) {
+        machine->registers[i] = lockstep->registers[i][lane];
+    }
+    machine->pc = lockstep->pc[lane];
+    machine->zero = lockstep->zero[lane] ? TRUE : FALSE;
+    machine->stackDepth = lockstep->stackDepth[lane];
+    memcpy(machine->stack, lockstep->stacks + lane * MACHINE_STACK_SIZE, machine->stackDepth * sizeof(int));
+    machine->steps = lockstep->steps[lane];
+}
+
+/* the free_lockstep function frees the memory of the lanes */
+void free_lockstep(Lockstep* lockstep) {
+    free_machine(&lockstep->code);
+    if (lockstep->memory != NULL) free(lockstep->memory);
+    if (lockstep->stacks != NULL) free(lockstep->stacks);
+    lockstep->memory = NULL;
+    lockstep->stacks = NULL;
+}
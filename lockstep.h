@@ -0,0 +1,58 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <stdio.h>
+#include "machine.h"
+#include "object_file.h"
+
+#define MAX_LANES 64 /* the most copies of a program that run together */
+
+/* The states of a lane */
+typedef enum {
+    LANE_RUNNING,
+    LANE_HALTED,
+    LANE_STEP_LIMIT, /* the lane ran its maximum number of instructions */
+    LANE_FAULT,
+    LANE_DETACHED, /* the lane is about to write into the code, so it has to continue on a machine of its own (detach_lane) */
+    LANE_STOPPED /* the lane was stopped by the caller */
+} LaneStatus;
+
+/* Copies of one program that run together, each of them with its own input. Every register and every word of the memory
+    is kept for all of the lanes side by side, so an instruction runs on all of the lanes that are at it in the same loops */
+typedef struct {
+    int laneCount;
+    Machine code; /* the code of the program, that is the same in every lane, and its decoded instructions */
+    unsigned short* memory; /* the word at an address of a lane is memory[address * MAX_LANES + lane] */
+    unsigned short registers[REGISTER_COUNT][MAX_LANES];
+    unsigned short zero[MAX_LANES]; /* the Z flag of every lane */
+    int pc[MAX_LANES];
+    int* stacks; /* MACHINE_STACK_SIZE return addresses for every lane */
+    int stackDepth[MAX_LANES];
+    unsigned long steps[MAX_LANES];
+    unsigned long maxSteps[MAX_LANES]; /* 0 for no limit */
+    unsigned char status[MAX_LANES];
+    FILE* input[MAX_LANES]; /* what red reads in every lane, NULL for no input */
+    FILE* output[MAX_LANES]; /* where prn writes in every lane, NULL to drop the output */
+    unsigned long groupSteps; /* the number of instructions that ran, once for all of the lanes that ran them together */
+} Lockstep;
+
+/* the create_lockstep function readies MAX_LANES lanes with memorySize words of memory each.
+    returns 0 on success and 1 if the memory could not be allocated */
+int create_lockstep(Lockstep* lockstep, int memorySize);
+
+/* the load_lockstep function loads an object into laneCount lanes, that start running at address 100 without limits or input.
+    returns 0 on success and 1 on error */
+int load_lockstep(Lockstep* lockstep, const ObjectFile* object, int laneCount);
+
+/* the run_lockstep function runs the lanes until none of them is running, or until groupSteps reaches maxGroupSteps (0 for no limit).
+    the lanes that are at the lowest address run together, so lanes that went different ways meet again where the ways join.
+    returns the number of lanes that are still running */
+int run_lockstep(Lockstep* lockstep, unsigned long maxGroupSteps);
+
+/* the detach_lane function copies the state of a lane to a machine with the same memory size, so it can continue with run_machine */
+void detach_lane(const Lockstep* lockstep, int lane, Machine* machine);
+
+/* the free_lockstep function frees the memory of the lanes */
+void free_lockstep(Lockstep* lockstep);
+
+#endif
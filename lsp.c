@@ -0,0 +1,712 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include "lsp.h"
+#include "json.h"
+#include "incremental.h"
+#include "diagnostics.h"
+#include "output_buffer.h"
+#include "mapped_file.h"
+#include "constants.h"
+#include "utils.h"
+
+#define LSP_READ_SIZE 65536 /* the most that is read from the input at once */
+#define LSP_MAX_HEADER_LENGTH 1024
+
+/* The JSON-RPC error codes that the server answers with */
+#define LSP_PARSE_ERROR -32700
+#define LSP_INVALID_REQUEST -32600
+#define LSP_METHOD_NOT_FOUND -32601
+
+/* A document that the client opened. its text is the text in the editor, which may not be saved */
+typedef struct {
+    char* uri;
+    char* name; /* the path of the document without .as, for the diagnostics */
+    char* text;
+    size_t size;
+    size_t capacity;
+    size_t* lineStarts; /* the offset of every line of the text */
+    int lineCount;
+    int lineCapacity;
+    int version;
+    boolean changed; /* the text changed since its diagnostics were published */
+    IncrementalFile state; /* the last build of the text */
+} Document;
+
+/* The state of the server */
+typedef struct {
+    int input;
+    FILE* output;
+    char* buffer; /* the input that was read and not handled yet, from start to size */
+    size_t start;
+    size_t size;
+    size_t capacity;
+    OutputBuffer message; /* the body of the message that is written */
+    Document** documents;
+    int documentCount;
+    int documentCapacity;
+    const AssemblerOptions* options;
+    boolean shutdown; /* the client sent shutdown */
+    boolean exit; /* the client sent exit */
+} LanguageServer;
+
+/* the find_span function returns the first place that pattern is found in length characters of text, or NULL */
+static const char* find_span(const char* text, size_t length, const char* pattern) {
+    size_t patternLength = strlen(pattern);
+    const char *end = text + length, *found;
+    while (text + patternLength <= end && (found = memchr(text, pattern[0], end - text)) != NULL) {
+        if (found + patternLength <= end && memcmp(found, pattern, patternLength) == 0) {
+            return found;
+        }
+        text = found + 1;
+    }
+    return NULL;
+}
+
+/* the fill_buffer function reads more of the input into the buffer. returns 0 on success and 1 at the end of the input or on error */
+static int fill_buffer(LanguageServer* server) {
+    char* grown;
+    ssize_t count;
+    if (server->start > 0) {
+        /* the handled input is dropped first */
+        memmove(server->buffer, server->buffer + server->start, server->size - server->start);
+        server->size -= server->start;
+        server->start = 0;
+    }
+    if (server->capacity - server->size < LSP_READ_SIZE) {
+        grown = realloc(server->buffer, server->capacity + LSP_READ_SIZE);
+        if (grown == NULL) {
+            fprintf(stderr, "Failed to allocate memory for the input\n");
+            return 1;
+        }
+        server->buffer = grown;
+        server->capacity += LSP_READ_SIZE;
+    }
+    do {
+        count = read(server->input, server->buffer + server->size, server->capacity - server->size);
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+        return 1;
+    }
+    server->size += count;
+    return 0;
+}
+
+/* the input_pending function checks if there is a message that wasn't handled yet, without waiting for one */
+static boolean input_pending(LanguageServer* server) {
+    struct pollfd request;
+    if (server->start < server->size) {
+        return TRUE;
+    }
+    request.fd = server->input;
+    request.events = POLLIN;
+    return poll(&request, 1, 0) > 0;
+}
+
+/* the read_message function reads the next message, and sets body and length to its content, which stays in the buffer until the next call.
+    returns 0 on success and 1 at the end of the input or on error */
+static int read_message(LanguageServer* server, const char** body, size_t* length) {
+    const char *header, *headerEnd;
+    size_t headerLength, contentLength;
+    boolean hasLength;
+
+    while ((headerEnd = server->size - server->start < 4 ? NULL :
+        find_span(server->buffer + server->start, server->size - server->start, "\r\n\r\n")) == NULL) {
+        if (server->size - server->start > LSP_MAX_HEADER_LENGTH) {
+            fprintf(stderr, "The header of a message is too long\n");
+            return 1;
+        }
+        if (fill_buffer(server) != 0) {
+            return 1;
+        }
+    }
+    header = server->buffer + server->start;
+    headerLength = headerEnd - header;
+    hasLength = FALSE;
+    contentLength = 0;
+    /* the header fields are separated by \r\n, only Content-Length is used */
+    while (header < server->buffer + server->start + headerLength) {
+        if (strncasecmp(header, "Content-Length:", 15) == 0) {
+            contentLength = strtoul(header + 15, NULL, 10);
+            hasLength = TRUE;
+        }
+        header = find_span(header, server->buffer + server->start + headerLength - header, "\r\n");
+        header = header == NULL ? server->buffer + server->start + headerLength : header + 2;
+    }
+    if (!hasLength) {
+        fprintf(stderr, "A message has no Content-Length\n");
+        return 1;
+    }
+    headerLength += 4;
+    while (server->size - server->start < headerLength + contentLength) {
+        if (fill_buffer(server) != 0) {
+            return 1;
+        }
+    }
+    *body = server->buffer + server->start + headerLength;
+    *length = contentLength;
+    server->start += headerLength + contentLength;
+    return 0;
+}
+
+/* the send_message function writes the message that was built in server->message, with its header */
+static void send_message(LanguageServer* server) {
+    if (server->message.failed) {
+        fprintf(stderr, "Failed to allocate memory for a message\n");
+    } else {
+        fprintf(server->output, "Content-Length: %lu\r\n\r\n", (unsigned long)server->message.size);
+        fwrite(server->message.data, 1, server->message.size, server->output);
+        fflush(server->output);
+    }
+    server->message.size = 0;
+    server->message.failed = FALSE;
+}
+
+/* the begin_response function starts the response to the request with the given id, the result is written after it */
+static void begin_response(LanguageServer* server, const JsonValue* id) {
+    output_puts(&server->message, "{\"jsonrpc\":\"2.0\",\"id\":");
+    write_json_value(&server->message, id);
+    output_puts(&server->message, ",\"result\":");
+}
+
+/* the send_error function answers a request with an error */
+static void send_error(LanguageServer* server, const JsonValue* id, int code, const char* text) {
+    char number[32];
+    output_puts(&server->message, "{\"jsonrpc\":\"2.0\",\"id\":");
+    write_json_value(&server->message, id);
+    sprintf(number, "%d", code);
+    output_puts(&server->message, ",\"error\":{\"code\":");
+    output_puts(&server->message, number);
+    output_puts(&server->message, ",\"message\":");
+    write_json_string(&server->message, text, strlen(text));
+    output_puts(&server->message, "}}");
+    send_message(server);
+}
+
+/* the index_lines function finds the start of every line of the text of a document. returns 0 on success and 1 if the memory could not be allocated */
+static int index_lines(Document* document) {
+    const char *text = document->text, *end = document->text + document->size, *newline;
+    size_t* grown;
+    int count = 0;
+    while (TRUE) {
+        if (count == document->lineCapacity) {
+            grown = realloc(document->lineStarts, (document->lineCapacity == 0 ? 256 : document->lineCapacity * 2) * sizeof(size_t));
+            if (grown == NULL) {
+                return 1;
+            }
+            document->lineStarts = grown;
+            document->lineCapacity = document->lineCapacity == 0 ? 256 : document->lineCapacity * 2;
+        }
+        document->lineStarts[count++] = text - document->text;
+        newline = text < end ? memchr(text, '\n', end - text) : NULL;
+        if (newline == NULL) {
+            break;
+        }
+        text = newline + 1;
+    }
+    document->lineCount = count;
+    return 0;
+}
+
+/* the line_length function returns the length of a line of a document, without its newline (and the \r before it) */
+static int line_length(const Document* document, int line) {
+    size_t end = line + 1 < document->lineCount ? document->lineStarts[line + 1] - 1 : document->size;
+    if (end > document->lineStarts[line] && document->text[end - 1] == '\r') {
+        end--;
+    }
+    return end - document->lineStarts[line];
+}
+
+/* the offset_of function returns the offset in the text of a position (a line and a character in it), moved into the text */
+static size_t offset_of(const Document* document, int line, int character) {
+    int length;
+    if (line < 0) {
+        return 0;
+    }
+    if (line >= document->lineCount) {
+        return document->size;
+    }
+    length = line + 1 < document->lineCount ? (int)(document->lineStarts[line + 1] - document->lineStarts[line] - 1) :
+        (int)(document->size - document->lineStarts[line]);
+    return document->lineStarts[line] + (character < 0 ? 0 : character > length ? length : character);
+}
+
+/* the replace_text function replaces the text of a document from start to end with length characters of text.
+    returns 0 on success and 1 if the memory could not be allocated */
+static int replace_text(Document* document, size_t start, size_t end, const char* text, size_t length) {
+    size_t size = document->size - (end - start) + length, capacity;
+    char* grown;
+    if (size + 1 > document->capacity) {
+        for (capacity = document->capacity == 0 ? 4096 : document->capacity; capacity < size + 1; capacity *= 2);
+        grown = realloc(document->text, capacity);
+        if (grown == NULL) {
+            return 1;
+        }
+        document->text = grown;
+        document->capacity = capacity;
+    }
+    memmove(document->text + start + length, document->text + end, document->size - end);
+    memcpy(document->text + start, text, length);
+    document->size = size;
+    document->text[size] = '\0';
+    document->changed = TRUE;
+    return index_lines(document);
+}
+
+/* the find_document function returns the open document with the given uri, or NULL */
+static Document* find_document(LanguageServer* server, const char* uri) {
+    int i;
+    for (i = 0; uri != NULL && i < server->documentCount; i++) {
+        if (strcmp(server->documents[i]->uri, uri) == 0) {
+            return server->documents[i];
+        }
+    }
+    return NULL;
+}
+
+/* the free_document function frees a document */
+static void free_document(Document* document) {
+    free_incremental_file(&document->state);
+    if (document->uri != NULL) free(document->uri);
+    if (document->name != NULL) free(document->name);
+    if (document->text != NULL) free(document->text);
+    if (document->lineStarts != NULL) free(document->lineStarts);
+    free(document);
+}
+
+/* the open_document function adds a document with the given uri and text. returns NULL if the memory could not be allocated */
+static Document* open_document(LanguageServer* server, const char* uri, const char* text, size_t length) {
+    Document** grown;
+    Document* document = calloc(1, sizeof(Document));
+    size_t nameLength;
+
+    if (document == NULL) {
+        return NULL;
+    }
+    if (init_incremental_file(&document->state, server->options->memorySize, FALSE) != 0) {
+        free(document);
+        return NULL;
+    }
+    document->uri = duplicate_string(uri);
+    /* the name is only used in the diagnostics of the document, which are published without it */
+    document->name = duplicate_string(strncmp(uri, "file://", 7) == 0 ? uri + 7 : uri);
+    if (document->uri == NULL || document->name == NULL || replace_text(document, 0, 0, text, length) != 0) {
+        free_document(document);
+        return NULL;
+    }
+    nameLength = strlen(document->name);
+    if (nameLength > 3 && strcmp(document->name + nameLength - 3, ".as") == 0) {
+        document->name[nameLength - 3] = '\0';
+    }
+    if (server->documentCount == server->documentCapacity) {
+        grown = realloc(server->documents, (server->documentCapacity + 8) * sizeof(Document*));
+        if (grown == NULL) {
+            free_document(document);
+            return NULL;
+        }
+        server->documents = grown;
+        server->documentCapacity += 8;
+    }
+    server->documents[server->documentCount++] = document;
+    return document;
+}
+
+/* the write_range function writes a range on a single line */
+static void write_range(OutputBuffer* output, int line, int start, int end) {
+    char range[128];
+    sprintf(range, "{\"start\":{\"line\":%d,\"character\":%d},\"end\":{\"line\":%d,\"character\":%d}}", line, start, line, end);
+    output_puts(output, range);
+}
+
+/* the source_line function returns the line of the source (starting from 0) that the line of the am file was written from.
+    the lines of a macro are on the line that calls it. amStarts has the number of am lines before every line of the source */
+static int source_line(const int* amStarts, int count, int amLine) {
+    int low = 0, high = count - 1, middle;
+    /* the last line of the source that starts before the am line */
+    while (low < high) {
+        middle = (low + high + 1) / 2;
+        if (amStarts[middle] < amLine) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+/* the write_diagnostic function writes a collected diagnostic as a diagnostic of the protocol */
+static void write_diagnostic(LanguageServer* server, const Document* document, const CollectedDiagnostic* diagnostic, const int* amStarts) {
+    char fields[64];
+    int line = 0, start = 0, end = 0, length;
+    const char* text;
+
+    if (diagnostic->line > 0) {
+        /* the preprocessor reports the lines of the source, and the rest of the stages the lines of the am file */
+        line = diagnostic->code < 200 || amStarts == NULL ? diagnostic->line - 1 :
+            source_line(amStarts, document->state.map.count, diagnostic->line);
+        line = line < document->lineCount ? line : document->lineCount - 1;
+        text = document->text + document->lineStarts[line];
+        length = line_length(document, line);
+        if (diagnostic->column > 0 && diagnostic->column <= length) {
+            /* the diagnostic points at a token, it is marked until the white space or the comma after it */
+            start = diagnostic->column - 1;
+            for (end = start + 1; end < length && !isspace((unsigned char)text[end]) && text[end] != ','; end++);
+        } else {
+            for (start = 0; start < length && isspace((unsigned char)text[start]); start++);
+            end = length;
+        }
+    }
+    output_puts(&server->message, "{\"range\":");
+    write_range(&server->message, line, start, end);
+    sprintf(fields, ",\"severity\":%d,\"code\":%d,", diagnostic->severity == SEVERITY_ERROR ? 1 : diagnostic->severity == SEVERITY_WARNING ? 2 : 3,
+        diagnostic->code);
+    output_puts(&server->message, fields);
+    output_puts(&server->message, "\"source\":\"assembler\",\"message\":");
+    write_json_string(&server->message, diagnostic->message, strlen(diagnostic->message));
+    output_puts(&server->message, "}");
+}
+
+/* the publish_diagnostics function assembles a document and sends its diagnostics */
+static void publish_diagnostics(LanguageServer* server, Document* document) {
+    const CollectedDiagnostic* diagnostics;
+    int i, count, *amStarts = NULL;
+    char version[32];
+    MappedFile source;
+
+    source.data = document->text;
+    source.size = document->size;
+    source.isMapped = FALSE;
+    analyze_incremental(&document->state, document->name, &source, server->options);
+    document->changed = FALSE;
+    diagnostics = collected_diagnostics(&count);
+
+    if (count > 0 && document->state.map.count > 0) {
+        amStarts = malloc(document->state.map.count * sizeof(int));
+        if (amStarts != NULL) {
+            amStarts[0] = 0;
+            for (i = 1; i < document->state.map.count; i++) {
+                amStarts[i] = amStarts[i - 1] + (document->state.map.lines[i - 1] > 0 ? document->state.map.lines[i - 1] : 0);
+            }
+        }
+    }
+    output_puts(&server->message, "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":");
+    write_json_string(&server->message, document->uri, strlen(document->uri));
+    sprintf(version, ",\"version\":%d", document->version);
+    output_puts(&server->message, version);
+    output_puts(&server->message, ",\"diagnostics\":[");
+    for (i = 0; i < count; i++) {
+        if (i > 0) output_puts(&server->message, ",");
+        write_diagnostic(server, document, &diagnostics[i], amStarts);
+    }
+    output_puts(&server->message, "]}}");
+    send_message(server);
+    if (amStarts != NULL) free(amStarts);
+}
+
+/* the is_name_character function checks if a character can be a part of the name of a symbol */
+static boolean is_name_character(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+/* the next_name function finds the next name in a line, from *position, and sets *start to where it starts.
+    the names in strings and comments, the directives and the numbers are skipped. returns the length of the name, or 0 if there are no more */
+static int next_name(const char* text, int length, int* position, int* start) {
+    int i = *position;
+    char* quote;
+    while (i < length) {
+        if (text[i] == ';') {
+            break;
+        } else if (text[i] == '"') {
+            quote = memchr(text + i + 1, '"', length - i - 1);
+            i = quote == NULL ? length : quote - text + 1;
+        } else if (is_name_character(text[i])) {
+            *start = i;
+            while (i < length && is_name_character(text[i])) {
+                i++;
+            }
+            if (isalpha((unsigned char)text[*start]) && (*start == 0 || text[*start - 1] != '.')) {
+                *position = i;
+                return i - *start;
+            }
+        } else {
+            i++;
+        }
+    }
+    *position = length;
+    return 0;
+}
+
+/* the starts_with function checks if text at position starts with word, followed by white space or the end of the line */
+static boolean starts_with(const char* text, int length, int position, const char* word) {
+    int wordLength = strlen(word);
+    return length - position >= wordLength && strncmp(text + position, word, wordLength) == 0 &&
+        (length - position == wordLength || isspace((unsigned char)text[position + wordLength]));
+}
+
+/* the skip_spaces function returns the position of the first character from position that isn't white space */
+static int skip_spaces(const char* text, int length, int position) {
+    while (position < length && isspace((unsigned char)text[position])) {
+        position++;
+    }
+    return position;
+}
+
+/* the defined_name function finds the name that a line defines: a label, a constant, an external or a macro,
+    and sets *start to where it starts. returns the length of the name, or 0 if the line doesn't define one */
+static int defined_name(const char* text, int length, int* start) {
+    int position = skip_spaces(text, length, 0), labelStart = -1, labelLength = 0, end;
+
+    for (end = position; end < length && is_name_character(text[end]); end++);
+    if (end < length && end > position && text[end] == ':' && isalpha((unsigned char)text[position])) {
+        labelStart = position;
+        labelLength = end - position;
+        position = skip_spaces(text, length, end + 1);
+    }
+    if (starts_with(text, length, position, ".define") || starts_with(text, length, position, ".extern") ||
+        (labelStart < 0 && starts_with(text, length, position, MACRO_START))) {
+        /* the name after the directive is defined, a label before it is ignored */
+        position = skip_spaces(text, length, position + (text[position] == '.' ? 7 : strlen(MACRO_START)));
+        for (end = position; end < length && !isspace((unsigned char)text[end]) && text[end] != '='; end++);
+        *start = position;
+        return end - position;
+    }
+    if (starts_with(text, length, position, ".entry")) {
+        return 0;
+    }
+    *start = labelStart;
+    return labelLength;
+}
+
+/* the name_at function finds the name at a position of a document, and sets *line and *start to where it starts.
+    returns its length, or 0 if there is no name there that can be a symbol */
+static int name_at(const Document* document, const JsonValue* position, int* line, int* start) {
+    char name[MAX_LINE_LENGTH + 1];
+    const char* text;
+    int length, character, nameLength, from = 0;
+
+    *line = json_int(json_member(position, "line"), -1);
+    character = json_int(json_member(position, "character"), -1);
+    if (*line < 0 || *line >= document->lineCount || character < 0) {
+        return 0;
+    }
+    text = document->text + document->lineStarts[*line];
+    length = line_length(document, *line);
+    while ((nameLength = next_name(text, length, &from, start)) > 0) {
+        if (*start <= character && character <= *start + nameLength) {
+            if (nameLength > MAX_LINE_LENGTH) {
+                return 0;
+            }
+            /* the keywords of the language are never symbols */
+            memcpy(name, text + *start, nameLength);
+            name[nameLength] = '\0';
+            return is_keyword(name, FALSE) ? 0 : nameLength;
+        }
+    }
+    return 0;
+}
+
+/* the write_location function writes the location of a name on a line of a document */
+static void write_location(LanguageServer* server, const Document* document, int line, int start, int length) {
+    output_puts(&server->message, "{\"uri\":");
+    write_json_string(&server->message, document->uri, strlen(document->uri));
+    output_puts(&server->message, ",\"range\":");
+    write_range(&server->message, line, start, start + length);
+    output_puts(&server->message, "}");
+}
+
+/* the answer_definition function answers a go to definition request with the lines that define the name at the position */
+static void answer_definition(LanguageServer* server, const JsonValue* id, const Document* document, const JsonValue* position) {
+    const char *name, *text;
+    int nameLine, nameStart, nameLength, line, start, length, count = 0;
+
+    begin_response(server, id);
+    nameLength = document == NULL ? 0 : name_at(document, position, &nameLine, &nameStart);
+    if (nameLength == 0) {
+        output_puts(&server->message, "null}");
+        send_message(server);
+        return;
+    }
+    name = document->text + document->lineStarts[nameLine] + nameStart;
+    output_puts(&server->message, "[");
+    for (line = 0; line < document->lineCount; line++) {
+        text = document->text + document->lineStarts[line];
+        length = defined_name(text, line_length(document, line), &start);
+        if (length == nameLength && memcmp(text + start, name, length) == 0) {
+            if (count++ > 0) output_puts(&server->message, ",");
+            write_location(server, document, line, start, length);
+        }
+    }
+    output_puts(&server->message, "]}");
+    send_message(server);
+}
+
+/* the answer_references function answers a find references request with every use of the name at the position,
+    and with its definitions if the client asked for them */
+static void answer_references(LanguageServer* server, const JsonValue* id, const Document* document, const JsonValue* params) {
+    const char *name, *text;
+    int nameLine, nameStart, nameLength, line, length, start, definitionStart, definitionLength, from, count = 0;
+    boolean includeDeclaration = json_member(json_member(params, "context"), "includeDeclaration") != NULL &&
+        json_member(json_member(params, "context"), "includeDeclaration")->type == JSON_TRUE;
+
+    begin_response(server, id);
+    nameLength = document == NULL ? 0 : name_at(document, json_member(params, "position"), &nameLine, &nameStart);
+    output_puts(&server->message, "[");
+    name = nameLength == 0 ? NULL : document->text + document->lineStarts[nameLine] + nameStart;
+    for (line = 0; name != NULL && line < document->lineCount; line++) {
+        text = document->text + document->lineStarts[line];
+        length = line_length(document, line);
+        definitionLength = defined_name(text, length, &definitionStart);
+        for (from = 0; next_name(text, length, &from, &start) > 0;) {
+            if (from - start == nameLength && memcmp(text + start, name, nameLength) == 0 &&
+                (includeDeclaration || definitionLength != nameLength || definitionStart != start)) {
+                if (count++ > 0) output_puts(&server->message, ",");
+                write_location(server, document, line, start, nameLength);
+            }
+        }
+    }
+    output_puts(&server->message, "]}");
+    send_message(server);
+}
+
+/* the apply_changes function applies the changes of a didChange notification to the text of a document.
+    a change with a range replaces that range, and a change without one replaces the whole text */
+static void apply_changes(Document* document, const JsonValue* changes) {
+    const JsonValue *change, *range, *text;
+    size_t start, end;
+    for (change = changes == NULL ? NULL : changes->children; change != NULL; change = change->next) {
+        text = json_member(change, "text");
+        range = json_member(change, "range");
+        if (text == NULL || text->type != JSON_STRING) {
+            continue;
+        }
+        if (range == NULL) {
+            start = 0;
+            end = document->size;
+        } else {
+            start = offset_of(document, json_int(json_member(json_member(range, "start"), "line"), 0),
+                json_int(json_member(json_member(range, "start"), "character"), 0));
+            end = offset_of(document, json_int(json_member(json_member(range, "end"), "line"), 0),
+                json_int(json_member(json_member(range, "end"), "character"), 0));
+            if (end < start) {
+                end = start;
+            }
+        }
+        if (replace_text(document, start, end, text->string, text->length) != 0) {
+            fprintf(stderr, "Failed to allocate memory for the text of %s\n", document->uri);
+        }
+    }
+}
+
+/* the close_document function closes a document, and clears its diagnostics */
+static void close_document(LanguageServer* server, Document* document) {
+    int i;
+    output_puts(&server->message, "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":");
+    write_json_string(&server->message, document->uri, strlen(document->uri));
+    output_puts(&server->message, ",\"diagnostics\":[]}}");
+    send_message(server);
+    for (i = 0; server->documents[i] != document; i++);
+    server->documents[i] = server->documents[--server->documentCount];
+    free_document(document);
+}
+
+/* the handle_message function handles a request or a notification */
+static void handle_message(LanguageServer* server, const JsonValue* message) {
+    const JsonValue *id = json_member(message, "id"), *params = json_member(message, "params"), *textDocument;
+    const char* method = json_string(json_member(message, "method"));
+    const char* text;
+    Document* document;
+
+    if (method == NULL) {
+        /* a response to a request of the server, the server doesn't send any */
+        return;
+    }
+    textDocument = json_member(params, "textDocument");
+    document = find_document(server, json_string(json_member(textDocument, "uri")));
+
+    if (strcmp(method, "exit") == 0) {
+        server->exit = TRUE;
+    } else if (server->shutdown && id != NULL) {
+        send_error(server, id, LSP_INVALID_REQUEST, "The server was shut down");
+    } else if (strcmp(method, "initialize") == 0) {
+        begin_response(server, id);
+        output_puts(&server->message, "{\"capabilities\":{\"textDocumentSync\":{\"openClose\":true,\"change\":2},"
+            "\"definitionProvider\":true,\"referencesProvider\":true},\"serverInfo\":{\"name\":\"assembler\"}}}");
+        send_message(server);
+    } else if (strcmp(method, "shutdown") == 0) {
+        server->shutdown = TRUE;
+        begin_response(server, id);
+        output_puts(&server->message, "null}");
+        send_message(server);
+    } else if (strcmp(method, "textDocument/didOpen") == 0) {
+        text = json_string(json_member(textDocument, "text"));
+        if (document != NULL || json_string(json_member(textDocument, "uri")) == NULL || text == NULL) {
+            return;
+        }
+        document = open_document(server, json_string(json_member(textDocument, "uri")), text, json_member(textDocument, "text")->length);
+        if (document == NULL) {
+            fprintf(stderr, "Failed to allocate memory for a document\n");
+            return;
+        }
+        document->version = json_int(json_member(textDocument, "version"), 0);
+    } else if (strcmp(method, "textDocument/didChange") == 0) {
+        if (document != NULL) {
+            document->version = json_int(json_member(textDocument, "version"), document->version);
+            apply_changes(document, json_member(params, "contentChanges"));
+        }
+    } else if (strcmp(method, "textDocument/didClose") == 0) {
+        if (document != NULL) {
+            close_document(server, document);
+        }
+    } else if (strcmp(method, "textDocument/definition") == 0) {
+        answer_definition(server, id, document, json_member(params, "position"));
+    } else if (strcmp(method, "textDocument/references") == 0) {
+        answer_references(server, id, document, params);
+    } else if (id != NULL) {
+        send_error(server, id, LSP_METHOD_NOT_FOUND, "Unknown method");
+    }
+    /* the other notifications (like initialized and didSave) need nothing */
+}
+
+int run_language_server(int input, FILE* output, const AssemblerOptions* options) {
+    LanguageServer server;
+    JsonValue* message;
+    const char* body;
+    size_t length;
+    int i;
+
+    memset(&server, 0, sizeof(LanguageServer));
+    server.input = input;
+    server.output = output;
+    server.options = options;
+    init_output_buffer(&server.message, NULL);
+
+    while (!server.exit && read_message(&server, &body, &length) == 0) {
+        message = parse_json(body, length);
+        if (message == NULL) {
+            send_error(&server, NULL, LSP_PARSE_ERROR, "The message isn't valid JSON");
+            continue;
+        }
+        handle_message(&server, message);
+        free_json(message);
+        /* the documents are assembled once the messages that were already sent are handled */
+        for (i = 0; !server.exit && !input_pending(&server) && i < server.documentCount; i++) {
+            if (server.documents[i]->changed) {
+                publish_diagnostics(&server, server.documents[i]);
+            }
+        }
+    }
+
+    for (i = 0; i < server.documentCount; i++) {
+        free_document(server.documents[i]);
+    }
+    if (server.documents != NULL) free(server.documents);
+    if (server.buffer != NULL) free(server.buffer);
+    free_output_buffer(&server.message);
+    return server.shutdown && server.exit ? 0 : 1;
+}
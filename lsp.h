@@ -0,0 +1,14 @@
+#ifndef LSP_H
+#define LSP_H
+
+#include <stdio.h>
+#include "structs.h"
+
+/* the run_language_server function answers Language Server Protocol messages that are read from the input file descriptor,
+    and writes the responses and the diagnostics of the open documents to output.
+    the documents are kept in memory and assembled with analyze_incremental (see incremental.h), nothing is written to the disk.
+    the diagnostics are published when no other message is waiting, so a burst of changes is assembled once.
+    returns 0 if the client asked the server to shut down before it exited, and 1 otherwise */
+int run_language_server(int input, FILE* output, const AssemblerOptions* options);
+
+#endif
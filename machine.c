@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "machine.h"
+#include "constants.h"
+#include "globals.h"
+#include "isa.h"
+
+/* the sign_extend function returns the number in the 12 bits of an operand word as an int */
+static int sign_extend(int value) {
+    value &= 0xFFF;
+    return value >= 0x800 ? value - 0x1000 : value;
+}
+
+/* the fault function writes an error about the instruction at address. the message may have a %d for the argument */
+static void fault(int address, const char* message, int argument) {
+    fprintf(stderr, "Error at address %04d: ", address);
+    fprintf(stderr, message, argument);
+    fprintf(stderr, "\n");
+}
+
+/* the decode_operand function decodes the operand that is in the given mode, in the words starting at address.
+    shift is where the number of a register is in the word. returns 1 if the operand can't be decoded, and writes why when report is TRUE */
+static int decode_operand(const Machine* machine, int instruction, int mode, int address, int shift, DecodedOperand* operand, boolean report) {
+    int word = machine->memory[address];
+    switch (mode) {
+        case MODE_IMMEDIATE:
+            operand->kind = OPERAND_KIND_IMMEDIATE;
+            operand->value = sign_extend(word >> OPERAND_VALUE_SHIFT) & WORD_MASK;
+            return 0;
+        case MODE_DIRECT:
+        case MODE_INDEXED:
+            if ((word & 3) == ARE_EXTERNAL) {
+                if (report) fault(instruction, "The instruction uses an external symbol, the program has to be linked first", 0);
+                return 1;
+            }
+            operand->kind = OPERAND_KIND_MEMORY;
+            operand->value = word >> OPERAND_VALUE_SHIFT;
+            if (mode == MODE_INDEXED) {
+                /* the index is in the next word, and it is added to the address once, here */
+                operand->value += sign_extend(machine->memory[address + 1] >> OPERAND_VALUE_SHIFT);
+            }
+            if (operand->value < 0 || operand->value >= machine->memorySize) {
+                if (report) fault(instruction, "The address %d is outside of the memory", operand->value);
+                return 1;
+            }
+            return 0;
+        case MODE_REGISTER:
+            operand->kind = OPERAND_KIND_REGISTER;
+            operand->value = (word >> shift) & (REGISTER_COUNT - 1);
+            return 0;
+        default:
+            operand->kind = OPERAND_KIND_NONE;
+            operand->value = 0;
+            return 0;
+    }
+}
+
+/* the decode_instruction function decodes the instruction at address, using the encoding table to check that its first word is valid.
+    returns 1 if the words at address aren't a valid instruction, and writes why when report is TRUE */
+int decode_instruction(const Machine* machine, int address, DecodedInstruction* decoded, boolean report) {
+    int word = machine->memory[address];
+    int opcode = (word >> OPCODE_SHIFT) & (OPCODE_COUNT - 1);
+    int count = instructionRules[opcode].numberOfOperandsRequired;
+    int sourceMode = count == 2 ? (word >> SOURCE_MODE_SHIFT) & 3 : MODE_NONE;
+    int destinationMode = count > 0 ? (word >> DESTINATION_MODE_SHIFT) & 3 : MODE_NONE;
+    const EncodingEntry* encoding = &encodingTable[opcode][sourceMode][destinationMode];
+    int next = address + 1;
+
+    if (!encoding->legal || encoding->firstWord != word) {
+        if (report) fault(address, "Invalid instruction word %d", word);
+        return 1;
+    }
+    if (address + encoding->words > machine->codeEnd) {
+        if (report) fault(address, "The instruction goes past the end of the code", 0);
+        return 1;
+    }
+    if (decode_operand(machine, address, sourceMode, next, registerShifts[count][0], &decoded->source, report) != 0) {
+        return 1;
+    }
+    if (!encoding->packedRegisters) {
+        /* two registers share one word, so the destination register is in the same word as the source register */
+        next += operandWords[sourceMode];
+    }
+    if (decode_operand(machine, address, destinationMode, next, registerShifts[count][count > 0 ? count - 1 : 0], &decoded->destination, report) != 0) {
+        return 1;
+    }
+    decoded->opcode = opcode;
+    decoded->length = encoding->words;
+    return 0;
+}
+
+/* the writes_code function checks if an instruction writes into the code of the machine */
+boolean writes_code(const Machine* machine, const DecodedInstruction* instruction) {
+    switch (instruction->opcode) {
+        case ENUM_MOV: case ENUM_ADD: case ENUM_SUB: case ENUM_NOT: case ENUM_CLR:
+        case ENUM_LEA: case ENUM_INC: case ENUM_DEC: case ENUM_RED:
+            return instruction->destination.kind == OPERAND_KIND_MEMORY && instruction->destination.value < machine->codeEnd;
+        default:
+            return FALSE;
+    }
+}
+
+/* the create_machine function readies a machine with memorySize words of memory.
+    returns 0 on success and 1 if the memory could not be allocated */
+int create_machine(Machine* machine, int memorySize) {
+    memset(machine, 0, sizeof(Machine));
+    machine->memorySize = memorySize;
+    machine->memory = calloc(memorySize, sizeof(unsigned short));
+    machine->decoded = calloc(memorySize, sizeof(DecodedInstruction));
+    machine->dirty = calloc(MACHINE_PAGE_COUNT(memorySize), sizeof(unsigned char));
+    if (machine->memory == NULL || machine->decoded == NULL || machine->dirty == NULL) {
+        free_machine(machine);
+        return 1;
+    }
+    return 0;
+}
+
+/* the load_machine function copies the words of an object into the memory of the machine, and resets its registers.
+    an object that still has externals must be linked first. returns 0 on success and 1 on error */
+int load_machine(Machine* machine, const ObjectFile* object) {
+    int i;
+    if (object->externalCount > 0) {
+        fprintf(stderr, "Error in file \"%s\": The program uses the external symbol \"%s\", it has to be linked first\n",
+            object->name, object->externals[0].name);
+        return 1;
+    }
+    if (START_POSITION + object->codeLength + object->dataLength > machine->memorySize) {
+        fprintf(stderr, "Error in file \"%s\": Program is too large\n", object->name);
+        return 1;
+    }
+    memset(machine->memory, 0, machine->memorySize * sizeof(unsigned short));
+    for (i = 0; i < object->codeLength + object->dataLength; i++) {
+        machine->memory[START_POSITION + i] = object->words[i] & WORD_MASK;
+    }
+    machine->codeEnd = START_POSITION + object->codeLength;
+    memset(machine->decoded, 0, machine->codeEnd * sizeof(DecodedInstruction));
+    memset(machine->dirty, 1, MACHINE_PAGE_COUNT(machine->memorySize));
+    memset(machine->registers, 0, sizeof(machine->registers));
+    machine->pc = START_POSITION;
+    machine->zero = FALSE;
+    machine->stackDepth = 0;
+    machine->steps = 0;
+    return 0;
+}
+
+/* the store function writes a value to the destination of an instruction.
+    a write into the code drops the decoded instructions that the word is a part of, so they are decoded again */
+static void store(Machine* machine, const DecodedOperand* operand, int value) {
+    int i;
+    if (operand->kind == OPERAND_KIND_REGISTER) {
+        machine->registers[operand->value] = value & WORD_MASK;
+        return;
+    }
+    machine->memory[operand->value] = value & WORD_MASK;
+    machine->dirty[operand->value >> MACHINE_PAGE_SHIFT] = 1;
+    if (operand->value < machine->codeEnd) {
+        for (i = operand->value; i >= 0 && i > operand->value - LONGEST_INSTRUCTION; i--) {
+            machine->decoded[i].length = 0;
+        }
+    }
+}
+
+/* the value_of macro reads the value of a decoded operand */
+#define value_of(machine, operand) ((operand).kind == OPERAND_KIND_IMMEDIATE ? (operand).value : \
+    (operand).kind == OPERAND_KIND_REGISTER ? (machine)->registers[(operand).value] : (machine)->memory[(operand).value])
+
+/* the target_of macro returns the address a jump goes to: the address of a direct operand, or the value of a register */
+#define target_of(machine, operand) ((operand).kind == OPERAND_KIND_REGISTER ? (machine)->registers[(operand).value] : (operand).value)
+
+/* the run_machine function runs the loaded program until it halts, faults or runs maxSteps instructions (0 for no limit).
+    red reads a character from input and prn writes a character to output.
+    every address is decoded the first time it runs, and then the decoded instruction is used */
+MachineStatus run_machine(Machine* machine, unsigned long maxSteps, FILE* input, FILE* output) {
+    DecodedInstruction* instruction;
+    unsigned long* profile = machine->profile;
+    int pc = machine->pc;
+    int next, value;
+    unsigned long steps = machine->steps;
+    MachineStatus status = MACHINE_FAULT;
+
+    for (;;) {
+        if (maxSteps > 0 && steps >= maxSteps) {
+            status = MACHINE_STEP_LIMIT;
+            break;
+        }
+        if (pc < START_POSITION || pc >= machine->codeEnd) {
+            fault(pc, "The program counter %d is outside of the code", pc);
+            break;
+        }
+        instruction = &machine->decoded[pc];
+        if (instruction->length == 0 && decode_instruction(machine, pc, instruction, TRUE) != 0) {
+            break;
+        }
+        next = pc + instruction->length;
+        steps++;
+        if (profile != NULL) {
+            profile[pc]++;
+        }
+
+        switch (instruction->opcode) {
+            case ENUM_MOV:
+                store(machine, &instruction->destination, value_of(machine, instruction->source));
+                break;
+            case ENUM_CMP:
+                machine->zero = ((value_of(machine, instruction->source) - value_of(machine, instruction->destination)) & WORD_MASK) == 0;
+                break;
+            case ENUM_ADD:
+                store(machine, &instruction->destination, value_of(machine, instruction->destination) + value_of(machine, instruction->source));
+                break;
+            case ENUM_SUB:
+                store(machine, &instruction->destination, value_of(machine, instruction->destination) - value_of(machine, instruction->source));
+                break;
+            case ENUM_NOT:
+                store(machine, &instruction->destination, ~value_of(machine, instruction->destination));
+                break;
+            case ENUM_CLR:
+                store(machine, &instruction->destination, 0);
+                break;
+            case ENUM_LEA:
+                store(machine, &instruction->destination, instruction->source.value);
+                break;
+            case ENUM_INC:
+                store(machine, &instruction->destination, value_of(machine, instruction->destination) + 1);
+                break;
+            case ENUM_DEC:
+                store(machine, &instruction->destination, value_of(machine, instruction->destination) - 1);
+                break;
+            case ENUM_JMP:
+                next = target_of(machine, instruction->destination);
+                break;
+            case ENUM_BNE:
+                if (!machine->zero) {
+                    next = target_of(machine, instruction->destination);
+                }
+                break;
+            case ENUM_RED:
+                value = getc(input);
+                store(machine, &instruction->destination, value == EOF ? WORD_MASK : value);
+                break;
+            case ENUM_PRN:
+                putc(value_of(machine, instruction->destination) & 0xFF, output);
+                break;
+            case ENUM_JSR:
+                if (machine->stackDepth == MACHINE_STACK_SIZE) {
+                    fault(pc, "The stack is full after %d calls", MACHINE_STACK_SIZE);
+                    goto end;
+                }
+                machine->stack[machine->stackDepth++] = next;
+                next = target_of(machine, instruction->destination);
+                break;
+            case ENUM_RTS:
+                if (machine->stackDepth == 0) {
+                    fault(pc, "rts without a call", 0);
+                    goto end;
+                }
+                next = machine->stack[--machine->stackDepth];
+                break;
+            default: /* hlt */
+                status = MACHINE_HALTED;
+                goto end;
+        }
+        pc = next;
+    }
+
+    end:
+    machine->pc = pc;
+    machine->steps = steps;
+    return status;
+}
+
+/* the free_machine function frees the memory of a machine */
+void free_machine(Machine* machine) {
+    if (machine->memory != NULL) free(machine->memory);
+    if (machine->decoded != NULL) free(machine->decoded);
+    if (machine->dirty != NULL) free(machine->dirty);
+    machine->memory = NULL;
+    machine->decoded = NULL;
+    machine->dirty = NULL;
+}
@@ -0,0 +1,81 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <stdio.h>
+#include "structs.h"
+#include "object_file.h"
+
+#define REGISTER_COUNT 8
+#define MACHINE_STACK_SIZE 1024 /* the number of return addresses jsr can keep */
+#define LONGEST_INSTRUCTION 5 /* the first word, and two indexed operands of two words each */
+#define MACHINE_PAGE_SHIFT 6 /* the writes into the memory are tracked in pages of 64 words */
+#define MACHINE_PAGE_COUNT(memorySize) (((memorySize) >> MACHINE_PAGE_SHIFT) + 1)
+
+/* How the value of a decoded operand is found */
+typedef enum {
+    OPERAND_KIND_NONE,
+    OPERAND_KIND_IMMEDIATE, /* the value is the number itself */
+    OPERAND_KIND_MEMORY, /* the value is an address, of a direct operand or of an indexed operand with its index added */
+    OPERAND_KIND_REGISTER /* the value is the number of the register */
+} OperandKind;
+
+/* An operand of a decoded instruction */
+typedef struct {
+    unsigned char kind;
+    int value;
+} DecodedOperand;
+
+/* An instruction that was decoded from the memory, so it doesn't have to be decoded again every time it runs */
+typedef struct {
+    unsigned char opcode;
+    unsigned char length; /* the number of words of the instruction, or 0 if the address wasn't decoded yet */
+    DecodedOperand source;
+    DecodedOperand destination;
+} DecodedInstruction;
+
+/* The state of the machine while it runs a program */
+typedef struct {
+    int memorySize;
+    unsigned short* memory;
+    DecodedInstruction* decoded; /* the decoded instruction of every address of the code */
+    int codeEnd; /* the address after the last word of the code, only the code is decoded */
+    int registers[REGISTER_COUNT];
+    int pc;
+    boolean zero; /* the Z flag, set by cmp */
+    int stack[MACHINE_STACK_SIZE]; /* the return addresses of jsr */
+    int stackDepth;
+    unsigned long steps; /* the number of instructions that were run */
+    unsigned long* profile; /* when not NULL, the number of times the instruction at every address ran (memorySize counters that the caller owns) */
+    unsigned char* dirty; /* a flag for every page of the memory that was written since the last snapshot */
+} Machine;
+
+/* The ways run_machine can stop */
+typedef enum {
+    MACHINE_HALTED, /* the program ran hlt */
+    MACHINE_STEP_LIMIT, /* the program ran the maximum number of instructions */
+    MACHINE_FAULT /* the program did something the machine can't do, the error was written to stderr */
+} MachineStatus;
+
+/* the create_machine function readies a machine with memorySize words of memory.
+    returns 0 on success and 1 if the memory could not be allocated */
+int create_machine(Machine* machine, int memorySize);
+
+/* the load_machine function copies the words of an object into the memory of the machine, and resets its registers.
+    an object that still has externals must be linked first. returns 0 on success and 1 on error */
+int load_machine(Machine* machine, const ObjectFile* object);
+
+/* the decode_instruction function decodes the instruction at address, using the encoding table to check that its first word is valid.
+    returns 1 if the words at address aren't a valid instruction, and writes why when report is TRUE */
+int decode_instruction(const Machine* machine, int address, DecodedInstruction* decoded, boolean report);
+
+/* the writes_code function checks if an instruction writes into the code of the machine */
+boolean writes_code(const Machine* machine, const DecodedInstruction* instruction);
+
+/* the run_machine function runs the loaded program until it halts, faults or runs maxSteps instructions (0 for no limit).
+    red reads a character from input and prn writes a character to output */
+MachineStatus run_machine(Machine* machine, unsigned long maxSteps, FILE* input, FILE* output);
+
+/* the free_machine function frees the memory of a machine */
+void free_machine(Machine* machine);
+
+#endif
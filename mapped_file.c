@@ -0,0 +1,107 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HAS_MMAP 1
+#endif
+
+/* Reads the whole file into an allocated buffer instead of mapping it.
+ Returns 0 on success and 1 if the file could not be opened or read */
+int read_whole_file(const char* fileName, MappedFile* file) {
+    FILE* fp;
+    char *buffer = NULL, *grown;
+    size_t size = 0, capacity = 0, readCount;
+
+    fp = fopen(fileName, "rb");
+    if (fp == NULL) {
+        return 1;
+    }
+    do {
+        if (size == capacity) {
+            capacity = capacity == 0 ? 4096 : capacity * 2;
+            grown = realloc(buffer, capacity);
+            if (grown == NULL) {
+                free(buffer);
+                fclose(fp);
+                return 1;
+            }
+            buffer = grown;
+        }
+        readCount = fread(buffer + size, 1, capacity - size, fp);
+        size += readCount;
+    } while (readCount > 0);
+    fclose(fp);
+
+    file->data = buffer;
+    file->size = size;
+    file->isMapped = FALSE;
+    return 0;
+}
+
+/* Maps the file with the given name into memory. Returns 0 on success and 1 if the file could not be opened or read */
+int map_file(const char* fileName, MappedFile* file) {
+#ifdef HAS_MMAP
+    int fd;
+    struct stat info;
+    void* mapping;
+
+    fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    /* an empty file can't be mapped, and a file that isn't regular is read instead */
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            close(fd);
+            file->data = mapping;
+            file->size = info.st_size;
+            file->isMapped = TRUE;
+            return 0;
+        }
+    }
+    close(fd);
+#endif
+    return read_whole_file(fileName, file);
+}
+
+/* Releases the memory of a file that was mapped by map_file */
+void unmap_file(MappedFile* file) {
+#ifdef HAS_MMAP
+    if (file->isMapped) {
+        munmap((void*)file->data, file->size);
+    } else
+#endif
+    free((void*)file->data);
+    file->data = NULL;
+    file->size = 0;
+}
+
+/* Finds the line that starts at *offset and stores a view of it in line, then advances *offset to the start of the next line.
+ The newline is found with memchr, which the C library implements with a vectorized scan.
+ Returns FALSE if there are no more lines in the file */
+boolean next_line(const MappedFile* file, size_t* offset, LineView* line) {
+    const char* newline;
+    if (*offset >= file->size) {
+        return FALSE;
+    }
+    line->start = file->data + *offset;
+    newline = memchr(line->start, '\n', file->size - *offset);
+    if (newline == NULL) {
+        line->length = file->size - *offset;
+        line->hasNewline = FALSE;
+        *offset = file->size;
+    } else {
+        line->length = newline - line->start;
+        line->hasNewline = TRUE;
+        *offset += line->length + 1;
+    }
+    return TRUE;
+}
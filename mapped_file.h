@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include "structs.h"
+
+/* A structure that holds the whole content of a file in memory. 
+ When possible the file is memory-mapped, otherwise it is read into an allocated buffer */
+typedef struct {
+    const char* data;
+    size_t size;
+    boolean isMapped; /* TRUE if data points to a mapping, FALSE if it was allocated */
+} MappedFile;
+
+/* A view of a single line inside a mapped file. It points into the mapping and doesn't include the newline character */
+typedef struct {
+    const char* start;
+    int length;
+    boolean hasNewline; /* FALSE only for the last line of a file that doesn't end with a newline */
+} LineView;
+
+/* Maps the file with the given name into memory. Returns 0 on success and 1 if the file could not be opened or read */
+int map_file(const char* fileName, MappedFile* file);
+
+/* Reads the whole file into an allocated buffer instead of mapping it.
+ Returns 0 on success and 1 if the file could not be opened or read */
+int read_whole_file(const char* fileName, MappedFile* file);
+
+/* Releases the memory of a file that was mapped by map_file */
+void unmap_file(MappedFile* file);
+
+/* Finds the line that starts at *offset and stores a view of it in line, then advances *offset to the start of the next line.
+ Returns FALSE if there are no more lines in the file */
+boolean next_line(const MappedFile* file, size_t* offset, LineView* line);
+
+#endif
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "object_file.h"
+#include "mapped_file.h"
+#include "utils.h"
+
+#define OBJECT_INITIAL_SYMBOLS 8
+
+#define OBJECT_LINES_PER_BATCH 8
+#define INVALID_DIGIT 4 /* the value of a character that isn't a base-4 digit, a bit that no digit has */
+
+/* the value of every character in an encrypted word: '*' is 0, '#' is 1, '%' is 2, '!' is 3, and INVALID_DIGIT for the other characters */
+static const unsigned char digitValues[256] = {
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 3, 4, 1, 4, 2, 4, 4, 4, 4, 0, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+};
+
+/* the decrypt_word function translates an encrypted base-4 word back into a binary word.
+    returns 0 on success and 1 if the text isn't an encrypted word */
+int decrypt_word(const char* text, int length, int* word) {
+    int i, digit;
+    if (length != ENCRYPTED_WORD_LENGTH) {
+        return 1;
+    }
+    *word = 0;
+    for (i = 0; i < length; i++) {
+        /* every character is two bits, the first character is the highest two */
+        digit = digitValues[(unsigned char)text[i]];
+        if (digit == INVALID_DIGIT) {
+            return 1;
+        }
+        *word = (*word << 2) | digit;
+    }
+    return 0;
+}
+
+/* the decode_batch function decodes OBJECT_LINES_PER_BATCH lines that start at text, if all of them are exactly the lines
+    that the assembler writes for the words at address and after it, with addresses of the given number of digits.
+    there are no branches inside the batch: every check is or-ed into one flag, so the loops have a fixed number of steps.
+    returns 1 if a line isn't in that form, and then the lines are read one by one to find the error */
+static int decode_batch(const char* text, int address, int digits, unsigned short words[OBJECT_LINES_PER_BATCH]) {
+    const unsigned char* line;
+    int i, j, word, value, digit, bad = 0;
+    /* the address, a space, the encrypted word and a newline */
+    int length = digits + ENCRYPTED_WORD_LENGTH + 2;
+
+    for (i = 0; i < OBJECT_LINES_PER_BATCH; i++) {
+        line = (const unsigned char*)text + i * length;
+        for (j = 0, value = 0; j < digits; j++) {
+            /* digit is 0-9 for the characters '0'-'9', and adding 6 carries out of the low 4 bits for every other character */
+            digit = line[j] ^ '0';
+            bad |= (digit + 6) & ~0xF;
+            value = value * 10 + digit;
+        }
+        bad |= value ^ (address + i);
+        bad |= (line[digits] ^ ' ') | (line[length - 1] ^ '\n');
+        line += digits + 1;
+        for (j = 0, word = 0; j < ENCRYPTED_WORD_LENGTH; j++) {
+            bad |= digitValues[line[j]] & INVALID_DIGIT;
+            word = (word << 2) | (digitValues[line[j]] & 3);
+        }
+        words[i] = word;
+    }
+    return bad != 0;
+}
+
+/* the address_digits function returns the number of digits that the assembler writes for an address, with %04d */
+static int address_digits(int address) {
+    int digits = 4;
+    for (address /= 10000; address > 0; address /= 10) {
+        digits++;
+    }
+    return digits;
+}
+
+/* the copy_line function copies a line of a file into buffer so it can be scanned.
+    returns 1 if the line is too long to be a line of an object file */
+static int copy_line(const LineView* line, char buffer[MAX_LINE_LENGTH + 1]) {
+    if (line->length > MAX_LINE_LENGTH) {
+        return 1;
+    }
+    memcpy(buffer, line->start, line->length);
+    buffer[line->length] = '\0';
+    return 0;
+}
+
+/* the parse_word_line function reads the address and the word of a line of an .ob file, straight from the mapped file.
+    returns 1 if the line isn't an address and an encrypted word */
+static int parse_word_line(const LineView* line, int* address, int* word) {
+    const char *c = line->start, *end = line->start + line->length, *text;
+    int digits = 0;
+
+    while (c < end && isspace((unsigned char)*c)) c++;
+    for (*address = 0; c < end && isdigit((unsigned char)*c) && digits < 9; c++, digits++) {
+        *address = *address * 10 + (*c - '0');
+    }
+    if (digits == 0 || c == end || !isspace((unsigned char)*c)) {
+        return 1;
+    }
+    while (c < end && isspace((unsigned char)*c)) c++;
+    for (text = c; c < end && !isspace((unsigned char)*c); c++);
+    return decrypt_word(text, c - text, word);
+}
+
+/* the read_words function reads the .ob file of the object into its words */
+static int read_words(const char* fileName, ObjectFile* object) {
+    MappedFile file;
+    LineView line;
+    size_t offset = 0;
+    char buffer[MAX_LINE_LENGTH + 1];
+    int lineNumber = 1, address, word, count = 0, digits, error = 0;
+
+    if (map_file(fileName, &file) != 0) {
+        fprintf(stderr, "File %s could not be opened.\n", fileName);
+        return 1;
+    }
+    /* the title of the file is the length of the code and the length of the data */
+    if (!next_line(&file, &offset, &line) || copy_line(&line, buffer) != 0 ||
+        sscanf(buffer, "%d %d", &object->codeLength, &object->dataLength) != 2 ||
+        object->codeLength < 0 || object->dataLength < 0 || object->codeLength + object->dataLength > MAX_MEMORY_SIZE) {
+        fprintf(stderr, "Error in file \"%s\" on line 1: Invalid title of an object file\n", fileName);
+        unmap_file(&file);
+        return 1;
+    }
+    object->words = malloc((object->codeLength + object->dataLength + 1) * sizeof(unsigned short));
+    if (object->words == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the words of file \"%s\"\n", fileName);
+        unmap_file(&file);
+        return 1;
+    }
+    while (count < object->codeLength + object->dataLength) {
+        /* the lines are decoded in batches while they are in the form that the assembler writes */
+        digits = address_digits(START_POSITION + count);
+        if (count + OBJECT_LINES_PER_BATCH <= object->codeLength + object->dataLength &&
+            address_digits(START_POSITION + count + OBJECT_LINES_PER_BATCH - 1) == digits &&
+            offset + OBJECT_LINES_PER_BATCH * (digits + ENCRYPTED_WORD_LENGTH + 2) <= file.size &&
+            decode_batch(file.data + offset, START_POSITION + count, digits, object->words + count) == 0) {
+            offset += OBJECT_LINES_PER_BATCH * (digits + ENCRYPTED_WORD_LENGTH + 2);
+            count += OBJECT_LINES_PER_BATCH;
+            lineNumber += OBJECT_LINES_PER_BATCH;
+            continue;
+        }
+        if (!next_line(&file, &offset, &line)) {
+            break;
+        }
+        lineNumber++;
+        /* every word is on its own line, after its address */
+        if (parse_word_line(&line, &address, &word) != 0) {
+            fprintf(stderr, "Error in file \"%s\" on line %d: Invalid word at offset %lu\n", fileName, lineNumber, (unsigned long)(line.start - file.data));
+            error = 1;
+            break;
+        }
+        if (address != START_POSITION + count) {
+            fprintf(stderr, "Error in file \"%s\" on line %d: Expected the address %04d but has %04d at offset %lu\n", fileName, lineNumber,
+                START_POSITION + count, address, (unsigned long)(line.start - file.data));
+            error = 1;
+            break;
+        }
+        object->words[count++] = word;
+    }
+    if (!error && count < object->codeLength + object->dataLength) {
+        fprintf(stderr, "Error in file \"%s\": The file has %d words instead of %d\n", fileName, count, object->codeLength + object->dataLength);
+        error = 1;
+    }
+    unmap_file(&file);
+    return error;
+}
+
+/* the read_symbols function reads the records of an .ent or .ext file into a growing array of symbols.
+    a file that doesn't exist has no records */
+static int read_symbols(const char* fileName, ObjectSymbol** symbols, int* count) {
+    MappedFile file;
+    LineView line;
+    size_t offset = 0;
+    char buffer[MAX_LINE_LENGTH + 1], name[MAX_LINE_LENGTH + 1];
+    int capacity = 0, lineNumber = 0, address;
+    ObjectSymbol* grown;
+
+    *symbols = NULL;
+    *count = 0;
+    if (map_file(fileName, &file) != 0) {
+        return 0;
+    }
+    while (next_line(&file, &offset, &line)) {
+        lineNumber++;
+        if (line.length == 0) {
+            continue;
+        }
+        if (copy_line(&line, buffer) != 0 || sscanf(buffer, "%s %d", name, &address) != 2 || strlen(name) > MAX_LABEL_LENGTH) {
+            fprintf(stderr, "Error in file \"%s\" on line %d: Invalid symbol record\n", fileName, lineNumber);
+            unmap_file(&file);
+            return 1;
+        }
+        if (*count == capacity) {
+            /* the array is doubled when it is full */
+            capacity = capacity == 0 ? OBJECT_INITIAL_SYMBOLS : capacity * 2;
+            grown = realloc(*symbols, capacity * sizeof(ObjectSymbol));
+            if (grown == NULL) {
+                fprintf(stderr, "Failed to allocate memory for the symbols of file \"%s\"\n", fileName);
+                unmap_file(&file);
+                return 1;
+            }
+            *symbols = grown;
+        }
+        strcpy((*symbols)[*count].name, name);
+        (*symbols)[*count].address = address;
+        (*symbols)[*count].line = lineNumber;
+        (*count)++;
+    }
+    unmap_file(&file);
+    return 0;
+}
+
+/* the load_object function reads name.ob, and name.ent and name.ext if they exist, into object.
+    the errors are written to stderr. returns 0 on success and 1 on error */
+int load_object(const char* name, ObjectFile* object) {
+    char *obName = NULL, *entName = NULL, *extName = NULL;
+    int error = 1;
+
+    memset(object, 0, sizeof(ObjectFile));
+    object->name = duplicate_string(name);
+    obName = concatenate_strings(name, ".ob");
+    entName = concatenate_strings(name, ".ent");
+    extName = concatenate_strings(name, ".ext");
+    if (object->name == NULL || obName == NULL || entName == NULL || extName == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the file names of \"%s\"\n", name);
+        goto end;
+    }
+    if (read_words(obName, object) != 0 ||
+        read_symbols(entName, &object->entries, &object->entryCount) != 0 ||
+        read_symbols(extName, &object->externals, &object->externalCount) != 0) {
+        goto end;
+    }
+    error = 0;
+
+    end:
+    if (obName != NULL) free(obName);
+    if (entName != NULL) free(entName);
+    if (extName != NULL) free(extName);
+    if (error) {
+        free_object(object);
+    }
+    return error;
+}
+
+/* the relocate_object_address function returns where an address of the object is after its code
+    is moved to codeStart and its data to dataStart, or -1 if the address isn't inside the object */
+int relocate_object_address(const ObjectFile* object, int address, int codeStart, int dataStart) {
+    if (address >= START_POSITION && address < START_POSITION + object->codeLength) {
+        return address - START_POSITION + codeStart;
+    }
+    if (address >= START_POSITION + object->codeLength && address < START_POSITION + object->codeLength + object->dataLength) {
+        return address - START_POSITION - object->codeLength + dataStart;
+    }
+    return -1;
+}
+
+/* the free_object function frees the memory of an object that was loaded with load_object */
+void free_object(ObjectFile* object) {
+    if (object->name != NULL) free(object->name);
+    if (object->words != NULL) free(object->words);
+    if (object->entries != NULL) free(object->entries);
+    if (object->externals != NULL) free(object->externals);
+    memset(object, 0, sizeof(ObjectFile));
+}
@@ -0,0 +1,40 @@
+#ifndef OBJECT_FILE_H
+#define OBJECT_FILE_H
+
+#include "constants.h"
+
+/* A symbol record of an object: an entry and its address, or an external and the address of one of its uses */
+typedef struct {
+    char name[MAX_LABEL_LENGTH + 1];
+    int address;
+    int line; /* the line of the record in the .ent or .ext file, for errors */
+} ObjectSymbol;
+
+/* A file that was assembled on its own, read back from its .ob, .ent and .ext files */
+typedef struct {
+    char* name; /* the name of the file without the extension */
+    int codeLength;
+    int dataLength;
+    unsigned short* words; /* the code and then the data, the first word is at START_POSITION */
+    ObjectSymbol* entries;
+    int entryCount;
+    ObjectSymbol* externals; /* every use of an external is a separate record */
+    int externalCount;
+} ObjectFile;
+
+/* the decrypt_word function translates an encrypted base-4 word back into a binary word.
+    returns 0 on success and 1 if the text isn't an encrypted word */
+int decrypt_word(const char* text, int length, int* word);
+
+/* the load_object function reads name.ob, and name.ent and name.ext if they exist, into object.
+    the errors are written to stderr. returns 0 on success and 1 on error */
+int load_object(const char* name, ObjectFile* object);
+
+/* the relocate_object_address function returns where an address of the object is after its code
+    is moved to codeStart and its data to dataStart, or -1 if the address isn't inside the object */
+int relocate_object_address(const ObjectFile* object, int address, int codeStart, int dataStart);
+
+/* the free_object function frees the memory of an object that was loaded with load_object */
+void free_object(ObjectFile* object);
+
+#endif
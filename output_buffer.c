@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <string.h>
+#include "output_buffer.h"
+
+/* Initializes an empty output buffer. If file is not NULL the content is written to it */
+void init_output_buffer(OutputBuffer* buffer, FILE* file) {
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    buffer->file = file;
+    buffer->failed = FALSE;
+}
+
+/* Appends length bytes of data to the output buffer. The buffer grows by doubling its capacity */
+void output_write(OutputBuffer* buffer, const char* data, size_t length) {
+    char* grown;
+    size_t capacity;
+    if (buffer->file != NULL) {
+        fwrite(data, 1, length, buffer->file);
+        return;
+    }
+    if (buffer->failed) {
+        return;
+    }
+    if (buffer->size + length > buffer->capacity) {
+        capacity = buffer->capacity == 0 ? 1024 : buffer->capacity;
+        while (capacity < buffer->size + length) {
+            capacity *= 2;
+        }
+        grown = realloc(buffer->data, capacity);
+        if (grown == NULL) {
+            buffer->failed = TRUE;
+            return;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, length);
+    buffer->size += length;
+}
+
+/* Appends a null-terminated string to the output buffer */
+void output_puts(OutputBuffer* buffer, const char* str) {
+    output_write(buffer, str, strlen(str));
+}
+
+/* Frees the memory of the output buffer. It doesn't close the file of a file-backed buffer */
+void free_output_buffer(OutputBuffer* buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
@@ -0,0 +1,30 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "structs.h"
+
+/* A structure that collects the content of an output file.
+ The content is kept in a growable memory buffer, unless a file is given, in which case it is written straight to the file */
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    FILE* file; /* when not NULL, the content is written to this file instead of being kept in memory */
+    boolean failed; /* set if memory could not be allocated for the content */
+} OutputBuffer;
+
+/* Initializes an empty output buffer. If file is not NULL the content is written to it */
+void init_output_buffer(OutputBuffer* buffer, FILE* file);
+
+/* Appends length bytes of data to the output buffer */
+void output_write(OutputBuffer* buffer, const char* data, size_t length);
+
+/* Appends a null-terminated string to the output buffer */
+void output_puts(OutputBuffer* buffer, const char* str);
+
+/* Frees the memory of the output buffer. It doesn't close the file of a file-backed buffer */
+void free_output_buffer(OutputBuffer* buffer);
+
+#endif
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <ctype.h>
 #include <string.h>
 #include "structs.h"
@@ -8,7 +9,11 @@
 #include "data_structures/node.h"
 #include "data_structures/hashtable.h"
 #include "globals.h"
+#include "parser.h"
+#include "mapped_file.h"
 #include "data_structures/node.h"
+#include "diagnostics.h"
+#include "library.h"
 
 /* Takes a line and returns a tokenized array of strings which are the tokens of the line
  For example: "add r1, r2, r3" would return ["add", "r1", ",", "r2", "," "r3"]. 
@@ -20,7 +25,26 @@
 Note: it ignores these rules if it's inside quotes or square barckets.
 For example, "  bne X[2 ]" would translate to ["bne", "X[2 ]"] */
 node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError) {
+    return tokenize_span(line, strlen(line), allocationError);
+}
+
+/* Inserts a token at the end of the list of tokens, and keeps the column it starts at */
+static node* append_token(node* head, const char* token, int column) {
+    node* last;
+    head = insert_node(head, token);
+    if (head != NULL) {
+        for (last = head; last->next != NULL; last = last->next);
+        last->column = column;
+    }
+    return head;
+}
+
+/* Same as tokenize_line, except that the line is given as a view: a pointer and a length.
+ The line doesn't have to be null-terminated, so it can point directly into a mapped file */
+node* tokenize_span(const char* line, int length, int* allocationError) {
     const char* cursor;
+    const char* lineEnd = line + length;
+    const char* tokenStart = line; /* where the token in the buffer starts */
     node* head = NULL;
     char buffer[MAX_LINE_LENGTH + 1], temp[2]; /* Temporary buffer for tokens */
     
@@ -28,7 +52,10 @@ node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError)
     int inBracket = 0, inString = 0; /* Track whether we're inside brackets or strings */
     *allocationError = 0;
 
-    for (cursor = line; *cursor != '\0'; cursor++) {
+    for (cursor = line; cursor < lineEnd && *cursor != '\0'; cursor++) {
+        if (bufferIndex == 0) {
+            tokenStart = cursor;
+        }
         /* Handle entering and exiting strings */
         if (*cursor == '"') {
             inString = TRUE; /* We're inside a string now and it is supposed
@@ -61,7 +88,7 @@ node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError)
         else if (*cursor == ',' || *cursor == '=' || (isspace((unsigned char)*cursor) && !inBracket)) {
             if (bufferIndex > 0) {
                 buffer[bufferIndex] = '\0';
-                head = insert_node(head, buffer); /* Insert the token into the list */
+                head = append_token(head, buffer, tokenStart - line + 1); /* Insert the token into the list */
                 if (head == NULL) { 
                     *allocationError = 1;
                     return NULL;
@@ -72,7 +99,7 @@ node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError)
             if (*cursor == ',' || *cursor == '=') {
                 temp[0] = *cursor; /* Assign the current character to the first element */
                 temp[1] = '\0';    /* Null-terminate the string */
-                head = insert_node(head, temp); /* Insert the token into the list */
+                head = append_token(head, temp, cursor - line + 1); /* Insert the token into the list */
                 if (head == NULL) { 
                     *allocationError = 1;
                     return NULL;
@@ -88,7 +115,7 @@ node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError)
     /* Handle the last token if there is one */
     if (bufferIndex > 0) {
         buffer[bufferIndex] = '\0'; /* Null-terminate the last token */
-        head = insert_node(head, buffer); /* Insert the last token into the list */
+        head = append_token(head, buffer, tokenStart - line + 1); /* Insert the last token into the list */
         if (head == NULL) { 
             *allocationError = 1;
             return NULL;
@@ -98,6 +125,21 @@ node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError)
     return head;
 }
 
+/* Checks if a token is a number, a constant of the file or a constant of the libraries that the file uses */
+static boolean is_value(const char* token, hashtable* constantsTable) {
+    int value;
+    return is_number_with_constants(token, constantsTable) || library_constant(token, &value);
+}
+
+/* Converts a token that is_value accepted to its value. the constants of the file come before the ones of the libraries */
+static int get_value(const char* token, hashtable* constantsTable) {
+    int value;
+    if (!is_number_with_constants(token, constantsTable) && library_constant(token, &value)) {
+        return value;
+    }
+    return get_number_with_constants(token, constantsTable);
+}
+
 /* This function checks wether a token represents an indexed constant e.g. X[2]. 
 If the token is indeed an indexed label it will store the name of the label in result_label and will store the constant index in the index variable.
 Otherwise the contents of result_label and index variable will be undefined */
@@ -144,13 +186,13 @@ boolean is_indexed(const char* token, hashtable* constantsTable, int* index, cha
     num[num_length] = '\0';
     trim(num); /* Ignore whitespaces in index according to https://opal.openu.ac.il/mod/ouilforum/discuss.php?d=3181019&p=7536805#p7536805 */
 
-    if (!is_number_with_constants(num, constantsTable)) {
+    if (!is_value(num, constantsTable)) {
         free(label);
         free(num);
         return FALSE;
     }
 
-    temp = get_number_with_constants(num, constantsTable);
+    temp = get_value(num, constantsTable);
     if (temp < 0) {
         free(label);
         free(num);
@@ -163,12 +205,24 @@ boolean is_indexed(const char* token, hashtable* constantsTable, int* index, cha
     return TRUE;
 }
 
+/* Sets the error of a parsed line. The arguments are given like in report (see diagnostics.h).
+ Only the first error of a line is kept, like the first error is the one that stops the parsing of the line */
+static void set_line_error(ParsedSyntaxLine* result, DiagnosticCode code, int column, const char* argTypes, ...) {
+    va_list args;
+    if (result->error != NULL) {
+        return;
+    }
+    va_start(args, argTypes);
+    result->error = create_diagnostic(code, column, argTypes, args);
+    va_end(args);
+}
+
 /* This function parses a line into a DirectiveStatement struct and stores the result in result */
 void parse_directive(node* tokens, DirectiveType type, hashtable* constantsTable, ParsedSyntaxLine* result) {
     char* token;
     int i, need_comma, len;
     if (tokens == NULL) {
-        strcpy(result->error, "Invalid directive, no tokens found");
+        set_line_error(result, DIAG_DIRECTIVE_EMPTY, 0, "");
         return;
     }
     switch (type) {
@@ -179,23 +233,23 @@ void parse_directive(node* tokens, DirectiveType type, hashtable* constantsTable
             need_comma = 0; /* A flag to indicate if we need */
             while (tokens != NULL) {
                 token = tokens->token;
-                if (!need_comma && is_number_with_constants(token, constantsTable)) {
-                    result->statement.directive.directiveValue.data.values[i] = get_number_with_constants(token, constantsTable);
+                if (!need_comma && is_value(token, constantsTable)) {
+                    result->statement.directive.directiveValue.data.values[i] = get_value(token, constantsTable);
                     i++;
                     need_comma = TRUE;
                 } else if (need_comma && strcmp(token, ",") == 0) {
                     need_comma = FALSE;
                 } else if (need_comma) {
-                    sprintf(result->error, "Invalid data directive, expected comma before %s", token);
+                    set_line_error(result, DIAG_DATA_EXPECTED_COMMA, tokens->column, "s", token);
                     return;
                 } else {
-                    sprintf(result->error, "Invalid data value: '%s'", token);
+                    set_line_error(result, DIAG_INVALID_DATA_VALUE, tokens->column, "s", token);
                     return;
                 }
                 tokens = tokens->next;
             }
             if (need_comma == FALSE) {
-                strcpy(result->error, "Invalid data directive, unexpected comma");
+                set_line_error(result, DIAG_DATA_UNEXPECTED_COMMA, 0, "");
                 return;
             }
             result->statement.directive.directiveValue.data.count = i;
@@ -205,7 +259,7 @@ void parse_directive(node* tokens, DirectiveType type, hashtable* constantsTable
             token = tokens->token;
             len = strlen(token);
             if (len < 2) { /* this checks needs to be here becaus if the length is less than 2 then " could be seen as a valid string*/
-                sprintf(result->error, "Invalid string value: %s", token);
+                set_line_error(result, DIAG_INVALID_STRING, tokens->column, "s", token);
                 return;
             }
 
@@ -218,17 +272,17 @@ void parse_directive(node* tokens, DirectiveType type, hashtable* constantsTable
                 strncpy(newString, token + 1, newLength);
                 newString[newLength] = '\0';
                 if (!is_string_printable(newString)) {
-                    sprintf(result->error, "Invalid string value, string has unprintable characters");
+                    set_line_error(result, DIAG_STRING_UNPRINTABLE, tokens->column, "");
                     free(newString);
                     return;
                 }
                 result->statement.directive.directiveValue.string = newString;
             } else {
-                sprintf(result->error, "Invalid string value: %s", token);
+                set_line_error(result, DIAG_INVALID_STRING, tokens->column, "s", token);
                 return;
             }
             if (tokens->next != NULL) {
-                sprintf(result->error, "Invalid string directive, unexpected token: '%s'", tokens->next->token);
+                set_line_error(result, DIAG_TOKEN_AFTER_STRING, tokens->next->column, "s", tokens->next->token);
                 return;
             }
             break;
@@ -237,11 +291,11 @@ void parse_directive(node* tokens, DirectiveType type, hashtable* constantsTable
             if (is_label(token)) {
                 result->statement.directive.directiveValue.entryLabel = duplicate_string(token);
             } else {
-                sprintf(result->error, "Invalid entry label: %s", token);
+                set_line_error(result, DIAG_INVALID_ENTRY_LABEL, tokens->column, "s", token);
                 return;
             }
             if (tokens->next != NULL) {
-                sprintf(result->error, "Invalid entry directive, unexpected token %s after label", tokens->next->token);
+                set_line_error(result, DIAG_TOKEN_AFTER_ENTRY, tokens->next->column, "s", tokens->next->token);
                 return;
             }
             break;
@@ -250,24 +304,25 @@ void parse_directive(node* tokens, DirectiveType type, hashtable* constantsTable
             if (is_label(token)) {
                 result->statement.directive.directiveValue.externLabel = duplicate_string(token);
             } else {
-                sprintf(result->error, "Invalid extern label: %s", token);
+                set_line_error(result, DIAG_INVALID_EXTERN_LABEL, tokens->column, "s", token);
                 return;
             }
             if (tokens->next != NULL) {
-                sprintf(result->error, "Invalid extern directive, unexpected token %s after label", tokens->next->token);
+                set_line_error(result, DIAG_TOKEN_AFTER_EXTERN, tokens->next->column, "s", tokens->next->token);
                 return;
             }
             break;
         default:
-            strcpy(result->error, "Invalid directive type");
+            set_line_error(result, DIAG_INVALID_DIRECTIVE, 0, "");
             return;
             
     }
     return;
 }
 
-/* This function parses a token into an Operand struct and stores the result in result */
-Operand* parse_operand(const char* token, hashtable* constantsTable, ParsedSyntaxLine* result) {
+/* This function parses a token into an Operand struct and stores the result in result.
+ column is where the token starts in the line, for the error */
+Operand* parse_operand(const char* token, int column, hashtable* constantsTable, ParsedSyntaxLine* result) {
     int len;
     int immediateIndex = 0;
     char* label;
@@ -279,16 +334,16 @@ Operand* parse_operand(const char* token, hashtable* constantsTable, ParsedSynta
     };
     /* Parse the operand */
     if (token[0] == '#' && len > 1) {
-        if (!is_number_with_constants(token + 1, constantsTable)) {
-            sprintf(result->error, "Invalid immediate operand: %s", token);
+        if (!is_value(token + 1, constantsTable)) {
+            set_line_error(result, DIAG_INVALID_IMMEDIATE, column, "s", token);
             free(operand);
             return NULL;
         }
         operand->operandType = OPERAND_TYPE_IMMEDIATE;
-        operand->operandValue.immediate = get_number_with_constants(token + 1, constantsTable);
+        operand->operandValue.immediate = get_value(token + 1, constantsTable);
     } else if (is_label(token)) {
-        if (is_number_with_constants(token, constantsTable)) {
-            sprintf(result->error, "Uncompatible operand: %s is a constant. However, it is used as a label. Perhaps you forgot a #?", token);
+        if (is_value(token, constantsTable)) {
+            set_line_error(result, DIAG_CONSTANT_AS_LABEL, column, "s", token);
             free(operand);
             return NULL;
         }
@@ -304,7 +359,7 @@ Operand* parse_operand(const char* token, hashtable* constantsTable, ParsedSynta
         free(label); /* the is_indexed funtion allocates memory for label */
     }
     else {
-        sprintf(result->error, "Uncompatible operand: %s", token);
+        set_line_error(result, DIAG_INVALID_OPERAND, column, "s", token);
         free(operand);
         return NULL;
     }
@@ -337,22 +392,22 @@ void parse_instruction(node* tokens, Opcode opcode, hashtable* constantsTable, P
     char* token;
     int need_comma = 0; /* A flag indicating whether a comma is required now as a token */
     int i, maxOperands = instructionRules[opcode].numberOfOperandsRequired;
+    char invalidType[100], sourceTypes[100], destinationTypes[100]; /* the operand types, for the error */
     result->statement.instruction.numOfOperands = 0;
     
     if (tokens == NULL && maxOperands > 0) { /* There are no operands */
-        strcpy(result->error, "Invalid instruction, no operands found");
+        set_line_error(result, DIAG_NO_OPERANDS, 0, "");
         return;
     }
     i = 0;
     while (tokens != NULL) {
         if (i >= maxOperands) {
-            sprintf(result->error, "Too many operands. The maximum number of operands for \"%s\" is %d", 
-            instructionRules[opcode].name, maxOperands);
+            set_line_error(result, DIAG_TOO_MANY_OPERANDS, tokens->column, "sd", instructionRules[opcode].name, maxOperands);
             goto end;
         }
         token = tokens->token;
         if (!need_comma) {
-            currentOperand = parse_operand(token, constantsTable, result);
+            currentOperand = parse_operand(token, tokens->column, constantsTable, result);
             if (currentOperand == NULL) {
                 /* No need to put in error because parse_operand takes care of that*/
                 goto end;
@@ -360,7 +415,11 @@ void parse_instruction(node* tokens, Opcode opcode, hashtable* constantsTable, P
             
             if (!is_operand_allowed_by_index(currentOperand, opcode, i)) {
                 /* Format a correct error message */
-                sprint_operand_error(result->error, opcode, i + 1, token, currentOperand->operandType);
+                operand_types_to_string(currentOperand->operandType, invalidType);
+                operand_types_to_string(instructionRules[opcode].allowedSourceTypes, sourceTypes);
+                operand_types_to_string(instructionRules[opcode].allowedDestinationTypes, destinationTypes);
+                set_line_error(result, DIAG_OPERAND_NOT_ALLOWED, tokens->column, "dsssss", i + 1, token, invalidType,
+                    instructionRules[opcode].name, sourceTypes, destinationTypes);
                 free(currentOperand);
                 goto end;
             }
@@ -372,7 +431,7 @@ void parse_instruction(node* tokens, Opcode opcode, hashtable* constantsTable, P
         } else if (strcmp(token, ",") == 0) {
             need_comma = FALSE;
         } else {
-            sprintf(result->error, "Expected comma but has: %s", token);
+            set_line_error(result, DIAG_EXPECTED_COMMA, tokens->column, "s", token);
             goto end;
         }
         
@@ -383,67 +442,67 @@ void parse_instruction(node* tokens, Opcode opcode, hashtable* constantsTable, P
 }
 
 /* This function parses a constant defintion statement into a ConstantDefintionStatement and stores it in result */
-void parse_constant_defintion(node* tokens, hashtable* constantsTable, ParsedSyntaxLine* result, Symbol_Node ** symbol_table_head) {
+void parse_constant_defintion(node* tokens, hashtable* constantsTable, ParsedSyntaxLine* result, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols) {
     char* token;
     char* name;
     Symbol_Node * symbolJ;
     int len, value;
     if (strlen(result->labelName) > 0) {
-        strcpy(result->error, "Invalid constant definition. Cannot have a label in a constant defintion statement.");
+        set_line_error(result, DIAG_CONSTANT_WITH_LABEL, 0, "");
         return;
     }
 
     if (tokens == NULL) {
-        strcpy(result->error, "Invalid constant definition, no tokens found");
+        set_line_error(result, DIAG_CONSTANT_EMPTY, 0, "");
         return;
     }
     token = tokens->token;
     len = strlen(token);
     if (len == 0) {
-        strcpy(result->error, "Invalid constant definition, empty token");
+        set_line_error(result, DIAG_CONSTANT_EMPTY_TOKEN, tokens->column, "");
         return;
     }
     if (!is_label(token)) {
-        sprintf(result->error, "Invalid constant definition, invalid name: %s", token);
+        set_line_error(result, DIAG_CONSTANT_INVALID_NAME, tokens->column, "s", token);
         return;
     }
-    if (search(constantsTable, token) != NULL) {
-        sprintf(result->error, "Invalid constant definition, constant already defined: %s", token);
+    if (search(constantsTable, token) != NULL || library_constant(token, &value)) {
+        set_line_error(result, DIAG_CONSTANT_REDEFINED, tokens->column, "s", token);
         return;
-    } else if (symbol_contains(*symbol_table_head, token) != NULL) {
-        sprintf(result->error, "Invalid constant definition, label already defined: %s", token);
+    } else if (symbol_contains(*symbol_table_head, token) != NULL || library_defines(token)) {
+        set_line_error(result, DIAG_CONSTANT_IS_LABEL, tokens->column, "s", token);
         return;
     }
     name = token;
     tokens = tokens->next;
     if (tokens == NULL) {
-        strcpy(result->error, "Invalid constant definition, no tokens found after label");
+        set_line_error(result, DIAG_CONSTANT_NO_EQUALS, 0, "");
         return;
     }
     token = tokens->token;
     if (strcmp(token, "=") != 0) {
-        sprintf(result->error, "Invalid constant definition, expected '=' but has: %s", token);
+        set_line_error(result, DIAG_CONSTANT_EXPECTED_EQUALS, tokens->column, "s", token);
         return;
     }
     tokens = tokens->next;
     if (tokens == NULL) {
-        strcpy(result->error, "Invalid constant definition, no tokens found after '='");
+        set_line_error(result, DIAG_CONSTANT_NO_VALUE, 0, "");
         return;
     }
     token = tokens->token;
-    if (!is_number_with_constants(token, constantsTable)) {
-        sprintf(result->error, "Invalid constant definition, invalid value: %s", token);
+    if (!is_value(token, constantsTable)) {
+        set_line_error(result, DIAG_CONSTANT_INVALID_VALUE, tokens->column, "s", token);
         return;
     }
     tokens = tokens->next;
     if (tokens != NULL) {
-        strcpy(result->error, "Invalid constant definition, unexpected token after value");
+        set_line_error(result, DIAG_TOKEN_AFTER_CONSTANT, tokens->column, "");
         return;
     }
     /* Add the constant name to the constant table and symbols list */
-    value = get_number_with_constants(token, constantsTable);
+    value = get_value(token, constantsTable);
     insert(constantsTable, name, &value, sizeof(int));
-    symbolJ = insert_symbol(symbol_table_head, name);
+    symbolJ = insert_symbol_from(symbol_table_head, freeSymbols, name);
     symbolJ->symbol->type = ENUM_SYMBOL_CONSTANT_MACRO;
     result->statement.constantDefinition.name = duplicate_string(name);
     result->statement.constantDefinition.value = value;
@@ -451,17 +510,19 @@ void parse_constant_defintion(node* tokens, hashtable* constantsTable, ParsedSyn
 }
 
 void initializeParsedMemory (ParsedSyntaxLine* parsed_line) {
-    parsed_line->error[0] = '\0';
+    parsed_line->error = NULL;
     parsed_line->labelName[0] = '\0';
     parsed_line->type = ENUM_INVALID;
     parsed_line->statement.directive.directiveValue.string = NULL;
 }
 
 /* Function to parse a line and return a ParsedSyntaxLine struct representin the parsed symbols of the line. 
-If an error has occured then the return's value error property will contain a different character than a '\0'. In that case the statement data inside the return value is undefined*/
-ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constantsTable, Symbol_Node ** symbol_table_head) {
+The line is given as a view (a pointer and a length, without the newline) so it can point directly into a mapped file.
+If an error has occured then the return's value error property will point to the diagnostic of the error, with the column it was found in. In that case the statement data inside the return value is undefined*/
+ParsedSyntaxLine* parse_line(const char* line, int length, hashtable* constantsTable, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols) {
     node *tokens = NULL, *firstToken = NULL, *symbolNames = NULL;
     int allocationError = 0;
+    int indent = 0; /* the number of whitespace characters that were removed from the start of the line */
     ParsedSyntaxLine* parsed_line =  (ParsedSyntaxLine *)calloc(1, sizeof(ParsedSyntaxLine));
     if (parsed_line == NULL) {
         return NULL;
@@ -469,23 +530,30 @@ ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constant
     initializeParsedMemory(parsed_line);
 
     /* A line is a comment if and only if its first character is ; */
-    if (line[0] == COMMENT) {
+    if (length > 0 && line[0] == COMMENT) {
         parsed_line->type = ENUM_COMMENT;
         goto end;
     }
 
-    /* remove leading and trailing whitespace */
-    trim(line);
+    /* remove leading and trailing whitespace, by moving the edges of the view */
+    while (length > 0 && isspace((unsigned char)line[0])) {
+        line++;
+        length--;
+        indent++;
+    }
+    while (length > 0 && isspace((unsigned char)line[length - 1])) {
+        length--;
+    }
 
-    if (line[0] == '\0' || line[0] == '\n') {
+    if (length == 0 || line[0] == '\0') {
         parsed_line->type = ENUM_EMPTY;
         goto end;
     }
 
     /* It's easier to parse a list of tokens in a line instead of one string */
-    tokens = tokenize_line(line, &allocationError);
+    tokens = tokenize_span(line, length, &allocationError);
     if (allocationError) {
-        strcpy(parsed_line->error, "Failed to tokenize line");
+        set_line_error(parsed_line, DIAG_TOKENIZE_FAILED, 0, "");
         goto end;
     }
     firstToken = tokens;
@@ -497,7 +565,7 @@ ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constant
     if (is_token_label(tokens[0].token)) {
         tokens[0].token[strlen(tokens[0].token) - 1] = '\0'; /* Remove the colon from the label */
         if (contains(symbolNames, tokens[0].token)) { /* Check if the label is already defined */
-            sprintf(parsed_line->error, "Trying to redefine the symbol \"%s\"", tokens[0].token);
+            set_line_error(parsed_line, DIAG_SYMBOL_REDEFINED, tokens->column, "s", tokens[0].token);
             goto end;
         }
         symbolNames = insert_node(symbolNames, tokens[0].token); /* Add the label to the symbols list */
@@ -511,7 +579,7 @@ ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constant
     /* According to https://opal.openu.ac.il/mod/ouilforum/discuss.php?d=3192253 a label
      for an empty line is defined as an error here*/
     if (tokens == NULL) {
-        sprintf(parsed_line->error, "Unexpected end of line after label: %s", parsed_line->labelName);
+        set_line_error(parsed_line, DIAG_LABEL_WITHOUT_STATEMENT, 0, "s", parsed_line->labelName);
         goto end;
     }
 
@@ -529,17 +597,21 @@ ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constant
     } else if (is_const_defintion_keyword(tokens[0].token, TRUE)) {
         parsed_line->type = ENUM_CONSTANT_DEFINITION;
         tokens = tokens->next;
-        parse_constant_defintion(tokens, constantsTable, parsed_line, symbol_table_head);
+        parse_constant_defintion(tokens, constantsTable, parsed_line, symbol_table_head, freeSymbols);
     } else {
         /* Can't have whitepsaces before comment sign https://opal.openu.ac.il/mod/ouilforum/discuss.php?d=3191487&p=7560784#p7560784*/
         if (tokens[0].token[0] == COMMENT) {
-            sprintf(parsed_line->error, "Comments can't have whitespaces before ';'");
+            set_line_error(parsed_line, DIAG_WHITESPACE_BEFORE_COMMENT, tokens->column, "");
         } else {
-            sprintf(parsed_line->error, "Unexpected token: %s", tokens[0].token);
+            set_line_error(parsed_line, DIAG_UNEXPECTED_TOKEN, tokens->column, "s", tokens[0].token);
         }
     }
 
     end:
+    /* the columns of the tokens start from the first character that wasn't removed */
+    if (parsed_line->error != NULL && parsed_line->error->column > 0 && parsed_line->error->code != DIAG_OUT_OF_MEMORY) {
+        parsed_line->error->column += indent;
+    }
     if (symbolNames != NULL) free_nodes(symbolNames);
     if (firstToken != NULL) free_nodes(firstToken);
     if (allocationError) {
@@ -551,27 +623,44 @@ ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constant
     return parsed_line;
 }
 
-/* Function to parse a file and return an array of ParsedSyntaxLine structs consisting of the parsed data of the file as AST */
+/* Function to parse a file and return an array of ParsedSyntaxLine structs consisting of the parsed data of the file as AST.
+The file is memory-mapped and every line is parsed straight from the mapping */
 ParsedSyntaxLine** parse_file(const char* file_name, int* lineCount, Symbol_Node ** symbol_table_head, int* error) {
-    FILE* file = NULL;
-    char line[MAX_LINE_LENGTH + 2];
-    /* Hashtable to store constants */
-    hashtable* constantsTable = NULL;
-    ParsedSyntaxLine** parsedLines = NULL;
-    file = fopen(file_name, "r");
+    MappedFile file;
+    ParsedSyntaxLine** parsedLines;
+    hashtable* constantsTable;
     *lineCount = 0;
 
-    if (file == NULL) {
+    if (map_file(file_name, &file) != 0) {
         fprintf(stderr, "File could not be opened.\n");
         return NULL;
     }
+    constantsTable = create_hashtable();
+    if (constantsTable == NULL) {
+        fprintf(stderr, "Failed to allocate memory for constantsTable\n");
+        unmap_file(&file);
+        return NULL;
+    }
+    parsedLines = parse_source(&file, lineCount, symbol_table_head, NULL, constantsTable, error);
+    free_hashtable(constantsTable);
+    unmap_file(&file);
+    return parsedLines;
+}
+
+/* Same as parse_file, except that the content of the file is already in memory,
+    and the constants are added to constantsTable which is owned by the caller */
+ParsedSyntaxLine** parse_source(const MappedFile* file, int* lineCount, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols, hashtable* constantsTable, int* error) {
+    LineView line;
+    size_t offset = 0;
+    ParsedSyntaxLine** parsedLines = NULL;
+    *lineCount = 0;
 
     /* Count the lines to correctly allocate memory for parsedLines */
-    while (fgets(line, MAX_LINE_LENGTH + 2, file) != NULL) {
+    while (next_line(file, &offset, &line)) {
         (*lineCount)++;
     }
 
-    rewind(file); 
+    offset = 0;
     /* parsedLines = calloc((*lineCount), sizeof(ParsedSyntaxLine*)); */
     parsedLines = malloc((*lineCount) * sizeof(ParsedSyntaxLine*));
     if (parsedLines == NULL) {
@@ -580,15 +669,8 @@ ParsedSyntaxLine** parse_file(const char* file_name, int* lineCount, Symbol_Node
     }
 
     *lineCount = 0;
-    constantsTable = create_hashtable(); 
-    if (constantsTable == NULL) {
-        fprintf(stderr, "Failed to allocate memory for constantsTable\n");
-        free(constantsTable);
-        goto end;
-    }
-
-    while (fgets(line, MAX_LINE_LENGTH + 2, file) != NULL) {
-        parsedLines[*lineCount] = parse_line(line, constantsTable, symbol_table_head);
+    while (next_line(file, &offset, &line)) {
+        parsedLines[*lineCount] = parse_line(line.start, line.length, constantsTable, symbol_table_head, freeSymbols);
         if (parsedLines[*lineCount] == NULL) {
             fprintf(stderr, "Memory allocation failed");
             goto end;
@@ -596,7 +678,5 @@ ParsedSyntaxLine** parse_file(const char* file_name, int* lineCount, Symbol_Node
         (*lineCount)++;
     }
     end:
-    fclose(file);
-    free_hashtable(constantsTable);
     return parsedLines;
-}
+}
\ No newline at end of file
@@ -1,7 +1,11 @@
+#ifndef PARSER_H
+#define PARSER_H
+
 #include "structs.h"
 #include "constants.h"
 #include "data_structures/node.h"
 #include "data_structures/hashtable.h"
+#include "mapped_file.h"
 
 /* Takes a line and returns a tokenized array of strings which are the tokens of the line
  For example: "add r1, r2, r3" would return ["add", "r1", ",", "r2", "," "r3"]. 
@@ -14,9 +18,22 @@ Note: it ignores these rules if it's inside quotes or square barckets.
 For example, "  bne X[2 ]" would translate to ["bne", "X[2 ]"] */
 node* tokenize_line(const char line[MAX_LINE_LENGTH + 1], int* allocationError);
 
+/* Same as tokenize_line, except that the line is given as a view: a pointer and a length.
+ The line doesn't have to be null-terminated, so it can point directly into a mapped file */
+node* tokenize_span(const char* line, int length, int* allocationError);
+
 /* Function to parse a line and return a ParsedSyntaxLine struct representin the parsed symbols of the line. 
-If an error has occured then the return's value error property will contain a different character than a '\0'. In that case the statement data inside the return value is undefined*/
-ParsedSyntaxLine* parse_line(char line[MAX_LINE_LENGTH + 1], hashtable* constantsTable, Symbol_Node ** symbol_table_head);
+The line is given as a view (a pointer and a length, without the newline) so it can point directly into a mapped file.
+If an error has occured then the return's value error property will contain a different character than a '\0'. In that case the statement data inside the return value is undefined.
+The symbol of a constant definition is taken from freeSymbols when it isn't NULL (see insert_symbol_from)*/
+ParsedSyntaxLine* parse_line(const char* line, int length, hashtable* constantsTable, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols);
+
+/* Function to parse a file and return an array of ParsedSyntaxLine structs consisting of the parsed data of the file as AST.
+The file is memory-mapped and every line is parsed straight from the mapping */
+ParsedSyntaxLine** parse_file(const char* file_name, int* line_count, Symbol_Node ** symbol_table_head, int* error);
+
+/* Same as parse_file, except that the content of the file is already in memory,
+    and the constants are added to constants_table which is owned by the caller */
+ParsedSyntaxLine** parse_source(const MappedFile* file, int* line_count, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols, hashtable* constants_table, int* error);
 
-/* Function to parse a file and return an array of ParsedSyntaxLine structs consisting of the parsed data of the file as AST */
-ParsedSyntaxLine** parse_file(const char* file_name, int* line_count, Symbol_Node ** symbol_table_head, int* error);
\ No newline at end of file
+#endif
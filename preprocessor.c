@@ -4,10 +4,15 @@
 #include <ctype.h>
 #include "data_structures/hashtable.h"
 #include "data_structures/node.h"
+#include "mapped_file.h"
+#include "output_buffer.h"
 #include "constants.h"
 #include "globals.h"
 #include "utils.h"
 #include "parser.h"
+#include "preprocessor.h"
+#include "diagnostics.h"
+#include "library.h"
 #include "data_structures/node.h"
 
 /* Function to check if a macro name is valid. Requirements for a valid macro name:
@@ -34,40 +39,492 @@ boolean is_macro_name_valid(const char* macroName) {
     return !is_keyword(macroName, FALSE); /* false because we don't check for : in a macro name*/
 }
 
+/* The location of a macro's code inside the mapped source file.
+ The code of a macro is always the consecutive lines between its mcr and endmcr lines, so it is kept as offsets
+ into the mapping instead of being copied. */
+typedef struct {
+    size_t start; /* the offset of the first line of the macro's code */
+    size_t end; /* the offset right after the last line of the macro's code */
+} MacroCode;
+
+/* Checks whether a line consists only of whitespace characters. These lines are not written to the am file */
+static boolean is_blank_line(const LineView* line) {
+    int i;
+    for (i = 0; i < line->length; i++) {
+        if (!isspace((unsigned char)line->start[i]) && line->start[i] != '\0') {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Writes a line to the am file. A line that is too long is cut to MAX_LINE_LENGTH characters */
+static void write_line(OutputBuffer* output, const LineView* line) {
+    if (line->length > MAX_LINE_LENGTH) {
+        output_write(output, line->start, MAX_LINE_LENGTH);
+        output_write(output, "\n", 1);
+    } else {
+        output_write(output, line->start, line->length);
+        if (line->hasNewline) {
+            output_write(output, "\n", 1);
+        }
+    }
+}
+
+/* Writes the code of a macro to the am file, line by line straight from the mapped source.
+ Returns the number of lines that were written */
+static int write_macro_code(OutputBuffer* output, const MappedFile* source, const MacroCode* code) {
+    size_t offset = code->start;
+    LineView line;
+    int written = 0;
+    while (offset < code->end && next_line(source, &offset, &line)) {
+        if (!is_blank_line(&line)) {
+            write_line(output, &line);
+            written++;
+        }
+    }
+    return written;
+}
+
+/* Imports the library of an .import directive, the tokens are the ones after the directive.
+ A path that isn't absolute is relative to the directory of the source file. Returns 0 on success */
+static int import_directive(const node* tokens, const char* fileName, int lineNumber) {
+    const char *name, *slash;
+    char* path;
+    size_t length, directory = 0;
+    const MacroLibrary* library;
+
+    if (tokens == NULL || tokens->next != NULL) {
+        report(DIAG_IMPORT_PATH_MISSING, fileName, lineNumber, tokens == NULL ? 0 : tokens->column, "");
+        return 1;
+    }
+    name = tokens->token;
+    length = strlen(name);
+    while (length > 0 && isspace((unsigned char)name[length - 1])) {
+        length--;
+    }
+    if (length < 3 || name[0] != '"' || name[length - 1] != '"' || memchr(name + 1, '"', length - 2) != NULL) {
+        report(DIAG_IMPORT_PATH_MISSING, fileName, lineNumber, tokens->column, "");
+        return 1;
+    }
+    slash = strrchr(fileName, '/');
+    if (name[1] != '/' && slash != NULL) {
+        directory = slash - fileName + 1;
+    }
+    path = malloc(directory + length - 1);
+    if (path == NULL) {
+        report(DIAG_OUT_OF_MEMORY, fileName, lineNumber, 0, "s", "the path of the library");
+        return 1;
+    }
+    memcpy(path, fileName, directory);
+    memcpy(path + directory, name + 1, length - 2);
+    path[directory + length - 2] = '\0';
+    library = load_library(path);
+    free(path);
+    if (library == NULL) {
+        report(DIAG_INVALID_LIBRARY, fileName, lineNumber, tokens->column, "s", name);
+        return 1;
+    }
+    if (import_library(library) != 0) {
+        report(DIAG_TOO_MANY_LIBRARIES, fileName, lineNumber, tokens->column, "d", MAX_FILE_LIBRARIES);
+        return 1;
+    }
+    return 0;
+}
+
+/* Adds the number of am lines that the next line of the source was written to, to the map (if there is one) */
+static void add_map_line(PreprocessMap* map, int written) {
+    int* grown;
+    if (map == NULL || map->failed) {
+        return;
+    }
+    if (map->count == map->capacity) {
+        grown = realloc(map->lines, (map->capacity == 0 ? 256 : 2 * map->capacity) * sizeof(int));
+        if (grown == NULL) {
+            map->failed = TRUE;
+            return;
+        }
+        map->lines = grown;
+        map->capacity = map->capacity == 0 ? 256 : 2 * map->capacity;
+    }
+    map->lines[map->count++] = written;
+}
+
+/* The directives of conditional assembly */
+typedef enum {
+    CONDITION_NONE,
+    CONDITION_IF_VALUE, /* .if */
+    CONDITION_IF_DEFINED, /* .ifdef */
+    CONDITION_IF_NOT_DEFINED, /* .ifndef */
+    CONDITION_OTHERWISE, /* .else */
+    CONDITION_END /* .endif */
+} ConditionDirective;
+
+/* An .if, .ifdef or .ifndef that wasn't closed with .endif yet */
+typedef struct {
+    int line; /* the line of the directive */
+    ConditionDirective directive;
+    boolean taken; /* one of its branches is (or was) assembled */
+    boolean inElse; /* its .else was reached */
+} OpenCondition;
+
+/* The conditions of the file. the lines of a branch that isn't assembled are skipped until the .else or .endif that ends it */
+typedef struct {
+    OpenCondition open[MAX_CONDITION_DEPTH];
+    int count;
+    boolean skipping;
+    int skippedDepth; /* the number of conditions that were opened inside the skipped branch and weren't closed yet */
+} ConditionState;
+
+/* The constants of --define, that the conditions of every file can use */
+static hashtable* commandLineDefines = NULL;
+
+/* Finds the directive of conditional assembly that a line starts with, by looking at its characters only, so that the lines
+ of a skipped branch are never tokenized. The offset of the text after the directive is set in rest */
+static ConditionDirective condition_directive(const LineView* line, int* rest) {
+    static const struct {
+        const char* name;
+        ConditionDirective directive;
+    } directives[] = {
+        {CONDITION_IF, CONDITION_IF_VALUE},
+        {CONDITION_IFDEF, CONDITION_IF_DEFINED},
+        {CONDITION_IFNDEF, CONDITION_IF_NOT_DEFINED},
+        {CONDITION_ELSE, CONDITION_OTHERWISE},
+        {CONDITION_ENDIF, CONDITION_END}
+    };
+    int i = 0, j, length;
+    while (i < line->length && (line->start[i] == ' ' || line->start[i] == '\t')) {
+        i++;
+    }
+    if (i == line->length || line->start[i] != '.') {
+        return CONDITION_NONE;
+    }
+    for (j = 0; j < sizeof(directives) / sizeof(directives[0]); j++) {
+        length = strlen(directives[j].name);
+        if (line->length - i >= length && memcmp(line->start + i, directives[j].name, length) == 0 &&
+            (line->length - i == length || isspace((unsigned char)line->start[i + length]))) {
+            *rest = i + length;
+            return directives[j].directive;
+        }
+    }
+    return CONDITION_NONE;
+}
+
+/* The name of a directive of conditional assembly, for the diagnostics */
+static const char* condition_name(ConditionDirective directive) {
+    switch (directive) {
+        case CONDITION_IF_DEFINED: return CONDITION_IFDEF;
+        case CONDITION_IF_NOT_DEFINED: return CONDITION_IFNDEF;
+        case CONDITION_OTHERWISE: return CONDITION_ELSE;
+        case CONDITION_END: return CONDITION_ENDIF;
+        default: return CONDITION_IF;
+    }
+}
+
+/* Finds the value of a constant for a condition: a .define of the file before the condition, a constant of a library, or a --define */
+static boolean condition_constant(hashtable* defines, const char* name, int* value) {
+    int* found = (int*)search(defines, name);
+    if (found == NULL && library_constant(name, value)) {
+        return TRUE;
+    }
+    if (found == NULL && commandLineDefines != NULL) {
+        found = (int*)search(commandLineDefines, name);
+    }
+    if (found == NULL) {
+        return FALSE;
+    }
+    *value = *found;
+    return TRUE;
+}
+
+/* Moves position over the spaces of the line */
+static void skip_line_spaces(const LineView* line, int* position) {
+    while (*position < line->length && isspace((unsigned char)line->start[*position])) {
+        (*position)++;
+    }
+}
+
+/* Reports that the text of a condition was unexpected, from position to the end of the line */
+static void report_condition_text(const LineView* line, int position, const char* fileName, int lineNumber) {
+    char text[MAX_LINE_LENGTH + 1];
+    int length;
+    skip_line_spaces(line, &position);
+    length = line->length - position;
+    while (length > 0 && isspace((unsigned char)line->start[position + length - 1])) {
+        length--;
+    }
+    if (length == 0) {
+        report(DIAG_INVALID_CONDITION, fileName, lineNumber, 0, "s", "end of line");
+        return;
+    }
+    memcpy(text, line->start + position, length);
+    text[length] = '\0';
+    report(DIAG_INVALID_CONDITION, fileName, lineNumber, position + 1, "s", text);
+}
+
+/* Reads a word of a condition (a number or a name) at position into word. Returns FALSE if there is no word there */
+static boolean condition_word(const LineView* line, int* position, char word[MAX_LINE_LENGTH + 1]) {
+    int start;
+    skip_line_spaces(line, position);
+    start = *position;
+    if (*position < line->length && (line->start[*position] == '-' || line->start[*position] == '+')) {
+        (*position)++;
+    }
+    while (*position < line->length && isalnum((unsigned char)line->start[*position])) {
+        (*position)++;
+    }
+    memcpy(word, line->start + start, *position - start);
+    word[*position - start] = '\0';
+    return *position > start;
+}
+
+/* Reads a value of a condition at position: a number, or the name of a constant. Returns 0 on success, and 1 after reporting the error */
+static int condition_value(const LineView* line, int* position, hashtable* defines, const char* fileName, int lineNumber, int* value) {
+    char word[MAX_LINE_LENGTH + 1];
+    int start;
+    skip_line_spaces(line, position);
+    start = *position;
+    if (!condition_word(line, position, word) || !(is_number(word) || is_label(word))) {
+        report_condition_text(line, start, fileName, lineNumber);
+        return 1;
+    }
+    if (is_number(word)) {
+        *value = get_number(word);
+    } else if (!condition_constant(defines, word, value)) {
+        report(DIAG_CONDITION_UNDEFINED, fileName, lineNumber, start + 1, "s", word);
+        return 1;
+    }
+    return 0;
+}
+
+/* Evaluates the condition of an .if that starts at position: a value, which is true when it isn't 0,
+ or two values with one of == != < > <= >= between them. Returns 0 on success, and 1 after reporting the error */
+static int evaluate_condition(const LineView* line, int position, hashtable* defines, const char* fileName, int lineNumber, boolean* result) {
+    char operator[3] = {'\0', '\0', '\0'};
+    int left, right;
+    if (condition_value(line, &position, defines, fileName, lineNumber, &left) != 0) {
+        return 1;
+    }
+    skip_line_spaces(line, &position);
+    if (position == line->length) {
+        *result = left != 0;
+        return 0;
+    }
+    if (strchr("=!<>", line->start[position]) != NULL) {
+        operator[0] = line->start[position++];
+        if (position < line->length && line->start[position] == '=') {
+            operator[1] = line->start[position++];
+        }
+    }
+    if (operator[0] == '\0' || strcmp(operator, "=") == 0 || strcmp(operator, "!") == 0) {
+        report_condition_text(line, position - strlen(operator), fileName, lineNumber);
+        return 1;
+    }
+    if (condition_value(line, &position, defines, fileName, lineNumber, &right) != 0) {
+        return 1;
+    }
+    skip_line_spaces(line, &position);
+    if (position < line->length) {
+        report_condition_text(line, position, fileName, lineNumber);
+        return 1;
+    }
+    if (strcmp(operator, "==") == 0) *result = left == right;
+    else if (strcmp(operator, "!=") == 0) *result = left != right;
+    else if (strcmp(operator, "<") == 0) *result = left < right;
+    else if (strcmp(operator, ">") == 0) *result = left > right;
+    else if (strcmp(operator, "<=") == 0) *result = left <= right;
+    else *result = left >= right;
+    return 0;
+}
+
+/* Checks that nothing follows a directive of conditional assembly that takes no operands. Returns 0 if nothing does */
+static int check_condition_end(const LineView* line, int position, ConditionDirective directive, const char* fileName, int lineNumber) {
+    char word[MAX_LINE_LENGTH + 1];
+    int start;
+    skip_line_spaces(line, &position);
+    if (position == line->length) {
+        return 0;
+    }
+    start = position;
+    while (position < line->length && !isspace((unsigned char)line->start[position])) {
+        position++;
+    }
+    memcpy(word, line->start + start, position - start);
+    word[position - start] = '\0';
+    report(DIAG_TOKEN_AFTER_CONDITION, fileName, lineNumber, start + 1, "ss", word, condition_name(directive));
+    return 1;
+}
+
+/* Handles an .else: the branch after it is assembled if no branch before it was. Returns 0 on success, and 1 after reporting the error */
+static int condition_else(ConditionState* state, const LineView* line, int rest, const char* fileName, int lineNumber) {
+    OpenCondition* condition;
+    int error = check_condition_end(line, rest, CONDITION_OTHERWISE, fileName, lineNumber);
+    if (state->count == 0) {
+        report(DIAG_ELSE_WITHOUT_IF, fileName, lineNumber, 0, "");
+        return 1;
+    }
+    condition = &state->open[state->count - 1];
+    if (condition->inElse) {
+        report(DIAG_ELSE_AGAIN, fileName, lineNumber, 0, "sd", condition_name(condition->directive), condition->line);
+        return 1;
+    }
+    condition->inElse = TRUE;
+    state->skipping = condition->taken;
+    condition->taken = TRUE;
+    return error;
+}
+
+/* Handles a directive of conditional assembly in the lines that are assembled.
+ Returns 0 on success, 1 after reporting an error, and -1 if the file can't be preprocessed any further */
+static int condition_line(ConditionState* state, ConditionDirective directive, const LineView* line, int rest, hashtable* defines,
+    const char* fileName, int lineNumber) {
+    char name[MAX_LINE_LENGTH + 1];
+    boolean result = FALSE;
+    int value, position = rest, error = 0;
+
+    if (directive == CONDITION_OTHERWISE) {
+        return condition_else(state, line, rest, fileName, lineNumber);
+    }
+    if (directive == CONDITION_END) {
+        error = check_condition_end(line, rest, directive, fileName, lineNumber);
+        if (state->count == 0) {
+            report(DIAG_ENDIF_WITHOUT_IF, fileName, lineNumber, 0, "");
+            return 1;
+        }
+        state->count--;
+        return error;
+    }
+
+    if (state->count == MAX_CONDITION_DEPTH) {
+        report(DIAG_CONDITION_TOO_DEEP, fileName, lineNumber, 0, "d", MAX_CONDITION_DEPTH);
+        return -1;
+    }
+    if (directive == CONDITION_IF_VALUE) {
+        error = evaluate_condition(line, position, defines, fileName, lineNumber, &result);
+    } else if (!condition_word(line, &position, name) || !is_label(name)) {
+        report_condition_text(line, rest, fileName, lineNumber);
+        error = 1;
+    } else {
+        result = condition_constant(defines, name, &value) == (directive == CONDITION_IF_DEFINED);
+        error = check_condition_end(line, position, directive, fileName, lineNumber);
+    }
+    /* a condition with an error is false, so that the rest of the file is still checked */
+    state->open[state->count].line = lineNumber;
+    state->open[state->count].directive = directive;
+    state->open[state->count].taken = result && !error;
+    state->open[state->count].inElse = FALSE;
+    state->count++;
+    state->skipping = !(result && !error);
+    return error;
+}
+
+/* Handles a line of a branch that is skipped. Only the directives of conditional assembly are looked for, to find where it ends.
+ Returns 0 on success, and 1 after reporting an error */
+static int skipped_line(ConditionState* state, ConditionDirective directive, const LineView* line, int rest, const char* fileName, int lineNumber) {
+    if (directive == CONDITION_IF_VALUE || directive == CONDITION_IF_DEFINED || directive == CONDITION_IF_NOT_DEFINED) {
+        state->skippedDepth++;
+    } else if (directive == CONDITION_END && state->skippedDepth > 0) {
+        state->skippedDepth--;
+    } else if (directive == CONDITION_END) {
+        state->count--;
+        state->skipping = FALSE;
+        return check_condition_end(line, rest, directive, fileName, lineNumber);
+    } else if (directive == CONDITION_OTHERWISE && state->skippedDepth == 0) {
+        return condition_else(state, line, rest, fileName, lineNumber);
+    }
+    return 0;
+}
+
+/* Keeps the value of a .define of the file, for the conditions after it. The parser checks the definition itself */
+static int keep_define(hashtable* defines, const node* tokens) {
+    int value;
+    if (tokens == NULL || tokens->next == NULL || strcmp(tokens->next->token, "=") != 0 || tokens->next->next == NULL ||
+        tokens->next->next->next != NULL || search(defines, tokens->token) != NULL) {
+        return 0;
+    }
+    if (is_number(tokens->next->next->token)) {
+        value = get_number(tokens->next->next->token);
+    } else if (!condition_constant(defines, tokens->next->next->token, &value)) {
+        return 0;
+    }
+    return insert(defines, tokens->token, &value, sizeof(int));
+}
+
+int define_condition_constant(const char* definition) {
+    char name[MAX_LINE_LENGTH + 1];
+    const char* equals = strchr(definition, '=');
+    size_t length = equals == NULL ? strlen(definition) : (size_t)(equals - definition);
+    int value = 1;
+
+    if (length > MAX_LABEL_LENGTH) {
+        return 1;
+    }
+    memcpy(name, definition, length);
+    name[length] = '\0';
+    if (!is_label(name) || (equals != NULL && (equals[1] == '\0' || !is_number(equals + 1)))) {
+        return 1;
+    }
+    if (equals != NULL) {
+        value = get_number(equals + 1);
+    }
+    if (commandLineDefines == NULL) {
+        commandLineDefines = create_hashtable();
+        if (commandLineDefines == NULL) {
+            return 1;
+        }
+    }
+    return insert(commandLineDefines, name, &value, sizeof(int));
+}
+
+void free_condition_constants(void) {
+    if (commandLineDefines != NULL) {
+        free_hashtable(commandLineDefines);
+        commandLineDefines = NULL;
+    }
+}
+
+boolean is_condition_directive(const char* token) {
+    return strcmp(token, CONDITION_IF) == 0 || strcmp(token, CONDITION_IFDEF) == 0 || strcmp(token, CONDITION_IFNDEF) == 0 ||
+        strcmp(token, CONDITION_ELSE) == 0 || strcmp(token, CONDITION_ENDIF) == 0;
+}
+
 /**
- * create_preprocessed_file - Processes an assembly source file to expand macros and prepare it for assembly.
- * The filename is the base name of the file to process, i.e. excluding an extension.
+ * preprocess_source - Processes an assembly source file to expand macros and prepare it for assembly.
+ * The source is the content of the .as file, and origialFileName is its name, which is used in error messages.
  * The symbol_table_head is a double pointer to the head of a linked list for symbol management.
  * 
- * This function reads an assembly file (.as), expands macros defined within it, and writes the result to a new file (.am).
+ * This function expands the macros defined within the source, and writes the result (the content of the .am file) to output.
  * It updates the symbol table with macro definitions.
  * It returns a PreprocessStatus indicating the success of the preprocessing, or a warning/error status if issues are encountered.
  */
-PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** symbol_table_head, char* origialFileName, char* newFileName) {
+PreprocessStatus preprocess_source(const MappedFile* source, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols, const char* origialFileName, OutputBuffer* output, PreprocessMap* map) {
     Symbol_Node * symbolJ = NULL;
     node* tokens = NULL, *firstToken = NULL;
-    char *currentMacroName = NULL, *currentMacroCode = NULL,
-     *tempMacroName = NULL, currentChar = 0,
-    *newMacroCode, *macroCode;
-    char line[MAX_LINE_LENGTH + 2];
-    char error[250];
-    int inMacro, lineTooLong, allocationError = 0;
+    char *currentMacroName = NULL, *tempMacroName = NULL;
+    MacroCode *currentMacroCode = NULL, *macroCode, emptyCode;
+    int inMacro = 0, lineTooLong = 0, allocationError = 0;
+    int failed = 0; /* a flag to indicate that an error was reported and the am file can't be created */
     int lineNumber = 0;
-    FILE *originalFp = NULL, *newFp = NULL;
+    LineView line, directiveLine;
+    size_t offset = 0;
     hashtable* macros = NULL;
+    const char* libraryCode;
+    size_t libraryCodeLength;
+    int libraryLines, rest = 0, status, i;
+    ConditionDirective directive;
+    ConditionState conditions;
+    hashtable* defines = NULL; /* the values of the .define lines that were assembled, for the conditions */
 
-    error[0] = '\0';
-    originalFp = fopen(origialFileName, "r");
-    newFp = fopen(newFileName, "w+");
-
-    if (originalFp == NULL || newFp == NULL) {
-        sprintf(error, "File %s could not be opened.\n", (originalFp == NULL) ? origialFileName : newFileName);
-        goto end;
-    }
-
+    /* the file starts with the libraries of --library, and adds the ones it imports */
+    begin_file_libraries();
+    conditions.count = 0;
+    conditions.skipping = FALSE;
+    conditions.skippedDepth = 0;
     macros = create_hashtable();
-    if (macros == NULL) {
-        sprintf(error, "Failed to allocate memory for macros hashtable\n");
+    defines = create_hashtable();
+    if (macros == NULL || defines == NULL) {
+        report(DIAG_OUT_OF_MEMORY, origialFileName, 0, 0, "s", "macros hashtable");
+        failed = 1;
         goto end;
     }
     /* Flag to check if currently reading a macro definition */
@@ -75,68 +532,102 @@ PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** s
     /* Flag to check if a line over the MAX_LINE_LENGTH have been found in the file */
     lineTooLong = 0;
     
-    while (fgets(line, MAX_LINE_LENGTH + 2, originalFp) != NULL) {
+    while (next_line(source, &offset, &line)) {
         lineNumber++;
+        /* the code of a macro may have any line, the directives of conditional assembly are only looked for outside of it */
+        /* like the other lines, only the first MAX_LINE_LENGTH characters of a directive are used */
+        directiveLine = line;
+        if (directiveLine.length > MAX_LINE_LENGTH) {
+            directiveLine.length = MAX_LINE_LENGTH;
+        }
+        directive = inMacro ? CONDITION_NONE : condition_directive(&directiveLine, &rest);
+        if (conditions.skipping) {
+            /* a skipped line is not written to the am file, and it is never tokenized */
+            add_map_line(map, MACRO_DEFINITION_LINE);
+            if (directive != CONDITION_NONE && skipped_line(&conditions, directive, &directiveLine, rest, origialFileName, lineNumber) != 0) {
+                failed = 1;
+            }
+            continue;
+        }
+
         /* Check if line is too long */
-        if (strstr(line, "\n") == NULL && !feof(originalFp)) {
+        if (line.length > MAX_LINE_LENGTH) {
             lineTooLong = 1;
-            fprintf(stderr, "Error in file \"%s\", line %d is too long, maximum length is %d\n", 
-            origialFileName, lineNumber, MAX_LINE_LENGTH);
-            do {
-                currentChar = fgetc(originalFp);
-            } while (currentChar != '\n' && currentChar != EOF);
-            line[MAX_LINE_LENGTH] = '\n'; /* Clear the rest of the line */
+            report(DIAG_LINE_TOO_LONG, origialFileName, lineNumber, MAX_LINE_LENGTH + 1, "d", MAX_LINE_LENGTH);
         }
 
-        /* Tokenize the line */
-        tokens = tokenize_line(line, &allocationError);
+        if (directive != CONDITION_NONE) {
+            /* like a macro definition, the directives of conditional assembly are not written to the am file */
+            add_map_line(map, MACRO_DEFINITION_LINE);
+            status = condition_line(&conditions, directive, &directiveLine, rest, defines, origialFileName, lineNumber);
+            if (status != 0) {
+                failed = 1;
+            }
+            if (status < 0) {
+                break;
+            }
+            continue;
+        }
+
+        /* Tokenize the line, only the first MAX_LINE_LENGTH characters of it are used */
+        tokens = tokenize_span(line.start, line.length > MAX_LINE_LENGTH ? MAX_LINE_LENGTH : line.length, &allocationError);
         if (allocationError) {
-            sprintf(error, "Error in file \"%s\", line %d: Failed to allocate memory\n", origialFileName, lineNumber);
+            report(DIAG_OUT_OF_MEMORY, origialFileName, lineNumber, 0, "s", "the tokens of the line");
+            failed = 1;
             goto end;
         }
         firstToken = tokens; /* Keep track of the first node to free it later*/
 
         if (firstToken == NULL) {
+            /* a blank line inside a macro is still a part of its definition */
+            add_map_line(map, inMacro ? MACRO_DEFINITION_LINE : 0);
             continue;
         }
 
         /* Check if line is start of a macro defintion */
         if (strcmp(firstToken->token, MACRO_START) == 0) {
             if (firstToken->next == NULL) {
-                sprintf(error, "Error in file \"%s\", line %d: Macro name is missing\n", origialFileName, lineNumber);
+                report(DIAG_MACRO_NAME_MISSING, origialFileName, lineNumber, 0, "");
+                failed = 1;
                 break;
             }
 
             if (!is_macro_name_valid(firstToken->next->token)) {
-                sprintf(error, "Error in file \"%s\", line %d: Invalid macro name %s\n", origialFileName, lineNumber, firstToken->next->token);
+                report(DIAG_INVALID_MACRO_NAME, origialFileName, lineNumber, firstToken->next->column, "s", firstToken->next->token);
+                failed = 1;
                 break;
             }
 
             if (firstToken->next->next != NULL) {
-                sprintf(error, "Error in file \"%s\", line %d: Unexpected token %s after macro name\n", origialFileName, lineNumber, firstToken->next->next->token);
+                report(DIAG_TOKEN_AFTER_MACRO_NAME, origialFileName, lineNumber, firstToken->next->next->column, "s", firstToken->next->next->token);
+                failed = 1;
                 break;
             }
             tempMacroName = firstToken->next->token;
-            symbolJ = insert_symbol(symbol_table_head, tempMacroName); /* Insert the new macro to the symbols table */
+            symbolJ = insert_symbol_from(symbol_table_head, freeSymbols, tempMacroName); /* Insert the new macro to the symbols table */
             if (symbolJ == NULL) {
-                sprintf(error, "Error: Failed to allocate memory for macro symbol\n");
+                report(DIAG_OUT_OF_MEMORY, origialFileName, lineNumber, 0, "s", "macro symbol");
                 allocationError = 1;
                 goto end;
             }
             symbolJ->symbol->type = ENUM_SYMBOL_CONSTANT_MACRO;
             inMacro = 1;
-            insert(macros, tempMacroName, "", 1); /* empty string because the macro hasn't been capturedm */
-            if (macros == NULL) {
-                sprintf(error, "Error: Failed to allocate memory for macro hashtable\n");
+            add_map_line(map, MACRO_DEFINITION_LINE);
+            /* the macro's code is empty until its lines are captured */
+            emptyCode.start = offset;
+            emptyCode.end = offset;
+            if (insert(macros, tempMacroName, &emptyCode, sizeof(MacroCode)) != 0) {
+                report(DIAG_OUT_OF_MEMORY, origialFileName, lineNumber, 0, "s", "macro hashtable");
                 allocationError = 1;
                 goto end;
             }
+            currentMacroCode = (MacroCode*)search(macros, tempMacroName);
             if (currentMacroName != NULL) {
                 free(currentMacroName);
             }
             currentMacroName = duplicate_string(tempMacroName);
             if (currentMacroName == NULL) {
-                sprintf(error, "Error: Failed to allocate memory for macro name\n");
+                report(DIAG_OUT_OF_MEMORY, origialFileName, lineNumber, 0, "s", "macro name");
                 allocationError = 1;
                 goto end;
             }
@@ -144,27 +635,23 @@ PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** s
         /* Check if line is end of a macro definition */
         else if (strcmp(tokens->token, MACRO_END) == 0 && inMacro) {
             if (tokens->next != NULL) {
-                sprintf(error, "Error in file \"%s\", line %d: Unexpected token %s after macro end: %s\n", origialFileName, lineNumber, tokens->next->token, MACRO_END);
+                report(DIAG_TOKEN_AFTER_MACRO_END, origialFileName, lineNumber, tokens->next->column, "ss", tokens->next->token, MACRO_END);
+                failed = 1;
                 break;
             }
             inMacro = 0;
+            add_map_line(map, MACRO_DEFINITION_LINE);
         }
-        /* If in macro, append line to macro's code */
+        /* If in macro, the line is part of the macro's code, which now ends after this line */
         else if (inMacro) {
-            currentMacroCode = (char*)search(macros, currentMacroName);
-            newMacroCode = concatenate_strings(currentMacroCode, line);
-            if (newMacroCode == NULL) {
-                sprintf(error, "Error: Failed to allocate memory for macro\n");
-                allocationError = 1;
-                goto end;
+            currentMacroCode->end = offset;
+            add_map_line(map, MACRO_DEFINITION_LINE);
+        /* the import of a library, like a macro definition it isn't written to the am file */
+        } else if (strcmp(firstToken->token, IMPORT_DIRECTIVE) == 0) {
+            add_map_line(map, MACRO_DEFINITION_LINE);
+            if (import_directive(firstToken->next, origialFileName, lineNumber) != 0) {
+                failed = 1;
             }
-            /* Update the macro defintion with the new code */
-            replace(macros, currentMacroName, newMacroCode, strlen(newMacroCode) + 1, &allocationError);
-            if (allocationError) {
-                sprintf(error, "Error: Failed to allocate memory for macro\n");
-                goto end;
-            }
-            free(newMacroCode);
         /* If not in macro, then the line is a normal line */
         } else {
             if (firstToken != NULL) {
@@ -173,11 +660,21 @@ PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** s
                 tempMacroName = NULL;
             }
             /* If a macro is called here, seach it */
-            macroCode = (char*)search(macros, tempMacroName);
+            macroCode = (MacroCode*)search(macros, tempMacroName);
             if (macroCode != NULL) {
-                fputs(macroCode, newFp);
+                add_map_line(map, write_macro_code(output, source, macroCode));
+            } else if ((libraryLines = library_macro(tempMacroName, &libraryCode, &libraryCodeLength)) >= 0) {
+                /* the code of a macro of a library is already in the form of the am file */
+                output_write(output, libraryCode, libraryCodeLength);
+                add_map_line(map, libraryLines);
             } else {
-                fputs(line, newFp);
+                write_line(output, &line);
+                add_map_line(map, 1);
+                if (strcmp(firstToken->token, DEFINE) == 0 && keep_define(defines, firstToken->next) != 0) {
+                    report(DIAG_OUT_OF_MEMORY, origialFileName, lineNumber, 0, "s", "the constants of the conditions");
+                    allocationError = 1;
+                    goto end;
+                }
             }
         }
 
@@ -188,6 +685,14 @@ PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** s
     }
 
 
+    /* the conditions that are still open when the file ends (and not when the loop stopped at an error) */
+    if (offset >= source->size) {
+        for (i = conditions.count - 1; i >= 0; i--) {
+            report(DIAG_IF_NOT_CLOSED, origialFileName, conditions.open[i].line, 0, "s", condition_name(conditions.open[i].directive));
+            failed = 1;
+        }
+    }
+
     end:
     /* Free the last tokens if not freed by the loop (early break)*/
     if (firstToken != NULL) {
@@ -195,17 +700,6 @@ PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** s
         firstToken = NULL;
     }
 
-    if (originalFp != NULL)
-        fclose(originalFp);
-    if (newFp != NULL)
-        fclose(newFp); /* Ensure the file is closed before trying to remove it */
-    if (error[0] != '\0' || allocationError) { 
-        if (error[0] != '\0') 
-            fprintf(stderr, "%s", error);
-        if (remove(newFileName) != 0) {
-            perror("Error deleting file");
-        }
-    }
     /* Free variables */
     if (currentMacroName != NULL) {
         free(currentMacroName);
@@ -213,8 +707,11 @@ PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** s
     if (macros != NULL) {
         free_hashtable(macros);
     }
+    if (defines != NULL) {
+        free_hashtable(defines);
+    }
 
-    if (error[0] != '\0' || allocationError) return PREPROCESS_FAIL;
+    if (failed || allocationError) return PREPROCESS_FAIL;
     if (lineTooLong) return PREPROCESS_WARNING;
     return PREPROCESS_SUCCESS;
 
@@ -2,16 +2,50 @@
 #define PREPROCESSOR_H
 
 #include "data_structures/node.h"
+#include "mapped_file.h"
+#include "output_buffer.h"
+
+#define MACRO_DEFINITION_LINE -1
+
+/* The number of lines of the am file that every line of the source was written to, so that a line that changes
+ can be preprocessed again on its own. the lines of a macro definition (mcr, its code and endmcr), .import and the directives of
+ conditional assembly, and the lines that a condition skips, are MACRO_DEFINITION_LINE */
+typedef struct {
+    int* lines;
+    int count;
+    int capacity;
+    boolean failed; /* set if the array could not grow */
+} PreprocessMap;
+
+/* Function to check if a macro name is valid: a latin letter and then up to 30 printable characters that aren't whitespace,
+ and not a reserved keyword */
+boolean is_macro_name_valid(const char* macroName);
+
+/* the define_condition_constant function adds a constant that the conditions of every file can use (the --define option).
+    the definition is NAME, which is 1, or NAME=VALUE. returns 0 on success and 1 if the definition isn't valid */
+int define_condition_constant(const char* definition);
+
+/* the free_condition_constants function frees the constants of define_condition_constant */
+void free_condition_constants(void);
+
+/* Function to check if a token is a directive of conditional assembly (.if, .ifdef, .ifndef, .else or .endif) */
+boolean is_condition_directive(const char* token);
 
 /**
- * create_preprocessed_file - Processes an assembly source file to expand macros and prepare it for assembly.
- * The filename is the base name of the file to process, i.e. excluding an extension.
+ * preprocess_source - Processes an assembly source file to expand macros and prepare it for assembly.
+ * The source is the content of the .as file, and origialFileName is its name, which is used in error messages.
  * The symbol_table_head is a double pointer to the head of a linked list for symbol management.
  * 
- * This function reads an assembly file (.as), expands macros defined within it, and writes the result to a new file (.am).
- * It updates the symbol table with macro definitions.
+ * This function expands the macros defined within the source, and writes the result (the content of the .am file) to output.
+ * It updates the symbol table with macro definitions, whose nodes are taken from freeSymbols when it isn't NULL (see insert_symbol_from).
+ * The lines between .if, .ifdef or .ifndef and the .else or .endif that ends it are only written when the condition holds,
+ * the conditions use the .define constants before them, the constants of the libraries and the --define constants.
+ * The lines of a branch that isn't assembled are only searched for the directives that end it.
+ * The libraries that the file imports with .import are added to the ones of --library (see library.h), and their macros are expanded
+ * like the macros of the file.
+ * When map isn't NULL, the number of am lines that every line of the source was written to is added to it.
  * It returns a PreprocessStatus indicating the success of the preprocessing, or a warning/error status if issues are encountered.
  */
-PreprocessStatus create_preprocessed_file(const char* filename, Symbol_Node ** symbol_table_head, char* origialFileName, char* newFileName);
+PreprocessStatus preprocess_source(const MappedFile* source, Symbol_Node ** symbol_table_head, Symbol_Node ** freeSymbols, const char* origialFileName, OutputBuffer* output, PreprocessMap* map);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+#include "constants.h"
+#include "mapped_file.h"
+#include "utils.h"
+
+#define PROFILE_INITIAL_LABELS 16
+
+/* A label of the code, and the number of instructions that ran from it until the next label */
+typedef struct {
+    char name[MAX_LABEL_LENGTH + 1];
+    int address;
+    unsigned long count;
+} ProfileLabel;
+
+/* The labels and the lines that are known about the program */
+typedef struct {
+    ProfileLabel* labels;
+    int labelCount;
+    int capacity;
+    int* lines; /* the line of the .am file of the instruction at every address, or 0 */
+    int lastLine; /* the largest line in lines */
+} ProfileInfo;
+
+/* the add_label function adds a label to the info, if it is a label of the code. returns 1 if the memory could not be allocated */
+static int add_label(ProfileInfo* info, const Machine* machine, const char* name, int address) {
+    ProfileLabel* grown;
+    if (address < START_POSITION || address >= machine->codeEnd || strlen(name) > MAX_LABEL_LENGTH) {
+        return 0;
+    }
+    if (info->labelCount == info->capacity) {
+        /* the array is doubled when it is full */
+        info->capacity = info->capacity == 0 ? PROFILE_INITIAL_LABELS : info->capacity * 2;
+        grown = realloc(info->labels, info->capacity * sizeof(ProfileLabel));
+        if (grown == NULL) {
+            return 1;
+        }
+        info->labels = grown;
+    }
+    strcpy(info->labels[info->labelCount].name, name);
+    info->labels[info->labelCount].address = address;
+    info->labels[info->labelCount].count = 0;
+    info->labelCount++;
+    return 0;
+}
+
+/* the read_map function reads the symbols and the lines of name.map into the info. a file that doesn't exist has neither */
+static int read_map(const char* name, const Machine* machine, ProfileInfo* info) {
+    MappedFile file;
+    LineView line;
+    size_t offset = 0;
+    char buffer[MAX_LINE_LENGTH + 1], kind[MAX_LINE_LENGTH + 1], label[MAX_LINE_LENGTH + 1];
+    char* mapName;
+    int address, lineNumber, error = 0;
+
+    mapName = concatenate_strings(name, ".map");
+    if (mapName == NULL) {
+        return 1;
+    }
+    if (map_file(mapName, &file) != 0) {
+        free(mapName);
+        return 0;
+    }
+    while (!error && next_line(&file, &offset, &line)) {
+        if (line.length > MAX_LINE_LENGTH) {
+            continue;
+        }
+        memcpy(buffer, line.start, line.length);
+        buffer[line.length] = '\0';
+        if (sscanf(buffer, "%s", kind) != 1) {
+            continue;
+        }
+        if (strcmp(kind, "symbol") == 0 && sscanf(buffer, "%*s %s %d", label, &address) == 2) {
+            error = add_label(info, machine, label, address);
+        } else if (strcmp(kind, "line") == 0 && sscanf(buffer, "%*s %d %d", &address, &lineNumber) == 2 &&
+            address >= 0 && address < machine->memorySize && lineNumber > 0) {
+            info->lines[address] = lineNumber;
+            if (lineNumber > info->lastLine) {
+                info->lastLine = lineNumber;
+            }
+        }
+    }
+    unmap_file(&file);
+    free(mapName);
+    return error;
+}
+
+/* the compare_address function orders labels by their address, and then by their name */
+static int compare_address(const void* first, const void* second) {
+    const ProfileLabel* a = (const ProfileLabel*)first;
+    const ProfileLabel* b = (const ProfileLabel*)second;
+    if (a->address != b->address) {
+        return a->address < b->address ? -1 : 1;
+    }
+    return strcmp(a->name, b->name);
+}
+
+/* the compare_count function orders labels from the most instructions to the least */
+static int compare_count(const void* first, const void* second) {
+    const ProfileLabel* a = (const ProfileLabel*)first;
+    const ProfileLabel* b = (const ProfileLabel*)second;
+    if (a->count != b->count) {
+        return a->count > b->count ? -1 : 1;
+    }
+    return compare_address(first, second);
+}
+
+/* the print_flat_profile function writes the number of instructions that ran from every label until the next one */
+static void print_flat_profile(FILE* stream, const Machine* machine, const ObjectFile* object, ProfileInfo* info) {
+    unsigned long beforeLabels = 0;
+    int i, j, address, end;
+
+    /* the same label can come from the .ent file and from the .map file */
+    if (info->labelCount > 0) {
+        qsort(info->labels, info->labelCount, sizeof(ProfileLabel), compare_address);
+    }
+    for (i = 0, j = 0; i < info->labelCount; i++) {
+        if (j == 0 || compare_address(&info->labels[j - 1], &info->labels[i]) != 0) {
+            info->labels[j++] = info->labels[i];
+        }
+    }
+    info->labelCount = j;
+
+    for (address = START_POSITION; address < machine->codeEnd && (info->labelCount == 0 || address < info->labels[0].address); address++) {
+        beforeLabels += machine->profile[address];
+    }
+    for (i = 0; i < info->labelCount; i++) {
+        end = i + 1 < info->labelCount ? info->labels[i + 1].address : machine->codeEnd;
+        for (address = info->labels[i].address; address < end; address++) {
+            info->labels[i].count += machine->profile[address];
+        }
+    }
+    if (info->labelCount > 0) {
+        qsort(info->labels, info->labelCount, sizeof(ProfileLabel), compare_count);
+    }
+
+    fprintf(stream, "Flat profile of \"%s\", %lu instructions:\n", object->name, machine->steps);
+    fprintf(stream, "%14s %8s  %s\n", "instructions", "percent", "label");
+    for (i = 0; i < info->labelCount; i++) {
+        if (info->labels[i].count > 0) {
+            fprintf(stream, "%14lu %7.2f%%  %s\n", info->labels[i].count,
+                machine->steps > 0 ? 100.0 * info->labels[i].count / machine->steps : 0.0, info->labels[i].name);
+        }
+    }
+    if (beforeLabels > 0) {
+        fprintf(stream, "%14lu %7.2f%%  %s\n", beforeLabels, machine->steps > 0 ? 100.0 * beforeLabels / machine->steps : 0.0, "(no label)");
+    }
+}
+
+/* the print_listing function writes every line of name.am with the number of instructions that ran on it.
+    returns 1 if the .am file could not be read, so the listing can be written by address instead */
+static int print_listing(FILE* stream, const Machine* machine, const ObjectFile* object, const ProfileInfo* info) {
+    MappedFile file;
+    LineView line;
+    size_t offset = 0;
+    unsigned long* lineCounts;
+    char* amName;
+    int address, lineNumber = 0;
+
+    amName = concatenate_strings(object->name, ".am");
+    if (amName == NULL || info->lastLine == 0 || map_file(amName, &file) != 0) {
+        if (amName != NULL) free(amName);
+        return 1;
+    }
+    lineCounts = calloc(info->lastLine + 1, sizeof(unsigned long));
+    if (lineCounts == NULL) {
+        unmap_file(&file);
+        free(amName);
+        return 1;
+    }
+    for (address = START_POSITION; address < machine->codeEnd; address++) {
+        if (info->lines[address] != 0) {
+            lineCounts[info->lines[address]] += machine->profile[address];
+        }
+    }
+
+    fprintf(stream, "\nListing of \"%s\":\n", amName);
+    while (next_line(&file, &offset, &line)) {
+        lineNumber++;
+        if (lineNumber <= info->lastLine && lineCounts[lineNumber] > 0) {
+            fprintf(stream, "%14lu | %.*s\n", lineCounts[lineNumber], line.length, line.start);
+        } else {
+            fprintf(stream, "%14s | %.*s\n", "", line.length, line.start);
+        }
+    }
+    free(lineCounts);
+    unmap_file(&file);
+    free(amName);
+    return 0;
+}
+
+/* the print_profile function writes the profile of a program that ran on the machine with its profile counters.
+    the flat profile counts the instructions that ran from every label of the code until the next label,
+    the labels are the entries of the object and the symbols of name.map (written by the assembler with --map).
+    when name.map has the lines of the instructions, the listing is name.am with the count of every line,
+    otherwise it is the count of every address that ran. returns 1 if the memory could not be allocated */
+int print_profile(FILE* stream, const Machine* machine, const ObjectFile* object) {
+    ProfileInfo info;
+    int i, address, error = 0;
+
+    memset(&info, 0, sizeof(ProfileInfo));
+    info.lines = calloc(machine->memorySize, sizeof(int));
+    if (info.lines == NULL) {
+        return 1;
+    }
+    for (i = 0; i < object->entryCount && !error; i++) {
+        error = add_label(&info, machine, object->entries[i].name, object->entries[i].address);
+    }
+    if (!error) {
+        error = read_map(object->name, machine, &info);
+    }
+    if (!error) {
+        print_flat_profile(stream, machine, object, &info);
+        if (print_listing(stream, machine, object, &info) != 0) {
+            fprintf(stream, "\nInstructions by address:\n");
+            for (address = START_POSITION; address < machine->codeEnd; address++) {
+                if (machine->profile[address] > 0) {
+                    fprintf(stream, "%14lu | %04d\n", machine->profile[address], address);
+                }
+            }
+        }
+    }
+    if (info.labels != NULL) free(info.labels);
+    free(info.lines);
+    return error;
+}
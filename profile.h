@@ -0,0 +1,15 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include "machine.h"
+#include "object_file.h"
+
+/* the print_profile function writes the profile of a program that ran on the machine with its profile counters.
+    the flat profile counts the instructions that ran from every label of the code until the next label,
+    the labels are the entries of the object and the symbols of name.map (written by the assembler with --map).
+    when name.map has the lines of the instructions, the listing is name.am with the count of every line,
+    otherwise it is the count of every address that ran. returns 1 if the memory could not be allocated */
+int print_profile(FILE* stream, const Machine* machine, const ObjectFile* object);
+
+#endif
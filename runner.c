@@ -0,0 +1,612 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "machine.h"
+#include "jit.h"
+#include "lockstep.h"
+#include "snapshot.h"
+#include "object_file.h"
+#include "mapped_file.h"
+#include "constants.h"
+#include "utils.h"
+#include "json.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define HAS_THREADS 1
+#endif
+
+#define DEFAULT_RUNNER_THREADS 4
+#define MAX_RUNNER_THREADS 256
+#define RUNNER_SLICE_STEPS 1000000 /* the number of instructions that run between two checks of the time limit */
+#define MAX_MANIFEST_FIELD 256
+
+/* The results a job can have */
+typedef enum {
+    JOB_PASS,
+    JOB_FAIL, /* the program halted, but its output isn't the expected output */
+    JOB_FAULT, /* the program did something the machine can't do */
+    JOB_STEP_LIMIT,
+    JOB_TIME_LIMIT,
+    JOB_ERROR /* the object, the input or the expected output could not be read */
+} JobStatus;
+
+static const char* jobStatusNames[] = {"pass", "fail", "fault", "step-limit", "time-limit", "error"};
+
+/* A line of the manifest: a program to run with an input, and the output it should write */
+typedef struct {
+    char object[MAX_MANIFEST_FIELD];
+    char input[MAX_MANIFEST_FIELD]; /* "-" for no input */
+    char expected[MAX_MANIFEST_FIELD]; /* "-" to only check that the program halts */
+    unsigned long maxSteps; /* 0 for no limit */
+    long timeLimit; /* in milliseconds, 0 for no limit */
+    JobStatus status;
+    unsigned long steps;
+    double milliseconds;
+    int next; /* with --lockstep, the next job of the batch that runs together with this job, or -1 */
+    boolean follows; /* with --lockstep, the job runs in the batch of an earlier job */
+} Job;
+
+/* The jobs that a worker will run. the worker takes jobs from the end, and the other workers steal from the start */
+typedef struct {
+    int* jobs;
+    int first;
+    int last; /* the jobs are jobs[first] to jobs[last - 1] */
+#ifdef HAS_THREADS
+    pthread_mutex_t lock;
+#endif
+} WorkQueue;
+
+/* What the workers share */
+typedef struct {
+    Job* jobs;
+    WorkQueue* queues;
+    int workerCount;
+    int memorySize;
+    boolean jit; /* --jit: the programs are translated into native code while they run */
+    boolean lockstep; /* --lockstep: the jobs of the same object run together, in the lanes of one Lockstep */
+} Runner;
+
+/* The program that is loaded on the machine of a worker. a job of the same object restores the snapshot instead of loading it again */
+typedef struct {
+    char object[MAX_MANIFEST_FIELD];
+    boolean valid; /* the machine still runs the object, and the snapshot was taken after it was loaded */
+    MachineSnapshot snapshot;
+} LoadedProgram;
+
+/* What a worker gets when it starts */
+typedef struct {
+    Runner* runner;
+    int index;
+} Worker;
+
+/* the now_milliseconds function returns the time from some fixed point, in milliseconds */
+static double now_milliseconds(void) {
+#ifdef HAS_THREADS
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+#else
+    return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+#endif
+}
+
+/* the take_job function takes the next job of a queue. fromStart is used by workers that steal from it.
+    returns the index of the job, or -1 if the queue is empty */
+static int take_job(WorkQueue* queue, boolean fromStart) {
+    int job = -1;
+#ifdef HAS_THREADS
+    pthread_mutex_lock(&queue->lock);
+#endif
+    if (queue->first < queue->last) {
+        job = fromStart ? queue->jobs[queue->first++] : queue->jobs[--queue->last];
+    }
+#ifdef HAS_THREADS
+    pthread_mutex_unlock(&queue->lock);
+#endif
+    return job;
+}
+
+/* the same_output function checks if the output of the program is the content of the expected file */
+static int same_output(FILE* output, const char* expectedName, int* error) {
+    MappedFile expected;
+    long size;
+    size_t i;
+    int same;
+    if (map_file(expectedName, &expected) != 0) {
+        *error = 1;
+        return 0;
+    }
+    size = ftell(output);
+    same = size >= 0 && (size_t)size == expected.size;
+    rewind(output);
+    for (i = 0; same && i < expected.size; i++) {
+        same = getc(output) == (unsigned char)expected.data[i];
+    }
+    unmap_file(&expected);
+    return same;
+}
+
+/* the open_streams function opens the input of a job, and a temporary file for its output. returns 0 on success and 1 on error */
+static int open_streams(const Job* job, FILE** input, FILE** output) {
+    *input = strcmp(job->input, "-") == 0 ? tmpfile() : fopen(job->input, "r");
+    *output = tmpfile();
+    if (*input == NULL || *output == NULL) {
+        fprintf(stderr, "Error: The input or the output of \"%s\" could not be opened\n", job->object);
+        if (*input != NULL) fclose(*input);
+        if (*output != NULL) fclose(*output);
+        *input = NULL;
+        *output = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+/* the run_slices function runs the program that is loaded on the machine, in slices of RUNNER_SLICE_STEPS instructions
+    so the time limit of the job is checked between them. returns TRUE if the job ran out of time */
+static boolean run_slices(const Job* job, Machine* machine, Jit* jit, FILE* input, FILE* output, double start, MachineStatus* status) {
+    unsigned long limit;
+    *status = MACHINE_STEP_LIMIT;
+    while (*status == MACHINE_STEP_LIMIT) {
+        limit = machine->steps + RUNNER_SLICE_STEPS;
+        if (job->maxSteps > 0 && limit > job->maxSteps) {
+            limit = job->maxSteps;
+        }
+        *status = jit != NULL ? run_jit(jit, machine, limit, input, output) : run_machine(machine, limit, input, output);
+        if (*status == MACHINE_STEP_LIMIT && job->maxSteps > 0 && machine->steps >= job->maxSteps) {
+            break;
+        }
+        if (*status == MACHINE_STEP_LIMIT && job->timeLimit > 0 && now_milliseconds() - start > job->timeLimit) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* the finish_job function sets the result of a job from the way its program stopped, and the output it wrote */
+static void finish_job(Job* job, MachineStatus status, boolean timedOut, FILE* output) {
+    int error = 0;
+    if (timedOut) {
+        job->status = JOB_TIME_LIMIT;
+    } else if (status == MACHINE_FAULT) {
+        job->status = JOB_FAULT;
+    } else if (status == MACHINE_STEP_LIMIT) {
+        job->status = JOB_STEP_LIMIT;
+    } else if (strcmp(job->expected, "-") == 0 || same_output(output, job->expected, &error)) {
+        job->status = JOB_PASS;
+    } else {
+        job->status = error ? JOB_ERROR : JOB_FAIL;
+        if (error) {
+            fprintf(stderr, "Error: The expected output \"%s\" could not be opened\n", job->expected);
+        }
+    }
+}
+
+/* the load_program function readies the machine to run the object of a job. when the object is the one that the machine ran last,
+    only the pages that the last job wrote are restored, and the translated code is kept unless the code was written.
+    returns 0 on success and 1 on error */
+static int load_program(const Job* job, Machine* machine, Jit* jit, LoadedProgram* loaded) {
+    ObjectFile object;
+
+    if (loaded->valid && strcmp(loaded->object, job->object) == 0) {
+        if (restore_snapshot(machine, &loaded->snapshot) && jit != NULL) {
+            flush_jit(jit);
+        }
+        return 0;
+    }
+    loaded->valid = FALSE;
+    if (load_object(job->object, &object) != 0) {
+        return 1;
+    }
+    if (load_machine(machine, &object) != 0) {
+        free_object(&object);
+        return 1;
+    }
+    free_object(&object);
+    if (jit != NULL) {
+        flush_jit(jit);
+    }
+    if (take_snapshot(&loaded->snapshot, machine) == 0) {
+        strcpy(loaded->object, job->object);
+        loaded->valid = TRUE;
+    }
+    return 0;
+}
+
+/* the run_job function runs a single job on the machine of the worker, with its translator when it isn't NULL */
+static void run_job(Job* job, Machine* machine, Jit* jit, LoadedProgram* loaded) {
+    FILE *input = NULL, *output = NULL;
+    MachineStatus status;
+    boolean timedOut;
+    double start;
+
+    job->status = JOB_ERROR;
+    machine->steps = 0;
+    start = now_milliseconds();
+    if (open_streams(job, &input, &output) != 0 || load_program(job, machine, jit, loaded) != 0) {
+        goto end;
+    }
+    timedOut = run_slices(job, machine, jit, input, output, start, &status);
+    finish_job(job, status, timedOut, output);
+
+    end:
+    job->steps = machine->steps;
+    job->milliseconds = now_milliseconds() - start;
+    if (input != NULL) fclose(input);
+    if (output != NULL) fclose(output);
+}
+
+/* the run_batch function runs the jobs of a batch, that all run the same object, together in the lanes of the worker.
+    a lane that writes into the code leaves the batch and continues on the machine of the worker */
+static void run_batch(Job* jobs, int first, Machine* machine, Jit* jit, Lockstep* lockstep, LoadedProgram* loaded) {
+    ObjectFile object;
+    FILE *inputs[MAX_LANES], *outputs[MAX_LANES];
+    MachineStatus status;
+    boolean timedOut, done[MAX_LANES];
+    int lanes[MAX_LANES], laneCount = 0, job, lane, running;
+    double start, now;
+
+    start = now_milliseconds();
+    for (job = first; job >= 0; job = jobs[job].next) {
+        jobs[job].status = JOB_ERROR;
+        jobs[job].steps = 0;
+        jobs[job].milliseconds = 0;
+    }
+    if (load_object(jobs[first].object, &object) != 0) {
+        return;
+    }
+    for (job = first; job >= 0; job = jobs[job].next) {
+        if (open_streams(&jobs[job], &inputs[laneCount], &outputs[laneCount]) == 0) {
+            done[laneCount] = FALSE;
+            lanes[laneCount++] = job;
+        }
+    }
+    if (laneCount == 0 || load_lockstep(lockstep, &object, laneCount) != 0) {
+        free_object(&object);
+        goto end;
+    }
+    free_object(&object);
+    for (lane = 0; lane < laneCount; lane++) {
+        lockstep->input[lane] = inputs[lane];
+        lockstep->output[lane] = outputs[lane];
+        lockstep->maxSteps[lane] = jobs[lanes[lane]].maxSteps;
+    }
+
+    /* the lanes run in slices, so the time limits are checked every RUNNER_SLICE_STEPS instructions */
+    do {
+        running = run_lockstep(lockstep, lockstep->groupSteps + RUNNER_SLICE_STEPS);
+        now = now_milliseconds();
+        for (lane = 0; lane < laneCount; lane++) {
+            job = lanes[lane];
+            if (lockstep->status[lane] == LANE_RUNNING && jobs[job].timeLimit > 0 && now - start > jobs[job].timeLimit) {
+                lockstep->status[lane] = LANE_STOPPED;
+                running--;
+            }
+            if (lockstep->status[lane] == LANE_RUNNING || done[lane]) {
+                continue;
+            }
+            done[lane] = TRUE;
+            jobs[job].steps = lockstep->steps[lane];
+            switch (lockstep->status[lane]) {
+                case LANE_DETACHED:
+                    detach_lane(lockstep, lane, machine);
+                    loaded->valid = FALSE;
+                    if (jit != NULL) {
+                        flush_jit(jit);
+                    }
+                    timedOut = run_slices(&jobs[job], machine, jit, inputs[lane], outputs[lane], start, &status);
+                    finish_job(&jobs[job], status, timedOut, outputs[lane]);
+                    jobs[job].steps = machine->steps;
+                    break;
+                case LANE_STOPPED:
+                    finish_job(&jobs[job], MACHINE_STEP_LIMIT, TRUE, outputs[lane]);
+                    break;
+                default:
+                    status = lockstep->status[lane] == LANE_HALTED ? MACHINE_HALTED :
+                        lockstep->status[lane] == LANE_FAULT ? MACHINE_FAULT : MACHINE_STEP_LIMIT;
+                    finish_job(&jobs[job], status, FALSE, outputs[lane]);
+                    break;
+            }
+            jobs[job].milliseconds = now_milliseconds() - start;
+        }
+    } while (running > 0);
+
+    end:
+    for (lane = 0; lane < laneCount; lane++) {
+        fclose(inputs[lane]);
+        fclose(outputs[lane]);
+    }
+}
+
+/* the group_jobs function puts the jobs that run the same object into batches of up to MAX_LANES jobs, for --lockstep.
+    the first job of every batch is the one that is queued */
+static void group_jobs(Job* jobs, int count) {
+    int i, j, last, size;
+    for (i = 0; i < count; i++) {
+        if (jobs[i].follows) {
+            continue;
+        }
+        last = i;
+        size = 1;
+        for (j = i + 1; j < count && size < MAX_LANES; j++) {
+            if (!jobs[j].follows && strcmp(jobs[j].object, jobs[i].object) == 0) {
+                jobs[last].next = j;
+                jobs[j].follows = TRUE;
+                last = j;
+                size++;
+            }
+        }
+    }
+}
+
+/* the work function runs the jobs of the worker's queue, and then steals jobs from the other queues until all of them are empty */
+static void* work(void* argument) {
+    Worker* worker = (Worker*)argument;
+    Runner* runner = worker->runner;
+    Machine machine;
+    Jit jit;
+    Lockstep lockstep;
+    LoadedProgram loaded;
+    int job, i;
+
+    if (create_machine(&machine, runner->memorySize) != 0) {
+        fprintf(stderr, "Failed to allocate memory for a machine\n");
+        return NULL;
+    }
+    if (runner->jit && create_jit(&jit, &machine) != 0) {
+        fprintf(stderr, "Failed to allocate memory for a translator\n");
+        free_machine(&machine);
+        return NULL;
+    }
+    if (runner->lockstep && create_lockstep(&lockstep, runner->memorySize) != 0) {
+        fprintf(stderr, "Failed to allocate memory for the lanes\n");
+        if (runner->jit) free_jit(&jit);
+        free_machine(&machine);
+        return NULL;
+    }
+    memset(&loaded, 0, sizeof(loaded));
+    for (;;) {
+        job = take_job(&runner->queues[worker->index], FALSE);
+        /* when the queue of the worker is empty, it steals from the start of the other queues */
+        for (i = 1; job < 0 && i < runner->workerCount; i++) {
+            job = take_job(&runner->queues[(worker->index + i) % runner->workerCount], TRUE);
+        }
+        if (job < 0) {
+            break;
+        }
+        if (runner->jobs[job].next >= 0) {
+            run_batch(runner->jobs, job, &machine, runner->jit ? &jit : NULL, &lockstep, &loaded);
+        } else {
+            run_job(&runner->jobs[job], &machine, runner->jit ? &jit : NULL, &loaded);
+        }
+    }
+    if (runner->jit) {
+        free_jit(&jit);
+    }
+    if (runner->lockstep) {
+        free_lockstep(&lockstep);
+    }
+    free_snapshot(&loaded.snapshot);
+    free_machine(&machine);
+    return NULL;
+}
+
+/* the read_manifest function reads the jobs of the manifest into a new array. every line is
+    OBJECT INPUT EXPECTED [MAX_STEPS [TIME_LIMIT]]
+    empty lines and lines that start with # are skipped. returns 0 on success and 1 on error */
+static int read_manifest(const char* fileName, Job** result, int* count, unsigned long maxSteps, long timeLimit) {
+    MappedFile file;
+    LineView line;
+    size_t offset = 0;
+    char buffer[4 * MAX_MANIFEST_FIELD];
+    int capacity = 0, lineNumber = 0, fields;
+    Job *jobs = NULL, *grown;
+    Job job;
+
+    *count = 0;
+    if (map_file(fileName, &file) != 0) {
+        fprintf(stderr, "File %s could not be opened.\n", fileName);
+        return 1;
+    }
+    while (next_line(&file, &offset, &line)) {
+        lineNumber++;
+        if (line.length >= (int)sizeof(buffer)) {
+            fprintf(stderr, "Error in file \"%s\" on line %d: The line is too long\n", fileName, lineNumber);
+            goto fail;
+        }
+        memcpy(buffer, line.start, line.length);
+        buffer[line.length] = '\0';
+        memset(&job, 0, sizeof(Job));
+        job.maxSteps = maxSteps;
+        job.timeLimit = timeLimit;
+        job.status = JOB_ERROR; /* until the job runs */
+        job.next = -1;
+        fields = sscanf(buffer, "%255s %255s %255s %lu %ld", job.object, job.input, job.expected, &job.maxSteps, &job.timeLimit);
+        if (fields <= 0 || job.object[0] == '#') {
+            continue;
+        }
+        if (fields < 3) {
+            fprintf(stderr, "Error in file \"%s\" on line %d: Expected an object, an input and an expected output\n", fileName, lineNumber);
+            goto fail;
+        }
+        if (*count == capacity) {
+            capacity = capacity == 0 ? 16 : capacity * 2;
+            grown = realloc(jobs, capacity * sizeof(Job));
+            if (grown == NULL) {
+                fprintf(stderr, "Failed to allocate memory for the jobs\n");
+                goto fail;
+            }
+            jobs = grown;
+        }
+        jobs[(*count)++] = job;
+    }
+    unmap_file(&file);
+    *result = jobs;
+    return 0;
+
+    fail:
+    unmap_file(&file);
+    if (jobs != NULL) free(jobs);
+    return 1;
+}
+
+/* the print_results function writes the results of all of the jobs as a JSON object, in the order of the manifest */
+static int print_results(const Job* jobs, int count) {
+    OutputBuffer output;
+    int i, passed = 0;
+    init_output_buffer(&output, stdout); /* the strings are written straight to stdout, between the printf calls */
+    printf("{\"results\":[\n");
+    for (i = 0; i < count; i++) {
+        printf("{\"object\":");
+        write_json_string(&output, jobs[i].object, strlen(jobs[i].object));
+        printf(",\"input\":");
+        write_json_string(&output, jobs[i].input, strlen(jobs[i].input));
+        printf(",\"status\":\"%s\",\"steps\":%lu,\"milliseconds\":%.3f}%s\n",
+            jobStatusNames[jobs[i].status], jobs[i].steps, jobs[i].milliseconds, i + 1 < count ? "," : "");
+        passed += jobs[i].status == JOB_PASS;
+    }
+    printf("],\"passed\":%d,\"failed\":%d}\n", passed, count - passed);
+    return passed == count ? 0 : 1;
+}
+
+/**
+ * The main function of the runner.
+ * It runs the programs of a manifest on the emulator, each of them with an input, and checks their output.
+ * Every line of the manifest is OBJECT INPUT EXPECTED [MAX_STEPS [TIME_LIMIT]]: OBJECT is the name of an assembled
+ * (or linked) file without the .ob extension, INPUT is read by red and EXPECTED is compared to what prn wrote.
+ * "-" as INPUT gives no input, and "-" as EXPECTED only checks that the program halts.
+ * The jobs are split between the threads, and a thread that runs out of jobs steals jobs from the others.
+ * Options:
+ *   --threads=N     the number of threads (default 4)
+ *   --max-steps=N   the instruction budget of a job that doesn't give one (default 0, no limit)
+ *   --time-limit=MS the time budget of a job that doesn't give one, in milliseconds (default 0, no limit)
+ *   --memory-size=N the number of words in the memory of the machine (default 4096, at most 65536)
+ *   --jit           translate the programs into native code while they run (only on x86-64, otherwise they are interpreted)
+ *   --lockstep      run the jobs of the same object together, up to 64 at a time, so every instruction runs once for all of them
+ * The results are written to stdout as JSON. Returns 0 if every job passed, and 1 otherwise.
+*/
+int main(int argc, char **argv) {
+    Runner runner;
+    Worker* workers = NULL;
+    Job* jobs = NULL;
+    const char* manifest = NULL;
+    unsigned long maxSteps = 0;
+    long timeLimit = 0;
+    int i, count, queued, threads = DEFAULT_RUNNER_THREADS, result = 1;
+#ifdef HAS_THREADS
+    pthread_t* handles;
+    int started = 0;
+#endif
+
+    runner.memorySize = MEMORY_SIZE;
+    runner.jit = FALSE;
+    runner.lockstep = FALSE;
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0 && manifest == NULL) {
+            manifest = argv[i];
+        } else if (strncmp(argv[i], "--threads=", 10) == 0 && is_number(argv[i] + 10) && argv[i][10] != '\0'
+            && get_number(argv[i] + 10) > 0 && get_number(argv[i] + 10) <= MAX_RUNNER_THREADS) {
+            threads = get_number(argv[i] + 10);
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            runner.jit = TRUE;
+        } else if (strcmp(argv[i], "--lockstep") == 0) {
+            runner.lockstep = TRUE;
+        } else if (strncmp(argv[i], "--max-steps=", 12) == 0 && is_number(argv[i] + 12) && argv[i][12] != '\0' && argv[i][12] != '-') {
+            maxSteps = strtoul(argv[i] + 12, NULL, 10);
+        } else if (strncmp(argv[i], "--time-limit=", 13) == 0 && is_number(argv[i] + 13) && argv[i][13] != '\0' && argv[i][13] != '-') {
+            timeLimit = strtol(argv[i] + 13, NULL, 10);
+        } else if (strncmp(argv[i], "--memory-size=", 14) == 0 && is_number(argv[i] + 14) && argv[i][14] != '\0'
+            && get_number(argv[i] + 14) > START_POSITION && get_number(argv[i] + 14) <= MAX_MEMORY_SIZE) {
+            runner.memorySize = get_number(argv[i] + 14);
+        } else {
+            fprintf(stderr, "Unknown option \"%s\", exiting program.\n", argv[i]);
+            return 1;
+        }
+    }
+    if (manifest == NULL) {
+        fprintf(stderr, "Usage: runner [--threads=N] [--max-steps=N] [--time-limit=MS] [--memory-size=N] [--jit] [--lockstep] MANIFEST\n");
+        return 1;
+    }
+    if (read_manifest(manifest, &jobs, &count, maxSteps, timeLimit) != 0) {
+        return 1;
+    }
+    if (count == 0) {
+        return print_results(jobs, 0);
+    }
+    if (runner.lockstep) {
+        group_jobs(jobs, count);
+    }
+    /* only the first job of a batch is queued, and the first job of the manifest always starts a batch */
+    for (i = 1, queued = 1; i < count; i++) {
+        queued += !jobs[i].follows;
+    }
+#ifndef HAS_THREADS
+    threads = 1;
+#endif
+    if (threads > queued) {
+        threads = queued;
+    }
+
+    /* the jobs are dealt to the queues in turns, so every thread starts with a similar part of the manifest */
+    runner.jobs = jobs;
+    runner.workerCount = threads;
+    runner.queues = calloc(threads, sizeof(WorkQueue));
+    workers = malloc(threads * sizeof(Worker));
+    if (runner.queues == NULL || workers == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the threads\n");
+        goto end;
+    }
+    for (i = 0; i < threads; i++) {
+        runner.queues[i].jobs = malloc(((size_t)queued / threads + 1) * sizeof(int));
+        if (runner.queues[i].jobs == NULL) {
+            fprintf(stderr, "Failed to allocate memory for the threads\n");
+            goto end;
+        }
+#ifdef HAS_THREADS
+        pthread_mutex_init(&runner.queues[i].lock, NULL);
+#endif
+        workers[i].runner = &runner;
+        workers[i].index = i;
+    }
+    for (i = 0, queued = 0; i < count; i++) {
+        if (!jobs[i].follows) {
+            runner.queues[queued % threads].jobs[runner.queues[queued % threads].last++] = i;
+            queued++;
+        }
+    }
+
+#ifdef HAS_THREADS
+    handles = malloc(threads * sizeof(pthread_t));
+    if (handles != NULL) {
+        /* the first worker runs on the main thread */
+        for (started = 1; started < threads; started++) {
+            if (pthread_create(&handles[started], NULL, work, &workers[started]) != 0) {
+                break;
+            }
+        }
+    }
+    work(&workers[0]);
+    for (i = 1; handles != NULL && i < started; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    if (handles != NULL) free(handles);
+#else
+    work(&workers[0]);
+#endif
+
+    result = print_results(jobs, count);
+
+    end:
+    for (i = 0; runner.queues != NULL && i < threads && runner.queues[i].jobs != NULL; i++) {
+#ifdef HAS_THREADS
+        pthread_mutex_destroy(&runner.queues[i].lock);
+#endif
+        free(runner.queues[i].jobs);
+    }
+    if (runner.queues != NULL) free(runner.queues);
+    if (workers != NULL) free(workers);
+    free(jobs);
+    return result;
+}
@@ -8,9 +8,8 @@
  as binary, and ready it for file creation */
 int secondPass(ParsedSyntaxLine **lines, translation *output, int lineCount, char * filename);
 
-/* the operandType function mathes the type of the operand (which is defined in structs.h) 
-    to the num of the type */
-int operandType (int originalOperandType);
+/* the secondPassLine function builds the translation of a single parsed line (the i-th line of the file) */
+int secondPassLine(ParsedSyntaxLine *parsedLine, translation *output, int i, char * filename);
 
 /* the directAddress function creates the word that deribes the adress of the symbol, 
     and returns a pointer to the symbol */
@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "constants.h"
+#include "globals.h"
+
+/* the take_snapshot function decodes all of the code of the machine and copies its state into the snapshot.
+    the pages that the machine writes from now on are tracked, so restore_snapshot only copies them back.
+    a snapshot is zeroed before its first use, and can be taken again. returns 0 on success and 1 if the memory could not be allocated */
+int take_snapshot(MachineSnapshot* snapshot, Machine* machine) {
+    Machine* state = &snapshot->state;
+    int address;
+
+    if (state->memory != NULL && state->memorySize != machine->memorySize) {
+        free_machine(state);
+    }
+    if (state->memory == NULL && create_machine(state, machine->memorySize) != 0) {
+        return 1;
+    }
+    /* every address of the code is decoded now, so a restored machine doesn't decode anything again.
+        an address in the middle of an instruction may not decode, and then it is left for the interpreter */
+    for (address = START_POSITION; address < machine->codeEnd; address++) {
+        if (machine->decoded[address].length == 0) {
+            decode_instruction(machine, address, &machine->decoded[address], FALSE);
+        }
+    }
+    memcpy(state->memory, machine->memory, machine->memorySize * sizeof(unsigned short));
+    memcpy(state->decoded, machine->decoded, machine->memorySize * sizeof(DecodedInstruction));
+    memcpy(state->registers, machine->registers, sizeof(machine->registers));
+    memcpy(state->stack, machine->stack, machine->stackDepth * sizeof(int));
+    state->codeEnd = machine->codeEnd;
+    state->pc = machine->pc;
+    state->zero = machine->zero;
+    state->stackDepth = machine->stackDepth;
+    state->steps = machine->steps;
+    memset(machine->dirty, 0, MACHINE_PAGE_COUNT(machine->memorySize));
+    return 0;
+}
+
+/* the restore_snapshot function puts the machine back in the state of the snapshot, copying only the pages that were written.
+    returns 1 if pages of the code were copied back, so the code that was translated from them isn't valid anymore, and 0 otherwise */
+int restore_snapshot(Machine* machine, const MachineSnapshot* snapshot) {
+    const Machine* state = &snapshot->state;
+    int page, start, end, codeChanged = 0;
+
+    for (page = 0; page < MACHINE_PAGE_COUNT(machine->memorySize); page++) {
+        if (!machine->dirty[page]) {
+            continue;
+        }
+        start = page << MACHINE_PAGE_SHIFT;
+        end = start + (1 << MACHINE_PAGE_SHIFT) < machine->memorySize ? start + (1 << MACHINE_PAGE_SHIFT) : machine->memorySize;
+        if (start < end) {
+            memcpy(machine->memory + start, state->memory + start, (end - start) * sizeof(unsigned short));
+        }
+        if (start < state->codeEnd) {
+            /* the instructions that start up to LONGEST_INSTRUCTION - 1 words before the page may have words in it */
+            start = start - (LONGEST_INSTRUCTION - 1) > 0 ? start - (LONGEST_INSTRUCTION - 1) : 0;
+            end = end < state->codeEnd ? end : state->codeEnd;
+            memcpy(machine->decoded + start, state->decoded + start, (end - start) * sizeof(DecodedInstruction));
+            codeChanged = 1;
+        }
+        machine->dirty[page] = 0;
+    }
+    memcpy(machine->registers, state->registers, sizeof(state->registers));
+    memcpy(machine->stack, state->stack, state->stackDepth * sizeof(int));
+    machine->codeEnd = state->codeEnd;
+    machine->pc = state->pc;
+    machine->zero = state->zero;
+    machine->stackDepth = state->stackDepth;
+    machine->steps = state->steps;
+    return codeChanged;
+}
+
+/* the free_snapshot function frees the memory of a snapshot */
+void free_snapshot(MachineSnapshot* snapshot) {
+    free_machine(&snapshot->state);
+}
+
+/* the write_number function writes a little-endian number of length bytes */
+static void write_number(FILE* file, unsigned long value, int length) {
+    int i;
+    for (i = 0; i < length; i++) {
+        putc((int)((value >> (8 * i)) & 0xFF), file);
+    }
+}
+
+/* the read_number function reads a little-endian number of length bytes. returns 1 if the file ended */
+static int read_number(FILE* file, unsigned long* value, int length) {
+    int i, byte;
+    *value = 0;
+    for (i = 0; i < length; i++) {
+        byte = getc(file);
+        if (byte == EOF) {
+            return 1;
+        }
+        *value |= (unsigned long)byte << (8 * i);
+    }
+    return 0;
+}
+
+/* the save_checkpoint function writes the state of the machine into a checkpoint file. returns 0 on success and 1 on error */
+int save_checkpoint(const Machine* machine, const char* fileName) {
+    FILE* file = fopen(fileName, "wb");
+    int i, error;
+    if (file == NULL) {
+        fprintf(stderr, "File %s could not be created.\n", fileName);
+        return 1;
+    }
+    fwrite(CHECKPOINT_MAGIC, 1, CHECKPOINT_MAGIC_LENGTH, file);
+    write_number(file, machine->memorySize, 4);
+    write_number(file, machine->codeEnd, 4);
+    write_number(file, machine->pc, 4);
+    write_number(file, machine->zero, 4);
+    write_number(file, machine->stackDepth, 4);
+    write_number(file, machine->steps, 8);
+    for (i = 0; i < REGISTER_COUNT; i++) {
+        write_number(file, machine->registers[i], 4);
+    }
+    for (i = 0; i < machine->stackDepth; i++) {
+        write_number(file, machine->stack[i], 4);
+    }
+    for (i = 0; i < machine->memorySize; i++) {
+        write_number(file, machine->memory[i], 2);
+    }
+    error = ferror(file);
+    if (fclose(file) != 0 || error) {
+        fprintf(stderr, "Error writing file %s\n", fileName);
+        return 1;
+    }
+    return 0;
+}
+
+/* the load_checkpoint function creates a machine with the state that is in a checkpoint file. returns 0 on success and 1 on error */
+int load_checkpoint(Machine* machine, const char* fileName) {
+    FILE* file = fopen(fileName, "rb");
+    char magic[CHECKPOINT_MAGIC_LENGTH];
+    unsigned long memorySize, codeEnd, pc, zero, stackDepth, steps, value;
+    int i, error = 0;
+
+    if (file == NULL) {
+        fprintf(stderr, "File %s could not be opened.\n", fileName);
+        return 1;
+    }
+    if (fread(magic, 1, CHECKPOINT_MAGIC_LENGTH, file) != CHECKPOINT_MAGIC_LENGTH || memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LENGTH) != 0 ||
+        read_number(file, &memorySize, 4) || read_number(file, &codeEnd, 4) || read_number(file, &pc, 4) ||
+        read_number(file, &zero, 4) || read_number(file, &stackDepth, 4) || read_number(file, &steps, 8) ||
+        memorySize <= START_POSITION || memorySize > MAX_MEMORY_SIZE || codeEnd < START_POSITION || codeEnd > memorySize ||
+        stackDepth > MACHINE_STACK_SIZE) {
+        fprintf(stderr, "Error in file \"%s\": It isn't a checkpoint\n", fileName);
+        fclose(file);
+        return 1;
+    }
+    if (create_machine(machine, (int)memorySize) != 0) {
+        fprintf(stderr, "Failed to allocate memory for the machine\n");
+        fclose(file);
+        return 1;
+    }
+    machine->codeEnd = (int)codeEnd;
+    machine->pc = (int)pc;
+    machine->zero = zero ? TRUE : FALSE;
+    machine->stackDepth = (int)stackDepth;
+    machine->steps = steps;
+    for (i = 0; i < REGISTER_COUNT && !error; i++) {
+        error = read_number(file, &value, 4);
+        machine->registers[i] = (int)(value & WORD_MASK);
+    }
+    for (i = 0; i < machine->stackDepth && !error; i++) {
+        error = read_number(file, &value, 4);
+        machine->stack[i] = (int)value;
+    }
+    for (i = 0; i < machine->memorySize && !error; i++) {
+        error = read_number(file, &value, 2);
+        machine->memory[i] = (unsigned short)(value & WORD_MASK);
+    }
+    fclose(file);
+    if (error) {
+        fprintf(stderr, "Error in file \"%s\": The checkpoint ends too early\n", fileName);
+        free_machine(machine);
+        return 1;
+    }
+    memset(machine->dirty, 1, MACHINE_PAGE_COUNT(machine->memorySize));
+    return 0;
+}
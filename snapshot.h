@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "machine.h"
+
+/*
+ A checkpoint file holds the state of a machine, so a long run can be stopped and resumed later.
+ Layout:
+    CHECKPOINT_MAGIC
+    memory size, end of the code, pc, Z flag, stack depth (4 bytes each), steps (8 bytes)
+    the registers and the return addresses of the stack (4 bytes each)
+    every word of the memory (2 bytes each)
+ All of the numbers are little-endian. The decoded instructions aren't kept, they are decoded again when they run.
+*/
+#define CHECKPOINT_MAGIC "ASMCKPT1"
+#define CHECKPOINT_MAGIC_LENGTH 8
+
+/* A copy of the state of a machine after its program was loaded, that the machine can go back to */
+typedef struct {
+    Machine state; /* the registers, the memory and the decoded instructions at the time of the snapshot */
+} MachineSnapshot;
+
+/* the take_snapshot function decodes all of the code of the machine and copies its state into the snapshot.
+    the pages that the machine writes from now on are tracked, so restore_snapshot only copies them back.
+    a snapshot is zeroed before its first use, and can be taken again. returns 0 on success and 1 if the memory could not be allocated */
+int take_snapshot(MachineSnapshot* snapshot, Machine* machine);
+
+/* the restore_snapshot function puts the machine back in the state of the snapshot, copying only the pages that were written.
+    returns 1 if pages of the code were copied back, so the code that was translated from them isn't valid anymore, and 0 otherwise */
+int restore_snapshot(Machine* machine, const MachineSnapshot* snapshot);
+
+/* the free_snapshot function frees the memory of a snapshot */
+void free_snapshot(MachineSnapshot* snapshot);
+
+/* the save_checkpoint function writes the state of the machine into a checkpoint file. returns 0 on success and 1 on error */
+int save_checkpoint(const Machine* machine, const char* fileName);
+
+/* the load_checkpoint function creates a machine with the state that is in a checkpoint file. returns 0 on success and 1 on error */
+int load_checkpoint(Machine* machine, const char* fileName);
+
+#endif
@@ -96,7 +96,7 @@ typedef struct {
 
 /* A structure that represents a single parsed line of the input file. It contains all the information needed about a line. */
 typedef struct ParsedSyntaxLine { 
-    char error[250];
+    struct Diagnostic* error; /* the error that was found in the line (see diagnostics.h), or NULL if the line is valid */
     char labelName[MAX_LABEL_LENGTH + 1];
     InstructionType type;
     union {
@@ -141,20 +141,48 @@ typedef struct Symbol {
 /* A structure that represents an external symbol in the externals table */
 typedef struct External {
     char * name;
-    int addresses [MEMORY_SIZE];
+    int * addresses; /* the addresses the external is used in, the array grows as needed */
     int numOfUse;
+    int capacity; /* the number of addresses that fit in the array */
 } External;
 
+/* A structure that holds the words of a memory image. the words are packed in 16 bits each,
+ and are kept in pages of IMAGE_PAGE_SIZE words that are only allocated when a word in them is written */
+typedef struct WordImage {
+   unsigned short ** pages;
+   int pageCount;
+   int used; /* the words before this address may have been written, the rest are all zero */
+   int failed; /* set if a page could not be allocated */
+} WordImage;
+
 /* A structure that we build after going through the program.
  it represents all of the aspects of a program, and we use it to build the final output files */
 typedef struct translation {
-   int code_image [MEMORY_SIZE];
-   int data_image [MEMORY_SIZE];
+   WordImage code_image;
+   WordImage data_image;
+   int memory_size; /* the number of words in the memory of the target machine */
    int IC;
    int DC;
    struct Symbol_Node * symbol_table_head;
    struct External_Node * external_table_head;
+   /* the state below is kept between files when the translation is reused, see translation.h */
+   struct Symbol_Node * free_symbols; /* symbol nodes of the previous files, used again by the first pass */
+   struct External_Node * free_externals; /* external nodes of the previous files, used again by the second pass */
+   struct hashtable * constants_table; /* the constants of the file, emptied between files */
+   int * code_lines; /* when not NULL, the line of the am file of the instruction that starts at every address of the code, or 0 */
 } translation;
 
+/* A structure that holds the command line options that the assembler was run with */
+typedef struct {
+    boolean streaming; /* --stream: parse the file line by line in both passes instead of keeping every parsed line in memory */
+    int ioDepth; /* --io-depth=N: how many files ahead are read when assembling a batch of files, 0 disables the batch I/O stage */
+    char* bundlePath; /* --bundle=PATH: write all of the output files into one bundle at PATH, or NULL to write separate files */
+    int memorySize; /* --memory-size=N: the number of words in the memory of the target machine */
+    int maxErrors; /* --max-errors=N: stop assembling a file after N errors, 0 for no limit */
+    boolean failFast; /* --fail-fast: skip the second pass of a file that had errors in the first pass */
+    boolean map; /* --map: write a .map file with the symbols and the line of every instruction */
+    boolean watch; /* --watch: after the files are assembled, assemble every file again when it is saved */
+} AssemblerOptions;
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "../structs.h"
+#include "../constants.h"
+#include "../assemble_file.h"
+#include "../translation.h"
+#include "../diagnostics.h"
+
+/* Checks that a translation that is reused for file after file doesn't grow.
+ The same file, with many constants and macros, is assembled again and again into one translation (like a batch of files is),
+ in both the normal and the streaming mode. After every file the nodes of the symbol table and the free symbols are counted,
+ and there must never be more of them than after the first file. The maximum resident set size must also stay the same,
+ up to MAX_RSS_GROWTH_KB.
+ The output of the assembler is sent to /dev/null by the makefile, only the result of the test is written to stderr. */
+
+#define DEFAULT_SOURCE "test/test-memory/test"
+#define DEFAULT_REPEATS 800
+#define WARMUP_REPEATS 20 /* files that are assembled before the resident set size is measured */
+#define MAX_RSS_GROWTH_KB 1024
+
+/* the count_symbols function returns the number of nodes of a symbol list */
+static long count_symbols(const Symbol_Node* head) {
+    long count = 0;
+    for (; head != NULL; head = head->next) {
+        count++;
+    }
+    return count;
+}
+
+/* the max_rss_kb function returns the maximum resident set size of the process, in kilobytes */
+static long max_rss_kb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+/* the run_repeats function assembles the file repeats times into one translation. returns 0 if the memory didn't grow */
+static int run_repeats(const char* fileName, int repeats, boolean streaming) {
+    AssemblerOptions options;
+    translation* output;
+    long nodes, firstNodes = 0, warmRss = 0, rss;
+    int i, result = 0;
+
+    memset(&options, 0, sizeof(options));
+    options.streaming = streaming;
+    options.memorySize = MEMORY_SIZE;
+
+    output = create_translation(options.memorySize);
+    if (output == NULL) {
+        fprintf(stderr, "Failed to allocate memory for translation struct\n");
+        return 1;
+    }
+
+    for (i = 0; i < repeats; i++) {
+        assemble_file(fileName, NULL, &options, output);
+        nodes = count_symbols(output->symbol_table_head) + count_symbols(output->free_symbols);
+        if (i == 0) {
+            firstNodes = nodes;
+        } else if (nodes > firstNodes) {
+            fprintf(stderr, "%s: %ld symbol nodes after file %d, %ld after the first file\n",
+                streaming ? "stream" : "normal", nodes, i + 1, firstNodes);
+            result = 1;
+            break;
+        }
+        if (i + 1 == WARMUP_REPEATS) {
+            warmRss = max_rss_kb();
+        }
+    }
+
+    rss = max_rss_kb();
+    if (result == 0 && warmRss != 0 && rss - warmRss > MAX_RSS_GROWTH_KB) {
+        fprintf(stderr, "%s: the maximum resident set size grew from %ldKB to %ldKB\n",
+            streaming ? "stream" : "normal", warmRss, rss);
+        result = 1;
+    }
+    if (result == 0) {
+        fprintf(stderr, "%s: %d files, %ld symbol nodes, maximum resident set size %ldKB\n",
+            streaming ? "stream" : "normal", repeats, firstNodes, rss);
+    }
+
+    free_translation(output);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* fileName = DEFAULT_SOURCE;
+    int repeats = DEFAULT_REPEATS, result;
+
+    if (argc > 1) {
+        fileName = argv[1];
+    }
+    if (argc > 2) {
+        repeats = atoi(argv[2]);
+        if (repeats <= WARMUP_REPEATS) {
+            fprintf(stderr, "The number of repeats must be more than %d\n", WARMUP_REPEATS);
+            return 1;
+        }
+    }
+
+    result = run_repeats(fileName, repeats, FALSE);
+    result |= run_repeats(fileName, repeats, TRUE);
+    end_diagnostics();
+    fprintf(stderr, result == 0 ? "memory test passed\n" : "memory test failed\n");
+    return result;
+}
@@ -0,0 +1,15 @@
+; the errors of conditional assembly
+MAIN:	clr r1
+.if rev == 1
+	inc r1
+.endif
+.if 1
+	inc r2
+.else
+	inc r3
+.else
+	inc r4
+.endif
+.endif
+.if 1
+	hlt
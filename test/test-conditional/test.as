@@ -0,0 +1,34 @@
+; conditional assembly, assembled with --define=FAST --define=LEVEL=2
+.define rev = 3
+.extern OUT
+MAIN:	clr r1
+.if rev >= 2
+	mov #8, r1
+.if LEVEL == 2
+	add #2, r1
+.else
+	add #1, r1
+.endif
+.else
+	mov #4, r1
+	this line is not checked
+.endif
+.ifdef FAST
+	inc r2
+.ifndef SLOW
+	inc r3
+.else
+	dec r3
+.endif
+.endif
+.ifndef FAST
+	dec r2
+.endif
+.if rev
+	jmp OUT
+.endif
+.if 0
+	mcr never
+	endmcr
+.endif
+	hlt
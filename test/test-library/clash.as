@@ -0,0 +1,6 @@
+; a label with the name of a constant of the library is an error
+.import "common.lib"
+MAIN:	clr r3
+	reset
+size:	.data 1
+	hlt
@@ -0,0 +1,13 @@
+; the macros and constants that test.as and clash.as import
+.define size = 4
+.define step = -2
+
+mcr reset
+	clr r1
+	clr r2
+endmcr
+
+mcr next
+	add #step, r1
+	inc r2
+endmcr
@@ -0,0 +1,13 @@
+; a file that uses the library compiled from common.as
+.import "common.lib"
+.define count = 3
+MAIN:	clr r3
+	reset
+LOOP:	inc r3
+	next
+	cmp r2, #size
+	bne LOOP
+	mov LIST[size], r3
+	prn #count
+	hlt
+LIST:	.data 1, 2, 3, 4, size, step
@@ -0,0 +1,1505 @@
+; many constants and macros, assembled again and again by test/memory_test.c
+.define c0 = 0
+.define c1 = 1
+.define c2 = 2
+.define c3 = 3
+.define c4 = 4
+.define c5 = 5
+.define c6 = 6
+.define c7 = 7
+.define c8 = 8
+.define c9 = 9
+.define c10 = 10
+.define c11 = 11
+.define c12 = 12
+.define c13 = 13
+.define c14 = 14
+.define c15 = 15
+.define c16 = 16
+.define c17 = 17
+.define c18 = 18
+.define c19 = 19
+.define c20 = 20
+.define c21 = 21
+.define c22 = 22
+.define c23 = 23
+.define c24 = 24
+.define c25 = 25
+.define c26 = 26
+.define c27 = 27
+.define c28 = 28
+.define c29 = 29
+.define c30 = 30
+.define c31 = 31
+.define c32 = 32
+.define c33 = 33
+.define c34 = 34
+.define c35 = 35
+.define c36 = 36
+.define c37 = 37
+.define c38 = 38
+.define c39 = 39
+.define c40 = 40
+.define c41 = 41
+.define c42 = 42
+.define c43 = 43
+.define c44 = 44
+.define c45 = 45
+.define c46 = 46
+.define c47 = 47
+.define c48 = 48
+.define c49 = 49
+.define c50 = 50
+.define c51 = 51
+.define c52 = 52
+.define c53 = 53
+.define c54 = 54
+.define c55 = 55
+.define c56 = 56
+.define c57 = 57
+.define c58 = 58
+.define c59 = 59
+.define c60 = 60
+.define c61 = 61
+.define c62 = 62
+.define c63 = 63
+.define c64 = 64
+.define c65 = 65
+.define c66 = 66
+.define c67 = 67
+.define c68 = 68
+.define c69 = 69
+.define c70 = 70
+.define c71 = 71
+.define c72 = 72
+.define c73 = 73
+.define c74 = 74
+.define c75 = 75
+.define c76 = 76
+.define c77 = 77
+.define c78 = 78
+.define c79 = 79
+.define c80 = 80
+.define c81 = 81
+.define c82 = 82
+.define c83 = 83
+.define c84 = 84
+.define c85 = 85
+.define c86 = 86
+.define c87 = 87
+.define c88 = 88
+.define c89 = 89
+.define c90 = 90
+.define c91 = 91
+.define c92 = 92
+.define c93 = 93
+.define c94 = 94
+.define c95 = 95
+.define c96 = 96
+.define c97 = 97
+.define c98 = 98
+.define c99 = 99
+.define c100 = 100
+.define c101 = 101
+.define c102 = 102
+.define c103 = 103
+.define c104 = 104
+.define c105 = 105
+.define c106 = 106
+.define c107 = 107
+.define c108 = 108
+.define c109 = 109
+.define c110 = 110
+.define c111 = 111
+.define c112 = 112
+.define c113 = 113
+.define c114 = 114
+.define c115 = 115
+.define c116 = 116
+.define c117 = 117
+.define c118 = 118
+.define c119 = 119
+.define c120 = 120
+.define c121 = 121
+.define c122 = 122
+.define c123 = 123
+.define c124 = 124
+.define c125 = 125
+.define c126 = 126
+.define c127 = 127
+.define c128 = 128
+.define c129 = 129
+.define c130 = 130
+.define c131 = 131
+.define c132 = 132
+.define c133 = 133
+.define c134 = 134
+.define c135 = 135
+.define c136 = 136
+.define c137 = 137
+.define c138 = 138
+.define c139 = 139
+.define c140 = 140
+.define c141 = 141
+.define c142 = 142
+.define c143 = 143
+.define c144 = 144
+.define c145 = 145
+.define c146 = 146
+.define c147 = 147
+.define c148 = 148
+.define c149 = 149
+.define c150 = 150
+.define c151 = 151
+.define c152 = 152
+.define c153 = 153
+.define c154 = 154
+.define c155 = 155
+.define c156 = 156
+.define c157 = 157
+.define c158 = 158
+.define c159 = 159
+.define c160 = 160
+.define c161 = 161
+.define c162 = 162
+.define c163 = 163
+.define c164 = 164
+.define c165 = 165
+.define c166 = 166
+.define c167 = 167
+.define c168 = 168
+.define c169 = 169
+.define c170 = 170
+.define c171 = 171
+.define c172 = 172
+.define c173 = 173
+.define c174 = 174
+.define c175 = 175
+.define c176 = 176
+.define c177 = 177
+.define c178 = 178
+.define c179 = 179
+.define c180 = 180
+.define c181 = 181
+.define c182 = 182
+.define c183 = 183
+.define c184 = 184
+.define c185 = 185
+.define c186 = 186
+.define c187 = 187
+.define c188 = 188
+.define c189 = 189
+.define c190 = 190
+.define c191 = 191
+.define c192 = 192
+.define c193 = 193
+.define c194 = 194
+.define c195 = 195
+.define c196 = 196
+.define c197 = 197
+.define c198 = 198
+.define c199 = 199
+.define c200 = 200
+.define c201 = 201
+.define c202 = 202
+.define c203 = 203
+.define c204 = 204
+.define c205 = 205
+.define c206 = 206
+.define c207 = 207
+.define c208 = 208
+.define c209 = 209
+.define c210 = 210
+.define c211 = 211
+.define c212 = 212
+.define c213 = 213
+.define c214 = 214
+.define c215 = 215
+.define c216 = 216
+.define c217 = 217
+.define c218 = 218
+.define c219 = 219
+.define c220 = 220
+.define c221 = 221
+.define c222 = 222
+.define c223 = 223
+.define c224 = 224
+.define c225 = 225
+.define c226 = 226
+.define c227 = 227
+.define c228 = 228
+.define c229 = 229
+.define c230 = 230
+.define c231 = 231
+.define c232 = 232
+.define c233 = 233
+.define c234 = 234
+.define c235 = 235
+.define c236 = 236
+.define c237 = 237
+.define c238 = 238
+.define c239 = 239
+.define c240 = 240
+.define c241 = 241
+.define c242 = 242
+.define c243 = 243
+.define c244 = 244
+.define c245 = 245
+.define c246 = 246
+.define c247 = 247
+.define c248 = 248
+.define c249 = 249
+.define c250 = 250
+.define c251 = 251
+.define c252 = 252
+.define c253 = 253
+.define c254 = 254
+.define c255 = 255
+.define c256 = 256
+.define c257 = 257
+.define c258 = 258
+.define c259 = 259
+.define c260 = 260
+.define c261 = 261
+.define c262 = 262
+.define c263 = 263
+.define c264 = 264
+.define c265 = 265
+.define c266 = 266
+.define c267 = 267
+.define c268 = 268
+.define c269 = 269
+.define c270 = 270
+.define c271 = 271
+.define c272 = 272
+.define c273 = 273
+.define c274 = 274
+.define c275 = 275
+.define c276 = 276
+.define c277 = 277
+.define c278 = 278
+.define c279 = 279
+.define c280 = 280
+.define c281 = 281
+.define c282 = 282
+.define c283 = 283
+.define c284 = 284
+.define c285 = 285
+.define c286 = 286
+.define c287 = 287
+.define c288 = 288
+.define c289 = 289
+.define c290 = 290
+.define c291 = 291
+.define c292 = 292
+.define c293 = 293
+.define c294 = 294
+.define c295 = 295
+.define c296 = 296
+.define c297 = 297
+.define c298 = 298
+.define c299 = 299
+mcr m0
+	mov #c0, r0
+endmcr
+mcr m1
+	mov #c1, r1
+endmcr
+mcr m2
+	mov #c2, r2
+endmcr
+mcr m3
+	mov #c3, r3
+endmcr
+mcr m4
+	mov #c4, r4
+endmcr
+mcr m5
+	mov #c5, r5
+endmcr
+mcr m6
+	mov #c6, r6
+endmcr
+mcr m7
+	mov #c7, r7
+endmcr
+mcr m8
+	mov #c8, r0
+endmcr
+mcr m9
+	mov #c9, r1
+endmcr
+mcr m10
+	mov #c10, r2
+endmcr
+mcr m11
+	mov #c11, r3
+endmcr
+mcr m12
+	mov #c12, r4
+endmcr
+mcr m13
+	mov #c13, r5
+endmcr
+mcr m14
+	mov #c14, r6
+endmcr
+mcr m15
+	mov #c15, r7
+endmcr
+mcr m16
+	mov #c16, r0
+endmcr
+mcr m17
+	mov #c17, r1
+endmcr
+mcr m18
+	mov #c18, r2
+endmcr
+mcr m19
+	mov #c19, r3
+endmcr
+mcr m20
+	mov #c20, r4
+endmcr
+mcr m21
+	mov #c21, r5
+endmcr
+mcr m22
+	mov #c22, r6
+endmcr
+mcr m23
+	mov #c23, r7
+endmcr
+mcr m24
+	mov #c24, r0
+endmcr
+mcr m25
+	mov #c25, r1
+endmcr
+mcr m26
+	mov #c26, r2
+endmcr
+mcr m27
+	mov #c27, r3
+endmcr
+mcr m28
+	mov #c28, r4
+endmcr
+mcr m29
+	mov #c29, r5
+endmcr
+mcr m30
+	mov #c30, r6
+endmcr
+mcr m31
+	mov #c31, r7
+endmcr
+mcr m32
+	mov #c32, r0
+endmcr
+mcr m33
+	mov #c33, r1
+endmcr
+mcr m34
+	mov #c34, r2
+endmcr
+mcr m35
+	mov #c35, r3
+endmcr
+mcr m36
+	mov #c36, r4
+endmcr
+mcr m37
+	mov #c37, r5
+endmcr
+mcr m38
+	mov #c38, r6
+endmcr
+mcr m39
+	mov #c39, r7
+endmcr
+mcr m40
+	mov #c40, r0
+endmcr
+mcr m41
+	mov #c41, r1
+endmcr
+mcr m42
+	mov #c42, r2
+endmcr
+mcr m43
+	mov #c43, r3
+endmcr
+mcr m44
+	mov #c44, r4
+endmcr
+mcr m45
+	mov #c45, r5
+endmcr
+mcr m46
+	mov #c46, r6
+endmcr
+mcr m47
+	mov #c47, r7
+endmcr
+mcr m48
+	mov #c48, r0
+endmcr
+mcr m49
+	mov #c49, r1
+endmcr
+mcr m50
+	mov #c50, r2
+endmcr
+mcr m51
+	mov #c51, r3
+endmcr
+mcr m52
+	mov #c52, r4
+endmcr
+mcr m53
+	mov #c53, r5
+endmcr
+mcr m54
+	mov #c54, r6
+endmcr
+mcr m55
+	mov #c55, r7
+endmcr
+mcr m56
+	mov #c56, r0
+endmcr
+mcr m57
+	mov #c57, r1
+endmcr
+mcr m58
+	mov #c58, r2
+endmcr
+mcr m59
+	mov #c59, r3
+endmcr
+mcr m60
+	mov #c60, r4
+endmcr
+mcr m61
+	mov #c61, r5
+endmcr
+mcr m62
+	mov #c62, r6
+endmcr
+mcr m63
+	mov #c63, r7
+endmcr
+mcr m64
+	mov #c64, r0
+endmcr
+mcr m65
+	mov #c65, r1
+endmcr
+mcr m66
+	mov #c66, r2
+endmcr
+mcr m67
+	mov #c67, r3
+endmcr
+mcr m68
+	mov #c68, r4
+endmcr
+mcr m69
+	mov #c69, r5
+endmcr
+mcr m70
+	mov #c70, r6
+endmcr
+mcr m71
+	mov #c71, r7
+endmcr
+mcr m72
+	mov #c72, r0
+endmcr
+mcr m73
+	mov #c73, r1
+endmcr
+mcr m74
+	mov #c74, r2
+endmcr
+mcr m75
+	mov #c75, r3
+endmcr
+mcr m76
+	mov #c76, r4
+endmcr
+mcr m77
+	mov #c77, r5
+endmcr
+mcr m78
+	mov #c78, r6
+endmcr
+mcr m79
+	mov #c79, r7
+endmcr
+mcr m80
+	mov #c80, r0
+endmcr
+mcr m81
+	mov #c81, r1
+endmcr
+mcr m82
+	mov #c82, r2
+endmcr
+mcr m83
+	mov #c83, r3
+endmcr
+mcr m84
+	mov #c84, r4
+endmcr
+mcr m85
+	mov #c85, r5
+endmcr
+mcr m86
+	mov #c86, r6
+endmcr
+mcr m87
+	mov #c87, r7
+endmcr
+mcr m88
+	mov #c88, r0
+endmcr
+mcr m89
+	mov #c89, r1
+endmcr
+mcr m90
+	mov #c90, r2
+endmcr
+mcr m91
+	mov #c91, r3
+endmcr
+mcr m92
+	mov #c92, r4
+endmcr
+mcr m93
+	mov #c93, r5
+endmcr
+mcr m94
+	mov #c94, r6
+endmcr
+mcr m95
+	mov #c95, r7
+endmcr
+mcr m96
+	mov #c96, r0
+endmcr
+mcr m97
+	mov #c97, r1
+endmcr
+mcr m98
+	mov #c98, r2
+endmcr
+mcr m99
+	mov #c99, r3
+endmcr
+mcr m100
+	mov #c100, r4
+endmcr
+mcr m101
+	mov #c101, r5
+endmcr
+mcr m102
+	mov #c102, r6
+endmcr
+mcr m103
+	mov #c103, r7
+endmcr
+mcr m104
+	mov #c104, r0
+endmcr
+mcr m105
+	mov #c105, r1
+endmcr
+mcr m106
+	mov #c106, r2
+endmcr
+mcr m107
+	mov #c107, r3
+endmcr
+mcr m108
+	mov #c108, r4
+endmcr
+mcr m109
+	mov #c109, r5
+endmcr
+mcr m110
+	mov #c110, r6
+endmcr
+mcr m111
+	mov #c111, r7
+endmcr
+mcr m112
+	mov #c112, r0
+endmcr
+mcr m113
+	mov #c113, r1
+endmcr
+mcr m114
+	mov #c114, r2
+endmcr
+mcr m115
+	mov #c115, r3
+endmcr
+mcr m116
+	mov #c116, r4
+endmcr
+mcr m117
+	mov #c117, r5
+endmcr
+mcr m118
+	mov #c118, r6
+endmcr
+mcr m119
+	mov #c119, r7
+endmcr
+mcr m120
+	mov #c120, r0
+endmcr
+mcr m121
+	mov #c121, r1
+endmcr
+mcr m122
+	mov #c122, r2
+endmcr
+mcr m123
+	mov #c123, r3
+endmcr
+mcr m124
+	mov #c124, r4
+endmcr
+mcr m125
+	mov #c125, r5
+endmcr
+mcr m126
+	mov #c126, r6
+endmcr
+mcr m127
+	mov #c127, r7
+endmcr
+mcr m128
+	mov #c128, r0
+endmcr
+mcr m129
+	mov #c129, r1
+endmcr
+mcr m130
+	mov #c130, r2
+endmcr
+mcr m131
+	mov #c131, r3
+endmcr
+mcr m132
+	mov #c132, r4
+endmcr
+mcr m133
+	mov #c133, r5
+endmcr
+mcr m134
+	mov #c134, r6
+endmcr
+mcr m135
+	mov #c135, r7
+endmcr
+mcr m136
+	mov #c136, r0
+endmcr
+mcr m137
+	mov #c137, r1
+endmcr
+mcr m138
+	mov #c138, r2
+endmcr
+mcr m139
+	mov #c139, r3
+endmcr
+mcr m140
+	mov #c140, r4
+endmcr
+mcr m141
+	mov #c141, r5
+endmcr
+mcr m142
+	mov #c142, r6
+endmcr
+mcr m143
+	mov #c143, r7
+endmcr
+mcr m144
+	mov #c144, r0
+endmcr
+mcr m145
+	mov #c145, r1
+endmcr
+mcr m146
+	mov #c146, r2
+endmcr
+mcr m147
+	mov #c147, r3
+endmcr
+mcr m148
+	mov #c148, r4
+endmcr
+mcr m149
+	mov #c149, r5
+endmcr
+mcr m150
+	mov #c150, r6
+endmcr
+mcr m151
+	mov #c151, r7
+endmcr
+mcr m152
+	mov #c152, r0
+endmcr
+mcr m153
+	mov #c153, r1
+endmcr
+mcr m154
+	mov #c154, r2
+endmcr
+mcr m155
+	mov #c155, r3
+endmcr
+mcr m156
+	mov #c156, r4
+endmcr
+mcr m157
+	mov #c157, r5
+endmcr
+mcr m158
+	mov #c158, r6
+endmcr
+mcr m159
+	mov #c159, r7
+endmcr
+mcr m160
+	mov #c160, r0
+endmcr
+mcr m161
+	mov #c161, r1
+endmcr
+mcr m162
+	mov #c162, r2
+endmcr
+mcr m163
+	mov #c163, r3
+endmcr
+mcr m164
+	mov #c164, r4
+endmcr
+mcr m165
+	mov #c165, r5
+endmcr
+mcr m166
+	mov #c166, r6
+endmcr
+mcr m167
+	mov #c167, r7
+endmcr
+mcr m168
+	mov #c168, r0
+endmcr
+mcr m169
+	mov #c169, r1
+endmcr
+mcr m170
+	mov #c170, r2
+endmcr
+mcr m171
+	mov #c171, r3
+endmcr
+mcr m172
+	mov #c172, r4
+endmcr
+mcr m173
+	mov #c173, r5
+endmcr
+mcr m174
+	mov #c174, r6
+endmcr
+mcr m175
+	mov #c175, r7
+endmcr
+mcr m176
+	mov #c176, r0
+endmcr
+mcr m177
+	mov #c177, r1
+endmcr
+mcr m178
+	mov #c178, r2
+endmcr
+mcr m179
+	mov #c179, r3
+endmcr
+mcr m180
+	mov #c180, r4
+endmcr
+mcr m181
+	mov #c181, r5
+endmcr
+mcr m182
+	mov #c182, r6
+endmcr
+mcr m183
+	mov #c183, r7
+endmcr
+mcr m184
+	mov #c184, r0
+endmcr
+mcr m185
+	mov #c185, r1
+endmcr
+mcr m186
+	mov #c186, r2
+endmcr
+mcr m187
+	mov #c187, r3
+endmcr
+mcr m188
+	mov #c188, r4
+endmcr
+mcr m189
+	mov #c189, r5
+endmcr
+mcr m190
+	mov #c190, r6
+endmcr
+mcr m191
+	mov #c191, r7
+endmcr
+mcr m192
+	mov #c192, r0
+endmcr
+mcr m193
+	mov #c193, r1
+endmcr
+mcr m194
+	mov #c194, r2
+endmcr
+mcr m195
+	mov #c195, r3
+endmcr
+mcr m196
+	mov #c196, r4
+endmcr
+mcr m197
+	mov #c197, r5
+endmcr
+mcr m198
+	mov #c198, r6
+endmcr
+mcr m199
+	mov #c199, r7
+endmcr
+mcr m200
+	mov #c200, r0
+endmcr
+mcr m201
+	mov #c201, r1
+endmcr
+mcr m202
+	mov #c202, r2
+endmcr
+mcr m203
+	mov #c203, r3
+endmcr
+mcr m204
+	mov #c204, r4
+endmcr
+mcr m205
+	mov #c205, r5
+endmcr
+mcr m206
+	mov #c206, r6
+endmcr
+mcr m207
+	mov #c207, r7
+endmcr
+mcr m208
+	mov #c208, r0
+endmcr
+mcr m209
+	mov #c209, r1
+endmcr
+mcr m210
+	mov #c210, r2
+endmcr
+mcr m211
+	mov #c211, r3
+endmcr
+mcr m212
+	mov #c212, r4
+endmcr
+mcr m213
+	mov #c213, r5
+endmcr
+mcr m214
+	mov #c214, r6
+endmcr
+mcr m215
+	mov #c215, r7
+endmcr
+mcr m216
+	mov #c216, r0
+endmcr
+mcr m217
+	mov #c217, r1
+endmcr
+mcr m218
+	mov #c218, r2
+endmcr
+mcr m219
+	mov #c219, r3
+endmcr
+mcr m220
+	mov #c220, r4
+endmcr
+mcr m221
+	mov #c221, r5
+endmcr
+mcr m222
+	mov #c222, r6
+endmcr
+mcr m223
+	mov #c223, r7
+endmcr
+mcr m224
+	mov #c224, r0
+endmcr
+mcr m225
+	mov #c225, r1
+endmcr
+mcr m226
+	mov #c226, r2
+endmcr
+mcr m227
+	mov #c227, r3
+endmcr
+mcr m228
+	mov #c228, r4
+endmcr
+mcr m229
+	mov #c229, r5
+endmcr
+mcr m230
+	mov #c230, r6
+endmcr
+mcr m231
+	mov #c231, r7
+endmcr
+mcr m232
+	mov #c232, r0
+endmcr
+mcr m233
+	mov #c233, r1
+endmcr
+mcr m234
+	mov #c234, r2
+endmcr
+mcr m235
+	mov #c235, r3
+endmcr
+mcr m236
+	mov #c236, r4
+endmcr
+mcr m237
+	mov #c237, r5
+endmcr
+mcr m238
+	mov #c238, r6
+endmcr
+mcr m239
+	mov #c239, r7
+endmcr
+mcr m240
+	mov #c240, r0
+endmcr
+mcr m241
+	mov #c241, r1
+endmcr
+mcr m242
+	mov #c242, r2
+endmcr
+mcr m243
+	mov #c243, r3
+endmcr
+mcr m244
+	mov #c244, r4
+endmcr
+mcr m245
+	mov #c245, r5
+endmcr
+mcr m246
+	mov #c246, r6
+endmcr
+mcr m247
+	mov #c247, r7
+endmcr
+mcr m248
+	mov #c248, r0
+endmcr
+mcr m249
+	mov #c249, r1
+endmcr
+mcr m250
+	mov #c250, r2
+endmcr
+mcr m251
+	mov #c251, r3
+endmcr
+mcr m252
+	mov #c252, r4
+endmcr
+mcr m253
+	mov #c253, r5
+endmcr
+mcr m254
+	mov #c254, r6
+endmcr
+mcr m255
+	mov #c255, r7
+endmcr
+mcr m256
+	mov #c256, r0
+endmcr
+mcr m257
+	mov #c257, r1
+endmcr
+mcr m258
+	mov #c258, r2
+endmcr
+mcr m259
+	mov #c259, r3
+endmcr
+mcr m260
+	mov #c260, r4
+endmcr
+mcr m261
+	mov #c261, r5
+endmcr
+mcr m262
+	mov #c262, r6
+endmcr
+mcr m263
+	mov #c263, r7
+endmcr
+mcr m264
+	mov #c264, r0
+endmcr
+mcr m265
+	mov #c265, r1
+endmcr
+mcr m266
+	mov #c266, r2
+endmcr
+mcr m267
+	mov #c267, r3
+endmcr
+mcr m268
+	mov #c268, r4
+endmcr
+mcr m269
+	mov #c269, r5
+endmcr
+mcr m270
+	mov #c270, r6
+endmcr
+mcr m271
+	mov #c271, r7
+endmcr
+mcr m272
+	mov #c272, r0
+endmcr
+mcr m273
+	mov #c273, r1
+endmcr
+mcr m274
+	mov #c274, r2
+endmcr
+mcr m275
+	mov #c275, r3
+endmcr
+mcr m276
+	mov #c276, r4
+endmcr
+mcr m277
+	mov #c277, r5
+endmcr
+mcr m278
+	mov #c278, r6
+endmcr
+mcr m279
+	mov #c279, r7
+endmcr
+mcr m280
+	mov #c280, r0
+endmcr
+mcr m281
+	mov #c281, r1
+endmcr
+mcr m282
+	mov #c282, r2
+endmcr
+mcr m283
+	mov #c283, r3
+endmcr
+mcr m284
+	mov #c284, r4
+endmcr
+mcr m285
+	mov #c285, r5
+endmcr
+mcr m286
+	mov #c286, r6
+endmcr
+mcr m287
+	mov #c287, r7
+endmcr
+mcr m288
+	mov #c288, r0
+endmcr
+mcr m289
+	mov #c289, r1
+endmcr
+mcr m290
+	mov #c290, r2
+endmcr
+mcr m291
+	mov #c291, r3
+endmcr
+mcr m292
+	mov #c292, r4
+endmcr
+mcr m293
+	mov #c293, r5
+endmcr
+mcr m294
+	mov #c294, r6
+endmcr
+mcr m295
+	mov #c295, r7
+endmcr
+mcr m296
+	mov #c296, r0
+endmcr
+mcr m297
+	mov #c297, r1
+endmcr
+mcr m298
+	mov #c298, r2
+endmcr
+mcr m299
+	mov #c299, r3
+endmcr
+MAIN:	clr r0
+m0
+m1
+m2
+m3
+m4
+m5
+m6
+m7
+m8
+m9
+m10
+m11
+m12
+m13
+m14
+m15
+m16
+m17
+m18
+m19
+m20
+m21
+m22
+m23
+m24
+m25
+m26
+m27
+m28
+m29
+m30
+m31
+m32
+m33
+m34
+m35
+m36
+m37
+m38
+m39
+m40
+m41
+m42
+m43
+m44
+m45
+m46
+m47
+m48
+m49
+m50
+m51
+m52
+m53
+m54
+m55
+m56
+m57
+m58
+m59
+m60
+m61
+m62
+m63
+m64
+m65
+m66
+m67
+m68
+m69
+m70
+m71
+m72
+m73
+m74
+m75
+m76
+m77
+m78
+m79
+m80
+m81
+m82
+m83
+m84
+m85
+m86
+m87
+m88
+m89
+m90
+m91
+m92
+m93
+m94
+m95
+m96
+m97
+m98
+m99
+m100
+m101
+m102
+m103
+m104
+m105
+m106
+m107
+m108
+m109
+m110
+m111
+m112
+m113
+m114
+m115
+m116
+m117
+m118
+m119
+m120
+m121
+m122
+m123
+m124
+m125
+m126
+m127
+m128
+m129
+m130
+m131
+m132
+m133
+m134
+m135
+m136
+m137
+m138
+m139
+m140
+m141
+m142
+m143
+m144
+m145
+m146
+m147
+m148
+m149
+m150
+m151
+m152
+m153
+m154
+m155
+m156
+m157
+m158
+m159
+m160
+m161
+m162
+m163
+m164
+m165
+m166
+m167
+m168
+m169
+m170
+m171
+m172
+m173
+m174
+m175
+m176
+m177
+m178
+m179
+m180
+m181
+m182
+m183
+m184
+m185
+m186
+m187
+m188
+m189
+m190
+m191
+m192
+m193
+m194
+m195
+m196
+m197
+m198
+m199
+m200
+m201
+m202
+m203
+m204
+m205
+m206
+m207
+m208
+m209
+m210
+m211
+m212
+m213
+m214
+m215
+m216
+m217
+m218
+m219
+m220
+m221
+m222
+m223
+m224
+m225
+m226
+m227
+m228
+m229
+m230
+m231
+m232
+m233
+m234
+m235
+m236
+m237
+m238
+m239
+m240
+m241
+m242
+m243
+m244
+m245
+m246
+m247
+m248
+m249
+m250
+m251
+m252
+m253
+m254
+m255
+m256
+m257
+m258
+m259
+m260
+m261
+m262
+m263
+m264
+m265
+m266
+m267
+m268
+m269
+m270
+m271
+m272
+m273
+m274
+m275
+m276
+m277
+m278
+m279
+m280
+m281
+m282
+m283
+m284
+m285
+m286
+m287
+m288
+m289
+m290
+m291
+m292
+m293
+m294
+m295
+m296
+m297
+m298
+m299
+	cmp VALUES[c2], #c299
+	hlt
+VALUES: .data c0, c1, c2, c3
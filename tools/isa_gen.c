@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include "../globals.h"
+#include "../isa.h"
+
+/**
+ * The ISA table generator. it writes isa_tables.c to the standard output.
+ * The description of the instruction set is the instructionRules in globals.c (the opcodes and the allowed
+ * addressing modes), the word layout in isa.h, and the number of words every addressing mode takes below.
+ * Both passes of the assembler look the encoding of an instruction up in the generated tables.
+*/
+
+/* The number of additional words an operand takes in each addressing mode */
+static const int modeWords[MODE_COUNT] = {
+    /* immediate: the number */ 1,
+    /* direct: the address of the label */ 1,
+    /* indexed: the address of the label, and the index */ 2,
+    /* register: the register number */ 1,
+    /* none */ 0
+};
+
+/* The OperandType flag of each addressing mode */
+static const int modeFlags[MODE_COUNT - 1] = {OPERAND_TYPE_IMMEDIATE, OPERAND_TYPE_DIRECT, OPERAND_TYPE_INDEXED, OPERAND_TYPE_REGISTER};
+
+/* the is_legal function checks if an instruction allows the given addressing modes */
+static int is_legal(int opcode, int source, int destination) {
+    InstructionRule rule = instructionRules[opcode];
+    int operands = (source != MODE_NONE) + (destination != MODE_NONE);
+    if (operands != rule.numberOfOperandsRequired || (source != MODE_NONE && destination == MODE_NONE)) {
+        return 0;
+    }
+    if (source != MODE_NONE && (rule.allowedSourceTypes & modeFlags[source]) == 0) {
+        return 0;
+    }
+    if (destination != MODE_NONE && (rule.allowedDestinationTypes & modeFlags[destination]) == 0) {
+        return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    int opcode, source, destination, words, packed, firstWord, i;
+
+    printf("/* This file is generated by tools/isa_gen.c, do not edit it */\n");
+    printf("#include \"isa.h\"\n\n");
+
+    printf("/* The encoding of every instruction, indexed by [opcode][source mode][destination mode].\n");
+    printf("    every entry is {words, legal, packed registers, first word} */\n");
+    printf("const EncodingEntry encodingTable[OPCODE_COUNT][MODE_COUNT][MODE_COUNT] = {\n");
+    for (opcode = 0; opcode < OPCODE_COUNT; opcode++) {
+        printf("    { /* %s */\n", instructionRules[opcode].name);
+        for (source = 0; source < MODE_COUNT; source++) {
+            printf("        {");
+            for (destination = 0; destination < MODE_COUNT; destination++) {
+                /* two registers share one word, every other operand takes the words of its mode */
+                packed = source == MODE_REGISTER && destination == MODE_REGISTER;
+                words = 1 + (packed ? 1 : modeWords[source] + modeWords[destination]);
+                firstWord = opcode << OPCODE_SHIFT;
+                if (source != MODE_NONE) firstWord |= source << SOURCE_MODE_SHIFT;
+                if (destination != MODE_NONE) firstWord |= destination << DESTINATION_MODE_SHIFT;
+                printf("{%d, %d, %d, %d}%s", words, is_legal(opcode, source, destination), packed, firstWord,
+                    destination + 1 < MODE_COUNT ? ", " : "");
+            }
+            printf("}%s\n", source + 1 < MODE_COUNT ? "," : "");
+        }
+        printf("    }%s\n", opcode + 1 < OPCODE_COUNT ? "," : "");
+    }
+    printf("};\n\n");
+
+    printf("/* The number of additional words an operand takes in each addressing mode */\n");
+    printf("const unsigned char operandWords[MODE_COUNT] = {");
+    for (i = 0; i < MODE_COUNT; i++) {
+        printf("%d%s", modeWords[i], i + 1 < MODE_COUNT ? ", " : "");
+    }
+    printf("};\n\n");
+
+    printf("/* The addressing mode of every OperandType flag, or MODE_NONE if it isn't a flag */\n");
+    printf("const unsigned char operandModes[OPERAND_TYPE_COUNT] = {");
+    for (i = 0; i < OPERAND_TYPE_COUNT; i++) {
+        int mode = MODE_NONE;
+        for (source = 0; source < MODE_COUNT - 1; source++) {
+            if (modeFlags[source] == i) mode = source;
+        }
+        printf("%d%s", mode, i + 1 < OPERAND_TYPE_COUNT ? ", " : "");
+    }
+    printf("};\n\n");
+
+    /* with one operand it is the destination, with two operands the first is the source */
+    printf("/* The shift of a register number in an operand word, indexed by [the number of operands][the index of the operand] */\n");
+    printf("const unsigned char registerShifts[MAX_OPERANDS + 1][MAX_OPERANDS] = {{%d, %d}, {%d, %d}, {%d, %d}};\n",
+        DESTINATION_REGISTER_SHIFT, DESTINATION_REGISTER_SHIFT,
+        DESTINATION_REGISTER_SHIFT, DESTINATION_REGISTER_SHIFT,
+        SOURCE_REGISTER_SHIFT, DESTINATION_REGISTER_SHIFT);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <stdlib.h>
+#include <string.h>
+#include "translation.h"
+#include "constants.h"
+#include "word_image.h"
+#include "data_structures/node.h"
+#include "data_structures/hashtable.h"
+
+/* the create_translation function allocates a translation that can be used to assemble one file after the other,
+    for a machine with memorySize words of memory. it returns NULL if the memory could not be allocated */
+translation* create_translation(int memorySize) {
+    translation* output = calloc(1, sizeof(translation));
+    if (output == NULL) {
+        return NULL;
+    }
+    /* the pages of the images are allocated only when the second pass writes to them */
+    if (init_word_image(&output->code_image, memorySize) != 0 || init_word_image(&output->data_image, memorySize) != 0) {
+        free_word_image(&output->code_image);
+        free(output);
+        return NULL;
+    }
+    output->constants_table = create_hashtable();
+    if (output->constants_table == NULL) {
+        free_word_image(&output->code_image);
+        free_word_image(&output->data_image);
+        free(output);
+        return NULL;
+    }
+    output->memory_size = memorySize;
+    output->symbol_table_head = NULL;
+    output->external_table_head = NULL;
+    output->free_symbols = NULL;
+    output->free_externals = NULL;
+    output->IC = START_POSITION;
+    output->DC = 0;
+    output->code_lines = NULL;
+    return output;
+}
+
+/* the enable_line_map function makes the second pass keep the line of every instruction in code_lines,
+    so that a .map file can be written with the output files. returns 0 on success and 1 if the memory could not be allocated */
+int enable_line_map(translation* output) {
+    if (output->code_lines == NULL) {
+        output->code_lines = calloc(output->memory_size, sizeof(int));
+    }
+    return output->code_lines == NULL;
+}
+
+/* the reset_translation function readies a translation for the next file.
+    only the pages of the images that the previous file wrote to are zeroed, and the nodes of the symbol table,
+    the externals table and the constants table are kept for the next file instead of being freed */
+void reset_translation(translation* output) {
+    clear_word_image(&output->code_image);
+    clear_word_image(&output->data_image);
+    if (output->code_lines != NULL && output->IC > START_POSITION) {
+        memset(output->code_lines + START_POSITION, 0, ((output->IC < output->memory_size ? output->IC : output->memory_size) - START_POSITION) * sizeof(int));
+    }
+    output->IC = START_POSITION;
+    output->DC = 0;
+
+    recycle_symbols(output->symbol_table_head, &output->free_symbols);
+    output->symbol_table_head = NULL;
+    recycle_externals(output->external_table_head, &output->free_externals);
+    output->external_table_head = NULL;
+    clear_hashtable(output->constants_table);
+}
+
+/* the free_translation function frees a translation and everything that it kept between files */
+void free_translation(translation* output) {
+    if (output == NULL) {
+        return;
+    }
+    free_word_image(&output->code_image);
+    free_word_image(&output->data_image);
+    free_symbols(output->symbol_table_head);
+    free_symbols(output->free_symbols);
+    free_externals(output->external_table_head);
+    free_externals(output->free_externals);
+    free_hashtable(output->constants_table);
+    if (output->code_lines != NULL) free(output->code_lines);
+    free(output);
+}
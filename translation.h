@@ -0,0 +1,22 @@
+#ifndef TRANSLATION_H
+#define TRANSLATION_H
+
+#include "structs.h"
+
+/* the create_translation function allocates a translation that can be used to assemble one file after the other,
+    for a machine with memorySize words of memory. it returns NULL if the memory could not be allocated */
+translation* create_translation(int memorySize);
+
+/* the reset_translation function readies a translation for the next file.
+    only the pages of the images that the previous file wrote to are zeroed, and the nodes of the symbol table,
+    the externals table and the constants table are kept for the next file instead of being freed */
+void reset_translation(translation* output);
+
+/* the enable_line_map function makes the second pass keep the line of every instruction in code_lines,
+    so that a .map file can be written with the output files. returns 0 on success and 1 if the memory could not be allocated */
+int enable_line_map(translation* output);
+
+/* the free_translation function frees a translation and everything that it kept between files */
+void free_translation(translation* output);
+
+#endif
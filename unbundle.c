@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <string.h>
+#include "bundle.h"
+
+/* Writes the content of a file in the bundle to a file with the same name */
+static int extract_entry(const Bundle* bundle, const BundleEntry* entry, FILE* destination) {
+    FILE* file = destination;
+    int error = 0;
+    if (file == NULL) {
+        file = fopen(entry->name, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Error creating file \"%s\"\n", entry->name);
+            return 1;
+        }
+    }
+    if (entry->size > 0 && fwrite(bundle_entry_data(bundle, entry), 1, entry->size, file) != entry->size) {
+        fprintf(stderr, "Error writing file \"%s\"\n", entry->name);
+        error = 1;
+    }
+    if (destination == NULL) {
+        fclose(file);
+    }
+    return error;
+}
+
+/**
+ * The main function of the bundle extractor.
+ * Usage:
+ *   unbundle --list BUNDLE            list the files in the bundle
+ *   unbundle BUNDLE [NAME...]         extract the named files (or all of the files) next to their original names
+ *   unbundle --stdout BUNDLE NAME...  write the content of the named files to the standard output
+*/
+int main(int argc, char** argv) {
+    Bundle bundle;
+    const BundleEntry* entry;
+    int i, first = 1, list = 0, toStdout = 0, error = 0;
+
+    if (argc > 1 && strcmp(argv[1], "--list") == 0) {
+        list = 1;
+        first = 2;
+    } else if (argc > 1 && strcmp(argv[1], "--stdout") == 0) {
+        toStdout = 1;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: unbundle [--list | --stdout] BUNDLE [NAME...]\n");
+        return 1;
+    }
+    if (open_bundle(argv[first], &bundle) != 0) {
+        fprintf(stderr, "Bundle %s could not be opened or is not a valid bundle\n", argv[first]);
+        return 1;
+    }
+
+    if (list) {
+        for (i = 0; i < bundle.count; i++) {
+            printf("%10lu %s\n", (unsigned long)bundle.entries[i].size, bundle.entries[i].name);
+        }
+    } else if (first + 1 == argc) {
+        /* extract everything, in the order the files were added so a later file with the same name wins */
+        for (i = 0; i < bundle.count; i++) {
+            error |= extract_entry(&bundle, &bundle.entries[i], toStdout ? stdout : NULL);
+        }
+    } else {
+        for (i = first + 1; i < argc; i++) {
+            entry = find_in_bundle(&bundle, argv[i]);
+            if (entry == NULL) {
+                fprintf(stderr, "File \"%s\" is not in the bundle\n", argv[i]);
+                error = 1;
+                continue;
+            }
+            error |= extract_entry(&bundle, entry, toStdout ? stdout : NULL);
+        }
+    }
+    close_bundle(&bundle);
+    return error;
+}
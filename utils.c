@@ -5,6 +5,7 @@
 #include "structs.h"
 #include "globals.h"
 #include "data_structures/hashtable.h"
+#include "diagnostics.h"
 
 /* Function to concatenate two strings and return the result. 
 The returned string has to be freed by the caller. */
@@ -254,6 +255,7 @@ void free_parsed_syntax_line(ParsedSyntaxLine* line) {
             /* These types don't hold dynamically allocated memory */
             break;
     }
+    free_diagnostic(line->error);
     free(line);
 }
 
@@ -335,7 +337,7 @@ boolean is_token_label(const char* token) {
     }
     
     /* Create a temporary copy of the token without the colon */
-    strncpy(tokenWithoutColon, token, len - 1);
+    memcpy(tokenWithoutColon, token, len - 1);
     tokenWithoutColon[len - 1] = '\0'; /* Null-terminate the string */
 
     return is_label(tokenWithoutColon);
@@ -369,18 +371,21 @@ void operand_types_to_string(int types, char* buffer) {
     }
 }
 
-/* Function to correctly inform the user of an error regarding an invalid operand.
-It generates and copies a full error message to the error variable */
-void sprint_operand_error(char error[], int opcode, int operandNumber, const char* token, OperandType invalidOperandType) {
-    char sourceTypes[100];
-    char destinationTypes[100];
-    char invalidOperand[100];
-
-    /* Convert operand types to string */
-    operand_types_to_string(instructionRules[opcode].allowedSourceTypes, sourceTypes);
-    operand_types_to_string(instructionRules[opcode].allowedDestinationTypes, destinationTypes);
-    operand_types_to_string(invalidOperandType, invalidOperand);
+/* Writes a number as length little-endian bytes, the way the numbers of the bundles and the libraries are kept */
+void put_le_number(unsigned char* bytes, unsigned long value, int length) {
+    int i;
+    for (i = 0; i < length; i++) {
+        bytes[i] = (unsigned char)(value & 0xFF);
+        value >>= 8;
+    }
+}
 
-    sprintf(error, "Error: Operand %d ('%s') of type %s is invalid for instruction '%s'. Allowed source types: [%s]. Allowed destination types: [%s].",
-            operandNumber, token, invalidOperand, instructionRules[opcode].name, sourceTypes, destinationTypes);
+/* Reads a number of length little-endian bytes */
+unsigned long get_le_number(const unsigned char* bytes, int length) {
+    unsigned long value = 0;
+    int i;
+    for (i = length - 1; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
 }
@@ -76,6 +76,8 @@ boolean is_string_printable(const char* token);
 /* Function to check if convert the types integer to a list of strings consisting the names of the types seperated by a comma. */
 void operand_types_to_string(int types, char* buffer);
 
-/* Function to correctly inform the user of an error regarding an invalid operand.
-It generates and copies a full error message to the error variable */
-void sprint_operand_error(char error[], int opcode, int operandNumber, const char* token, OperandType invalidOperandType);
\ No newline at end of file
+/* Writes a number as length little-endian bytes, the way the numbers of the bundles and the libraries are kept */
+void put_le_number(unsigned char* bytes, unsigned long value, int length);
+
+/* Reads a number of length little-endian bytes */
+unsigned long get_le_number(const unsigned char* bytes, int length);
\ No newline at end of file
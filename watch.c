@@ -0,0 +1,193 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "watch.h"
+#include "assemble_file.h"
+#include "incremental.h"
+#include "utils.h"
+#include "diagnostics.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#define HAS_INOTIFY 1
+#endif
+
+#define WATCH_DEBOUNCE_MS 50 /* how long to wait for more saves before assembling the files that were saved */
+#define WATCH_BUFFER_SIZE 4096
+
+#ifdef HAS_INOTIFY
+
+/* A file that is watched. The directory of the file is watched and not the file itself,
+ because many editors save by writing a new file and renaming it over the old one */
+typedef struct {
+    int directory; /* the watch descriptor of the directory of the file */
+    char* asName; /* the name of the .as file */
+    const char* name; /* the name of the .as file inside its directory (points into asName) */
+    boolean changed; /* the file was saved since it was last assembled */
+    boolean incremental; /* state is used to assemble the file, it is FALSE with --stream */
+    IncrementalFile state; /* the lines of the last build of the file, so only the lines that changed are assembled again */
+} WatchedFile;
+
+/* the add_watch function watches the directory of the file. returns 0 on success and 1 on error */
+static int add_watch(int fd, const char* fileName, WatchedFile* file) {
+    char* slash;
+    int result = 0;
+
+    file->asName = concatenate_strings(fileName, ".as");
+    if (file->asName == NULL) {
+        fprintf(stderr, "Failed to allocate memory for as file name\n");
+        return 1;
+    }
+    slash = strrchr(file->asName, '/');
+    if (slash == NULL) {
+        file->name = file->asName;
+        file->directory = inotify_add_watch(fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO);
+    } else {
+        file->name = slash + 1;
+        /* the name of the directory is the part of asName before the slash ("/" for a file in the root) */
+        *slash = '\0';
+        file->directory = inotify_add_watch(fd, slash == file->asName ? "/" : file->asName, IN_CLOSE_WRITE | IN_MOVED_TO);
+        *slash = '/';
+    }
+    if (file->directory < 0) {
+        fprintf(stderr, "The directory of %s could not be watched.\n", file->asName);
+        result = 1;
+    }
+    return result;
+}
+
+/* the read_events function reads the events that are waiting and marks the files that they are about as changed.
+    returns 0 on success and 1 on error */
+static int read_events(int fd, WatchedFile* files, int fileCount) {
+    long buffer[WATCH_BUFFER_SIZE / sizeof(long)]; /* long keeps the events aligned */
+    const struct inotify_event* event;
+    ssize_t size;
+    size_t offset;
+    int i;
+
+    size = read(fd, buffer, sizeof(buffer));
+    if (size < 0) {
+        return errno != EINTR && errno != EAGAIN;
+    }
+    for (offset = 0; offset < (size_t)size; offset += sizeof(struct inotify_event) + event->len) {
+        event = (const struct inotify_event*)((const char*)buffer + offset);
+        for (i = 0; i < fileCount; i++) {
+            /* when events were dropped, any of the files may have been saved */
+            if ((event->mask & IN_Q_OVERFLOW) ||
+                (event->len > 0 && event->wd == files[i].directory && strcmp(event->name, files[i].name) == 0)) {
+                files[i].changed = TRUE;
+            }
+        }
+    }
+    return 0;
+}
+
+/* the assemble_watched function assembles a watched file, from the lines of its last build when it can */
+static void assemble_watched(WatchedFile* file, const char* fileName, const AssemblerOptions* options, translation* output) {
+    if (file->incremental) {
+        assemble_incremental(&file->state, fileName, options);
+    } else {
+        assemble_file(fileName, NULL, options, output);
+    }
+    /* the output of every file is shown as soon as it is assembled, even when stdout isn't a terminal */
+    fflush(stdout);
+}
+
+/* the wait_for_events function waits up to timeout milliseconds (-1 for no limit) for events.
+    returns 1 if there are events to read, 0 if there weren't any and -1 on error */
+static int wait_for_events(int fd, int timeout) {
+    struct pollfd request;
+    int ready;
+
+    request.fd = fd;
+    request.events = POLLIN;
+    do {
+        ready = poll(&request, 1, timeout);
+    } while (ready < 0 && errno == EINTR);
+    return ready < 0 ? -1 : ready > 0;
+}
+
+int watch_files(char** fileNames, int fileCount, const AssemblerOptions* options, translation* output) {
+    WatchedFile* files;
+    clock_t start;
+    int i, assembled, fd, result = 1;
+
+    files = calloc(fileCount, sizeof(WatchedFile));
+    if (files == NULL) {
+        fprintf(stderr, "Failed to allocate memory for the watched files\n");
+        return 1;
+    }
+    fd = inotify_init();
+    if (fd < 0) {
+        fprintf(stderr, "The files could not be watched.\n");
+        free(files);
+        return 1;
+    }
+    for (i = 0; i < fileCount; i++) {
+        if (add_watch(fd, fileNames[i], &files[i]) != 0) {
+            goto end;
+        }
+        /* a streamed file isn't kept in memory, so it is assembled from the start every time */
+        if (!options->streaming) {
+            if (init_incremental_file(&files[i].state, output->memory_size, output->code_lines != NULL) != 0) {
+                fprintf(stderr, "Failed to allocate memory for the watched files\n");
+                goto end;
+            }
+            files[i].incremental = TRUE;
+        }
+    }
+    /* the files are watched before they are first assembled, so a save during the first build isn't missed */
+    for (i = 0; i < fileCount; i++) {
+        assemble_watched(&files[i], fileNames[i], options, output);
+    }
+    flush_diagnostics();
+
+    printf("Watching %d file%s for changes\n\n", fileCount, fileCount == 1 ? "" : "s");
+    fflush(stdout);
+    while (wait_for_events(fd, -1) > 0) {
+        if (read_events(fd, files, fileCount) != 0) {
+            break;
+        }
+        /* an editor can write a file more than once when it is saved, so the files are assembled after the saves stop */
+        while (wait_for_events(fd, WATCH_DEBOUNCE_MS) > 0 && read_events(fd, files, fileCount) == 0);
+
+        start = clock();
+        assembled = 0;
+        for (i = 0; i < fileCount; i++) {
+            if (files[i].changed) {
+                files[i].changed = FALSE;
+                assemble_watched(&files[i], fileNames[i], options, output);
+                assembled++;
+            }
+        }
+        if (assembled > 0) {
+            printf("Assembled %d file%s in %.3f ms, watching for changes\n\n", assembled, assembled == 1 ? "" : "s",
+                (double)(clock() - start) * 1000 / CLOCKS_PER_SEC);
+            fflush(stdout);
+        }
+    }
+    fprintf(stderr, "Stopped watching the files after an error.\n");
+
+    end:
+    for (i = 0; i < fileCount; i++) {
+        if (files[i].asName != NULL) free(files[i].asName);
+        if (files[i].incremental) free_incremental_file(&files[i].state);
+    }
+    free(files);
+    close(fd);
+    return result;
+}
+
+#else
+
+int watch_files(char** fileNames, int fileCount, const AssemblerOptions* options, translation* output) {
+    fprintf(stderr, "--watch is only available on Linux.\n");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "structs.h"
+
+/* the watch_files function assembles the .as files of fileNames (base names, without the extension), then waits for them to be saved
+    and assembles every file that was saved again. the lines of the last build of every file are kept (see incremental.h),
+    so only the lines that changed are assembled again. with --stream the files are assembled from the start into output.
+    the saves that come within WATCH_DEBOUNCE_MS of each other are handled together, so a file is assembled once for a burst of saves.
+    it only returns on error (1), or if watching isn't available on this system */
+int watch_files(char** fileNames, int fileCount, const AssemblerOptions* options, translation* output);
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdlib.h>
+#include <string.h>
+#include "word_image.h"
+#include "constants.h"
+
+/* the get_page function returns the page that holds address, it is allocated if create is set */
+static unsigned short * get_page(WordImage* image, int address, int create) {
+    int page = address / IMAGE_PAGE_SIZE;
+    if (address < 0 || page >= image->pageCount) {
+        return NULL;
+    }
+    if (image->pages[page] == NULL && create) {
+        image->pages[page] = calloc(IMAGE_PAGE_SIZE, sizeof(unsigned short));
+        if (image->pages[page] == NULL) {
+            image->failed = 1;
+        }
+    }
+    return image->pages[page];
+}
+
+/* the init_word_image function readies an empty image that can hold size words, no page is allocated yet.
+    returns 0 on success and 1 if the memory could not be allocated */
+int init_word_image(WordImage* image, int size) {
+    image->pageCount = (size + IMAGE_PAGE_SIZE - 1) / IMAGE_PAGE_SIZE;
+    image->pages = calloc(image->pageCount, sizeof(unsigned short *));
+    image->used = 0;
+    image->failed = 0;
+    if (image->pages == NULL) {
+        image->pageCount = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/* the image_word function returns the word at address, a word that was never written is 0 */
+int image_word(const WordImage* image, int address) {
+    int page = address / IMAGE_PAGE_SIZE;
+    if (address < 0 || page >= image->pageCount || image->pages[page] == NULL) {
+        return 0;
+    }
+    return image->pages[page][address % IMAGE_PAGE_SIZE];
+}
+
+/* the set_image_word function writes the word at address, allocating its page if needed.
+    returns 0 on success and 1 if the address is outside of the image or the page could not be allocated */
+int set_image_word(WordImage* image, int address, int word) {
+    unsigned short * page = get_page(image, address, 1);
+    if (page == NULL) {
+        return 1;
+    }
+    page[address % IMAGE_PAGE_SIZE] = (unsigned short)(word & WORD_MASK);
+    if (address >= image->used) {
+        image->used = address + 1;
+    }
+    return 0;
+}
+
+/* the or_image_word function adds the given bits to the word at address, like set_image_word */
+int or_image_word(WordImage* image, int address, int bits) {
+    return set_image_word(image, address, image_word(image, address) | bits);
+}
+
+/* the clear_word_image function zeroes the words that were written, the pages are kept for the next use */
+void clear_word_image(WordImage* image) {
+    int page;
+    for (page = 0; page * IMAGE_PAGE_SIZE < image->used; page++) {
+        if (image->pages[page] != NULL) {
+            memset(image->pages[page], 0, IMAGE_PAGE_SIZE * sizeof(unsigned short));
+        }
+    }
+    image->used = 0;
+    image->failed = 0;
+}
+
+/* the free_word_image function frees the pages of the image */
+void free_word_image(WordImage* image) {
+    int page;
+    for (page = 0; page < image->pageCount; page++) {
+        free(image->pages[page]);
+    }
+    free(image->pages);
+    image->pages = NULL;
+    image->pageCount = 0;
+    image->used = 0;
+}
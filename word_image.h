@@ -0,0 +1,26 @@
+#ifndef WORD_IMAGE_H
+#define WORD_IMAGE_H
+
+#include "structs.h"
+
+/* the init_word_image function readies an empty image that can hold size words, no page is allocated yet.
+    returns 0 on success and 1 if the memory could not be allocated */
+int init_word_image(WordImage* image, int size);
+
+/* the image_word function returns the word at address, a word that was never written is 0 */
+int image_word(const WordImage* image, int address);
+
+/* the set_image_word function writes the word at address, allocating its page if needed.
+    returns 0 on success and 1 if the address is outside of the image or the page could not be allocated */
+int set_image_word(WordImage* image, int address, int word);
+
+/* the or_image_word function adds the given bits to the word at address, like set_image_word */
+int or_image_word(WordImage* image, int address, int bits);
+
+/* the clear_word_image function zeroes the words that were written, the pages are kept for the next use */
+void clear_word_image(WordImage* image);
+
+/* the free_word_image function frees the pages of the image */
+void free_word_image(WordImage* image);
+
+#endif
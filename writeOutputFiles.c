@@ -4,99 +4,147 @@
 #include "utils.h"
 #include "constants.h"
 #include "writeOutputFiles.h"
+#include "output_buffer.h"
+#include "batch_io.h"
+#include "word_image.h"
 #include "data_structures/node.h"
 
-/* the write_output_files function creates the output files that describe the whole program */
+/* the format_word_line function writes the line of a word in the .ob file, like "%04d %s\n" with the encrypted word,
+    without allocating the encrypted word. returns the length of the line */
+static int format_word_line (char * line, int address, int code) {
+  static const char digits[] = "*#%!";
+  int i, length;
+  if (address >= 10000) {
+    length = sprintf(line, "%04d ", address);
+  } else {
+    for (i = 3; i >= 0; i--, address /= 10) {
+      line[i] = '0' + address % 10;
+    }
+    line[4] = ' ';
+    length = 5;
+  }
+  for (i = ENCRYPTED_WORD_LENGTH - 1; i >= 0; i--, code >>= 2) {
+    line[length + i] = digits[code & 3];
+  }
+  length += ENCRYPTED_WORD_LENGTH;
+  line[length++] = '\n';
+  return length;
+}
+
+/* the write_output_files function creates the output files that describe the whole program.
+    the content of each file is built in memory, and then the file is written (or queued to be written in batch mode) */
 void write_output_files (const char * filename, translation * output) {
   char * obName;
   char * entName;
   char * extName;
-  FILE * obFile;
-  FILE * entFile = NULL;
-  FILE * extFile = NULL;
+  OutputBuffer obFile;
+  OutputBuffer entFile;
+  OutputBuffer extFile;
+  char line[MAX_LABEL_LENGTH + 32];
   int i, j;
-  char * encrypted;
   Symbol_Node * current;
   External_Node * currentExt;
 
   obName = concatenate_strings(filename, ".ob");
   entName = concatenate_strings(filename, ".ent");
   extName = concatenate_strings(filename, ".ext");
+  init_output_buffer(&obFile, NULL);
+  init_output_buffer(&entFile, NULL);
+  init_output_buffer(&extFile, NULL);
 
-  obFile = fopen(obName, "w");
-  if (obFile) {
-    printf("Creating .ob file for file \"%s\"\n", filename);
-    fprintf(obFile, "%4d %d\n", output->IC - START_POSITION, output->DC); /* the tile of the file */
-    for (i = START_POSITION; i < output->IC; i++) { /* for each word in the code image */
-      encrypted = encrypt(output->code_image[i]);
-      fprintf(obFile, "%04d %s\n", i, encrypted);
-      free(encrypted);
-    }
-    for (i = output->IC; i < output->IC + output->DC; i++) { /* for each word in the data image */
-      encrypted = encrypt(output->data_image[i - output->IC]);
-      fprintf(obFile, "%04d %s\n", i, encrypted);
-      free(encrypted);
-    }
-    for (current = output->symbol_table_head; current != NULL; current = current->next) {
-      /* for each symbol in the symbol table */
-      if (current->symbol->type == ENUM_SYMBOL_ENTRY_DATA ||
-        current->symbol->type == ENUM_SYMBOL_ENTRY_CODE ||
-        current->symbol->type == ENUM_SYMBOL_ENTRY_STRING) {
-          /* if the symbol is an entry */
-          if (entFile == NULL) {
-            entFile = fopen(entName, "w");
-            if (entFile) {
-              printf("Creating .ent file for file \"%s\"\n", filename);
-              /* write the name of the symbol, and it's address */
-              fprintf(entFile, "%-10s\t%04d\n", current->symbol->name, current->symbol->address);
-            } else {
-              printf("Error creating .ent file for file \"%s\"\n", filename);
-            }
-          } else {
-            /* write the name of the symbol, and it's address */
-            fprintf(entFile, "%-10s\t%04d\n", current->symbol->name, current->symbol->address);
-          }
-        }
-    }
-    for (currentExt = output->external_table_head; currentExt != NULL; currentExt = currentExt->next) {
-      /* for each external in the external table. 
-        if there is no use of an external, the loop will be skipped */
-      if (extFile == NULL) {
-        extFile = fopen(extName, "w");
-        if (extFile) {
-          printf("Creating .ext file for file \"%s\"\n", filename);
-          for (j = 0; j < currentExt->external->numOfUse; j++) {
-            /* for each use of the external, write the name of the external,
-                and the address it was used in */
-            fprintf(extFile, "%-10s\t%04d\n", currentExt->external->name, currentExt->external->addresses[j]);
-          }
-        } else {
-          printf("Error creating .ext file for file \"%s\"\n", filename);
-        }
-      } else {
-        for (j = 0; j < currentExt->external->numOfUse; j++) {
-          /* for each use of the external, write the name of the external,
-              and the address it was used in */
-          fprintf(extFile, "%-10s\t%04d\n", currentExt->external->name, currentExt->external->addresses[j]);
+  printf("Creating .ob file for file \"%s\"\n", filename);
+  sprintf(line, "%4d %d\n", output->IC - START_POSITION, output->DC); /* the tile of the file */
+  output_puts(&obFile, line);
+  for (i = START_POSITION; i < output->IC; i++) { /* for each word in the code image */
+    output_write(&obFile, line, format_word_line(line, i, image_word(&output->code_image, i)));
+  }
+  for (i = output->IC; i < output->IC + output->DC; i++) { /* for each word in the data image */
+    output_write(&obFile, line, format_word_line(line, i, image_word(&output->data_image, i - output->IC)));
+  }
+  for (current = output->symbol_table_head; current != NULL; current = current->next) {
+    /* for each symbol in the symbol table */
+    if (current->symbol->type == ENUM_SYMBOL_ENTRY_DATA ||
+      current->symbol->type == ENUM_SYMBOL_ENTRY_CODE ||
+      current->symbol->type == ENUM_SYMBOL_ENTRY_STRING) {
+        /* if the symbol is an entry */
+        if (entFile.size == 0) {
+          printf("Creating .ent file for file \"%s\"\n", filename);
         }
+        /* write the name of the symbol, and it's address */
+        sprintf(line, "%-10s\t%04d\n", current->symbol->name, current->symbol->address);
+        output_puts(&entFile, line);
       }
+  }
+  for (currentExt = output->external_table_head; currentExt != NULL; currentExt = currentExt->next) {
+    /* for each external in the external table. 
+      if there is no use of an external, the loop will be skipped */
+    if (extFile.size == 0) {
+      printf("Creating .ext file for file \"%s\"\n", filename);
     }
-    fclose(obFile);
-    if (entFile) {
-      fclose(entFile);
-    }
-    if (extFile) {
-      fclose(extFile);
+    for (j = 0; j < currentExt->external->numOfUse; j++) {
+      /* for each use of the external, write the name of the external,
+          and the address it was used in */
+      sprintf(line, "%-10s\t%04d\n", currentExt->external->name, currentExt->external->addresses[j]);
+      output_puts(&extFile, line);
     }
-  } else {
-    fprintf(stderr, "Error creating .ob file for file \"%s\"\n", filename);
   }
 
+  if (output->code_lines != NULL) {
+    write_map_file(filename, output);
+  }
+
+  write_output_file(obName, &obFile);
+  if (entFile.size > 0) {
+    write_output_file(entName, &entFile);
+  }
+  if (extFile.size > 0) {
+    write_output_file(extName, &extFile);
+  }
+
+  free_output_buffer(&obFile);
+  free_output_buffer(&entFile);
+  free_output_buffer(&extFile);
   free(entName);
   free(extName);
   free(obName);
 }
 
+/* the write_map_file function writes the .map file of the program, that the profiler of the emulator reads.
+    it has a "symbol NAME ADDRESS" line for every symbol of the code and the data, and a "line ADDRESS LINE" line
+    for every instruction, with the line of the .am file that it came from */
+void write_map_file (const char * filename, translation * output) {
+  char * mapName;
+  OutputBuffer mapFile;
+  char line[MAX_LABEL_LENGTH + 32];
+  Symbol_Node * current;
+  int i;
+
+  mapName = concatenate_strings(filename, ".map");
+  if (mapName == NULL) {
+    fprintf(stderr, "Failed to allocate memory for map file name\n");
+    return;
+  }
+  init_output_buffer(&mapFile, NULL);
+  printf("Creating .map file for file \"%s\"\n", filename);
+  for (current = output->symbol_table_head; current != NULL; current = current->next) {
+    if (current->symbol->type != ENUM_SYMBOL_ENTRY && current->symbol->type != ENUM_SYMBOL_EXTERN &&
+      current->symbol->type != ENUM_SYMBOL_CONSTANT_MACRO) {
+        /* only the symbols that have an address */
+        sprintf(line, "symbol %s %04d\n", current->symbol->name, current->symbol->address);
+        output_puts(&mapFile, line);
+      }
+  }
+  for (i = START_POSITION; i < output->IC && i < output->memory_size; i++) {
+    if (output->code_lines[i] != 0) {
+      sprintf(line, "line %04d %d\n", i, output->code_lines[i]);
+      output_puts(&mapFile, line);
+    }
+  }
+  write_output_file(mapName, &mapFile);
+  free_output_buffer(&mapFile);
+  free(mapName);
+}
+
 /* the encrypt function translates the binary word into an encrypted base-4 word */
 char * encrypt (int code) {
   char * result = calloc(ENCRYPTED_WORD_LENGTH + 1, sizeof(char));
@@ -6,6 +6,9 @@
 /* the write_output_files function creates the output files that describe the whole program */
 void write_output_files (const char * filename, translation * output);
 
+/* the write_map_file function writes the .map file of the program, with the addresses of its symbols and the line of every instruction */
+void write_map_file (const char * filename, translation * output);
+
 /* the encrypt function translates the binary word into an encrypted base-4 word */
 char * encrypt (int code);
 